@@ -18,7 +18,9 @@ void AssetManager::PushFront(std::unique_ptr<AssetResolver> resolver) {
     return;
   }
 
+  std::scoped_lock lock(mutex_);
   resolvers_.push_front(std::move(resolver));
+  resolver_cache_.clear();
 }
 
 void AssetManager::PushBack(std::unique_ptr<AssetResolver> resolver) {
@@ -26,7 +28,32 @@ void AssetManager::PushBack(std::unique_ptr<AssetResolver> resolver) {
     return;
   }
 
+  std::scoped_lock lock(mutex_);
   resolvers_.push_back(std::move(resolver));
+  resolver_cache_.clear();
+}
+
+std::vector<const AssetResolver*> AssetManager::GetResolvers() const {
+  std::scoped_lock lock(mutex_);
+  std::vector<const AssetResolver*> resolvers;
+  resolvers.reserve(resolvers_.size());
+  for (const auto& resolver : resolvers_) {
+    resolvers.push_back(resolver.get());
+  }
+  return resolvers;
+}
+
+const AssetResolver* AssetManager::GetCachedResolver(
+    const std::string& asset_name) const {
+  std::scoped_lock lock(mutex_);
+  auto found = resolver_cache_.find(asset_name);
+  return found != resolver_cache_.end() ? found->second : nullptr;
+}
+
+// Whether |resolver| has the asset, whatever its size.
+static bool HasAsset(const AssetResolver& resolver,
+                     const std::string& asset_name) {
+  return resolver.GetRangeAsMapping(asset_name, 0, 0) != nullptr;
 }
 
 // |AssetResolver|
@@ -37,18 +64,76 @@ std::unique_ptr<fml::Mapping> AssetManager::GetAsMapping(
   }
   TRACE_EVENT1("flutter", "AssetManager::GetAsMapping", "name",
                asset_name.c_str());
-  for (const auto& resolver : resolvers_) {
+  const AssetResolver* cached_resolver = GetCachedResolver(asset_name);
+  if (cached_resolver != nullptr) {
+    auto mapping = cached_resolver->GetAsMapping(asset_name);
+    if (mapping != nullptr) {
+      return mapping;
+    }
+  }
+
+  for (const auto* resolver : GetResolvers()) {
+    if (resolver == cached_resolver) {
+      continue;
+    }
     auto mapping = resolver->GetAsMapping(asset_name);
     if (mapping != nullptr) {
+      std::scoped_lock lock(mutex_);
+      resolver_cache_[asset_name] = resolver;
       return mapping;
     }
   }
+
+  if (cached_resolver != nullptr) {
+    std::scoped_lock lock(mutex_);
+    resolver_cache_.erase(asset_name);
+  }
+  FML_DLOG(WARNING) << "Could not find asset: " << asset_name;
+  return nullptr;
+}
+
+// |AssetResolver|
+std::unique_ptr<fml::Mapping> AssetManager::GetRangeAsMapping(
+    const std::string& asset_name,
+    size_t offset,
+    size_t length) const {
+  if (asset_name.size() == 0) {
+    return nullptr;
+  }
+  TRACE_EVENT1("flutter", "AssetManager::GetRangeAsMapping", "name",
+               asset_name.c_str());
+  // Only the first resolver that has the asset is read from, so a range past
+  // its end doesn't fall through to the assets it shadows. The remembered
+  // resolvers are only updated by |GetAsMapping|.
+  const AssetResolver* cached_resolver = GetCachedResolver(asset_name);
+  if (cached_resolver != nullptr) {
+    auto mapping =
+        cached_resolver->GetRangeAsMapping(asset_name, offset, length);
+    if (mapping != nullptr || HasAsset(*cached_resolver, asset_name)) {
+      return mapping;
+    }
+  }
+
+  for (const auto* resolver : GetResolvers()) {
+    if (resolver == cached_resolver) {
+      continue;
+    }
+    auto mapping = resolver->GetRangeAsMapping(asset_name, offset, length);
+    if (mapping != nullptr) {
+      return mapping;
+    }
+    if (HasAsset(*resolver, asset_name)) {
+      FML_DLOG(WARNING) << "Range is past the end of asset: " << asset_name;
+      return nullptr;
+    }
+  }
   FML_DLOG(WARNING) << "Could not find asset: " << asset_name;
   return nullptr;
 }
 
 // |AssetResolver|
 bool AssetManager::IsValid() const {
+  std::scoped_lock lock(mutex_);
   return resolvers_.size() > 0;
 }
 
@@ -7,7 +7,10 @@
 
 #include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "flutter/assets/asset_resolver.h"
 #include "flutter/fml/macros.h"
@@ -15,6 +18,12 @@
 
 namespace flutter {
 
+/// Resolves assets with the first of its resolvers that has them.
+///
+/// The resolver that an asset was found in is remembered, so later lookups of
+/// the asset don't have to try the resolvers before it. This class is
+/// thread-safe, and resolvers can be added while assets are being read on
+/// other threads.
 class AssetManager final : public AssetResolver {
  public:
   AssetManager();
@@ -32,8 +41,26 @@ class AssetManager final : public AssetResolver {
   std::unique_ptr<fml::Mapping> GetAsMapping(
       const std::string& asset_name) const override;
 
+  // |AssetResolver|
+  std::unique_ptr<fml::Mapping> GetRangeAsMapping(
+      const std::string& asset_name,
+      size_t offset,
+      size_t length) const override;
+
  private:
+  // Guards the resolvers and the resolvers that assets were found in. The
+  // resolvers are only ever added, so they can be read from without holding
+  // the lock.
+  mutable std::mutex mutex_;
   std::deque<std::unique_ptr<AssetResolver>> resolvers_;
+  mutable std::unordered_map<std::string, const AssetResolver*>
+      resolver_cache_;
+
+  // Returns the resolvers in the order they are tried in.
+  std::vector<const AssetResolver*> GetResolvers() const;
+
+  // Returns the resolver the asset was last found in, or nullptr.
+  const AssetResolver* GetCachedResolver(const std::string& asset_name) const;
 
   FML_DISALLOW_COPY_AND_ASSIGN(AssetManager);
 };
@@ -0,0 +1,54 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/assets/asset_resolver.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace flutter {
+
+namespace {
+
+// A part of another mapping, which it keeps alive.
+class MappingRange final : public fml::Mapping {
+ public:
+  MappingRange(std::unique_ptr<fml::Mapping> mapping,
+               size_t offset,
+               size_t length)
+      : mapping_(std::move(mapping)), offset_(offset), length_(length) {}
+
+  ~MappingRange() override = default;
+
+  // |fml::Mapping|
+  size_t GetSize() const override { return length_; }
+
+  // |fml::Mapping|
+  const uint8_t* GetMapping() const override {
+    return mapping_->GetMapping() + offset_;
+  }
+
+ private:
+  const std::unique_ptr<fml::Mapping> mapping_;
+  const size_t offset_;
+  const size_t length_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(MappingRange);
+};
+
+}  // namespace
+
+std::unique_ptr<fml::Mapping> AssetResolver::GetRangeAsMapping(
+    const std::string& asset_name,
+    size_t offset,
+    size_t length) const {
+  auto mapping = GetAsMapping(asset_name);
+  if (mapping == nullptr || offset > mapping->GetSize()) {
+    return nullptr;
+  }
+  length = std::min(length, mapping->GetSize() - offset);
+  return std::make_unique<MappingRange>(std::move(mapping), offset, length);
+}
+
+}  // namespace flutter
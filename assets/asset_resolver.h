@@ -24,6 +24,19 @@ class AssetResolver {
   [[nodiscard]] virtual std::unique_ptr<fml::Mapping> GetAsMapping(
       const std::string& asset_name) const = 0;
 
+  /// Returns up to |length| bytes of the asset starting at |offset|. The
+  /// mapping is shorter than |length| if the asset ends first, and empty if
+  /// |offset| is the size of the asset. Returns nullptr if there is no such
+  /// asset or if |offset| is past its end.
+  ///
+  /// The default implementation returns a part of the mapping returned by
+  /// |GetAsMapping|, which is only cheap for resolvers that map their assets
+  /// lazily.
+  [[nodiscard]] virtual std::unique_ptr<fml::Mapping> GetRangeAsMapping(
+      const std::string& asset_name,
+      size_t offset,
+      size_t length) const;
+
  private:
   FML_DISALLOW_COPY_AND_ASSIGN(AssetResolver);
 };
@@ -45,4 +45,23 @@ std::unique_ptr<fml::Mapping> DirectoryAssetBundle::GetAsMapping(
   return mapping;
 }
 
+// |AssetResolver|
+std::unique_ptr<fml::Mapping> DirectoryAssetBundle::GetRangeAsMapping(
+    const std::string& asset_name,
+    size_t offset,
+    size_t length) const {
+  if (!is_valid_) {
+    FML_DLOG(WARNING) << "Asset bundle was not valid.";
+    return nullptr;
+  }
+
+  auto file = fml::OpenFile(descriptor_, asset_name.c_str(), false,
+                            fml::FilePermission::kRead);
+  if (!file.is_valid()) {
+    return nullptr;
+  }
+
+  return fml::ReadFileRange(file, offset, length);
+}
+
 }  // namespace flutter
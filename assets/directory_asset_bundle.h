@@ -29,6 +29,12 @@ class DirectoryAssetBundle : public AssetResolver {
   std::unique_ptr<fml::Mapping> GetAsMapping(
       const std::string& asset_name) const override;
 
+  // |AssetResolver|
+  std::unique_ptr<fml::Mapping> GetRangeAsMapping(
+      const std::string& asset_name,
+      size_t offset,
+      size_t length) const override;
+
   FML_DISALLOW_COPY_AND_ASSIGN(DirectoryAssetBundle);
 };
 
@@ -0,0 +1,187 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/assets/packed_asset_bundle.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "flutter/fml/file.h"
+#include "flutter/fml/logging.h"
+
+namespace flutter {
+
+namespace {
+
+// All the fields of the file are little-endian.
+struct Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t entry_count;
+  // The size of the names of all the entries, which follow the index.
+  uint32_t names_size;
+};
+
+struct IndexRecord {
+  uint64_t offset;
+  uint64_t size;
+  // The offset of the name of the entry from the start of the names.
+  uint32_t name_offset;
+  uint32_t name_size;
+};
+
+constexpr uint32_t kMagic = 0x4b415046;  // "FPAK"
+constexpr uint32_t kVersion = 1;
+
+size_t AlignUp(size_t offset) {
+  return (offset + PackedAssetBundle::kAlignment - 1) &
+         ~(PackedAssetBundle::kAlignment - 1);
+}
+
+}  // namespace
+
+constexpr char PackedAssetBundle::kFileName[];
+
+std::unique_ptr<PackedAssetBundle> PackedAssetBundle::Open(
+    const fml::UniqueFD& directory) {
+  if (!fml::FileExists(directory, kFileName)) {
+    return nullptr;
+  }
+  auto bundle = std::make_unique<PackedAssetBundle>(
+      fml::FileMapping::CreateReadOnly(directory, kFileName));
+  if (!bundle->IsValid()) {
+    FML_LOG(ERROR) << "The packed asset bundle is invalid.";
+    return nullptr;
+  }
+  return bundle;
+}
+
+std::unique_ptr<fml::Mapping> PackedAssetBundle::Pack(
+    const std::map<std::string, std::unique_ptr<fml::Mapping>>& assets) {
+  size_t names_size = 0;
+  for (const auto& asset : assets) {
+    names_size += asset.first.size();
+  }
+  const size_t names_offset =
+      sizeof(Header) + assets.size() * sizeof(IndexRecord);
+
+  std::vector<IndexRecord> records;
+  records.reserve(assets.size());
+  size_t name_offset = 0;
+  size_t end = AlignUp(names_offset + names_size);
+  for (const auto& asset : assets) {
+    IndexRecord record = {};
+    record.offset = end;
+    record.size = asset.second->GetSize();
+    record.name_offset = name_offset;
+    record.name_size = asset.first.size();
+    records.push_back(record);
+    name_offset += asset.first.size();
+    end = AlignUp(end + record.size);
+  }
+
+  std::vector<uint8_t> data(end);
+  Header header = {};
+  header.magic = kMagic;
+  header.version = kVersion;
+  header.entry_count = assets.size();
+  header.names_size = names_size;
+  memcpy(data.data(), &header, sizeof(header));
+  memcpy(data.data() + sizeof(header), records.data(),
+         records.size() * sizeof(IndexRecord));
+  auto record = records.begin();
+  for (const auto& asset : assets) {
+    memcpy(data.data() + names_offset + record->name_offset,
+           asset.first.data(), asset.first.size());
+    if (record->size > 0) {
+      memcpy(data.data() + record->offset, asset.second->GetMapping(),
+             record->size);
+    }
+    ++record;
+  }
+  return std::make_unique<fml::DataMapping>(std::move(data));
+}
+
+PackedAssetBundle::PackedAssetBundle(std::unique_ptr<fml::Mapping> mapping)
+    : mapping_(std::move(mapping)) {
+  is_valid_ = mapping_ != nullptr && ReadIndex();
+}
+
+PackedAssetBundle::~PackedAssetBundle() = default;
+
+bool PackedAssetBundle::ReadIndex() {
+  const uint8_t* data = mapping_->GetMapping();
+  const size_t size = mapping_->GetSize();
+  if (size < sizeof(Header)) {
+    return false;
+  }
+  Header header;
+  memcpy(&header, data, sizeof(header));
+  if (header.magic != kMagic || header.version != kVersion ||
+      header.entry_count > (size - sizeof(Header)) / sizeof(IndexRecord)) {
+    return false;
+  }
+  const size_t names_offset =
+      sizeof(Header) + header.entry_count * sizeof(IndexRecord);
+  if (header.names_size > size - names_offset) {
+    return false;
+  }
+
+  index_.reserve(header.entry_count);
+  for (size_t i = 0; i < header.entry_count; i++) {
+    IndexRecord record;
+    memcpy(&record, data + sizeof(Header) + i * sizeof(IndexRecord),
+           sizeof(record));
+    if (record.name_offset > header.names_size ||
+        record.name_size > header.names_size - record.name_offset ||
+        record.offset > size || record.size > size - record.offset) {
+      return false;
+    }
+    std::string name(
+        reinterpret_cast<const char*>(data + names_offset + record.name_offset),
+        record.name_size);
+    index_[std::move(name)] = {static_cast<size_t>(record.offset),
+                               static_cast<size_t>(record.size)};
+  }
+  return true;
+}
+
+// |AssetResolver|
+bool PackedAssetBundle::IsValid() const {
+  return is_valid_;
+}
+
+// |AssetResolver|
+std::unique_ptr<fml::Mapping> PackedAssetBundle::GetAsMapping(
+    const std::string& asset_name) const {
+  auto found = index_.find(asset_name);
+  if (found == index_.end()) {
+    return nullptr;
+  }
+  return MapRange(found->second.offset, found->second.size);
+}
+
+// |AssetResolver|
+std::unique_ptr<fml::Mapping> PackedAssetBundle::GetRangeAsMapping(
+    const std::string& asset_name,
+    size_t offset,
+    size_t length) const {
+  auto found = index_.find(asset_name);
+  if (found == index_.end() || offset > found->second.size) {
+    return nullptr;
+  }
+  return MapRange(found->second.offset + offset,
+                  std::min(length, found->second.size - offset));
+}
+
+std::unique_ptr<fml::Mapping> PackedAssetBundle::MapRange(size_t offset,
+                                                          size_t size) const {
+  return std::make_unique<fml::NonOwnedMapping>(
+      mapping_->GetMapping() + offset, size,
+      [mapping = mapping_](const uint8_t* data, size_t size) {});
+}
+
+}  // namespace flutter
@@ -0,0 +1,78 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_ASSETS_PACKED_ASSET_BUNDLE_H_
+#define FLUTTER_ASSETS_PACKED_ASSET_BUNDLE_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "flutter/assets/asset_resolver.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/fml/unique_fd.h"
+
+namespace flutter {
+
+/// Resolves assets from a single file that holds all of them.
+///
+/// The file starts with an index of the names, offsets and sizes of the
+/// assets, followed by their contents, each aligned to |kAlignment| bytes. The
+/// file is mapped once and the index is read when the bundle is created, so
+/// looking up an asset doesn't touch the file system. The mappings returned by
+/// the bundle point into the mapping of the file and keep it alive.
+class PackedAssetBundle : public AssetResolver {
+ public:
+  /// The name of the packed bundle in an assets directory.
+  static constexpr char kFileName[] = "assets.pack";
+
+  static constexpr size_t kAlignment = 16;
+
+  /// Returns the packed bundle in |directory|, or nullptr if there is none.
+  static std::unique_ptr<PackedAssetBundle> Open(
+      const fml::UniqueFD& directory);
+
+  /// Returns the contents of a packed bundle that holds |assets|.
+  static std::unique_ptr<fml::Mapping> Pack(
+      const std::map<std::string, std::unique_ptr<fml::Mapping>>& assets);
+
+  explicit PackedAssetBundle(std::unique_ptr<fml::Mapping> mapping);
+
+  ~PackedAssetBundle() override;
+
+  // |AssetResolver|
+  bool IsValid() const override;
+
+  // |AssetResolver|
+  std::unique_ptr<fml::Mapping> GetAsMapping(
+      const std::string& asset_name) const override;
+
+  // |AssetResolver|
+  std::unique_ptr<fml::Mapping> GetRangeAsMapping(
+      const std::string& asset_name,
+      size_t offset,
+      size_t length) const override;
+
+ private:
+  struct Entry {
+    size_t offset = 0;
+    size_t size = 0;
+  };
+
+  const std::shared_ptr<fml::Mapping> mapping_;
+  std::unordered_map<std::string, Entry> index_;
+  bool is_valid_ = false;
+
+  bool ReadIndex();
+
+  std::unique_ptr<fml::Mapping> MapRange(size_t offset, size_t size) const;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PackedAssetBundle);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_ASSETS_PACKED_ASSET_BUNDLE_H_
@@ -41,6 +41,8 @@ std::string Settings::ToString() const {
   stream << "dump_skp_on_shader_compilation: " << dump_skp_on_shader_compilation
          << std::endl;
   stream << "cache_sksl: " << cache_sksl << std::endl;
+  stream << "persistent_cache_max_bytes: " << persistent_cache_max_bytes
+         << std::endl;
   stream << "endless_trace_buffer: " << endless_trace_buffer << std::endl;
   stream << "enable_dart_profiling: " << enable_dart_profiling << std::endl;
   stream << "disable_dart_asserts: " << disable_dart_asserts << std::endl;
@@ -50,6 +52,21 @@ std::string Settings::ToString() const {
   stream << "use_test_fonts: " << use_test_fonts << std::endl;
   stream << "enable_software_rendering: " << enable_software_rendering
          << std::endl;
+  stream << "raster_cache_max_bytes: " << raster_cache_max_bytes << std::endl;
+  stream << "raster_cache_max_idle_frames: " << raster_cache_max_idle_frames
+         << std::endl;
+  stream << "concurrent_raster_cache_population: "
+         << concurrent_raster_cache_population << std::endl;
+  stream << "software_raster_tile_count: " << software_raster_tile_count
+         << std::endl;
+  stream << "frame_pipeline_depth: " << frame_pipeline_depth << std::endl;
+  stream << "drop_stale_frames: " << drop_stale_frames << std::endl;
+  stream << "text_layout_cache_max_bytes: " << text_layout_cache_max_bytes
+         << std::endl;
+  stream << "decoded_image_cache_max_bytes: " << decoded_image_cache_max_bytes
+         << std::endl;
+  stream << "animated_image_lookahead_frames: "
+         << animated_image_lookahead_frames << std::endl;
   stream << "log_tag: " << log_tag << std::endl;
   stream << "icu_initialization_required: " << icu_initialization_required
          << std::endl;
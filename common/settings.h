@@ -97,6 +97,10 @@ struct Settings {
   bool trace_systrace = false;
   bool dump_skp_on_shader_compilation = false;
   bool cache_sksl = false;
+  // The maximum number of bytes of shaders kept in each persistent cache
+  // store. When it is exceeded, the least recently used shaders are evicted.
+  // Zero means that there is no limit.
+  size_t persistent_cache_max_bytes = 0;
   bool endless_trace_buffer = false;
   bool enable_dart_profiling = false;
   bool disable_dart_asserts = false;
@@ -173,6 +177,54 @@ struct Settings {
   UnhandledExceptionCallback unhandled_exception_callback;
   bool enable_software_rendering = false;
   bool skia_deterministic_rendering_on_cpu = false;
+
+  // The maximum number of bytes of images held by the raster cache. When it is
+  // exceeded, the least recently used entries are evicted. Zero means that
+  // there is no budget.
+  size_t raster_cache_max_bytes = 0;
+
+  // The number of consecutive frames a raster cache entry may go unused before
+  // it is evicted. Retaining entries for a few frames avoids rasterizing the
+  // same content again when it reappears, e.g. when scrolling back.
+  size_t raster_cache_max_idle_frames = 0;
+
+  // Rasterize raster cache entries for pictures on the concurrent worker
+  // threads of the VM instead of on the raster thread. Pictures are drawn
+  // directly until their cache entry becomes available in a later frame. Only
+  // applies to software rendering.
+  bool concurrent_raster_cache_population = false;
+
+  // The number of horizontal bands frames are split into when rendering in
+  // software. The frame is recorded once and the bands are rasterized
+  // concurrently on the worker threads of the VM. Zero or one rasterizes
+  // frames on the raster thread alone.
+  uint32_t software_raster_tile_count = 0;
+
+  // The number of frames the UI thread may produce ahead of the raster thread.
+  // A deeper pipeline lets the UI thread start on the next frame while the
+  // raster thread is still busy with earlier ones. Zero picks the default for
+  // the platform, which is two frames in most configurations.
+  uint32_t frame_pipeline_depth = 0;
+
+  // Skip frames that have missed their target time when a newer frame is
+  // already waiting to be rasterized, so the raster thread catches up with the
+  // UI thread instead of presenting a backlog of late frames.
+  bool drop_stale_frames = false;
+
+  // The maximum number of bytes of shaped words held by the text layout cache,
+  // which is shared by all the engines in the process. Zero keeps the default
+  // budget of the text engine.
+  size_t text_layout_cache_max_bytes = 0;
+
+  // The maximum number of bytes of decoded images that the image decoder of
+  // each engine keeps for decoding the same encoded image again. Zero disables
+  // the cache.
+  size_t decoded_image_cache_max_bytes = 16 * 1024 * 1024;
+
+  // The number of frames of animated images decoded on the worker threads
+  // ahead of the frame being shown. Zero decodes each frame when it is
+  // requested.
+  size_t animated_image_lookahead_frames = 2;
   bool verbose_logging = false;
   std::string log_tag = "flutter";
 
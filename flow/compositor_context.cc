@@ -4,11 +4,63 @@
 
 #include "flutter/flow/compositor_context.h"
 
+#include <algorithm>
+
 #include "flutter/flow/layers/layer_tree.h"
 #include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkPixmap.h"
 
 namespace flutter {
 
+namespace {
+
+// Bands shorter than this cost more to dispatch and replay than they save.
+constexpr int kMinRasterTileHeight = 32;
+
+// Replays |picture| into the |area| of |pixmap| in up to |tile_count|
+// horizontal bands, which are rasterized concurrently on |task_runner|.
+void DrawPictureInTiles(const SkPicture& picture,
+                        const SkMatrix& matrix,
+                        const SkSurfaceProps& props,
+                        const SkPixmap& pixmap,
+                        const SkIRect& area,
+                        size_t tile_count,
+                        fml::ConcurrentTaskRunner& task_runner) {
+  TRACE_EVENT0("flutter", "CompositorContext::DrawPictureInTiles");
+  const size_t max_tile_count =
+      (area.height() + kMinRasterTileHeight - 1) / kMinRasterTileHeight;
+  tile_count = std::min(tile_count, max_tile_count);
+  if (tile_count == 0) {
+    return;
+  }
+  const int band_count = static_cast<int>(tile_count);
+  const int tile_height = (area.height() + band_count - 1) / band_count;
+
+  task_runner.ParallelFor(tile_count, [&](size_t index) {
+    TRACE_EVENT0("flutter", "RasterizeTile");
+    const int top = area.top() + static_cast<int>(index) * tile_height;
+    const SkIRect tile =
+        SkIRect::MakeLTRB(area.left(), top, area.right(),
+                          std::min(top + tile_height, area.bottom()));
+    SkPixmap tile_pixmap;
+    if (tile.isEmpty() || !pixmap.extractSubset(&tile_pixmap, tile)) {
+      return;
+    }
+    auto canvas = SkCanvas::MakeRasterDirect(tile_pixmap.info(),
+                                             tile_pixmap.writable_addr(),
+                                             tile_pixmap.rowBytes(), &props);
+    if (!canvas) {
+      return;
+    }
+    canvas->translate(-tile.left(), -tile.top());
+    canvas->concat(matrix);
+    canvas->drawPicture(&picture);
+  });
+}
+
+}  // namespace
+
 CompositorContext::CompositorContext(fml::Milliseconds frame_budget)
     : raster_time_(frame_budget), ui_time_(frame_budget) {}
 
@@ -43,6 +95,13 @@ std::unique_ptr<CompositorContext::ScopedFrame> CompositorContext::AcquireFrame(
       instrumentation_enabled, surface_supports_readback, raster_thread_merger);
 }
 
+void CompositorContext::SetTiledRasterization(
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner,
+    size_t tile_count) {
+  tile_task_runner_ = std::move(task_runner);
+  tile_count_ = tile_task_runner_ ? tile_count : 0;
+}
+
 CompositorContext::ScopedFrame::ScopedFrame(
     CompositorContext& context,
     GrContext* gr_context,
@@ -69,7 +128,8 @@ CompositorContext::ScopedFrame::~ScopedFrame() {
 
 RasterStatus CompositorContext::ScopedFrame::Raster(
     flutter::LayerTree& layer_tree,
-    bool ignore_raster_cache) {
+    bool ignore_raster_cache,
+    FrameDamage* frame_damage) {
   TRACE_EVENT0("flutter", "CompositorContext::ScopedFrame::Raster");
   bool root_needs_readback = layer_tree.Preroll(*this, ignore_raster_cache);
   bool needs_save_layer = root_needs_readback && !surface_supports_readback();
@@ -82,9 +142,48 @@ RasterStatus CompositorContext::ScopedFrame::Raster(
   if (post_preroll_result == PostPrerollResult::kResubmitFrame) {
     return RasterStatus::kResubmit;
   }
+
+  std::optional<SkIRect> damage;
+  if (frame_damage) {
+    damage = layer_tree.ComputeDamage(frame_damage->prev_layer_tree,
+                                      root_surface_transformation());
+    frame_damage->damage = damage;
+#if !FLUTTER_RELEASE
+    const SkISize& frame_size = layer_tree.frame_size();
+    FML_TRACE_COUNTER(
+        "flutter", "FrameDamage", reinterpret_cast<int64_t>(&context_),  //
+        "DamagedPixels",
+        damage ? damage->width() * damage->height() : frame_size.area(),  //
+        "FramePixels", frame_size.area()                                   //
+    );
+#endif  // !FLUTTER_RELEASE
+  }
+
+  const bool clip_to_damage =
+      damage && !(frame_damage && frame_damage->repaint_entire_frame);
+
+  // Frames drawn into pixels in memory may be recorded and then replayed into
+  // bands of the canvas concurrently. The layers are painted into the
+  // recording canvas in place of the canvas of the frame.
+  SkCanvas* const frame_canvas = canvas_;
+  SkPixmap pixmap;
+  SkPictureRecorder recorder;
+  const bool tiled = context_.tile_count_ > 1 && frame_canvas &&
+                     !gr_context_ && !view_embedder_ && !root_needs_readback &&
+                     frame_canvas->peekPixels(&pixmap);
+  if (tiled) {
+    canvas_ = recorder.beginRecording(SkRect::Make(layer_tree.frame_size()));
+  }
+
   // Clearing canvas after preroll reduces one render target switch when preroll
   // paints some raster cache.
   if (canvas()) {
+    if (clip_to_damage) {
+      // Everything outside of the damaged area is left as it was painted by
+      // the previous frame.
+      canvas()->save();
+      canvas()->clipRect(SkRect::Make(*damage));
+    }
     if (needs_save_layer) {
       FML_LOG(INFO) << "Using SaveLayer to protect non-readback surface";
       SkRect bounds = SkRect::Make(layer_tree.frame_size());
@@ -98,6 +197,22 @@ RasterStatus CompositorContext::ScopedFrame::Raster(
   if (canvas() && needs_save_layer) {
     canvas()->restore();
   }
+  if (canvas() && clip_to_damage) {
+    canvas()->restore();
+  }
+
+  if (tiled) {
+    canvas_ = frame_canvas;
+    sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+    SkIRect area = frame_canvas->getDeviceClipBounds();
+    SkSurfaceProps props(0, kUnknown_SkPixelGeometry);
+    frame_canvas->getProps(&props);
+    if (picture && (!clip_to_damage || area.intersect(*damage))) {
+      DrawPictureInTiles(*picture, frame_canvas->getTotalMatrix(), props,
+                         pixmap, area, context_.tile_count_,
+                         *context_.tile_task_runner_);
+    }
+  }
   return RasterStatus::kSuccess;
 }
 
@@ -6,12 +6,14 @@
 #define FLUTTER_FLOW_COMPOSITOR_CONTEXT_H_
 
 #include <memory>
+#include <optional>
 #include <string>
 
 #include "flutter/flow/embedded_views.h"
 #include "flutter/flow/instrumentation.h"
 #include "flutter/flow/raster_cache.h"
 #include "flutter/flow/texture.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/raster_thread_merger.h"
 #include "third_party/skia/include/core/SkCanvas.h"
@@ -35,6 +37,25 @@ enum class RasterStatus {
   kFailed
 };
 
+// Damage tracking state of a frame rasterized by
+// |CompositorContext::ScopedFrame::Raster|.
+struct FrameDamage {
+  // The layer tree last rasterized into the target surface. If null, the
+  // entire frame is repainted.
+  const LayerTree* prev_layer_tree = nullptr;
+
+  // Whether the surface no longer holds the pixels of |prev_layer_tree|, e.g.
+  // because it renders into a different buffer than the previous frame. The
+  // damage is still computed and reported, so that the surface can present
+  // just the damaged area, but the entire frame is repainted.
+  bool repaint_entire_frame = false;
+
+  // The area of the frame that changed since |prev_layer_tree|, in device
+  // pixels. Set by |ScopedFrame::Raster|. Only this area is repainted, unless
+  // |repaint_entire_frame| is set. An empty optional means the entire frame.
+  std::optional<SkIRect> damage;
+};
+
 class CompositorContext {
  public:
   class ScopedFrame {
@@ -64,8 +85,12 @@ class CompositorContext {
 
     GrContext* gr_context() const { return gr_context_; }
 
+    // Prerolls and paints |layer_tree| into the canvas of this frame. If
+    // |frame_damage| is provided, painting is limited to the area that changed
+    // since |FrameDamage::prev_layer_tree| and that area is reported back.
     virtual RasterStatus Raster(LayerTree& layer_tree,
-                                bool ignore_raster_cache);
+                                bool ignore_raster_cache,
+                                FrameDamage* frame_damage = nullptr);
 
    private:
     CompositorContext& context_;
@@ -97,6 +122,20 @@ class CompositorContext {
 
   void OnGrContextDestroyed();
 
+  // Splits the rasterization of frames drawn into raster (i.e. software)
+  // canvases across the workers of |task_runner|. The layer tree of such a
+  // frame is recorded into a picture once, which is then replayed into
+  // |tile_count| horizontal bands of the canvas concurrently.
+  //
+  // Frames that read back from the surface, e.g. for backdrop filters, are
+  // still rasterized on the calling thread, since a band can't see the pixels
+  // of its neighbours.
+  //
+  // A |tile_count| below two or a null |task_runner| disables tiling.
+  void SetTiledRasterization(
+      std::shared_ptr<fml::ConcurrentTaskRunner> task_runner,
+      size_t tile_count);
+
   RasterCache& raster_cache() { return raster_cache_; }
 
   TextureRegistry& texture_registry() { return texture_registry_; }
@@ -113,6 +152,8 @@ class CompositorContext {
   Counter frame_count_;
   Stopwatch raster_time_;
   Stopwatch ui_time_;
+  std::shared_ptr<fml::ConcurrentTaskRunner> tile_task_runner_;
+  size_t tile_count_ = 0;
 
   void BeginFrame(ScopedFrame& frame, bool enable_instrumentation);
 
@@ -0,0 +1,201 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/diff_context.h"
+
+#include <unordered_map>
+
+#include "flutter/fml/hash_combine.h"
+#include "flutter/fml/logging.h"
+
+namespace flutter {
+
+namespace {
+
+// The identifier of the state at the root of the tree. Any non-zero value
+// works as long as it stays the same from frame to frame.
+constexpr uint64_t kRootStateId = 1;
+
+uint64_t MakeIdentified(uint64_t hash) {
+  return hash == kUnidentifiedContent ? kUnidentifiedContent + 1 : hash;
+}
+
+}  // namespace
+
+DiffContext::DiffContext(const SkMatrix& root_transformation,
+                         const SkISize& frame_size)
+    : matrix_(root_transformation),
+      clip_(SkRect::Make(frame_size)),
+      state_id_(kRootStateId) {}
+
+DiffContext::~DiffContext() = default;
+
+DiffContext::AutoSubtreeRestore::AutoSubtreeRestore(DiffContext* context)
+    : context_(context),
+      matrix_(context->matrix_),
+      clip_(context->clip_),
+      state_id_(context->state_id_) {}
+
+DiffContext::AutoSubtreeRestore::~AutoSubtreeRestore() {
+  context_->matrix_ = matrix_;
+  context_->clip_ = clip_;
+  context_->state_id_ = state_id_;
+}
+
+DiffContext::AutoCollapsedSubtree::AutoCollapsedSubtree(DiffContext* context,
+                                                        const SkRect& bounds,
+                                                        uint64_t state_id)
+    : context_(context),
+      bounds_(context->matrix_.mapRect(bounds)),
+      first_region_(context->regions_.size()),
+      content_seed_(fml::HashCombine(context->state_id_,
+                                     HashMatrix(context->matrix_),
+                                     state_id)),
+      restore_(context) {
+  if (!bounds_.intersect(context->clip_)) {
+    bounds_.setEmpty();
+  }
+  context->PushState(state_id);
+}
+
+DiffContext::AutoCollapsedSubtree::~AutoCollapsedSubtree() {
+  auto& regions = context_->regions_;
+  FML_DCHECK(regions.size() >= first_region_);
+
+  std::size_t content_id = content_seed_;
+  bool identified = true;
+  for (size_t i = first_region_; i < regions.size(); i++) {
+    const PaintRegion& region = regions[i];
+    if (region.content_id == kUnidentifiedContent) {
+      identified = false;
+      break;
+    }
+    fml::HashCombineSeed(content_id, region.content_id,
+                         HashRect(region.bounds));
+  }
+  regions.resize(first_region_);
+
+  if (bounds_.isEmpty()) {
+    return;
+  }
+  if (!identified) {
+    content_id = kUnidentifiedContent;
+  } else {
+    content_id = MakeIdentified(content_id);
+  }
+  regions.push_back({content_id, bounds_});
+}
+
+void DiffContext::PushTransform(const SkMatrix& transform) {
+  matrix_.preConcat(transform);
+}
+
+void DiffContext::ClipRect(const SkRect& local_rect) {
+  if (!clip_.intersect(matrix_.mapRect(local_rect))) {
+    clip_.setEmpty();
+  }
+}
+
+void DiffContext::PushState(uint64_t state_id) {
+  state_id_ = fml::HashCombine(state_id_, state_id);
+}
+
+void DiffContext::AddPaintRegion(uint64_t content_id,
+                                 const SkRect& local_bounds) {
+  SkRect bounds = matrix_.mapRect(local_bounds);
+  if (!bounds.intersect(clip_)) {
+    return;
+  }
+  if (content_id != kUnidentifiedContent) {
+    // The transform is part of the identity as well since the same bounds may
+    // be produced by different transforms, e.g. when content is mirrored.
+    content_id = MakeIdentified(
+        fml::HashCombine(state_id_, HashMatrix(matrix_), content_id));
+  }
+  regions_.push_back({content_id, bounds});
+}
+
+void DiffContext::AddVolatileRegion(const SkRect& local_bounds) {
+  AddPaintRegion(kUnidentifiedContent, local_bounds);
+}
+
+SkIRect DiffContext::ComputeDamage(const std::vector<PaintRegion>& previous,
+                                   const std::vector<PaintRegion>& current,
+                                   const SkISize& frame_size) {
+  std::unordered_multimap<uint64_t, size_t> previous_regions;
+  previous_regions.reserve(previous.size());
+  for (size_t i = 0; i < previous.size(); i++) {
+    if (previous[i].content_id != kUnidentifiedContent) {
+      previous_regions.emplace(previous[i].content_id, i);
+    }
+  }
+
+  std::vector<bool> matched(previous.size(), false);
+  SkRect damage = SkRect::MakeEmpty();
+  // Unchanged regions must keep their relative paint order, otherwise content
+  // that overlaps them may now be drawn above or below where it used to be.
+  size_t next_unmatched = 0;
+  for (const PaintRegion& region : current) {
+    bool found = false;
+    auto range = previous_regions.equal_range(region.content_id);
+    for (auto it = range.first; it != range.second; ++it) {
+      const size_t index = it->second;
+      if (!matched[index] && index >= next_unmatched &&
+          previous[index].bounds == region.bounds) {
+        matched[index] = true;
+        next_unmatched = index + 1;
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      damage.join(region.bounds);
+    }
+  }
+
+  for (size_t i = 0; i < previous.size(); i++) {
+    if (!matched[i]) {
+      damage.join(previous[i].bounds);
+    }
+  }
+
+  // Leave room for anti-aliasing and integral snapping of translations.
+  SkIRect damage_bounds = damage.roundOut();
+  if (damage_bounds.isEmpty()) {
+    return SkIRect::MakeEmpty();
+  }
+  damage_bounds.outset(1, 1);
+  if (!damage_bounds.intersect(SkIRect::MakeSize(frame_size))) {
+    return SkIRect::MakeEmpty();
+  }
+  return damage_bounds;
+}
+
+uint64_t DiffContext::HashMatrix(const SkMatrix& matrix) {
+  std::size_t hash = fml::HashCombine();
+  for (int i = 0; i < 9; i++) {
+    fml::HashCombineSeed(hash, matrix[i]);
+  }
+  return hash;
+}
+
+uint64_t DiffContext::HashRect(const SkRect& rect) {
+  return fml::HashCombine(rect.fLeft, rect.fTop, rect.fRight, rect.fBottom);
+}
+
+uint64_t DiffContext::HashRRect(const SkRRect& rrect) {
+  std::size_t hash = HashRect(rrect.rect());
+  for (int corner = 0; corner < 4; corner++) {
+    const SkVector radii = rrect.radii(static_cast<SkRRect::Corner>(corner));
+    fml::HashCombineSeed(hash, radii.fX, radii.fY);
+  }
+  return hash;
+}
+
+uint64_t DiffContext::HashPath(const SkPath& path) {
+  return fml::HashCombine(path.getGenerationID(),
+                          static_cast<int>(path.getFillType()));
+}
+
+}  // namespace flutter
@@ -0,0 +1,158 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_DIFF_CONTEXT_H_
+#define FLUTTER_FLOW_DIFF_CONTEXT_H_
+
+#include <optional>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkMatrix.h"
+#include "third_party/skia/include/core/SkPath.h"
+#include "third_party/skia/include/core/SkRRect.h"
+#include "third_party/skia/include/core/SkRect.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// A region of the frame painted by a single layer, or by a whole subtree that
+/// is tracked as one unit (see |DiffContext::AutoCollapsedSubtree|).
+///
+struct PaintRegion {
+  /// Identifies what is drawn into |bounds|. The identifier covers the content
+  /// of the layer itself and all the state inherited from its ancestors that
+  /// affects how it is drawn (opacity, clips, filters). A value of
+  /// |kUnidentifiedContent| never matches any other region and so is always
+  /// considered damaged.
+  uint64_t content_id;
+
+  /// The bounds of the content in device space, clipped by all ancestor clips.
+  SkRect bounds;
+};
+
+static constexpr uint64_t kUnidentifiedContent = 0;
+
+//------------------------------------------------------------------------------
+/// Collects the |PaintRegion|s of a prerolled layer tree so that two
+/// consecutive frames can be compared and only the area that changed between
+/// them needs to be repainted.
+///
+/// Layers describe themselves to the context in |Layer::Diff|. Container
+/// layers that transform, clip or otherwise alter the rendering of their
+/// children push that state on the context before walking the children and
+/// restore it afterwards with an |AutoSubtreeRestore|.
+///
+class DiffContext {
+ public:
+  DiffContext(const SkMatrix& root_transformation, const SkISize& frame_size);
+
+  ~DiffContext();
+
+  // Saves the transform, clip and inherited state of the context and restores
+  // it on destruction.
+  class AutoSubtreeRestore {
+   public:
+    explicit AutoSubtreeRestore(DiffContext* context);
+
+    ~AutoSubtreeRestore();
+
+   private:
+    DiffContext* context_;
+    SkMatrix matrix_;
+    SkRect clip_;
+    uint64_t state_id_;
+
+    FML_DISALLOW_COPY_AND_ASSIGN(AutoSubtreeRestore);
+  };
+
+  // Collapses all regions added while this object is alive into a single
+  // region covering |bounds| (in the local coordinates at construction time).
+  // Used by layers whose effect on their children reaches beyond the bounds of
+  // the individual children, such as image filters and shader masks, so that
+  // any change in the subtree damages the whole layer.
+  //
+  // |state_id| identifies what the collapsing layer itself draws and how it
+  // alters its children. It is pushed like |PushState| for the children, and
+  // is part of the identity of the collapsed region along with the inherited
+  // state and the transform, so the region changes even if the layer has no
+  // children.
+  class AutoCollapsedSubtree {
+   public:
+    AutoCollapsedSubtree(DiffContext* context,
+                         const SkRect& bounds,
+                         uint64_t state_id);
+
+    ~AutoCollapsedSubtree();
+
+   private:
+    DiffContext* context_;
+    SkRect bounds_;
+    size_t first_region_;
+    uint64_t content_seed_;
+    AutoSubtreeRestore restore_;
+
+    FML_DISALLOW_COPY_AND_ASSIGN(AutoCollapsedSubtree);
+  };
+
+  // Concatenates |transform| to the current transform.
+  void PushTransform(const SkMatrix& transform);
+
+  // Intersects the current clip with |local_rect|.
+  void ClipRect(const SkRect& local_rect);
+
+  // Mixes the state introduced by a layer (e.g. an opacity value or a color
+  // filter) into the identity of all regions added below it.
+  void PushState(uint64_t state_id);
+
+  // Adds the region painted by a layer with the given content identifier.
+  // |local_bounds| is in the coordinate space of the current transform.
+  void AddPaintRegion(uint64_t content_id, const SkRect& local_bounds);
+
+  // Adds a region whose content may change without the layer tree changing,
+  // such as an external texture. It is repainted on every frame.
+  void AddVolatileRegion(const SkRect& local_bounds);
+
+  // Indicates that the frame cannot be described by paint regions alone
+  // (e.g. because a layer reads back from the surface) and must be repainted
+  // completely.
+  void MarkFullDamage() { full_damage_ = true; }
+
+  bool full_damage() const { return full_damage_; }
+
+  const SkMatrix& matrix() const { return matrix_; }
+
+  std::vector<PaintRegion> TakePaintRegions() { return std::move(regions_); }
+
+  // Returns the device space area that differs between two frames described
+  // by |previous| and |current|, clipped to |frame_size|.
+  //
+  // A region is unchanged if the other frame has a region with the same
+  // content identifier and bounds, painted in the same order relative to the
+  // other unchanged regions.
+  static SkIRect ComputeDamage(const std::vector<PaintRegion>& previous,
+                               const std::vector<PaintRegion>& current,
+                               const SkISize& frame_size);
+
+  static uint64_t HashMatrix(const SkMatrix& matrix);
+
+  static uint64_t HashRect(const SkRect& rect);
+
+  static uint64_t HashRRect(const SkRRect& rrect);
+
+  static uint64_t HashPath(const SkPath& path);
+
+ private:
+  SkMatrix matrix_;
+  SkRect clip_;
+  uint64_t state_id_;
+  bool full_damage_ = false;
+  std::vector<PaintRegion> regions_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DiffContext);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_DIFF_CONTEXT_H_
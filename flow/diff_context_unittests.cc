@@ -0,0 +1,144 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/diff_context.h"
+
+#include "flutter/testing/testing.h"
+
+namespace flutter {
+namespace testing {
+
+static const SkISize kFrameSize = SkISize::Make(100, 100);
+
+TEST(DiffContextTest, IdenticalFramesHaveNoDamage) {
+  std::vector<PaintRegion> regions = {
+      {1, SkRect::MakeLTRB(10, 10, 20, 20)},
+      {2, SkRect::MakeLTRB(30, 30, 40, 40)},
+  };
+  EXPECT_TRUE(
+      DiffContext::ComputeDamage(regions, regions, kFrameSize).isEmpty());
+}
+
+TEST(DiffContextTest, ChangedContentDamagesOldAndNewBounds) {
+  std::vector<PaintRegion> previous = {
+      {1, SkRect::MakeLTRB(10, 10, 20, 20)},
+      {2, SkRect::MakeLTRB(60, 60, 70, 70)},
+  };
+  std::vector<PaintRegion> current = {
+      {1, SkRect::MakeLTRB(10, 10, 20, 20)},
+      {3, SkRect::MakeLTRB(50, 50, 60, 60)},
+  };
+  // Outset by one pixel for anti-aliasing.
+  EXPECT_EQ(DiffContext::ComputeDamage(previous, current, kFrameSize),
+            SkIRect::MakeLTRB(49, 49, 71, 71));
+}
+
+TEST(DiffContextTest, MovedContentIsDamaged) {
+  std::vector<PaintRegion> previous = {{1, SkRect::MakeLTRB(10, 10, 20, 20)}};
+  std::vector<PaintRegion> current = {{1, SkRect::MakeLTRB(12, 10, 22, 20)}};
+  EXPECT_EQ(DiffContext::ComputeDamage(previous, current, kFrameSize),
+            SkIRect::MakeLTRB(9, 9, 23, 21));
+}
+
+TEST(DiffContextTest, ReorderedContentIsDamaged) {
+  std::vector<PaintRegion> previous = {
+      {1, SkRect::MakeLTRB(10, 10, 20, 20)},
+      {2, SkRect::MakeLTRB(15, 15, 25, 25)},
+  };
+  std::vector<PaintRegion> current = {
+      {2, SkRect::MakeLTRB(15, 15, 25, 25)},
+      {1, SkRect::MakeLTRB(10, 10, 20, 20)},
+  };
+  EXPECT_EQ(DiffContext::ComputeDamage(previous, current, kFrameSize),
+            SkIRect::MakeLTRB(9, 9, 21, 21));
+}
+
+TEST(DiffContextTest, UnidentifiedContentIsAlwaysDamaged) {
+  std::vector<PaintRegion> regions = {
+      {kUnidentifiedContent, SkRect::MakeLTRB(10, 10, 20, 20)},
+  };
+  EXPECT_EQ(DiffContext::ComputeDamage(regions, regions, kFrameSize),
+            SkIRect::MakeLTRB(9, 9, 21, 21));
+}
+
+TEST(DiffContextTest, DamageIsClippedToFrame) {
+  std::vector<PaintRegion> previous;
+  std::vector<PaintRegion> current = {{1, SkRect::MakeLTRB(-10, 90, 20, 120)}};
+  EXPECT_EQ(DiffContext::ComputeDamage(previous, current, kFrameSize),
+            SkIRect::MakeLTRB(0, 89, 21, 100));
+}
+
+TEST(DiffContextTest, RegionsAreTransformedAndClipped) {
+  DiffContext context(SkMatrix::Translate(5, 5), kFrameSize);
+  {
+    DiffContext::AutoSubtreeRestore subtree(&context);
+    context.PushTransform(SkMatrix::Scale(2, 2));
+    context.ClipRect(SkRect::MakeLTRB(0, 0, 10, 10));
+    context.AddPaintRegion(1, SkRect::MakeLTRB(5, 5, 20, 20));
+  }
+  context.AddPaintRegion(1, SkRect::MakeLTRB(0, 0, 10, 10));
+
+  std::vector<PaintRegion> regions = context.TakePaintRegions();
+  ASSERT_EQ(regions.size(), 2u);
+  EXPECT_EQ(regions[0].bounds, SkRect::MakeLTRB(15, 15, 25, 25));
+  EXPECT_EQ(regions[1].bounds, SkRect::MakeLTRB(5, 5, 15, 15));
+  // The same content drawn with a different transform is not the same region.
+  EXPECT_NE(regions[0].content_id, regions[1].content_id);
+}
+
+TEST(DiffContextTest, StateChangesContentIdentity) {
+  auto record = [](uint64_t state) {
+    DiffContext context(SkMatrix::I(), kFrameSize);
+    context.PushState(state);
+    context.AddPaintRegion(1, SkRect::MakeLTRB(0, 0, 10, 10));
+    return context.TakePaintRegions();
+  };
+  EXPECT_EQ(record(128)[0].content_id, record(128)[0].content_id);
+  EXPECT_NE(record(128)[0].content_id, record(255)[0].content_id);
+}
+
+TEST(DiffContextTest, CollapsedSubtreeCoversItsBounds) {
+  DiffContext context(SkMatrix::I(), kFrameSize);
+  {
+    DiffContext::AutoCollapsedSubtree subtree(
+        &context, SkRect::MakeLTRB(0, 0, 50, 50), 1);
+    context.AddPaintRegion(1, SkRect::MakeLTRB(10, 10, 20, 20));
+    context.AddPaintRegion(2, SkRect::MakeLTRB(30, 30, 40, 40));
+  }
+
+  std::vector<PaintRegion> regions = context.TakePaintRegions();
+  ASSERT_EQ(regions.size(), 1u);
+  EXPECT_EQ(regions[0].bounds, SkRect::MakeLTRB(0, 0, 50, 50));
+  EXPECT_NE(regions[0].content_id, kUnidentifiedContent);
+}
+
+TEST(DiffContextTest, CollapsedSubtreeIdentityIncludesStateAndTransform) {
+  // Records a collapsed subtree without children, like a layer that only
+  // paints itself.
+  auto record = [](uint64_t inherited_state, const SkMatrix& matrix,
+                   uint64_t own_state) {
+    DiffContext context(SkMatrix::I(), kFrameSize);
+    context.PushState(inherited_state);
+    context.PushTransform(matrix);
+    {
+      DiffContext::AutoCollapsedSubtree subtree(
+          &context, SkRect::MakeLTRB(0, 0, 50, 50), own_state);
+    }
+    std::vector<PaintRegion> regions = context.TakePaintRegions();
+    EXPECT_EQ(regions.size(), 1u);
+    return regions.empty() ? kUnidentifiedContent : regions[0].content_id;
+  };
+  const uint64_t content_id = record(1, SkMatrix::I(), 1);
+  EXPECT_NE(content_id, kUnidentifiedContent);
+  EXPECT_EQ(record(1, SkMatrix::I(), 1), content_id);
+  EXPECT_NE(record(2, SkMatrix::I(), 1), content_id);
+  EXPECT_NE(record(1, SkMatrix::I(), 2), content_id);
+  // Mirrored around the center of the bounds, so the bounds stay the same.
+  SkMatrix mirror = SkMatrix::Scale(-1, 1);
+  mirror.postTranslate(50, 0);
+  EXPECT_NE(record(1, mirror, 1), content_id);
+}
+
+}  // namespace testing
+}  // namespace flutter
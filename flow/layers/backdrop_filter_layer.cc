@@ -26,4 +26,11 @@ void BackdropFilterLayer::Paint(PaintContext& context) const {
   PaintChildren(context);
 }
 
+void BackdropFilterLayer::Diff(DiffContext* context) const {
+  // The filter reads back everything painted below it, so the damage of this
+  // layer cannot be determined from the layer tree alone.
+  context->MarkFullDamage();
+  DiffChildren(context);
+}
+
 }  // namespace flutter
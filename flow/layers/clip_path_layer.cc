@@ -4,6 +4,8 @@
 
 #include "flutter/flow/layers/clip_path_layer.h"
 
+#include "flutter/fml/hash_combine.h"
+
 #if defined(LEGACY_FUCHSIA_EMBEDDER)
 
 #include "lib/ui/scenic/cpp/commands.h"
@@ -75,4 +77,12 @@ void ClipPathLayer::Paint(PaintContext& context) const {
   }
 }
 
+void ClipPathLayer::Diff(DiffContext* context) const {
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->PushState(fml::HashCombine(DiffContext::HashPath(clip_path_),
+                                      static_cast<int>(clip_behavior_)));
+  context->ClipRect(clip_path_.getBounds());
+  DiffChildren(context);
+}
+
 }  // namespace flutter
@@ -68,4 +68,13 @@ void ClipRectLayer::Paint(PaintContext& context) const {
   }
 }
 
+void ClipRectLayer::Diff(DiffContext* context) const {
+  DiffContext::AutoSubtreeRestore subtree(context);
+  // The clip only affects the pixels of the children at its edges, which are
+  // covered by the clipped bounds of the children.
+  context->PushState(static_cast<uint64_t>(clip_behavior_));
+  context->ClipRect(clip_rect_);
+  DiffChildren(context);
+}
+
 }  // namespace flutter
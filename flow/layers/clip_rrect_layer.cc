@@ -4,6 +4,8 @@
 
 #include "flutter/flow/layers/clip_rrect_layer.h"
 
+#include "flutter/fml/hash_combine.h"
+
 namespace flutter {
 
 ClipRRectLayer::ClipRRectLayer(const SkRRect& clip_rrect, Clip clip_behavior)
@@ -69,4 +71,12 @@ void ClipRRectLayer::Paint(PaintContext& context) const {
   }
 }
 
+void ClipRRectLayer::Diff(DiffContext* context) const {
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->PushState(fml::HashCombine(DiffContext::HashRRect(clip_rrect_),
+                                      static_cast<int>(clip_behavior_)));
+  context->ClipRect(clip_rrect_.getBounds());
+  DiffChildren(context);
+}
+
 }  // namespace flutter
@@ -17,6 +17,8 @@ class ClipRRectLayer : public ContainerLayer {
 
   void Paint(PaintContext& context) const override;
 
+  void Diff(DiffContext* context) const override;
+
   bool UsesSaveLayer() const {
     return clip_behavior_ == Clip::antiAliasWithSaveLayer;
   }
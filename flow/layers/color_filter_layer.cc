@@ -28,4 +28,10 @@ void ColorFilterLayer::Paint(PaintContext& context) const {
   PaintChildren(context);
 }
 
+void ColorFilterLayer::Diff(DiffContext* context) const {
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->PushState(reinterpret_cast<uintptr_t>(filter_.get()));
+  DiffChildren(context);
+}
+
 }  // namespace flutter
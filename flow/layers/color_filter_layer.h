@@ -19,6 +19,8 @@ class ColorFilterLayer : public ContainerLayer {
 
   void Paint(PaintContext& context) const override;
 
+  void Diff(DiffContext* context) const override;
+
  private:
   sk_sp<SkColorFilter> filter_;
 
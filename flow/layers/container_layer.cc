@@ -26,6 +26,10 @@ void ContainerLayer::Paint(PaintContext& context) const {
   PaintChildren(context);
 }
 
+void ContainerLayer::Diff(DiffContext* context) const {
+  DiffChildren(context);
+}
+
 void ContainerLayer::PrerollChildren(PrerollContext* context,
                                      const SkMatrix& child_matrix,
                                      SkRect* child_paint_bounds) {
@@ -78,6 +82,14 @@ void ContainerLayer::PaintChildren(PaintContext& context) const {
   }
 }
 
+void ContainerLayer::DiffChildren(DiffContext* context) const {
+  for (auto& layer : layers_) {
+    if (layer->needs_painting()) {
+      layer->Diff(context);
+    }
+  }
+}
+
 void ContainerLayer::TryToPrepareRasterCache(PrerollContext* context,
                                              Layer* layer,
                                              const SkMatrix& matrix) {
@@ -18,6 +18,7 @@ class ContainerLayer : public Layer {
 
   void Preroll(PrerollContext* context, const SkMatrix& matrix) override;
   void Paint(PaintContext& context) const override;
+  void Diff(DiffContext* context) const override;
 #if defined(LEGACY_FUCHSIA_EMBEDDER)
   void CheckForChildLayerBelow(PrerollContext* context) override;
   void UpdateScene(SceneUpdateContext& context) override;
@@ -30,6 +31,7 @@ class ContainerLayer : public Layer {
                        const SkMatrix& child_matrix,
                        SkRect* child_paint_bounds);
   void PaintChildren(PaintContext& context) const;
+  void DiffChildren(DiffContext* context) const;
 
 #if defined(LEGACY_FUCHSIA_EMBEDDER)
   void UpdateSceneChildren(SceneUpdateContext& context);
@@ -92,4 +92,12 @@ void ImageFilterLayer::Paint(PaintContext& context) const {
   PaintChildren(context);
 }
 
+void ImageFilterLayer::Diff(DiffContext* context) const {
+  // The filter may move pixels of the children around (e.g. a blur), so any
+  // change below this layer damages all of it.
+  DiffContext::AutoCollapsedSubtree subtree(
+      context, paint_bounds(), reinterpret_cast<uintptr_t>(filter_.get()));
+  DiffChildren(context);
+}
+
 }  // namespace flutter
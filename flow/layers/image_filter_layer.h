@@ -19,6 +19,8 @@ class ImageFilterLayer : public MergedContainerLayer {
 
   void Paint(PaintContext& context) const override;
 
+  void Diff(DiffContext* context) const override;
+
  private:
   // The ImageFilterLayer might cache the filtered output of this layer
   // if the layer remains stable (if it is not animating for instance).
@@ -27,6 +27,10 @@ uint64_t Layer::NextUniqueID() {
 
 void Layer::Preroll(PrerollContext* context, const SkMatrix& matrix) {}
 
+void Layer::Diff(DiffContext* context) const {
+  context->AddPaintRegion(unique_id(), paint_bounds());
+}
+
 Layer::AutoPrerollSaveLayerState::AutoPrerollSaveLayerState(
     PrerollContext* preroll_context,
     bool save_layer_is_active,
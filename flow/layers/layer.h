@@ -8,6 +8,7 @@
 #include <memory>
 #include <vector>
 
+#include "flutter/flow/diff_context.h"
 #include "flutter/flow/embedded_views.h"
 #include "flutter/flow/instrumentation.h"
 #include "flutter/flow/raster_cache.h"
@@ -162,6 +163,15 @@ class Layer {
 
   virtual void Paint(PaintContext& context) const = 0;
 
+  // Describes the regions of the frame painted by this layer to |context| so
+  // that the area that changed since the previous frame can be computed. Only
+  // valid after Preroll.
+  //
+  // The default implementation identifies the content of the layer by its
+  // unique_id(), so the layer is only considered unchanged when it is retained
+  // from the previous frame.
+  virtual void Diff(DiffContext* context) const;
+
 #if defined(LEGACY_FUCHSIA_EMBEDDER)
   // Updates the system composited scene.
   virtual void UpdateScene(SceneUpdateContext& context);
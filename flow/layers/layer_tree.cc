@@ -132,6 +132,28 @@ void LayerTree::Paint(CompositorContext::ScopedFrame& frame,
     root_layer_->Paint(context);
 }
 
+std::optional<SkIRect> LayerTree::ComputeDamage(
+    const LayerTree* prev_layer_tree,
+    const SkMatrix& root_surface_transformation) {
+  TRACE_EVENT0("flutter", "LayerTree::ComputeDamage");
+
+  DiffContext context(root_surface_transformation, frame_size_);
+  if (root_layer_ && root_layer_->needs_painting()) {
+    root_layer_->Diff(&context);
+  }
+  paint_regions_ = context.TakePaintRegions();
+  paint_regions_valid_ = !context.full_damage();
+
+  if (!paint_regions_valid_ || prev_layer_tree == nullptr ||
+      prev_layer_tree == this || !prev_layer_tree->paint_regions_valid_ ||
+      prev_layer_tree->frame_size_ != frame_size_) {
+    return std::nullopt;
+  }
+
+  return DiffContext::ComputeDamage(prev_layer_tree->paint_regions_,
+                                    paint_regions_, frame_size_);
+}
+
 sk_sp<SkPicture> LayerTree::Flatten(const SkRect& bounds) {
   TRACE_EVENT0("flutter", "LayerTree::Flatten");
 
@@ -8,8 +8,11 @@
 #include <stdint.h>
 
 #include <memory>
+#include <optional>
+#include <vector>
 
 #include "flutter/flow/compositor_context.h"
+#include "flutter/flow/diff_context.h"
 #include "flutter/flow/layers/layer.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/time/time_delta.h"
@@ -44,6 +47,18 @@ class LayerTree {
 
   sk_sp<SkPicture> Flatten(const SkRect& bounds);
 
+  // Records the regions painted by this tree and returns the area of the frame
+  // that differs from |prev_layer_tree|, in device pixels. Must be called
+  // after Preroll.
+  //
+  // |prev_layer_tree| must be the tree last rasterized into the surface this
+  // tree is about to be painted into, with the surface still holding its
+  // pixels. Returns std::nullopt if the whole frame needs to be repainted,
+  // which is always the case when there is no previous tree.
+  std::optional<SkIRect> ComputeDamage(
+      const LayerTree* prev_layer_tree,
+      const SkMatrix& root_surface_transformation);
+
   Layer* root_layer() const { return root_layer_.get(); }
 
   void set_root_layer(std::shared_ptr<Layer> root_layer) {
@@ -92,6 +107,10 @@ class LayerTree {
   uint32_t rasterizer_tracing_threshold_;
   bool checkerboard_raster_cache_images_;
   bool checkerboard_offscreen_layers_;
+  // The regions painted by this tree as recorded by |ComputeDamage|. Only
+  // valid if |paint_regions_valid_| is true.
+  std::vector<PaintRegion> paint_regions_;
+  bool paint_regions_valid_ = false;
 
   FML_DISALLOW_COPY_AND_ASSIGN(LayerTree);
 };
@@ -4,13 +4,17 @@
 
 #include "flutter/flow/layers/layer_tree.h"
 
+#include <cstring>
+
 #include "flutter/flow/compositor_context.h"
 #include "flutter/flow/layers/container_layer.h"
 #include "flutter/flow/testing/mock_layer.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/testing/canvas_test.h"
 #include "flutter/testing/mock_canvas.h"
 #include "gtest/gtest.h"
+#include "third_party/skia/include/core/SkSurface.h"
 
 namespace flutter {
 namespace testing {
@@ -203,5 +207,72 @@ TEST_F(LayerTreeTest, NeedsSystemComposite) {
                                                child_path2, child_paint2}}}));
 }
 
+TEST_F(LayerTreeTest, ComputeDamage) {
+  const SkPath retained_path = SkPath().addRect(5.0f, 6.0f, 20.5f, 21.5f);
+  const SkPath changed_path = SkPath().addRect(30.0f, 30.0f, 40.0f, 40.0f);
+  auto retained_layer = std::make_shared<MockLayer>(retained_path);
+  auto layer = std::make_shared<ContainerLayer>();
+  layer->Add(retained_layer);
+  layer->Add(std::make_shared<MockLayer>(changed_path));
+
+  layer_tree().set_root_layer(layer);
+  layer_tree().Preroll(frame());
+  // Without a previous frame everything is damaged.
+  EXPECT_EQ(layer_tree().ComputeDamage(nullptr, root_transform()),
+            std::nullopt);
+
+  LayerTree next_layer_tree(SkISize::Make(64, 64), 100.0f, 1.0f);
+  auto next_layer = std::make_shared<ContainerLayer>();
+  next_layer->Add(retained_layer);
+  next_layer->Add(std::make_shared<MockLayer>(changed_path));
+  next_layer_tree.set_root_layer(next_layer);
+  next_layer_tree.Preroll(frame());
+
+  // Only the layer that was not retained is damaged, offset by the root
+  // transform and outset for anti-aliasing.
+  EXPECT_EQ(next_layer_tree.ComputeDamage(&layer_tree(), root_transform()),
+            SkIRect::MakeLTRB(30, 30, 42, 42));
+}
+
+TEST(LayerTree, TiledRasterizationMatchesSerialRasterization) {
+  const SkISize size = SkISize::Make(100, 300);
+  auto layer = std::make_shared<ContainerLayer>();
+  layer->Add(
+      std::make_shared<MockLayer>(SkPath().addCircle(50.0f, 150.0f, 140.0f),
+                                  SkPaint(SkColors::kCyan)));
+  layer->Add(std::make_shared<MockLayer>(
+      SkPath().addRect(10.5f, 20.5f, 90.5f, 280.5f),
+      SkPaint(SkColors::kMagenta)));
+  LayerTree layer_tree(size, 100.0f, 1.0f);
+  layer_tree.set_root_layer(layer);
+
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  auto rasterize = [&](bool tiled) {
+    CompositorContext compositor_context;
+    if (tiled) {
+      compositor_context.SetTiledRasterization(loop->GetTaskRunner(), 8);
+    }
+    auto surface = SkSurface::MakeRasterN32Premul(size.width(), size.height());
+    auto frame = compositor_context.AcquireFrame(
+        nullptr, surface->getCanvas(), nullptr, SkMatrix::I(), false, true,
+        nullptr);
+    EXPECT_EQ(frame->Raster(layer_tree, true), RasterStatus::kSuccess);
+    return surface->makeImageSnapshot();
+  };
+
+  sk_sp<SkImage> serial_image = rasterize(false);
+  sk_sp<SkImage> tiled_image = rasterize(true);
+  SkPixmap serial_pixels;
+  SkPixmap tiled_pixels;
+  ASSERT_TRUE(serial_image->peekPixels(&serial_pixels));
+  ASSERT_TRUE(tiled_image->peekPixels(&tiled_pixels));
+  for (int y = 0; y < size.height(); y++) {
+    ASSERT_EQ(memcmp(serial_pixels.addr32(0, y), tiled_pixels.addr32(0, y),
+                     size.width() * sizeof(uint32_t)),
+              0)
+        << "row " << y;
+  }
+}
+
 }  // namespace testing
 }  // namespace flutter
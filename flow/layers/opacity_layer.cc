@@ -99,4 +99,11 @@ void OpacityLayer::UpdateScene(SceneUpdateContext& context) {
 
 #endif
 
+void OpacityLayer::Diff(DiffContext* context) const {
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->PushTransform(SkMatrix::Translate(offset_.fX, offset_.fY));
+  context->PushState(alpha_);
+  DiffChildren(context);
+}
+
 }  // namespace flutter
@@ -5,6 +5,7 @@
 #include "flutter/flow/layers/opacity_layer.h"
 
 #include "flutter/flow/layers/clip_rect_layer.h"
+#include "flutter/flow/layers/physical_shape_layer.h"
 #include "flutter/flow/testing/layer_test.h"
 #include "flutter/flow/testing/mock_layer.h"
 #include "flutter/fml/macros.h"
@@ -406,5 +407,26 @@ TEST_F(OpacityLayerTest, CullRectIsTransformed) {
   EXPECT_EQ(mockLayer->parent_cull_rect().fTop, -20);
 }
 
+TEST_F(OpacityLayerTest, ChangedOpacityDamagesCollapsedChildren) {
+  const SkISize frame_size = SkISize::Make(100, 100);
+  const SkPath child_path = SkPath().addRect(10.0f, 10.0f, 50.0f, 50.0f);
+  auto diff = [this, &frame_size, &child_path](SkAlpha alpha) {
+    auto layer = std::make_shared<OpacityLayer>(alpha, SkPoint());
+    // Physical shapes collapse their subtree into a single region.
+    layer->Add(std::make_shared<PhysicalShapeLayer>(
+        SK_ColorGREEN, SK_ColorBLACK, 0.0f, child_path, Clip::none));
+    layer->Preroll(preroll_context(), SkMatrix());
+    DiffContext context(SkMatrix::I(), frame_size);
+    layer->Diff(&context);
+    return context.TakePaintRegions();
+  };
+
+  const std::vector<PaintRegion> regions = diff(128);
+  EXPECT_TRUE(
+      DiffContext::ComputeDamage(regions, diff(128), frame_size).isEmpty());
+  EXPECT_EQ(DiffContext::ComputeDamage(regions, diff(64), frame_size),
+            SkIRect::MakeLTRB(9, 9, 51, 51));
+}
+
 }  // namespace testing
 }  // namespace flutter
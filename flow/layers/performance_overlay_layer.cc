@@ -97,4 +97,9 @@ void PerformanceOverlayLayer::Paint(PaintContext& context) const {
                      options_ & kDisplayEngineStatistics, "UI", font_path_);
 }
 
+void PerformanceOverlayLayer::Diff(DiffContext* context) const {
+  // The statistics change on every frame.
+  context->AddVolatileRegion(paint_bounds());
+}
+
 }  // namespace flutter
@@ -5,6 +5,7 @@
 #include "flutter/flow/layers/physical_shape_layer.h"
 
 #include "flutter/flow/paint_utils.h"
+#include "flutter/fml/hash_combine.h"
 #include "third_party/skia/include/utils/SkShadowUtils.h"
 
 namespace flutter {
@@ -185,4 +186,17 @@ void PhysicalShapeLayer::DrawShadow(SkCanvas* canvas,
       dpr * kLightRadius, ambientColor, spotColor, flags);
 }
 
+void PhysicalShapeLayer::Diff(DiffContext* context) const {
+  // The paint bounds include the shadow, which depends on the whole shape.
+  DiffContext::AutoCollapsedSubtree subtree(
+      context, paint_bounds(),
+      fml::HashCombine(color_, shadow_color_, elevation_,
+                       DiffContext::HashPath(path_),
+                       static_cast<int>(clip_behavior_)));
+  if (clip_behavior_ != Clip::none) {
+    context->ClipRect(path_.getBounds());
+  }
+  DiffChildren(context);
+}
+
 }  // namespace flutter
@@ -149,6 +149,38 @@ TEST_F(PhysicalShapeLayerTest, ElevationSimple) {
 #endif
 }
 
+TEST_F(PhysicalShapeLayerTest, ChangesWithoutChildrenAreDamaged) {
+  const SkISize frame_size = SkISize::Make(100, 100);
+  const SkPath rect_path = SkPath().addRect(10.0f, 10.0f, 50.0f, 50.0f);
+  const SkPath oval_path =
+      SkPath().addOval(SkRect::MakeLTRB(10.0f, 10.0f, 50.0f, 50.0f));
+  auto diff = [this, &frame_size](SkColor color, float elevation,
+                                  const SkPath& path) {
+    auto layer = std::make_shared<PhysicalShapeLayer>(
+        color, SK_ColorBLACK, elevation, path, Clip::none);
+    layer->Preroll(preroll_context(), SkMatrix());
+    DiffContext context(SkMatrix::I(), frame_size);
+    layer->Diff(&context);
+    return context.TakePaintRegions();
+  };
+
+  const std::vector<PaintRegion> regions =
+      diff(SK_ColorGREEN, 0.0f, rect_path);
+  EXPECT_TRUE(DiffContext::ComputeDamage(
+                  regions, diff(SK_ColorGREEN, 0.0f, rect_path), frame_size)
+                  .isEmpty());
+  EXPECT_FALSE(DiffContext::ComputeDamage(
+                   regions, diff(SK_ColorRED, 0.0f, rect_path), frame_size)
+                   .isEmpty());
+  EXPECT_FALSE(DiffContext::ComputeDamage(
+                   regions, diff(SK_ColorGREEN, 4.0f, rect_path), frame_size)
+                   .isEmpty());
+  // The oval has the same bounds as the rect.
+  EXPECT_FALSE(DiffContext::ComputeDamage(
+                   regions, diff(SK_ColorGREEN, 0.0f, oval_path), frame_size)
+                   .isEmpty());
+}
+
 TEST_F(PhysicalShapeLayerTest, ElevationComplex) {
   // The layer tree should look like this:
   // layers[0] +1.0f = 1.0f
@@ -4,6 +4,7 @@
 
 #include "flutter/flow/layers/picture_layer.h"
 
+#include "flutter/fml/hash_combine.h"
 #include "flutter/fml/logging.h"
 
 namespace flutter {
@@ -62,4 +63,10 @@ void PictureLayer::Paint(PaintContext& context) const {
   picture()->playback(context.leaf_nodes_canvas);
 }
 
+void PictureLayer::Diff(DiffContext* context) const {
+  context->AddPaintRegion(
+      fml::HashCombine(picture()->uniqueID(), offset_.x(), offset_.y()),
+      paint_bounds());
+}
+
 }  // namespace flutter
@@ -26,6 +26,8 @@ class PictureLayer : public Layer {
 
   void Paint(PaintContext& context) const override;
 
+  void Diff(DiffContext* context) const override;
+
  private:
   SkPoint offset_;
   // Even though pictures themselves are not GPU resources, they may reference
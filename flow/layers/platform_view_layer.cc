@@ -52,4 +52,10 @@ void PlatformViewLayer::UpdateScene(SceneUpdateContext& context) {
 }
 #endif
 
+void PlatformViewLayer::Diff(DiffContext* context) const {
+  // Platform views are composited by the external view embedder, which
+  // repaints the overlays on top of them in full.
+  context->MarkFullDamage();
+}
+
 }  // namespace flutter
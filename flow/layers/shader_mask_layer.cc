@@ -4,6 +4,8 @@
 
 #include "flutter/flow/layers/shader_mask_layer.h"
 
+#include "flutter/fml/hash_combine.h"
+
 namespace flutter {
 
 ShaderMaskLayer::ShaderMaskLayer(sk_sp<SkShader> shader,
@@ -37,4 +39,13 @@ void ShaderMaskLayer::Paint(PaintContext& context) const {
       SkRect::MakeWH(mask_rect_.width(), mask_rect_.height()), paint);
 }
 
+void ShaderMaskLayer::Diff(DiffContext* context) const {
+  DiffContext::AutoCollapsedSubtree subtree(
+      context, paint_bounds(),
+      fml::HashCombine(reinterpret_cast<uintptr_t>(shader_.get()),
+                       DiffContext::HashRect(mask_rect_),
+                       static_cast<int>(blend_mode_)));
+  DiffChildren(context);
+}
+
 }  // namespace flutter
@@ -43,4 +43,9 @@ void TextureLayer::Paint(PaintContext& context) const {
                  context.gr_context, filter_quality_);
 }
 
+void TextureLayer::Diff(DiffContext* context) const {
+  // The contents of the texture may change without the layer tree changing.
+  context->AddVolatileRegion(paint_bounds());
+}
+
 }  // namespace flutter
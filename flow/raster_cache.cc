@@ -4,11 +4,14 @@
 
 #include "flutter/flow/raster_cache.h"
 
+#include <algorithm>
+#include <chrono>
 #include <vector>
 
 #include "flutter/flow/layers/layer.h"
 #include "flutter/flow/paint_utils.h"
 #include "flutter/fml/logging.h"
+#include "flutter/fml/make_copyable.h"
 #include "flutter/fml/trace_event.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkImage.h"
@@ -38,7 +41,8 @@ RasterCache::RasterCache(size_t access_threshold,
                          size_t picture_cache_limit_per_frame)
     : access_threshold_(access_threshold),
       picture_cache_limit_per_frame_(picture_cache_limit_per_frame),
-      checkerboard_images_(false) {}
+      checkerboard_images_(false),
+      pending_rasterizations_(std::make_shared<std::atomic<size_t>>(0)) {}
 
 static bool CanRasterizePicture(SkPicture* picture) {
   if (picture == nullptr) {
@@ -143,6 +147,7 @@ void RasterCache::Prepare(PrerollContext* context,
   entry.used_this_frame = true;
   if (!entry.image) {
     entry.image = RasterizeLayer(context, layer, ctm, checkerboard_images_);
+    frame_stats_.misses++;
   }
 }
 
@@ -186,7 +191,10 @@ bool RasterCache::Prepare(GrContext* context,
   if (access_threshold_ == 0) {
     return false;
   }
-  if (picture_cached_this_frame_ >= picture_cache_limit_per_frame_) {
+  const bool rasterize_concurrently =
+      concurrent_task_runner_ != nullptr && context == nullptr;
+  if (!rasterize_concurrently &&
+      picture_cached_this_frame_ >= picture_cache_limit_per_frame_) {
     return false;
   }
   if (!IsPictureWorthRasterizing(picture, will_change, is_complex)) {
@@ -213,13 +221,58 @@ bool RasterCache::Prepare(GrContext* context,
   }
 
   if (!entry.image) {
+    if (rasterize_concurrently) {
+      return PrepareConcurrently(entry, picture, transformation_matrix,
+                                 dst_color_space);
+    }
     entry.image = RasterizePicture(picture, context, transformation_matrix,
                                    dst_color_space, checkerboard_images_);
     picture_cached_this_frame_++;
+    frame_stats_.misses++;
   }
   return true;
 }
 
+bool RasterCache::PrepareConcurrently(Entry& entry,
+                                      SkPicture* picture,
+                                      const SkMatrix& transformation_matrix,
+                                      SkColorSpace* dst_color_space) {
+  if (entry.pending_image.valid()) {
+    if (entry.pending_image.wait_for(std::chrono::seconds(0)) !=
+        std::future_status::ready) {
+      // Keep drawing the picture directly until the worker is done.
+      return false;
+    }
+    // A failed rasterization is retried the next time the picture is
+    // prepared, like it is for synchronous rasterization.
+    entry.image = entry.pending_image.get();
+    return entry.image != nullptr;
+  }
+
+  if (pending_rasterizations_->load() >= kMaxPendingRasterizations) {
+    return false;
+  }
+
+  std::promise<std::unique_ptr<RasterCacheResult>> promise;
+  entry.pending_image = promise.get_future();
+  pending_rasterizations_->fetch_add(1);
+  frame_stats_.misses++;
+
+  concurrent_task_runner_->PostTask(fml::MakeCopyable(
+      [promise = std::move(promise), picture = sk_ref_sp(picture),
+       ctm = transformation_matrix,
+       dst_color_space = sk_ref_sp(dst_color_space),
+       checkerboard = checkerboard_images_,
+       pending_rasterizations = pending_rasterizations_]() mutable {
+        promise.set_value(Rasterize(
+            nullptr, ctm, dst_color_space.get(), checkerboard,
+            picture->cullRect(),
+            [&picture](SkCanvas* canvas) { canvas->drawPicture(picture); }));
+        pending_rasterizations->fetch_sub(1);
+      }));
+  return false;
+}
+
 bool RasterCache::Draw(const SkPicture& picture, SkCanvas& canvas) const {
   PictureRasterCacheKey cache_key(picture.uniqueID(), canvas.getTotalMatrix());
   auto it = picture_cache_.find(cache_key);
@@ -233,6 +286,7 @@ bool RasterCache::Draw(const SkPicture& picture, SkCanvas& canvas) const {
 
   if (entry.image) {
     entry.image->draw(canvas);
+    frame_stats_.hits++;
     return true;
   }
 
@@ -254,6 +308,7 @@ bool RasterCache::Draw(const Layer* layer,
 
   if (entry.image) {
     entry.image->draw(canvas, paint);
+    frame_stats_.hits++;
     return true;
   }
 
@@ -263,8 +318,52 @@ bool RasterCache::Draw(const Layer* layer,
 void RasterCache::SweepAfterFrame() {
   SweepOneCacheAfterFrame(picture_cache_);
   SweepOneCacheAfterFrame(layer_cache_);
+  EvictToByteBudget();
   picture_cached_this_frame_ = 0;
   TraceStatsToTimeline();
+  frame_stats_ = {};
+}
+
+void RasterCache::EvictToByteBudget() {
+  if (max_bytes_ == 0) {
+    return;
+  }
+
+  size_t cached_bytes = GetCachedBytes();
+  if (cached_bytes <= max_bytes_) {
+    return;
+  }
+
+  TRACE_EVENT0("flutter", "RasterCache::EvictToByteBudget");
+  std::vector<EvictionCandidate> candidates;
+  CollectEvictionCandidates(picture_cache_, candidates);
+  CollectEvictionCandidates(layer_cache_, candidates);
+
+  // Least recently used first. Among entries last used in the same frame,
+  // evicting the larger ones first frees the budget with fewer evictions.
+  std::sort(candidates.begin(), candidates.end(),
+            [](const EvictionCandidate& a, const EvictionCandidate& b) {
+              if (a.entry->idle_frames != b.entry->idle_frames) {
+                return a.entry->idle_frames > b.entry->idle_frames;
+              }
+              return a.entry->image_bytes() > b.entry->image_bytes();
+            });
+
+  for (const auto& candidate : candidates) {
+    if (cached_bytes <= max_bytes_) {
+      break;
+    }
+    cached_bytes -= candidate.entry->image_bytes();
+    Evict(*candidate.entry);
+    candidate.erase();
+  }
+}
+
+void RasterCache::Evict(const Entry& entry) {
+  if (entry.image) {
+    frame_stats_.evicted_entries++;
+    frame_stats_.evicted_bytes += entry.image_bytes();
+  }
 }
 
 void RasterCache::Clear() {
@@ -272,6 +371,12 @@ void RasterCache::Clear() {
   layer_cache_.clear();
 }
 
+void RasterCache::SetRetentionPolicy(size_t max_idle_frames,
+                                     size_t max_bytes) {
+  max_idle_frames_ = max_idle_frames;
+  max_bytes_ = max_bytes;
+}
+
 size_t RasterCache::GetCachedEntriesCount() const {
   return layer_cache_.size() + picture_cache_.size();
 }
@@ -284,6 +389,28 @@ size_t RasterCache::GetPictureCachedEntriesCount() const {
   return picture_cache_.size();
 }
 
+size_t RasterCache::GetCachedBytes() const {
+  size_t bytes = 0;
+  for (const auto& item : picture_cache_) {
+    bytes += item.second.image_bytes();
+  }
+  for (const auto& item : layer_cache_) {
+    bytes += item.second.image_bytes();
+  }
+  return bytes;
+}
+
+void RasterCache::SetConcurrentTaskRunner(
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner) {
+  if (concurrent_task_runner_ == task_runner) {
+    return;
+  }
+  concurrent_task_runner_ = std::move(task_runner);
+  // Images that are still being rasterized by the previous workers are
+  // dropped along with the rest of the cache.
+  Clear();
+}
+
 void RasterCache::SetCheckboardCacheImages(bool checkerboard) {
   if (checkerboard_images_ == checkerboard) {
     return;
@@ -326,6 +453,14 @@ void RasterCache::TraceStatsToTimeline() const {
                     "PictureMBytes", picture_cache_bytes * 1e-6  //
   );
 
+  FML_TRACE_COUNTER("flutter", "RasterCacheFrameStats",
+                    reinterpret_cast<int64_t>(this),                   //
+                    "Hits", frame_stats_.hits,                         //
+                    "Misses", frame_stats_.misses,                     //
+                    "EvictedCount", frame_stats_.evicted_entries,      //
+                    "EvictedMBytes", frame_stats_.evicted_bytes * 1e-6  //
+  );
+
 #endif  // !FLUTTER_RELEASE
 }
 
@@ -5,10 +5,15 @@
 #ifndef FLUTTER_FLOW_RASTER_CACHE_H_
 #define FLUTTER_FLOW_RASTER_CACHE_H_
 
+#include <atomic>
+#include <functional>
+#include <future>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "flutter/flow/raster_cache_key.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/weak_ptr.h"
 #include "third_party/skia/include/core/SkImage.h"
@@ -134,6 +139,8 @@ class RasterCache {
   // 3. The picture is accessed too few times
   // 4. There are too many pictures to be cached in the current frame.
   //    (See also kDefaultPictureCacheLimitPerFrame.)
+  // 5. The picture is still being rasterized on a worker thread. (See also
+  //    |SetConcurrentTaskRunner|.)
   bool Prepare(GrContext* context,
                SkPicture* picture,
                const SkMatrix& transformation_matrix,
@@ -158,48 +165,145 @@ class RasterCache {
             SkCanvas& canvas,
             SkPaint* paint = nullptr) const;
 
+  // Evicts the entries that have not been used for more than the allowed
+  // number of idle frames, then evicts the least recently used entries until
+  // the cached images fit in the byte budget.
+  //
+  // See also |SetRetentionPolicy|.
   void SweepAfterFrame();
 
   void Clear();
 
   void SetCheckboardCacheImages(bool checkerboard);
 
+  /**
+   * @brief Configure how long entries are kept in the cache.
+   *
+   * @param max_idle_frames the number of consecutive frames an entry may go
+   *        unused before it is evicted. With the default of zero, entries
+   *        that were not used in a frame are evicted at the end of it.
+   * @param max_bytes the maximum number of bytes of cached images. When the
+   *        budget is exceeded at the end of a frame, the least recently used
+   *        entries are evicted first, and larger entries before smaller ones
+   *        that were last used in the same frame. Zero means no budget.
+   */
+  void SetRetentionPolicy(size_t max_idle_frames, size_t max_bytes);
+
+  /**
+   * @brief Rasterize pictures on the workers of |task_runner| instead of on
+   * the calling thread.
+   *
+   * The picture is drawn directly until a worker has finished rasterizing it,
+   * and the cached image is used from the first frame prepared after that.
+   * Since dispatching the work is cheap, the per frame limit on the number of
+   * pictures cached does not apply. Instead, at most
+   * |kMaxPendingRasterizations| pictures are rasterized at any given time.
+   *
+   * Only pictures prepared without a GrContext (i.e. with software rendering)
+   * are rasterized concurrently. Pictures prepared for a GPU surface may
+   * reference texture backed images that must not be accessed from the
+   * workers, and are still rasterized synchronously.
+   *
+   * @param task_runner the task runner of the workers, or nullptr to
+   *        rasterize all pictures synchronously.
+   */
+  void SetConcurrentTaskRunner(
+      std::shared_ptr<fml::ConcurrentTaskRunner> task_runner);
+
+  // The maximum number of pictures rasterized on workers at the same time.
+  static constexpr size_t kMaxPendingRasterizations = 16;
+
   size_t GetCachedEntriesCount() const;
 
   size_t GetLayerCachedEntriesCount() const;
 
   size_t GetPictureCachedEntriesCount() const;
 
+  // The total number of bytes of the images held by the cache.
+  size_t GetCachedBytes() const;
+
  private:
   struct Entry {
     bool used_this_frame = false;
+    // The number of consecutive frames in which the entry was not used.
+    size_t idle_frames = 0;
     size_t access_count = 0;
     std::unique_ptr<RasterCacheResult> image;
+    // Valid while the image is being rasterized on a worker thread.
+    std::future<std::unique_ptr<RasterCacheResult>> pending_image;
+
+    size_t image_bytes() const {
+      return image ? static_cast<size_t>(image->image_bytes()) : 0;
+    }
+  };
+
+  // The entries of both caches, in the order they should be evicted when the
+  // cache goes over its byte budget.
+  struct EvictionCandidate {
+    Entry* entry;
+    std::function<void()> erase;
+  };
+
+  // Stats of the current frame reported to the timeline.
+  struct FrameStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evicted_entries = 0;
+    size_t evicted_bytes = 0;
   };
 
   template <class Cache>
-  static void SweepOneCacheAfterFrame(Cache& cache) {
+  void SweepOneCacheAfterFrame(Cache& cache) {
     std::vector<typename Cache::iterator> dead;
 
     for (auto it = cache.begin(); it != cache.end(); ++it) {
       Entry& entry = it->second;
-      if (!entry.used_this_frame) {
+      if (entry.used_this_frame) {
+        entry.idle_frames = 0;
+      } else if (++entry.idle_frames > max_idle_frames_) {
         dead.push_back(it);
       }
       entry.used_this_frame = false;
     }
 
     for (auto it : dead) {
+      Evict(it->second);
       cache.erase(it);
     }
   }
 
+  template <class Cache>
+  void CollectEvictionCandidates(Cache& cache,
+                                 std::vector<EvictionCandidate>& candidates) {
+    for (auto it = cache.begin(); it != cache.end(); ++it) {
+      if (it->second.image) {
+        candidates.push_back(
+            {&it->second, [&cache, it]() { cache.erase(it); }});
+      }
+    }
+  }
+
+  bool PrepareConcurrently(Entry& entry,
+                           SkPicture* picture,
+                           const SkMatrix& transformation_matrix,
+                           SkColorSpace* dst_color_space);
+
+  void EvictToByteBudget();
+
+  void Evict(const Entry& entry);
+
   const size_t access_threshold_;
   const size_t picture_cache_limit_per_frame_;
   size_t picture_cached_this_frame_ = 0;
+  size_t max_idle_frames_ = 0;
+  size_t max_bytes_ = 0;
   mutable PictureRasterCacheKey::Map<Entry> picture_cache_;
   mutable LayerRasterCacheKey::Map<Entry> layer_cache_;
+  mutable FrameStats frame_stats_;
   bool checkerboard_images_;
+  std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner_;
+  // Shared with the worker tasks, which may outlive the cache.
+  std::shared_ptr<std::atomic<size_t>> pending_rasterizations_;
 
   void TraceStatsToTimeline() const;
 
@@ -3,6 +3,8 @@
 // found in the LICENSE file.
 
 #include "flutter/flow/raster_cache.h"
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/synchronization/waitable_event.h"
 
 #include "gtest/gtest.h"
 #include "third_party/skia/include/core/SkCanvas.h"
@@ -132,6 +134,122 @@ TEST(RasterCache, SweepsRemoveUnusedFrames) {
   ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
 }
 
+TEST(RasterCache, SweepsKeepEntriesForMaxIdleFrames) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+  cache.SetRetentionPolicy(2, 0);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture = GetSamplePicture();
+
+  SkCanvas dummy_canvas;
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true,
+                             false));  // 1
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+
+  cache.SweepAfterFrame();
+
+  ASSERT_TRUE(cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true,
+                            false));  // 2
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+
+  cache.SweepAfterFrame();
+  cache.SweepAfterFrame();  // 1st idle frame.
+  cache.SweepAfterFrame();  // 2nd idle frame.
+
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+
+  cache.SweepAfterFrame();
+  cache.SweepAfterFrame();
+  cache.SweepAfterFrame();
+  cache.SweepAfterFrame();  // 3rd idle frame.
+
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_EQ(cache.GetCachedEntriesCount(), 0u);
+}
+
+TEST(RasterCache, SweepsEvictLeastRecentlyUsedEntriesOverByteBudget) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture1 = GetSamplePicture();
+  auto picture2 = GetSamplePicture();
+  // Room for one rasterized sample picture of 150x100 pixels, but not two.
+  const size_t picture_bytes = 150 * 100 * 4;
+  cache.SetRetentionPolicy(10, picture_bytes * 3 / 2);
+
+  SkCanvas dummy_canvas;
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture1.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture2.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Draw(*picture1, dummy_canvas));
+  ASSERT_FALSE(cache.Draw(*picture2, dummy_canvas));
+
+  cache.SweepAfterFrame();
+
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture1.get(), matrix, srgb.get(), true, false));
+  ASSERT_TRUE(cache.Draw(*picture1, dummy_canvas));
+
+  cache.SweepAfterFrame();
+  ASSERT_EQ(cache.GetCachedBytes(), picture_bytes);
+
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture2.get(), matrix, srgb.get(), true, false));
+  ASSERT_TRUE(cache.Draw(*picture2, dummy_canvas));
+  ASSERT_EQ(cache.GetCachedBytes(), 2 * picture_bytes);
+
+  // picture1 was not used in the last frame, so it is evicted first.
+  cache.SweepAfterFrame();
+  ASSERT_EQ(cache.GetCachedBytes(), picture_bytes);
+  ASSERT_FALSE(cache.Draw(*picture1, dummy_canvas));
+  ASSERT_TRUE(cache.Draw(*picture2, dummy_canvas));
+}
+
+TEST(RasterCache, PicturesAreRasterizedOnWorkersWhenConcurrent) {
+  size_t threshold = 1;
+  // Would prevent any picture from being cached synchronously.
+  size_t picture_cache_limit_per_frame = 0;
+  flutter::RasterCache cache(threshold, picture_cache_limit_per_frame);
+
+  auto loop = fml::ConcurrentMessageLoop::Create(1);
+  cache.SetConcurrentTaskRunner(loop->GetTaskRunner());
+
+  SkMatrix matrix = SkMatrix::I();
+  auto picture = GetSamplePicture();
+  SkCanvas dummy_canvas;
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  cache.SweepAfterFrame();
+
+  // The picture is dispatched to the worker and drawn directly in this frame.
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  cache.SweepAfterFrame();
+
+  // Tasks run in order on the single worker.
+  fml::AutoResetWaitableEvent latch;
+  loop->GetTaskRunner()->PostTask([&latch]() { latch.Signal(); });
+  latch.Wait();
+
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_GT(cache.GetCachedBytes(), 0u);
+}
+
 // Construct a cache result whose device target rectangle rounds out to be one
 // pixel wider than the cached image.  Verify that it can be drawn without
 // triggering any assertions.
@@ -4,25 +4,160 @@
 
 #include "rtree.h"
 
-#include <list>
+#include <algorithm>
+#include <cmath>
 
 #include "flutter/fml/logging.h"
 #include "third_party/skia/include/core/SkBBHFactory.h"
 
 namespace flutter {
 
-RTree::RTree() : bbh_{SkRTreeFactory{}()}, all_ops_count_(0) {}
+namespace {
+
+// A drawn rect found by |searchNonOverlappingDrawnRects|, along with the index
+// of the first operation it covers.
+struct DrawnRect {
+  int first_op;
+  SkRect bounds;
+};
+
+uint32_t FindRoot(std::vector<uint32_t>& parents, uint32_t index) {
+  while (parents[index] != index) {
+    parents[index] = parents[parents[index]];
+    index = parents[index];
+  }
+  return index;
+}
+
+// Joins the rects that intersect with each other, transitively, in a single
+// pass. Returns true if any rects were joined.
+bool JoinIntersectingRects(std::vector<DrawnRect>& rects) {
+  // Sweep from left to right. Only the rects whose left edge lies before the
+  // right edge of a rect can intersect with it.
+  std::sort(rects.begin(), rects.end(),
+            [](const DrawnRect& a, const DrawnRect& b) {
+              return a.bounds.fLeft < b.bounds.fLeft;
+            });
+
+  const uint32_t count = rects.size();
+  std::vector<uint32_t> parents(count);
+  for (uint32_t i = 0; i < count; i++) {
+    parents[i] = i;
+  }
+
+  bool joined = false;
+  for (uint32_t i = 0; i < count; i++) {
+    const SkRect& rect = rects[i].bounds;
+    for (uint32_t j = i + 1;
+         j < count && rects[j].bounds.fLeft < rect.fRight; j++) {
+      if (!SkRect::Intersects(rect, rects[j].bounds)) {
+        continue;
+      }
+      uint32_t root_i = FindRoot(parents, i);
+      uint32_t root_j = FindRoot(parents, j);
+      if (root_i != root_j) {
+        parents[std::max(root_i, root_j)] = std::min(root_i, root_j);
+        joined = true;
+      }
+    }
+  }
+
+  if (!joined) {
+    return false;
+  }
+
+  // Roots always precede the members of their set, so a single forward pass
+  // folds every set into its root.
+  std::vector<DrawnRect> result;
+  std::vector<uint32_t> result_index(count);
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t root = FindRoot(parents, i);
+    if (root == i) {
+      result_index[i] = result.size();
+      result.push_back(rects[i]);
+    } else {
+      DrawnRect& joined_rect = result[result_index[root]];
+      joined_rect.bounds.join(rects[i].bounds);
+      joined_rect.first_op = std::min(joined_rect.first_op, rects[i].first_op);
+    }
+  }
+  rects = std::move(result);
+  return true;
+}
+
+}  // namespace
+
+RTree::RTree() : all_ops_count_(0) {}
 
 void RTree::insert(const SkRect boundsArray[],
                    const SkBBoxHierarchy::Metadata metadata[],
                    int N) {
   FML_DCHECK(0 == all_ops_count_);
-  bbh_->insert(boundsArray, metadata, N);
+  std::vector<uint32_t> leaves;
+  leaves.reserve(N);
+  std::vector<SkRect> bounds(boundsArray, boundsArray + N);
   for (int i = 0; i < N; i++) {
-    if (metadata != nullptr && metadata[i].isDraw) {
-      draw_op_[i] = boundsArray[i];
+    bounds[i].sort();
+    // Empty rects can never intersect with a query.
+    if (!bounds[i].isEmpty()) {
+      leaves.push_back(i);
     }
   }
+
+  // Sort-Tile-Recursive: sort the leaves into vertical slices by the center
+  // of their bounds, then each slice from top to bottom. The slices alternate
+  // between going down and up so that consecutive leaves stay close to each
+  // other across slice boundaries.
+  auto center_x = [&bounds](uint32_t op) { return bounds[op].centerX(); };
+  auto center_y = [&bounds](uint32_t op) { return bounds[op].centerY(); };
+  std::sort(leaves.begin(), leaves.end(), [&](uint32_t a, uint32_t b) {
+    return center_x(a) < center_x(b);
+  });
+  const size_t node_count = (leaves.size() + kFanout - 1) / kFanout;
+  const size_t slice_count = std::ceil(std::sqrt(node_count));
+  const size_t slice_size = std::max<size_t>(1, slice_count) * kFanout;
+  bool downwards = true;
+  for (size_t start = 0; start < leaves.size(); start += slice_size) {
+    auto begin = leaves.begin() + start;
+    auto end = leaves.begin() + std::min(start + slice_size, leaves.size());
+    std::sort(begin, end, [&](uint32_t a, uint32_t b) {
+      return downwards ? center_y(a) < center_y(b) : center_y(a) > center_y(b);
+    });
+    downwards = !downwards;
+  }
+
+  left_.reserve(leaves.size() + node_count + 1);
+  top_.reserve(leaves.size() + node_count + 1);
+  right_.reserve(leaves.size() + node_count + 1);
+  bottom_.reserve(leaves.size() + node_count + 1);
+  leaf_ops_.reserve(leaves.size());
+  leaf_is_draw_.reserve(leaves.size());
+  for (uint32_t op : leaves) {
+    AppendNode(bounds[op]);
+    leaf_ops_.push_back(op);
+    leaf_is_draw_.push_back(metadata != nullptr && metadata[op].isDraw);
+  }
+
+  // Pack each level into full nodes of the level above it, until there is a
+  // single root.
+  level_offsets_.push_back(0);
+  uint32_t level_begin = 0;
+  uint32_t level_end = left_.size();
+  while (level_end - level_begin > 1) {
+    for (uint32_t node = level_begin; node < level_end; node += kFanout) {
+      SkRect node_bounds = SkRect::MakeEmpty();
+      const uint32_t last_child = std::min(node + kFanout, level_end);
+      for (uint32_t child = node; child < last_child; child++) {
+        node_bounds.join(NodeBounds(child));
+      }
+      AppendNode(node_bounds);
+    }
+    level_offsets_.push_back(level_end);
+    level_begin = level_end;
+    level_end = left_.size();
+  }
+  level_offsets_.push_back(level_end);
+
   all_ops_count_ = N;
 }
 
@@ -30,59 +165,96 @@ void RTree::insert(const SkRect boundsArray[], int N) {
   insert(boundsArray, nullptr, N);
 }
 
-void RTree::search(const SkRect& query, std::vector<int>* results) const {
-  bbh_->search(query, results);
+void RTree::AppendNode(const SkRect& bounds) {
+  left_.push_back(bounds.fLeft);
+  top_.push_back(bounds.fTop);
+  right_.push_back(bounds.fRight);
+  bottom_.push_back(bounds.fBottom);
 }
 
-std::list<SkRect> RTree::searchNonOverlappingDrawnRects(
-    const SkRect& query) const {
-  // Get the indexes for the operations that intersect with the query rect.
-  std::vector<int> intermediary_results;
-  search(query, &intermediary_results);
+template <typename Visitor>
+void RTree::VisitIntersectingLeaves(const SkRect& query,
+                                    Visitor visitor) const {
+  if (left_.empty()) {
+    return;
+  }
 
-  std::list<SkRect> final_results;
-  for (int index : intermediary_results) {
-    auto draw_op = draw_op_.find(index);
-    // Ignore records that don't draw anything.
-    if (draw_op == draw_op_.end()) {
+  auto intersects = [this, &query](uint32_t node) {
+    return left_[node] < query.fRight && query.fLeft < right_[node] &&
+           top_[node] < query.fBottom && query.fTop < bottom_[node];
+  };
+
+  // Pairs of level and node index.
+  std::vector<std::pair<uint32_t, uint32_t>> pending;
+  const uint32_t root_level = level_offsets_.size() - 2;
+  const uint32_t root = left_.size() - 1;
+  if (intersects(root)) {
+    pending.emplace_back(root_level, root);
+  }
+
+  while (!pending.empty()) {
+    const uint32_t level = pending.back().first;
+    const uint32_t node = pending.back().second;
+    pending.pop_back();
+
+    if (level == 0) {
+      visitor(node);
       continue;
     }
-    auto current_record_rect = draw_op->second;
-    auto replaced_existing_rect = false;
-    // // If the current record rect intersects with any of the rects in the
-    // // result list, then join them, and update the rect in final_results.
-    std::list<SkRect>::iterator curr_rect_itr = final_results.begin();
-    std::list<SkRect>::iterator first_intersecting_rect_itr;
-    while (!replaced_existing_rect && curr_rect_itr != final_results.end()) {
-      if (SkRect::Intersects(*curr_rect_itr, current_record_rect)) {
-        replaced_existing_rect = true;
-        first_intersecting_rect_itr = curr_rect_itr;
-        curr_rect_itr->join(current_record_rect);
-      }
-      curr_rect_itr++;
-    }
-    // It's possible that the result contains duplicated rects at this point.
-    // For example, consider a result list that contains rects A, B. If a
-    // new rect C is a superset of A and B, then A and B are the same set after
-    // the merge. As a result, find such cases and remove them from the result
-    // list.
-    while (replaced_existing_rect && curr_rect_itr != final_results.end()) {
-      if (SkRect::Intersects(*curr_rect_itr, *first_intersecting_rect_itr)) {
-        first_intersecting_rect_itr->join(*curr_rect_itr);
-        curr_rect_itr = final_results.erase(curr_rect_itr);
-      } else {
-        curr_rect_itr++;
+
+    const uint32_t first_child =
+        level_offsets_[level - 1] + (node - level_offsets_[level]) * kFanout;
+    const uint32_t last_child =
+        std::min(first_child + kFanout, level_offsets_[level]);
+    for (uint32_t child = first_child; child < last_child; child++) {
+      if (intersects(child)) {
+        pending.emplace_back(level - 1, child);
       }
     }
-    if (!replaced_existing_rect) {
-      final_results.push_back(current_record_rect);
+  }
+}
+
+void RTree::search(const SkRect& query, std::vector<int>* results) const {
+  const size_t first_result = results->size();
+  VisitIntersectingLeaves(
+      query, [this, results](uint32_t leaf) {
+        results->push_back(leaf_ops_[leaf]);
+      });
+  std::sort(results->begin() + first_result, results->end());
+}
+
+std::vector<SkRect> RTree::searchNonOverlappingDrawnRects(
+    const SkRect& query) const {
+  std::vector<DrawnRect> drawn_rects;
+  VisitIntersectingLeaves(query, [this, &drawn_rects](uint32_t leaf) {
+    // Ignore records that don't draw anything.
+    if (leaf_is_draw_[leaf]) {
+      drawn_rects.push_back({leaf_ops_[leaf], NodeBounds(leaf)});
     }
+  });
+
+  // A joined rect may intersect with rects that none of its parts intersected
+  // with, so repeat until no rects intersect with each other.
+  while (drawn_rects.size() > 1 && JoinIntersectingRects(drawn_rects)) {
+  }
+
+  std::sort(drawn_rects.begin(), drawn_rects.end(),
+            [](const DrawnRect& a, const DrawnRect& b) {
+              return a.first_op < b.first_op;
+            });
+  std::vector<SkRect> final_results;
+  final_results.reserve(drawn_rects.size());
+  for (const DrawnRect& drawn_rect : drawn_rects) {
+    final_results.push_back(drawn_rect.bounds);
   }
   return final_results;
 }
 
 size_t RTree::bytesUsed() const {
-  return bbh_->bytesUsed();
+  return sizeof(float) * (left_.capacity() + top_.capacity() +
+                          right_.capacity() + bottom_.capacity()) +
+         sizeof(uint32_t) * level_offsets_.capacity() +
+         sizeof(int) * leaf_ops_.capacity() + leaf_is_draw_.capacity() / 8;
 }
 
 RTreeFactory::RTreeFactory() {
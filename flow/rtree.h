@@ -5,15 +5,22 @@
 #ifndef FLUTTER_FLOW_RTREE_H_
 #define FLUTTER_FLOW_RTREE_H_
 
-#include <list>
-#include <map>
+#include <cstdint>
+#include <vector>
 
 #include "third_party/skia/include/core/SkBBHFactory.h"
 #include "third_party/skia/include/core/SkTypes.h"
 
 namespace flutter {
 /**
- * An R-Tree implementation that forwards calls to an SkRTree.
+ * A bulk loaded R-Tree of the operations recorded in a picture.
+ *
+ * The tree is built once from all the bounds passed to |insert|. Entries are
+ * ordered with the Sort-Tile-Recursive algorithm and packed into full nodes,
+ * so the tree has the minimum number of nodes for its fan-out. The bounds of
+ * all the nodes are kept in contiguous arrays, one per edge, level by level.
+ * The children of a node are the consecutive nodes of the level below it, so
+ * no child pointers are stored.
  *
  * This implementation provides a searchNonOverlappingDrawnRects method,
  * which can be used to query the rects for the operations recorded in the tree.
@@ -26,6 +33,10 @@ class RTree : public SkBBoxHierarchy {
               const SkBBoxHierarchy::Metadata[],
               int N) override;
   void insert(const SkRect[], int N) override;
+
+  // Finds the indexes of the operations whose bounds intersect with the query
+  // rect. The indexes are sorted in ascending order, which is the order the
+  // operations must be played back in.
   void search(const SkRect& query, std::vector<int>* results) const override;
   size_t bytesUsed() const override;
 
@@ -34,17 +45,41 @@ class RTree : public SkBBoxHierarchy {
   //
   // When two rects intersect with each other, they are joined into a single
   // rect which also intersects with the query rect. In other words, the bounds
-  // of each rect in the result list are mutually exclusive.
-  std::list<SkRect> searchNonOverlappingDrawnRects(const SkRect& query) const;
+  // of each rect in the result list are mutually exclusive. The rects are
+  // ordered by the first drawing operation they contain.
+  std::vector<SkRect> searchNonOverlappingDrawnRects(const SkRect& query) const;
 
   // Insertion count (not overall node count, which may be greater).
   int getCount() const { return all_ops_count_; }
 
  private:
-  // A map containing the draw operation rects keyed off the operation index
-  // in the insert call.
-  std::map<int, SkRect> draw_op_;
-  sk_sp<SkBBoxHierarchy> bbh_;
+  // The maximum number of children of a node.
+  static constexpr uint32_t kFanout = 8;
+
+  void AppendNode(const SkRect& bounds);
+
+  SkRect NodeBounds(uint32_t node) const {
+    return SkRect::MakeLTRB(left_[node], top_[node], right_[node],
+                            bottom_[node]);
+  }
+
+  // Calls |visitor| with the index of every leaf whose bounds intersect with
+  // |query|.
+  template <typename Visitor>
+  void VisitIntersectingLeaves(const SkRect& query, Visitor visitor) const;
+
+  // The bounds of the nodes. The leaves come first, followed by each upper
+  // level of the tree, ending with the root.
+  std::vector<float> left_;
+  std::vector<float> top_;
+  std::vector<float> right_;
+  std::vector<float> bottom_;
+  // The index of the first node of each level, plus the total node count.
+  std::vector<uint32_t> level_offsets_;
+  // The operation index of each leaf.
+  std::vector<int> leaf_ops_;
+  // Whether the operation of each leaf draws something.
+  std::vector<bool> leaf_is_draw_;
   int all_ops_count_;
 };
 
@@ -0,0 +1,167 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <list>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/flow/rtree.h"
+#include "third_party/skia/include/core/SkBBHFactory.h"
+
+namespace flutter {
+namespace benchmarking {
+
+namespace {
+
+// The previous implementation of |RTree|, which wrapped an SkRTree and joined
+// the drawn rects in a list. Kept as the baseline for the benchmarks below.
+class SkRTreeBaseline {
+ public:
+  SkRTreeBaseline() : bbh_(SkRTreeFactory{}()) {}
+
+  void insert(const SkRect bounds[],
+              const SkBBoxHierarchy::Metadata metadata[],
+              int N) {
+    bbh_->insert(bounds, metadata, N);
+    for (int i = 0; i < N; i++) {
+      if (metadata[i].isDraw) {
+        draw_op_[i] = bounds[i];
+      }
+    }
+  }
+
+  std::list<SkRect> searchNonOverlappingDrawnRects(const SkRect& query) const {
+    std::vector<int> results;
+    bbh_->search(query, &results);
+
+    std::list<SkRect> final_results;
+    for (int index : results) {
+      auto draw_op = draw_op_.find(index);
+      if (draw_op == draw_op_.end()) {
+        continue;
+      }
+      auto current_record_rect = draw_op->second;
+      auto replaced_existing_rect = false;
+      auto curr_rect_itr = final_results.begin();
+      std::list<SkRect>::iterator first_intersecting_rect_itr;
+      while (!replaced_existing_rect && curr_rect_itr != final_results.end()) {
+        if (SkRect::Intersects(*curr_rect_itr, current_record_rect)) {
+          replaced_existing_rect = true;
+          first_intersecting_rect_itr = curr_rect_itr;
+          curr_rect_itr->join(current_record_rect);
+        }
+        curr_rect_itr++;
+      }
+      while (replaced_existing_rect && curr_rect_itr != final_results.end()) {
+        if (SkRect::Intersects(*curr_rect_itr, *first_intersecting_rect_itr)) {
+          first_intersecting_rect_itr->join(*curr_rect_itr);
+          curr_rect_itr = final_results.erase(curr_rect_itr);
+        } else {
+          curr_rect_itr++;
+        }
+      }
+      if (!replaced_existing_rect) {
+        final_results.push_back(current_record_rect);
+      }
+    }
+    return final_results;
+  }
+
+ private:
+  std::map<int, SkRect> draw_op_;
+  sk_sp<SkBBoxHierarchy> bbh_;
+};
+
+// The bounds of the operations of a picture that mostly draws small,
+// scattered glyph runs and shapes, with a clip or transform every few ops,
+// similar to the content of a scrolling list.
+struct PictureOps {
+  std::vector<SkRect> bounds;
+  std::vector<SkBBoxHierarchy::Metadata> metadata;
+};
+
+PictureOps MakePictureOps(int op_count) {
+  std::mt19937 generator(op_count);
+  std::uniform_real_distribution<float> position(0, 2000);
+  std::uniform_real_distribution<float> size(4, 80);
+  PictureOps ops;
+  ops.bounds.reserve(op_count);
+  ops.metadata.reserve(op_count);
+  for (int i = 0; i < op_count; i++) {
+    const float left = position(generator);
+    const float top = position(generator);
+    ops.bounds.push_back(SkRect::MakeXYWH(left, top, size(generator),
+                                          size(generator) / 2));
+    SkBBoxHierarchy::Metadata metadata;
+    metadata.isDraw = i % 4 != 0;
+    ops.metadata.push_back(metadata);
+  }
+  return ops;
+}
+
+// The size of a platform view the overlays are computed for.
+const SkRect kQuery = SkRect::MakeXYWH(600, 600, 800, 500);
+
+}  // namespace
+
+static void BM_RTreeInsert(benchmark::State& state) {
+  const PictureOps ops = MakePictureOps(state.range(0));
+  while (state.KeepRunning()) {
+    RTree rtree;
+    rtree.insert(ops.bounds.data(), ops.metadata.data(), ops.bounds.size());
+  }
+}
+
+static void BM_SkRTreeBaselineInsert(benchmark::State& state) {
+  const PictureOps ops = MakePictureOps(state.range(0));
+  while (state.KeepRunning()) {
+    SkRTreeBaseline rtree;
+    rtree.insert(ops.bounds.data(), ops.metadata.data(), ops.bounds.size());
+  }
+}
+
+static void BM_RTreeSearch(benchmark::State& state) {
+  const PictureOps ops = MakePictureOps(state.range(0));
+  RTree rtree;
+  rtree.insert(ops.bounds.data(), ops.metadata.data(), ops.bounds.size());
+  std::vector<int> results;
+  while (state.KeepRunning()) {
+    results.clear();
+    rtree.search(kQuery, &results);
+    benchmark::DoNotOptimize(results.data());
+  }
+}
+
+static void BM_RTreeSearchNonOverlappingDrawnRects(benchmark::State& state) {
+  const PictureOps ops = MakePictureOps(state.range(0));
+  RTree rtree;
+  rtree.insert(ops.bounds.data(), ops.metadata.data(), ops.bounds.size());
+  while (state.KeepRunning()) {
+    auto rects = rtree.searchNonOverlappingDrawnRects(kQuery);
+    benchmark::DoNotOptimize(rects.data());
+  }
+}
+
+static void BM_SkRTreeBaselineSearchNonOverlappingDrawnRects(
+    benchmark::State& state) {
+  const PictureOps ops = MakePictureOps(state.range(0));
+  SkRTreeBaseline rtree;
+  rtree.insert(ops.bounds.data(), ops.metadata.data(), ops.bounds.size());
+  while (state.KeepRunning()) {
+    auto rects = rtree.searchNonOverlappingDrawnRects(kQuery);
+    benchmark::DoNotOptimize(rects.size());
+  }
+}
+
+BENCHMARK(BM_RTreeInsert)->Range(1 << 10, 1 << 16);
+BENCHMARK(BM_SkRTreeBaselineInsert)->Range(1 << 10, 1 << 16);
+BENCHMARK(BM_RTreeSearch)->Range(1 << 10, 1 << 16);
+BENCHMARK(BM_RTreeSearchNonOverlappingDrawnRects)->Range(1 << 10, 1 << 16);
+BENCHMARK(BM_SkRTreeBaselineSearchNonOverlappingDrawnRects)
+    ->Range(1 << 10, 1 << 16);
+
+}  // namespace benchmarking
+}  // namespace flutter
@@ -231,5 +231,30 @@ TEST(RTree, searchNonOverlappingDrawnRects_JoinRectsWhenIntersectedCase3) {
   ASSERT_EQ(*hits.begin(), SkRect::MakeLTRB(50, 50, 620, 300));
 }
 
+TEST(RTree, searchReturnsIntersectingOpsInOrder) {
+  // Enough ops to build a tree of several levels.
+  std::vector<SkRect> bounds;
+  for (int y = 0; y < 40; y++) {
+    for (int x = 0; x < 40; x++) {
+      bounds.push_back(SkRect::MakeXYWH(x * 10, y * 10, 8, 8));
+    }
+  }
+  RTree rtree;
+  rtree.insert(bounds.data(), bounds.size());
+  ASSERT_EQ(1600, rtree.getCount());
+
+  SkRect query = SkRect::MakeLTRB(95, 195, 125, 215);
+  std::vector<int> expected;
+  for (size_t i = 0; i < bounds.size(); i++) {
+    if (SkRect::Intersects(bounds[i], query)) {
+      expected.push_back(i);
+    }
+  }
+  std::vector<int> results;
+  rtree.search(query, &results);
+  ASSERT_EQ(12UL, results.size());
+  ASSERT_EQ(expected, results);
+}
+
 }  // namespace testing
 }  // namespace flutter
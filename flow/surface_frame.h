@@ -6,6 +6,7 @@
 #define FLUTTER_FLOW_SURFACE_FRAME_H_
 
 #include <memory>
+#include <optional>
 
 #include "flutter/flow/gl_context_switch.h"
 #include "flutter/fml/macros.h"
@@ -42,10 +43,36 @@ class SurfaceFrame {
 
   bool supports_readback() { return supports_readback_; }
 
+  // Whether the backing store of this frame still holds the pixels of the
+  // frame submitted before it, so that only the damaged area of the frame
+  // needs to be repainted.
+  bool retains_previous_contents() const { return retains_previous_contents_; }
+
+  void set_retains_previous_contents(bool retains_previous_contents) {
+    retains_previous_contents_ = retains_previous_contents;
+  }
+
+  // Whether the surface makes use of the damage of this frame, to repaint or
+  // present only the area that changed. The damage is only computed for such
+  // frames, since diffing the layer trees is wasted work otherwise.
+  bool wants_damage() const { return wants_damage_; }
+
+  void set_wants_damage(bool wants_damage) { wants_damage_ = wants_damage; }
+
+  // The area of this frame that changed since the previously submitted frame,
+  // in device pixels. Surfaces may use this to present only the damaged area.
+  // An empty optional means the entire frame changed.
+  const std::optional<SkIRect>& damage() const { return damage_; }
+
+  void set_damage(std::optional<SkIRect> damage) { damage_ = damage; }
+
  private:
   bool submitted_ = false;
   sk_sp<SkSurface> surface_;
   bool supports_readback_;
+  bool retains_previous_contents_ = false;
+  bool wants_damage_ = false;
+  std::optional<SkIRect> damage_;
   SubmitCallback submit_callback_;
   std::unique_ptr<GLContextResult> context_result_;
 
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 
+#include "flutter/fml/synchronization/count_down_latch.h"
 #include "flutter/fml/thread.h"
 #include "flutter/fml/trace_event.h"
 
@@ -19,11 +20,19 @@ std::shared_ptr<ConcurrentMessageLoop> ConcurrentMessageLoop::Create(
 
 ConcurrentMessageLoop::ConcurrentMessageLoop(size_t worker_count)
     : worker_count_(std::max<size_t>(worker_count, 1ul)) {
+  for (size_t i = 0; i < worker_count_; ++i) {
+    worker_queues_.emplace_back(std::make_unique<WorkerQueue>());
+  }
+
+  // The workers start by acquiring the wake mutex, so they don't look at the
+  // thread IDs before all of them are known.
+  std::scoped_lock lock(wake_mutex_);
+
   for (size_t i = 0; i < worker_count_; ++i) {
     workers_.emplace_back([i, this]() {
       fml::Thread::SetCurrentThreadName(
           std::string{"io.flutter.worker." + std::to_string(i + 1)});
-      WorkerMain();
+      WorkerMain(i);
     });
   }
 
@@ -52,63 +61,132 @@ void ConcurrentMessageLoop::PostTask(const fml::closure& task) {
     return;
   }
 
-  std::unique_lock lock(tasks_mutex_);
-
   // Don't just drop tasks on the floor in case of shutdown.
   if (shutdown_) {
     FML_DLOG(WARNING)
         << "Tried to post a task to shutdown concurrent message "
            "loop. The task will be executed on the callers thread.";
-    lock.unlock();
     task();
     return;
   }
 
-  tasks_.push(task);
+  // Tasks posted by a worker are likely to work on the same data as the task
+  // that posted them, so keep them on that worker unless they are stolen.
+  size_t worker_index = GetCurrentWorkerIndex();
+  if (worker_index == worker_count_) {
+    worker_index = next_worker_.fetch_add(1) % worker_count_;
+  }
+  EnqueueTask(worker_index, task, false);
+  WakeWorkers(false);
+}
 
-  // Unlock the mutex before notifying the condition variable because that mutex
-  // has to be acquired on the other thread anyway. Waiting in this scope till
-  // it is acquired there is a pessimization.
-  lock.unlock();
+size_t ConcurrentMessageLoop::GetCurrentWorkerIndex() const {
+  const auto current_thread_id = std::this_thread::get_id();
+  for (size_t i = 0; i < worker_thread_ids_.size(); ++i) {
+    if (worker_thread_ids_[i] == current_thread_id) {
+      return i;
+    }
+  }
+  return worker_count_;
+}
 
-  tasks_condition_.notify_one();
+void ConcurrentMessageLoop::EnqueueTask(size_t worker_index,
+                                        fml::closure task,
+                                        bool affine) {
+  WorkerQueue& queue = *worker_queues_[worker_index];
+  std::scoped_lock lock(queue.mutex);
+  if (affine) {
+    queue.affine_tasks.emplace_back(std::move(task));
+    ++queue.affine_task_count;
+  } else {
+    queue.tasks.emplace_back(std::move(task));
+    ++stealable_task_count_;
+  }
 }
 
-void ConcurrentMessageLoop::WorkerMain() {
-  while (true) {
-    std::unique_lock lock(tasks_mutex_);
-    tasks_condition_.wait(lock, [&]() {
-      return tasks_.size() > 0 || shutdown_ || HasThreadTasksLocked();
-    });
+fml::closure ConcurrentMessageLoop::TakeTask(size_t worker_index) {
+  fml::closure task;
+  {
+    WorkerQueue& queue = *worker_queues_[worker_index];
+    std::scoped_lock lock(queue.mutex);
+    if (!queue.affine_tasks.empty()) {
+      task = std::move(queue.affine_tasks.front());
+      queue.affine_tasks.pop_front();
+      --queue.affine_task_count;
+      return task;
+    }
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      --stealable_task_count_;
+      return task;
+    }
+  }
 
-    // Shutdown cannot be read with the task mutex unlocked.
-    bool shutdown_now = shutdown_;
-    fml::closure task;
-    std::vector<fml::closure> thread_tasks;
+  if (stealable_task_count_ == 0) {
+    return task;
+  }
 
-    if (tasks_.size() != 0) {
-      task = tasks_.front();
-      tasks_.pop();
+  for (size_t i = 1; i < worker_count_; ++i) {
+    WorkerQueue& victim = *worker_queues_[(worker_index + i) % worker_count_];
+    std::scoped_lock lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.back());
+      victim.tasks.pop_back();
+      --stealable_task_count_;
+      return task;
     }
+  }
+  return task;
+}
 
-    if (HasThreadTasksLocked()) {
-      thread_tasks = GetThreadTasksLocked();
-      FML_DCHECK(!HasThreadTasksLocked());
-    }
+bool ConcurrentMessageLoop::HasTasksForWorker(size_t worker_index) const {
+  return stealable_task_count_ > 0 ||
+         worker_queues_[worker_index]->affine_task_count > 0;
+}
 
-    // Don't hold onto the mutex while tasks are being executed as they could
-    // themselves try to post more tasks to the message loop.
-    lock.unlock();
+void ConcurrentMessageLoop::WakeWorkers(bool all) {
+  // The task counts are updated before the sleeping workers are counted, and
+  // a worker is counted as sleeping before it checks the task counts, so
+  // either the worker sees the new task or it is woken up here.
+  if (sleeping_worker_count_ == 0) {
+    return;
+  }
 
-    TRACE_EVENT0("flutter", "ConcurrentWorkerWake");
-    // Execute the primary task we woke up for.
-    if (task) {
-      task();
+  // Acquire the mutex so the notification can't fall between the check of
+  // the task counts by a worker and the start of its wait.
+  { std::scoped_lock lock(wake_mutex_); }
+
+  if (all) {
+    wake_condition_.notify_all();
+  } else {
+    wake_condition_.notify_one();
+  }
+}
+
+void ConcurrentMessageLoop::WorkerMain(size_t worker_index) {
+  while (true) {
+    bool shutdown_now = false;
+    {
+      std::unique_lock lock(wake_mutex_);
+      ++sleeping_worker_count_;
+      wake_condition_.wait(lock, [&]() {
+        return shutdown_ || HasTasksForWorker(worker_index);
+      });
+      --sleeping_worker_count_;
+      shutdown_now = shutdown_;
     }
 
-    // Execute any thread tasks.
-    for (const auto& thread_task : thread_tasks) {
-      thread_task();
+    TRACE_EVENT0("flutter", "ConcurrentWorkerWake");
+    // Run tasks until there are none left this worker can run. Tasks are run
+    // without holding any locks as they could themselves post more tasks to the
+    // message loop.
+    while (fml::closure task = TakeTask(worker_index)) {
+      task();
+      if (shutdown_) {
+        shutdown_now = true;
+        break;
+      }
     }
 
     if (shutdown_now) {
@@ -118,9 +196,9 @@ void ConcurrentMessageLoop::WorkerMain() {
 }
 
 void ConcurrentMessageLoop::Terminate() {
-  std::scoped_lock lock(tasks_mutex_);
+  std::scoped_lock lock(wake_mutex_);
   shutdown_ = true;
-  tasks_condition_.notify_all();
+  wake_condition_.notify_all();
 }
 
 void ConcurrentMessageLoop::PostTaskToAllWorkers(fml::closure task) {
@@ -128,24 +206,23 @@ void ConcurrentMessageLoop::PostTaskToAllWorkers(fml::closure task) {
     return;
   }
 
-  std::scoped_lock lock(tasks_mutex_);
-  for (const auto& worker_thread_id : worker_thread_ids_) {
-    thread_tasks_[worker_thread_id].emplace_back(task);
+  for (size_t i = 0; i < worker_count_; ++i) {
+    EnqueueTask(i, task, true);
   }
-  tasks_condition_.notify_all();
+  WakeWorkers(true);
 }
 
-bool ConcurrentMessageLoop::HasThreadTasksLocked() const {
-  return thread_tasks_.count(std::this_thread::get_id()) > 0;
-}
+void ConcurrentMessageLoop::PostTaskToWorker(size_t worker_index,
+                                             fml::closure task) {
+  FML_DCHECK(worker_index < worker_count_);
+  if (!task) {
+    return;
+  }
 
-std::vector<fml::closure> ConcurrentMessageLoop::GetThreadTasksLocked() {
-  auto found = thread_tasks_.find(std::this_thread::get_id());
-  FML_DCHECK(found != thread_tasks_.end());
-  std::vector<fml::closure> pending_tasks;
-  std::swap(pending_tasks, found->second);
-  thread_tasks_.erase(found);
-  return pending_tasks;
+  EnqueueTask(worker_index, std::move(task), true);
+  // Only the target worker can run the task, and there is no telling which
+  // worker a single notification wakes.
+  WakeWorkers(true);
 }
 
 ConcurrentTaskRunner::ConcurrentTaskRunner(
@@ -170,4 +247,56 @@ void ConcurrentTaskRunner::PostTask(const fml::closure& task) {
   task();
 }
 
+namespace {
+
+// The state of a |ConcurrentTaskRunner::ParallelFor| call, shared with the
+// helper tasks, which may only start after the call has returned.
+struct ParallelForState {
+  ParallelForState(size_t count, const std::function<void(size_t)>& body)
+      : count(count), body(body), latch(count) {}
+
+  // Runs the remaining invocations until there are none left.
+  void Run() {
+    size_t index;
+    while ((index = next_index.fetch_add(1)) < count) {
+      body(index);
+      latch.CountDown();
+    }
+  }
+
+  const size_t count;
+  const std::function<void(size_t)> body;
+  std::atomic_size_t next_index = 0;
+  fml::CountDownLatch latch;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ParallelForState);
+};
+
+}  // namespace
+
+void ConcurrentTaskRunner::ParallelFor(
+    size_t count,
+    const std::function<void(size_t)>& body) {
+  if (count == 0 || !body) {
+    return;
+  }
+
+  auto loop = weak_loop_.lock();
+  const size_t helper_count =
+      loop ? std::min(count, loop->GetWorkerCount()) - 1 : 0;
+  if (helper_count == 0) {
+    for (size_t i = 0; i < count; ++i) {
+      body(i);
+    }
+    return;
+  }
+
+  auto state = std::make_shared<ParallelForState>(count, body);
+  for (size_t i = 0; i < helper_count; ++i) {
+    loop->PostTask([state]() { state->Run(); });
+  }
+  state->Run();
+  state->latch.Wait();
+}
+
 }  // namespace fml
@@ -5,10 +5,14 @@
 #ifndef FLUTTER_FML_CONCURRENT_MESSAGE_LOOP_H_
 #define FLUTTER_FML_CONCURRENT_MESSAGE_LOOP_H_
 
+#include <atomic>
 #include <condition_variable>
-#include <map>
-#include <queue>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include "flutter/fml/closure.h"
 #include "flutter/fml/macros.h"
@@ -17,6 +21,14 @@ namespace fml {
 
 class ConcurrentTaskRunner;
 
+// A pool of worker threads that run the tasks posted to it in no particular
+// order.
+//
+// Each worker has its own queue of tasks. Tasks posted from a worker go to the
+// queue of that worker, and tasks posted from other threads are distributed
+// among the workers in turn. A worker runs the tasks of its own queue first,
+// oldest first, and steals the newest tasks of the other workers when its own
+// queue is empty. Workers only sleep when there are no tasks left to steal.
 class ConcurrentMessageLoop
     : public std::enable_shared_from_this<ConcurrentMessageLoop> {
  public:
@@ -33,27 +45,58 @@ class ConcurrentMessageLoop
 
   void PostTaskToAllWorkers(fml::closure task);
 
+  // Posts a task that runs on the worker with the given index, which must be
+  // less than |GetWorkerCount|. The task is never stolen by other workers.
+  void PostTaskToWorker(size_t worker_index, fml::closure task);
+
  private:
   friend ConcurrentTaskRunner;
 
+  struct WorkerQueue {
+    std::mutex mutex;
+    // The tasks that may run on any worker. The owning worker takes tasks from
+    // the front, and other workers steal them from the back.
+    std::deque<fml::closure> tasks;
+    // The tasks that may only run on the owning worker.
+    std::deque<fml::closure> affine_tasks;
+    // The size of |affine_tasks|, readable without holding |mutex|.
+    std::atomic_size_t affine_task_count = 0;
+  };
+
   size_t worker_count_ = 0;
   std::vector<std::thread> workers_;
-  std::mutex tasks_mutex_;
-  std::condition_variable tasks_condition_;
-  std::queue<fml::closure> tasks_;
   std::vector<std::thread::id> worker_thread_ids_;
-  std::map<std::thread::id, std::vector<fml::closure>> thread_tasks_;
-  bool shutdown_ = false;
+  std::vector<std::unique_ptr<WorkerQueue>> worker_queues_;
+  // The worker that the next task posted from outside the loop is queued on.
+  std::atomic_size_t next_worker_ = 0;
+  // The total number of tasks in |WorkerQueue::tasks| of all workers.
+  std::atomic_size_t stealable_task_count_ = 0;
+  // The number of workers waiting on |wake_condition_|.
+  std::atomic_size_t sleeping_worker_count_ = 0;
+  std::mutex wake_mutex_;
+  std::condition_variable wake_condition_;
+  // Only written with |wake_mutex_| held.
+  std::atomic_bool shutdown_ = false;
 
   ConcurrentMessageLoop(size_t worker_count);
 
-  void WorkerMain();
+  void WorkerMain(size_t worker_index);
 
   void PostTask(const fml::closure& task);
 
-  bool HasThreadTasksLocked() const;
+  // Returns the index of the worker running on the current thread, or
+  // |worker_count_| if the current thread is not a worker of this loop.
+  size_t GetCurrentWorkerIndex() const;
+
+  void EnqueueTask(size_t worker_index, fml::closure task, bool affine);
 
-  std::vector<fml::closure> GetThreadTasksLocked();
+  // Takes the next task the given worker may run, or returns an empty closure
+  // if there is none.
+  fml::closure TakeTask(size_t worker_index);
+
+  bool HasTasksForWorker(size_t worker_index) const;
+
+  void WakeWorkers(bool all);
 
   FML_DISALLOW_COPY_AND_ASSIGN(ConcurrentMessageLoop);
 };
@@ -66,6 +109,13 @@ class ConcurrentTaskRunner {
 
   void PostTask(const fml::closure& task);
 
+  // Invokes |body| once for every index in [0, |count|) and returns when all
+  // the invocations are done. The invocations are spread over the workers of
+  // the loop and the calling thread, so |body| must be safe to call
+  // concurrently. The calling thread takes part in the work, so this may also
+  // be called from a worker of the loop.
+  void ParallelFor(size_t count, const std::function<void(size_t)>& body);
+
  private:
   friend ConcurrentMessageLoop;
 
@@ -6,21 +6,30 @@
 
 #include "flutter/fml/delayed_task.h"
 
+#include <algorithm>
+#include <functional>
+
 namespace fml {
 
 DelayedTask::DelayedTask(size_t order,
-                         const fml::closure& task,
+                         fml::Task task,
                          fml::TimePoint target_time)
-    : order_(order), task_(task), target_time_(target_time) {}
+    : order_(order), task_(std::move(task)), target_time_(target_time) {}
+
+DelayedTask::DelayedTask(DelayedTask&& other) = default;
 
-DelayedTask::DelayedTask(const DelayedTask& other) = default;
+DelayedTask& DelayedTask::operator=(DelayedTask&& other) = default;
 
 DelayedTask::~DelayedTask() = default;
 
-const fml::closure& DelayedTask::GetTask() const {
+const fml::Task& DelayedTask::GetTask() const {
   return task_;
 }
 
+fml::Task DelayedTask::TakeTask() {
+  return std::move(task_);
+}
+
 fml::TimePoint DelayedTask::GetTargetTime() const {
   return target_time_;
 }
@@ -32,4 +41,25 @@ bool DelayedTask::operator>(const DelayedTask& other) const {
   return target_time_ > other.target_time_;
 }
 
+DelayedTaskQueue::DelayedTaskQueue() = default;
+
+DelayedTaskQueue::DelayedTaskQueue(DelayedTaskQueue&& other) = default;
+
+DelayedTaskQueue& DelayedTaskQueue::operator=(DelayedTaskQueue&& other) =
+    default;
+
+DelayedTaskQueue::~DelayedTaskQueue() = default;
+
+void DelayedTaskQueue::push(DelayedTask task) {
+  tasks_.emplace_back(std::move(task));
+  std::push_heap(tasks_.begin(), tasks_.end(), std::greater<DelayedTask>());
+}
+
+DelayedTask DelayedTaskQueue::pop() {
+  std::pop_heap(tasks_.begin(), tasks_.end(), std::greater<DelayedTask>());
+  DelayedTask task = std::move(tasks_.back());
+  tasks_.pop_back();
+  return task;
+}
+
 }  // namespace fml
@@ -5,24 +5,26 @@
 #ifndef FLUTTER_FML_DELAYED_TASK_H_
 #define FLUTTER_FML_DELAYED_TASK_H_
 
-#include "flutter/fml/closure.h"
-#include "flutter/fml/time/time_point.h"
+#include <vector>
 
-#include <queue>
+#include "flutter/fml/task.h"
+#include "flutter/fml/time/time_point.h"
 
 namespace fml {
 
 class DelayedTask {
  public:
-  DelayedTask(size_t order,
-              const fml::closure& task,
-              fml::TimePoint target_time);
+  DelayedTask(size_t order, fml::Task task, fml::TimePoint target_time);
+
+  DelayedTask(DelayedTask&& other);
 
-  DelayedTask(const DelayedTask& other);
+  DelayedTask& operator=(DelayedTask&& other);
 
   ~DelayedTask();
 
-  const fml::closure& GetTask() const;
+  const fml::Task& GetTask() const;
+
+  fml::Task TakeTask();
 
   fml::TimePoint GetTargetTime() const;
 
@@ -30,13 +32,41 @@ class DelayedTask {
 
  private:
   size_t order_;
-  fml::closure task_;
+  fml::Task task_;
   fml::TimePoint target_time_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DelayedTask);
 };
 
-using DelayedTaskQueue = std::priority_queue<DelayedTask,
-                                             std::deque<DelayedTask>,
-                                             std::greater<DelayedTask>>;
+// A min-heap of delayed tasks ordered by target time, and then by the order
+// they were posted in. The tasks are moved in and out of the heap, never
+// copied.
+class DelayedTaskQueue {
+ public:
+  DelayedTaskQueue();
+
+  DelayedTaskQueue(DelayedTaskQueue&& other);
+
+  DelayedTaskQueue& operator=(DelayedTaskQueue&& other);
+
+  ~DelayedTaskQueue();
+
+  bool empty() const { return tasks_.empty(); }
+
+  size_t size() const { return tasks_.size(); }
+
+  const DelayedTask& top() const { return tasks_.front(); }
+
+  void push(DelayedTask task);
+
+  // Removes the top task from the heap and returns it.
+  DelayedTask pop();
+
+ private:
+  std::vector<DelayedTask> tasks_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DelayedTaskQueue);
+};
 
 }  // namespace fml
 
@@ -7,6 +7,7 @@
 
 #include <functional>
 #include <initializer_list>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -72,6 +73,13 @@ bool IsFile(const std::string& path);
 
 bool TruncateFile(const fml::UniqueFD& file, size_t size);
 
+/// Reads up to |length| bytes of |file| starting at |offset|. Fewer bytes are
+/// returned if the file ends first. Returns nullptr if |offset| is past the
+/// end of the file or if the file could not be read.
+std::unique_ptr<Mapping> ReadFileRange(const fml::UniqueFD& file,
+                                       size_t offset,
+                                       size_t length);
+
 bool FileExists(const fml::UniqueFD& base_directory, const char* path);
 
 bool UnlinkDirectory(const char* path);
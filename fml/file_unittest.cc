@@ -269,6 +269,59 @@ TEST(FileTest, EmptyMappingTest) {
   ASSERT_TRUE(fml::UnlinkFile(dir.fd(), "my_contents"));
 }
 
+TEST(FileTest, CanReadFileRanges) {
+  fml::ScopedTemporaryDirectory dir;
+
+  {
+    auto file = fml::OpenFile(dir.fd(), "my_contents", true,
+                              fml::FilePermission::kReadWrite);
+    ASSERT_TRUE(WriteStringToFile(file, "abcdef"));
+
+    auto read_range = [&file](size_t offset, size_t length) {
+      auto mapping = fml::ReadFileRange(file, offset, length);
+      if (!mapping) {
+        return std::string("<null>");
+      }
+      return std::string(reinterpret_cast<const char*>(mapping->GetMapping()),
+                         mapping->GetSize());
+    };
+
+    ASSERT_EQ(read_range(0, 6), "abcdef");
+    ASSERT_EQ(read_range(2, 3), "cde");
+    ASSERT_EQ(read_range(4, 10), "ef");
+    ASSERT_EQ(read_range(6, 1), "");
+    ASSERT_EQ(read_range(7, 1), "<null>");
+  }
+
+  ASSERT_TRUE(fml::UnlinkFile(dir.fd(), "my_contents"));
+}
+
+TEST(FileTest, OnlyOwnedMappingsAreMutable) {
+  fml::ScopedTemporaryDirectory dir;
+
+  {
+    auto file = fml::OpenFile(dir.fd(), "my_contents", true,
+                              fml::FilePermission::kReadWrite);
+    ASSERT_TRUE(WriteStringToFile(file, "abcdef"));
+
+    // The pages of file mappings are shared with the file.
+    fml::FileMapping read_only_mapping(file);
+    ASSERT_EQ(read_only_mapping.GetOwnedMutableMapping(), nullptr);
+    fml::FileMapping writable_mapping(file,
+                                      {fml::FileMapping::Protection::kWrite});
+    ASSERT_EQ(writable_mapping.GetOwnedMutableMapping(), nullptr);
+  }
+
+  ASSERT_TRUE(fml::UnlinkFile(dir.fd(), "my_contents"));
+
+  fml::DataMapping data_mapping(std::vector<uint8_t>{1, 2, 3});
+  ASSERT_EQ(data_mapping.GetOwnedMutableMapping(), data_mapping.GetMapping());
+
+  const uint8_t bytes[] = {1, 2, 3};
+  fml::NonOwnedMapping non_owned_mapping(bytes, sizeof(bytes));
+  ASSERT_EQ(non_owned_mapping.GetOwnedMutableMapping(), nullptr);
+}
+
 TEST(FileTest, FileTestsWork) {
   fml::ScopedTemporaryDirectory dir;
   ASSERT_TRUE(dir.fd().is_valid());
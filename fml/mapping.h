@@ -28,6 +28,11 @@ class Mapping {
 
   virtual const uint8_t* GetMapping() const = 0;
 
+  // Returns the bytes of the mapping if the mapping alone owns them and they
+  // may be written to, or null otherwise. Such bytes can be handed out as
+  // writable without a copy, for as long as the mapping is alive.
+  virtual uint8_t* GetOwnedMutableMapping();
+
  private:
   FML_DISALLOW_COPY_AND_ASSIGN(Mapping);
 };
@@ -96,6 +101,9 @@ class DataMapping final : public Mapping {
   // |Mapping|
   const uint8_t* GetMapping() const override;
 
+  // |Mapping|
+  uint8_t* GetOwnedMutableMapping() override;
+
  private:
   std::vector<uint8_t> data_;
 
@@ -18,6 +18,7 @@
 #include "flutter/fml/memory/ref_counted.h"
 #include "flutter/fml/message_loop.h"
 #include "flutter/fml/message_loop_task_queues.h"
+#include "flutter/fml/task.h"
 #include "flutter/fml/time/time_point.h"
 #include "flutter/fml/wakeable.h"
 
@@ -34,7 +35,9 @@ class MessageLoopImpl : public Wakeable,
 
   virtual void Terminate() = 0;
 
-  void PostTask(const fml::closure& task, fml::TimePoint target_time);
+  void PostTask(fml::Task task,
+                fml::TimePoint target_time,
+                TaskPriority priority = TaskPriority::kNormal);
 
   void AddTaskObserver(intptr_t key, const fml::closure& callback);
 
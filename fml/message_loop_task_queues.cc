@@ -7,24 +7,104 @@
 #include "flutter/fml/message_loop_task_queues.h"
 #include "flutter/fml/make_copyable.h"
 #include "flutter/fml/message_loop_impl.h"
+#include "flutter/fml/trace_event.h"
 
+#include <algorithm>
 #include <iostream>
 
 namespace fml {
 
+namespace {
+
+// Returns the priority an expired task is scheduled with, see
+// |MessageLoopTaskQueues::GetTasksToRunNow|.
+size_t GetEffectivePriority(size_t priority,
+                            fml::TimePoint target_time,
+                            fml::TimePoint now) {
+  constexpr size_t kMaxPromotedPriority =
+      static_cast<size_t>(TaskPriority::kInput);
+  if (priority <= kMaxPromotedPriority) {
+    return priority;
+  }
+  const int64_t promotions =
+      (now - target_time).ToNanoseconds() /
+      MessageLoopTaskQueues::kTaskAgingInterval.ToNanoseconds();
+  if (promotions >= static_cast<int64_t>(priority - kMaxPromotedPriority)) {
+    return kMaxPromotedPriority;
+  }
+  return priority - promotions;
+}
+
+}  // namespace
+
 std::mutex MessageLoopTaskQueues::creation_mutex_;
 
 const size_t TaskQueueId::kUnmerged = ULONG_MAX;
 
+const fml::TimeDelta MessageLoopTaskQueues::kTaskAgingInterval =
+    fml::TimeDelta::FromMilliseconds(100);
+
 fml::RefPtr<MessageLoopTaskQueues> MessageLoopTaskQueues::instance_;
 
 TaskQueueEntry::TaskQueueEntry()
     : owner_of(_kUnmerged), subsumed_by(_kUnmerged) {
   wakeable = NULL;
   task_observers = TaskObservers();
-  delayed_tasks = DelayedTaskQueue();
 }
 
+bool TaskQueueEntry::HasDelayedTasks() const {
+  for (const auto& tasks : delayed_tasks) {
+    if (!tasks.empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t TaskQueueEntry::GetNumDelayedTasks() const {
+  size_t count = 0;
+  for (const auto& tasks : delayed_tasks) {
+    count += tasks.size();
+  }
+  return count;
+}
+
+fml::TimePoint TaskQueueEntry::GetNextTargetTime() const {
+  fml::TimePoint next = fml::TimePoint::Max();
+  for (const auto& tasks : delayed_tasks) {
+    if (!tasks.empty() && tasks.top().GetTargetTime() < next) {
+      next = tasks.top().GetTargetTime();
+    }
+  }
+  return next;
+}
+
+// Locks the tasks of a queue, along with the tasks of the queue it owns if it
+// has been merged. The entries must stay locked (shared or exclusively) for the
+// lifetime of this object so that the merge state cannot change.
+class MessageLoopTaskQueues::MergedEntriesLock {
+ public:
+  MergedEntriesLock(const MessageLoopTaskQueues& queues, TaskQueueId queue_id) {
+    const auto& entry = queues.queue_entries_.at(queue_id);
+    owner_lock_ =
+        std::unique_lock<std::mutex>(entry->tasks_mutex, std::defer_lock);
+    if (entry->owner_of == _kUnmerged) {
+      owner_lock_.lock();
+      return;
+    }
+    subsumed_lock_ = std::unique_lock<std::mutex>(
+        queues.queue_entries_.at(entry->owner_of)->tasks_mutex,
+        std::defer_lock);
+    std::lock(owner_lock_, subsumed_lock_);
+  }
+
+ private:
+  std::unique_lock<std::mutex> owner_lock_;
+  std::unique_lock<std::mutex> subsumed_lock_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(MergedEntriesLock);
+};
+
 fml::RefPtr<MessageLoopTaskQueues> MessageLoopTaskQueues::GetInstance() {
   std::scoped_lock creation(creation_mutex_);
   if (!instance_) {
@@ -34,7 +114,7 @@ fml::RefPtr<MessageLoopTaskQueues> MessageLoopTaskQueues::GetInstance() {
 }
 
 TaskQueueId MessageLoopTaskQueues::CreateTaskQueue() {
-  std::lock_guard guard(queue_mutex_);
+  UniqueLock entries_lock(*entries_mutex_);
   TaskQueueId loop_id = TaskQueueId(task_queue_id_counter_);
   ++task_queue_id_counter_;
   queue_entries_[loop_id] = std::make_unique<TaskQueueEntry>();
@@ -42,12 +122,14 @@ TaskQueueId MessageLoopTaskQueues::CreateTaskQueue() {
 }
 
 MessageLoopTaskQueues::MessageLoopTaskQueues()
-    : task_queue_id_counter_(0), order_(0) {}
+    : entries_mutex_(fml::SharedMutex::Create()),
+      task_queue_id_counter_(0),
+      order_(0) {}
 
 MessageLoopTaskQueues::~MessageLoopTaskQueues() = default;
 
 void MessageLoopTaskQueues::Dispose(TaskQueueId queue_id) {
-  std::lock_guard guard(queue_mutex_);
+  UniqueLock entries_lock(*entries_mutex_);
   const auto& queue_entry = queue_entries_.at(queue_id);
   FML_DCHECK(queue_entry->subsumed_by == _kUnmerged);
   TaskQueueId subsumed = queue_entry->owner_of;
@@ -58,7 +140,7 @@ void MessageLoopTaskQueues::Dispose(TaskQueueId queue_id) {
 }
 
 void MessageLoopTaskQueues::DisposeTasks(TaskQueueId queue_id) {
-  std::lock_guard guard(queue_mutex_);
+  UniqueLock entries_lock(*entries_mutex_);
   const auto& queue_entry = queue_entries_.at(queue_id);
   FML_DCHECK(queue_entry->subsumed_by == _kUnmerged);
   TaskQueueId subsumed = queue_entry->owner_of;
@@ -69,44 +151,54 @@ void MessageLoopTaskQueues::DisposeTasks(TaskQueueId queue_id) {
 }
 
 void MessageLoopTaskQueues::RegisterTask(TaskQueueId queue_id,
-                                         const fml::closure& task,
-                                         fml::TimePoint target_time) {
-  std::lock_guard guard(queue_mutex_);
+                                         fml::Task task,
+                                         fml::TimePoint target_time,
+                                         TaskPriority priority) {
+  SharedLock entries_lock(*entries_mutex_);
   size_t order = order_++;
   const auto& queue_entry = queue_entries_.at(queue_id);
-  queue_entry->delayed_tasks.push({order, task, target_time});
   TaskQueueId loop_to_wake = queue_id;
   if (queue_entry->subsumed_by != _kUnmerged) {
     loop_to_wake = queue_entry->subsumed_by;
   }
-  WakeUpUnlocked(loop_to_wake,
-                 queue_entry->delayed_tasks.top().GetTargetTime());
+  // The loop to wake runs the tasks of both merged queues, so both are locked
+  // to compute its wake time.
+  MergedEntriesLock tasks_lock(*this, loop_to_wake);
+  queue_entry->delayed_tasks[static_cast<size_t>(priority)].push(
+      {order, std::move(task), target_time});
+  WakeUpUnlocked(loop_to_wake, GetNextWakeTimeUnlocked(loop_to_wake));
 }
 
 bool MessageLoopTaskQueues::HasPendingTasks(TaskQueueId queue_id) const {
-  std::lock_guard guard(queue_mutex_);
+  SharedLock entries_lock(*entries_mutex_);
+  MergedEntriesLock tasks_lock(*this, queue_id);
   return HasPendingTasksUnlocked(queue_id);
 }
 
 void MessageLoopTaskQueues::GetTasksToRunNow(
     TaskQueueId queue_id,
     FlushType type,
-    std::vector<fml::closure>& invocations) {
-  std::lock_guard guard(queue_mutex_);
+    std::vector<fml::Task>& invocations) {
+  SharedLock entries_lock(*entries_mutex_);
+  MergedEntriesLock tasks_lock(*this, queue_id);
   if (!HasPendingTasksUnlocked(queue_id)) {
     return;
   }
 
   const auto now = fml::TimePoint::Now();
 
+  TracePendingTasksUnlocked(queue_id);
+
   while (HasPendingTasksUnlocked(queue_id)) {
     TaskQueueId top_queue = _kUnmerged;
-    const auto& top = PeekNextTaskUnlocked(queue_id, top_queue);
-    if (top.GetTargetTime() > now) {
+    size_t top_priority = 0;
+    const DelayedTask* top =
+        PeekNextTaskUnlocked(queue_id, now, top_queue, top_priority);
+    if (top == nullptr) {
       break;
     }
-    invocations.emplace_back(top.GetTask());
-    queue_entries_.at(top_queue)->delayed_tasks.pop();
+    auto& tasks = queue_entries_.at(top_queue)->delayed_tasks[top_priority];
+    invocations.emplace_back(tasks.pop().TakeTask());
     if (type == FlushType::kSingle) {
       break;
     }
@@ -127,19 +219,20 @@ void MessageLoopTaskQueues::WakeUpUnlocked(TaskQueueId queue_id,
 }
 
 size_t MessageLoopTaskQueues::GetNumPendingTasks(TaskQueueId queue_id) const {
-  std::lock_guard guard(queue_mutex_);
+  SharedLock entries_lock(*entries_mutex_);
+  MergedEntriesLock tasks_lock(*this, queue_id);
   const auto& queue_entry = queue_entries_.at(queue_id);
   if (queue_entry->subsumed_by != _kUnmerged) {
     return 0;
   }
 
   size_t total_tasks = 0;
-  total_tasks += queue_entry->delayed_tasks.size();
+  total_tasks += queue_entry->GetNumDelayedTasks();
 
   TaskQueueId subsumed = queue_entry->owner_of;
   if (subsumed != _kUnmerged) {
     const auto& subsumed_entry = queue_entries_.at(subsumed);
-    total_tasks += subsumed_entry->delayed_tasks.size();
+    total_tasks += subsumed_entry->GetNumDelayedTasks();
   }
   return total_tasks;
 }
@@ -147,20 +240,25 @@ size_t MessageLoopTaskQueues::GetNumPendingTasks(TaskQueueId queue_id) const {
 void MessageLoopTaskQueues::AddTaskObserver(TaskQueueId queue_id,
                                             intptr_t key,
                                             const fml::closure& callback) {
-  std::lock_guard guard(queue_mutex_);
+  SharedLock entries_lock(*entries_mutex_);
   FML_DCHECK(callback != nullptr) << "Observer callback must be non-null.";
-  queue_entries_.at(queue_id)->task_observers[key] = callback;
+  const auto& queue_entry = queue_entries_.at(queue_id);
+  std::lock_guard tasks_lock(queue_entry->tasks_mutex);
+  queue_entry->task_observers[key] = callback;
 }
 
 void MessageLoopTaskQueues::RemoveTaskObserver(TaskQueueId queue_id,
                                                intptr_t key) {
-  std::lock_guard guard(queue_mutex_);
-  queue_entries_.at(queue_id)->task_observers.erase(key);
+  SharedLock entries_lock(*entries_mutex_);
+  const auto& queue_entry = queue_entries_.at(queue_id);
+  std::lock_guard tasks_lock(queue_entry->tasks_mutex);
+  queue_entry->task_observers.erase(key);
 }
 
 std::vector<fml::closure> MessageLoopTaskQueues::GetObserversToNotify(
     TaskQueueId queue_id) const {
-  std::lock_guard guard(queue_mutex_);
+  SharedLock entries_lock(*entries_mutex_);
+  MergedEntriesLock tasks_lock(*this, queue_id);
   std::vector<fml::closure> observers;
 
   if (queue_entries_.at(queue_id)->subsumed_by != _kUnmerged) {
@@ -183,7 +281,7 @@ std::vector<fml::closure> MessageLoopTaskQueues::GetObserversToNotify(
 
 void MessageLoopTaskQueues::SetWakeable(TaskQueueId queue_id,
                                         fml::Wakeable* wakeable) {
-  std::lock_guard guard(queue_mutex_);
+  UniqueLock entries_lock(*entries_mutex_);
   FML_CHECK(!queue_entries_.at(queue_id)->wakeable)
       << "Wakeable can only be set once.";
   queue_entries_.at(queue_id)->wakeable = wakeable;
@@ -193,7 +291,7 @@ bool MessageLoopTaskQueues::Merge(TaskQueueId owner, TaskQueueId subsumed) {
   if (owner == subsumed) {
     return true;
   }
-  std::lock_guard guard(queue_mutex_);
+  UniqueLock entries_lock(*entries_mutex_);
   auto& owner_entry = queue_entries_.at(owner);
   auto& subsumed_entry = queue_entries_.at(subsumed);
 
@@ -222,7 +320,7 @@ bool MessageLoopTaskQueues::Merge(TaskQueueId owner, TaskQueueId subsumed) {
 }
 
 bool MessageLoopTaskQueues::Unmerge(TaskQueueId owner) {
-  std::lock_guard guard(queue_mutex_);
+  UniqueLock entries_lock(*entries_mutex_);
   const auto& owner_entry = queue_entries_.at(owner);
   const TaskQueueId subsumed = owner_entry->owner_of;
   if (subsumed == _kUnmerged) {
@@ -245,7 +343,7 @@ bool MessageLoopTaskQueues::Unmerge(TaskQueueId owner) {
 
 bool MessageLoopTaskQueues::Owns(TaskQueueId owner,
                                  TaskQueueId subsumed) const {
-  std::lock_guard guard(queue_mutex_);
+  SharedLock entries_lock(*entries_mutex_);
   return subsumed == queue_entries_.at(owner)->owner_of || owner == subsumed;
 }
 
@@ -259,7 +357,7 @@ bool MessageLoopTaskQueues::HasPendingTasksUnlocked(
     return false;
   }
 
-  if (!entry->delayed_tasks.empty()) {
+  if (entry->HasDelayedTasks()) {
     return true;
   }
 
@@ -268,47 +366,84 @@ bool MessageLoopTaskQueues::HasPendingTasksUnlocked(
     // this is not an owner and queue is empty.
     return false;
   } else {
-    return !queue_entries_.at(subsumed)->delayed_tasks.empty();
+    return queue_entries_.at(subsumed)->HasDelayedTasks();
   }
 }
 
 fml::TimePoint MessageLoopTaskQueues::GetNextWakeTimeUnlocked(
     TaskQueueId queue_id) const {
-  TaskQueueId tmp = _kUnmerged;
-  return PeekNextTaskUnlocked(queue_id, tmp).GetTargetTime();
+  FML_DCHECK(HasPendingTasksUnlocked(queue_id));
+  const auto& entry = queue_entries_.at(queue_id);
+  fml::TimePoint next = entry->GetNextTargetTime();
+  const TaskQueueId subsumed = entry->owner_of;
+  if (subsumed != _kUnmerged) {
+    next = std::min(next, queue_entries_.at(subsumed)->GetNextTargetTime());
+  }
+  return next;
 }
 
-const DelayedTask& MessageLoopTaskQueues::PeekNextTaskUnlocked(
+const DelayedTask* MessageLoopTaskQueues::PeekNextTaskUnlocked(
     TaskQueueId owner,
-    TaskQueueId& top_queue_id) const {
+    fml::TimePoint now,
+    TaskQueueId& top_queue_id,
+    size_t& top_priority) const {
   FML_DCHECK(HasPendingTasksUnlocked(owner));
-  const auto& entry = queue_entries_.at(owner);
-  const TaskQueueId subsumed = entry->owner_of;
-  if (subsumed == _kUnmerged) {
-    top_queue_id = owner;
-    return entry->delayed_tasks.top();
-  }
-
-  const auto& owner_tasks = entry->delayed_tasks;
-  const auto& subsumed_tasks = queue_entries_.at(subsumed)->delayed_tasks;
-
-  // we are owning another task queue
-  const bool subsumed_has_task = !subsumed_tasks.empty();
-  const bool owner_has_task = !owner_tasks.empty();
-  if (owner_has_task && subsumed_has_task) {
-    const auto owner_task = owner_tasks.top();
-    const auto subsumed_task = subsumed_tasks.top();
-    if (owner_task > subsumed_task) {
-      top_queue_id = subsumed;
-    } else {
-      top_queue_id = owner;
+  // When this queue owns another one, the tasks of both queues are considered.
+  const TaskQueueId queue_ids[] = {owner, queue_entries_.at(owner)->owner_of};
+
+  const DelayedTask* top = nullptr;
+  size_t top_effective_priority = kTaskPriorityCount;
+  for (const TaskQueueId queue_id : queue_ids) {
+    if (queue_id == _kUnmerged) {
+      continue;
+    }
+    const auto& entry = queue_entries_.at(queue_id);
+    for (size_t priority = 0; priority < kTaskPriorityCount; priority++) {
+      const auto& tasks = entry->delayed_tasks[priority];
+      // Each queue is ordered by target time, so its top is also the task that
+      // has been waiting the longest.
+      if (tasks.empty() || tasks.top().GetTargetTime() > now) {
+        continue;
+      }
+      const DelayedTask& task = tasks.top();
+      const size_t effective_priority =
+          GetEffectivePriority(priority, task.GetTargetTime(), now);
+      if (top == nullptr || effective_priority < top_effective_priority ||
+          (effective_priority == top_effective_priority && *top > task)) {
+        top = &task;
+        top_effective_priority = effective_priority;
+        top_queue_id = queue_id;
+        top_priority = priority;
+      }
+    }
+  }
+  return top;
+}
+
+void MessageLoopTaskQueues::TracePendingTasksUnlocked(
+    TaskQueueId queue_id) const {
+#if !FLUTTER_RELEASE
+  std::array<size_t, kTaskPriorityCount> pending = {};
+  const TaskQueueId queue_ids[] = {queue_id,
+                                   queue_entries_.at(queue_id)->owner_of};
+  for (const TaskQueueId id : queue_ids) {
+    if (id == _kUnmerged) {
+      continue;
+    }
+    const auto& entry = queue_entries_.at(id);
+    for (size_t priority = 0; priority < kTaskPriorityCount; priority++) {
+      pending[priority] += entry->delayed_tasks[priority].size();
     }
-  } else if (owner_has_task) {
-    top_queue_id = owner;
-  } else {
-    top_queue_id = subsumed;
   }
-  return queue_entries_.at(top_queue_id)->delayed_tasks.top();
+
+  FML_TRACE_COUNTER(
+      "fml", "TaskQueuePendingTasks", static_cast<int64_t>(queue_id),  //
+      "Frame", pending[static_cast<size_t>(TaskPriority::kFrame)],     //
+      "Input", pending[static_cast<size_t>(TaskPriority::kInput)],     //
+      "Normal", pending[static_cast<size_t>(TaskPriority::kNormal)],   //
+      "Idle", pending[static_cast<size_t>(TaskPriority::kIdle)]        //
+  );
+#endif  // !FLUTTER_RELEASE
 }
 
 }  // namespace fml
@@ -5,7 +5,9 @@
 #ifndef FLUTTER_FML_MESSAGE_LOOP_TASK_QUEUES_H_
 #define FLUTTER_FML_MESSAGE_LOOP_TASK_QUEUES_H_
 
+#include <array>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -14,6 +16,8 @@
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/ref_counted.h"
 #include "flutter/fml/synchronization/shared_mutex.h"
+#include "flutter/fml/task.h"
+#include "flutter/fml/task_priority.h"
 #include "flutter/fml/wakeable.h"
 
 namespace fml {
@@ -39,7 +43,8 @@ class TaskQueueEntry {
   using TaskObservers = std::map<intptr_t, fml::closure>;
   Wakeable* wakeable;
   TaskObservers task_observers;
-  DelayedTaskQueue delayed_tasks;
+  // The pending tasks of each |TaskPriority|, indexed by priority.
+  std::array<DelayedTaskQueue, kTaskPriorityCount> delayed_tasks;
 
   // Note: Both of these can be _kUnmerged, which indicates that
   // this queue has not been merged or subsumed. OR exactly one
@@ -48,8 +53,20 @@ class TaskQueueEntry {
   TaskQueueId owner_of;
   TaskQueueId subsumed_by;
 
+  // Guards the tasks and the task observers. The wakeable and the merge state
+  // are only modified while the entries of all queues are locked exclusively.
+  std::mutex tasks_mutex;
+
   TaskQueueEntry();
 
+  bool HasDelayedTasks() const;
+
+  size_t GetNumDelayedTasks() const;
+
+  // The earliest target time of the pending tasks, or |TimePoint::Max| if
+  // there are none.
+  fml::TimePoint GetNextTargetTime() const;
+
  private:
   FML_DISALLOW_COPY_ASSIGN_AND_MOVE(TaskQueueEntry);
 };
@@ -62,6 +79,10 @@ enum class FlushType {
 // This class keeps track of all the tasks and observers that
 // need to be run on it's MessageLoopImpl. This also wakes up the
 // loop at the required times.
+//
+// Each queue has its own lock, so threads posting to or running tasks of
+// different queues do not contend with each other. Creating, disposing,
+// merging and unmerging queues lock all the queues exclusively.
 class MessageLoopTaskQueues
     : public fml::RefCountedThreadSafe<MessageLoopTaskQueues> {
  public:
@@ -78,14 +99,21 @@ class MessageLoopTaskQueues
   // Tasks methods.
 
   void RegisterTask(TaskQueueId queue_id,
-                    const fml::closure& task,
-                    fml::TimePoint target_time);
+                    fml::Task task,
+                    fml::TimePoint target_time,
+                    TaskPriority priority = TaskPriority::kNormal);
 
   bool HasPendingTasks(TaskQueueId queue_id) const;
 
+  // Collects the tasks whose target time has expired, highest priority first.
+  //
+  // Tasks other than frame tasks are promoted one priority for every
+  // |kTaskAgingInterval| they have been waiting past their target time, up to
+  // the priority of input tasks. This way a steady stream of high priority
+  // tasks cannot starve the others, while frame tasks always run first.
   void GetTasksToRunNow(TaskQueueId queue_id,
                         FlushType type,
-                        std::vector<fml::closure>& invocations);
+                        std::vector<fml::Task>& invocations);
 
   size_t GetNumPendingTasks(TaskQueueId queue_id) const;
 
@@ -124,8 +152,11 @@ class MessageLoopTaskQueues
   // Returns true if owner owns the subsumed task queue.
   bool Owns(TaskQueueId owner, TaskQueueId subsumed) const;
 
+  static const fml::TimeDelta kTaskAgingInterval;
+
  private:
   class MergedQueuesRunner;
+  class MergedEntriesLock;
 
   MessageLoopTaskQueues();
 
@@ -135,15 +166,23 @@ class MessageLoopTaskQueues
 
   bool HasPendingTasksUnlocked(TaskQueueId queue_id) const;
 
-  const DelayedTask& PeekNextTaskUnlocked(TaskQueueId owner,
-                                          TaskQueueId& top_queue_id) const;
+  // Returns the task that should run next at |now|, or nullptr if the target
+  // time of all the pending tasks is later than |now|.
+  const DelayedTask* PeekNextTaskUnlocked(TaskQueueId owner,
+                                          fml::TimePoint now,
+                                          TaskQueueId& top_queue_id,
+                                          size_t& top_priority) const;
 
   fml::TimePoint GetNextWakeTimeUnlocked(TaskQueueId queue_id) const;
 
+  void TracePendingTasksUnlocked(TaskQueueId queue_id) const;
+
   static std::mutex creation_mutex_;
   static fml::RefPtr<MessageLoopTaskQueues> instance_;
 
-  mutable std::mutex queue_mutex_;
+  // Guards |queue_entries_| and the merge state of the entries. It is only
+  // locked exclusively to add, remove, merge or unmerge queues.
+  std::unique_ptr<fml::SharedMutex> entries_mutex_;
   std::map<TaskQueueId, std::unique_ptr<TaskQueueEntry>> queue_entries_;
 
   size_t task_queue_id_counter_;
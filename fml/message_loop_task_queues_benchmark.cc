@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <atomic>
 #include <cassert>
 #include <string>
 #include <thread>
@@ -39,7 +40,7 @@ static void BM_RegisterAndGetTasks(benchmark::State& state) {
         }
         tasks_registered.CountDown();
         tasks_registered.Wait();
-        std::vector<fml::closure> invocations;
+        std::vector<fml::Task> invocations;
         task_queue->GetTasksToRunNow(TaskQueueId(task_runner_id),
                                      fml::FlushType::kAll, invocations);
         assert(invocations.size() == num_tasks_per_queue);
@@ -57,5 +58,107 @@ static void BM_RegisterAndGetTasks(benchmark::State& state) {
 
 BENCHMARK(BM_RegisterAndGetTasks);
 
+// Each producer thread posts to its own queue, like the platform, UI, raster
+// and IO threads of several engines do. These should not contend with each
+// other.
+static void BM_RegisterTasksOnSeparateQueues(benchmark::State& state) {
+  const int num_producers = state.range(0);
+  const int num_tasks_per_producer = 1000;
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  std::vector<TaskQueueId> queue_ids;
+  for (int i = 0; i < num_producers; i++) {
+    queue_ids.push_back(task_queue->CreateTaskQueue());
+  }
+  const fml::TimePoint past = fml::TimePoint::Now();
+
+  while (state.KeepRunning()) {
+    std::vector<std::thread> threads;
+    CountDownLatch tasks_done(num_producers);
+    for (int i = 0; i < num_producers; i++) {
+      threads.emplace_back([queue_id = queue_ids[i], &task_queue, past,
+                            &tasks_done]() {
+        std::vector<fml::Task> invocations;
+        for (int j = 0; j < num_tasks_per_producer; j++) {
+          task_queue->RegisterTask(
+              queue_id, [] {}, past);
+          // Drain regularly so the queues stay short.
+          if (j % 16 == 15) {
+            task_queue->GetTasksToRunNow(queue_id, fml::FlushType::kAll,
+                                         invocations);
+            invocations.clear();
+          }
+        }
+        task_queue->GetTasksToRunNow(queue_id, fml::FlushType::kAll,
+                                     invocations);
+        tasks_done.CountDown();
+      });
+    }
+    tasks_done.Wait();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  for (auto queue_id : queue_ids) {
+    task_queue->Dispose(queue_id);
+  }
+  state.SetItemsProcessed(state.iterations() * num_producers *
+                          num_tasks_per_producer);
+}
+
+// All producer threads post to a single queue that is drained by one
+// consumer, like platform messages or image decode callbacks on the UI thread.
+static void BM_RegisterTasksOnSharedQueue(benchmark::State& state) {
+  const int num_producers = state.range(0);
+  const int num_tasks_per_producer = 1000;
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  const auto queue_id = task_queue->CreateTaskQueue();
+  const fml::TimePoint past = fml::TimePoint::Now();
+
+  while (state.KeepRunning()) {
+    std::vector<std::thread> threads;
+    CountDownLatch tasks_done(num_producers);
+    for (int i = 0; i < num_producers; i++) {
+      threads.emplace_back([queue_id, &task_queue, past, &tasks_done]() {
+        for (int j = 0; j < num_tasks_per_producer; j++) {
+          task_queue->RegisterTask(
+              queue_id, [] {}, past);
+        }
+        tasks_done.CountDown();
+      });
+    }
+    std::atomic_bool producers_done = false;
+    std::thread consumer([queue_id, &task_queue, &producers_done]() {
+      std::vector<fml::Task> invocations;
+      while (!producers_done) {
+        task_queue->GetTasksToRunNow(queue_id, fml::FlushType::kAll,
+                                     invocations);
+        invocations.clear();
+      }
+      task_queue->GetTasksToRunNow(queue_id, fml::FlushType::kAll,
+                                   invocations);
+    });
+    tasks_done.Wait();
+    producers_done = true;
+    consumer.join();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  task_queue->Dispose(queue_id);
+  state.SetItemsProcessed(state.iterations() * num_producers *
+                          num_tasks_per_producer);
+}
+
+BENCHMARK(BM_RegisterTasksOnSeparateQueues)
+    ->RangeMultiplier(2)
+    ->Range(4, 64)
+    ->UseRealTime();
+BENCHMARK(BM_RegisterTasksOnSharedQueue)
+    ->RangeMultiplier(2)
+    ->Range(4, 64)
+    ->UseRealTime();
+
 }  // namespace benchmarking
 }  // namespace fml
@@ -127,7 +127,7 @@ TEST(MessageLoopTaskQueueMergeUnmerge, MergeInvokesBothWakeables) {
 
   task_queue->Merge(queue_id_1, queue_id_2);
 
-  std::vector<fml::closure> invocations;
+  std::vector<fml::Task> invocations;
   task_queue->GetTasksToRunNow(queue_id_1, fml::FlushType::kAll, invocations);
 
   latch.Wait();
@@ -157,7 +157,7 @@ TEST(MessageLoopTaskQueueMergeUnmerge,
   task_queue->Merge(queue_id_1, queue_id_2);
   task_queue->Unmerge(queue_id_1);
 
-  std::vector<fml::closure> invocations;
+  std::vector<fml::Task> invocations;
 
   task_queue->GetTasksToRunNow(queue_id_1, fml::FlushType::kAll, invocations);
   latch_1.Wait();
@@ -184,7 +184,7 @@ TEST(MessageLoopTaskQueueMergeUnmerge, GetTasksToRunNowBlocksMerge) {
                           }));
 
   std::thread tasks_to_run_now_thread([&]() {
-    std::vector<fml::closure> invocations;
+    std::vector<fml::Task> invocations;
     task_queue->GetTasksToRunNow(queue_id_1, fml::FlushType::kAll, invocations);
   });
 
@@ -208,3 +208,29 @@ TEST(MessageLoopTaskQueueMergeUnmerge, GetTasksToRunNowBlocksMerge) {
   tasks_to_run_now_thread.join();
   merge_thread.join();
 }
+
+TEST(MessageLoopTaskQueueMergeUnmerge,
+     PrioritiesAreHonoredAcrossMergedQueues) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+
+  auto queue_id_1 = task_queue->CreateTaskQueue();
+  auto queue_id_2 = task_queue->CreateTaskQueue();
+  std::vector<int> order;
+  const auto now = fml::TimePoint::Now();
+
+  task_queue->RegisterTask(
+      queue_id_1, [&order]() { order.push_back(1); }, now);
+  task_queue->RegisterTask(
+      queue_id_2, [&order]() { order.push_back(0); }, now,
+      fml::TaskPriority::kFrame);
+
+  task_queue->Merge(queue_id_1, queue_id_2);
+
+  std::vector<fml::Task> invocations;
+  task_queue->GetTasksToRunNow(queue_id_1, fml::FlushType::kAll, invocations);
+  for (auto& invocation : invocations) {
+    invocation();
+  }
+
+  ASSERT_EQ(order, (std::vector<int>{0, 1}));
+}
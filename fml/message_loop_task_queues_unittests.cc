@@ -69,7 +69,7 @@ TEST(MessageLoopTaskQueue, PreserveTaskOrdering) {
   task_queue->RegisterTask(
       queue_id, [&test_val]() { test_val = 2; }, fml::TimePoint::Now());
 
-  std::vector<fml::closure> invocations;
+  std::vector<fml::Task> invocations;
   task_queue->GetTasksToRunNow(queue_id, fml::FlushType::kAll, invocations);
 
   int expected_value = 1;
@@ -81,6 +81,93 @@ TEST(MessageLoopTaskQueue, PreserveTaskOrdering) {
   }
 }
 
+TEST(MessageLoopTaskQueue, HigherPriorityTasksRunFirst) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto queue_id = task_queue->CreateTaskQueue();
+  std::vector<int> order;
+  const auto now = fml::TimePoint::Now();
+
+  task_queue->RegisterTask(
+      queue_id, [&order]() { order.push_back(3); }, now,
+      fml::TaskPriority::kIdle);
+  task_queue->RegisterTask(
+      queue_id, [&order]() { order.push_back(2); }, now);
+  task_queue->RegisterTask(
+      queue_id, [&order]() { order.push_back(1); }, now,
+      fml::TaskPriority::kInput);
+  task_queue->RegisterTask(
+      queue_id, [&order]() { order.push_back(0); }, now,
+      fml::TaskPriority::kFrame);
+  // Tasks that have not expired yet do not run, whatever their priority.
+  task_queue->RegisterTask(
+      queue_id, [&order]() { order.push_back(-1); }, fml::TimePoint::Max(),
+      fml::TaskPriority::kFrame);
+
+  std::vector<fml::Task> invocations;
+  task_queue->GetTasksToRunNow(queue_id, fml::FlushType::kAll, invocations);
+  for (auto& invocation : invocations) {
+    invocation();
+  }
+
+  ASSERT_EQ(order, (std::vector<int>{0, 1, 2, 3}));
+  ASSERT_EQ(task_queue->GetNumPendingTasks(queue_id), 1u);
+}
+
+TEST(MessageLoopTaskQueue, TasksOfTheSamePriorityRunInPostOrder) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto queue_id = task_queue->CreateTaskQueue();
+  std::vector<int> order;
+  const auto now = fml::TimePoint::Now();
+
+  // Like a pointer event that follows a metrics change, neither overtakes
+  // the other, but both overtake the earlier task of a lower priority.
+  task_queue->RegisterTask(
+      queue_id, [&order]() { order.push_back(2); }, now);
+  task_queue->RegisterTask(
+      queue_id, [&order]() { order.push_back(0); }, now,
+      fml::TaskPriority::kInput);
+  task_queue->RegisterTask(
+      queue_id, [&order]() { order.push_back(1); }, now,
+      fml::TaskPriority::kInput);
+
+  std::vector<fml::Task> invocations;
+  task_queue->GetTasksToRunNow(queue_id, fml::FlushType::kAll, invocations);
+  for (auto& invocation : invocations) {
+    invocation();
+  }
+
+  ASSERT_EQ(order, (std::vector<int>{0, 1, 2}));
+}
+
+TEST(MessageLoopTaskQueue, WaitingTasksArePromoted) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto queue_id = task_queue->CreateTaskQueue();
+  std::vector<int> order;
+  const auto now = fml::TimePoint::Now();
+  const auto long_ago =
+      now - fml::MessageLoopTaskQueues::kTaskAgingInterval * 3;
+
+  task_queue->RegisterTask(
+      queue_id, [&order]() { order.push_back(2); }, now,
+      fml::TaskPriority::kInput);
+  task_queue->RegisterTask(
+      queue_id, [&order]() { order.push_back(1); }, long_ago,
+      fml::TaskPriority::kIdle);
+  task_queue->RegisterTask(
+      queue_id, [&order]() { order.push_back(0); }, now,
+      fml::TaskPriority::kFrame);
+
+  std::vector<fml::Task> invocations;
+  task_queue->GetTasksToRunNow(queue_id, fml::FlushType::kAll, invocations);
+  for (auto& invocation : invocations) {
+    invocation();
+  }
+
+  // The idle task waited long enough to run before the newer input task, but
+  // never before frame tasks.
+  ASSERT_EQ(order, (std::vector<int>{0, 1, 2}));
+}
+
 void TestNotifyObservers(fml::TaskQueueId queue_id) {
   auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
   std::vector<fml::closure> observers =
@@ -4,7 +4,10 @@
 
 #define FML_USED_ON_EMBEDDER
 
+#include <atomic>
 #include <iostream>
+#include <memory>
+#include <set>
 #include <thread>
 
 #include "flutter/fml/build_config.h"
@@ -137,6 +140,22 @@ TEST(MessageLoop, DelayedTasksAtSameTimeAreRunInOrder) {
   ASSERT_TRUE(terminated);
 }
 
+TEST(MessageLoop, CanPostMoveOnlyTasks) {
+  int result = 0;
+  std::thread thread([&result]() {
+    fml::MessageLoop::EnsureInitializedForCurrentThread();
+    auto& loop = fml::MessageLoop::GetCurrent();
+    auto value = std::make_unique<int>(42);
+    loop.GetTaskRunner()->PostTask([value = std::move(value), &result]() {
+      result = *value;
+      fml::MessageLoop::GetCurrent().Terminate();
+    });
+    loop.Run();
+  });
+  thread.join();
+  ASSERT_EQ(result, 42);
+}
+
 TEST(MessageLoop, CheckRunsTaskOnCurrentThread) {
   fml::RefPtr<fml::TaskRunner> runner;
   fml::AutoResetWaitableEvent latch;
@@ -315,3 +334,77 @@ TEST(MessageLoop, CanCreateConcurrentMessageLoop) {
   latch.Wait();
   ASSERT_GE(thread_ids.size(), 1u);
 }
+
+TEST(MessageLoop, TasksPostedToWorkerRunOnThatWorker) {
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  const size_t kCount = 10;
+  std::vector<std::thread::id> thread_ids(kCount);
+  fml::CountDownLatch latch(kCount);
+  for (size_t i = 0; i < kCount; ++i) {
+    loop->PostTaskToWorker(2, [&thread_ids, &latch, i]() {
+      thread_ids[i] = std::this_thread::get_id();
+      latch.CountDown();
+    });
+  }
+  latch.Wait();
+  for (size_t i = 1; i < kCount; ++i) {
+    ASSERT_EQ(thread_ids[i], thread_ids[0]);
+  }
+  ASSERT_NE(thread_ids[0], std::this_thread::get_id());
+}
+
+TEST(MessageLoop, IdleWorkersStealTasksOfBusyWorkers) {
+  auto loop = fml::ConcurrentMessageLoop::Create(2);
+  auto task_runner = loop->GetTaskRunner();
+  fml::AutoResetWaitableEvent subtask_done;
+  std::thread::id poster_id;
+  std::thread::id subtask_id;
+  fml::AutoResetWaitableEvent done;
+  task_runner->PostTask([&]() {
+    poster_id = std::this_thread::get_id();
+    // The subtask is queued on this worker, which is blocked until the
+    // subtask has run, so only the other worker can run it.
+    task_runner->PostTask([&]() {
+      subtask_id = std::this_thread::get_id();
+      subtask_done.Signal();
+    });
+    subtask_done.Wait();
+    done.Signal();
+  });
+  done.Wait();
+  ASSERT_NE(poster_id, subtask_id);
+}
+
+TEST(MessageLoop, ParallelForVisitsEveryIndexOnce) {
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  auto task_runner = loop->GetTaskRunner();
+  const size_t kCount = 1000;
+  std::vector<std::atomic_size_t> visits(kCount);
+  task_runner->ParallelFor(kCount,
+                           [&visits](size_t index) { ++visits[index]; });
+  for (size_t i = 0; i < kCount; ++i) {
+    ASSERT_EQ(visits[i], 1u);
+  }
+}
+
+TEST(MessageLoop, ParallelForCanBeNestedInWorkers) {
+  auto loop = fml::ConcurrentMessageLoop::Create(2);
+  auto task_runner = loop->GetTaskRunner();
+  std::atomic_size_t sum = 0;
+  task_runner->ParallelFor(8, [&](size_t outer) {
+    task_runner->ParallelFor(8,
+                             [&](size_t inner) { sum += outer * 8 + inner; });
+  });
+  ASSERT_EQ(sum, 63u * 64u / 2u);
+}
+
+TEST(MessageLoop, ParallelForRunsOnCallerWhenLoopIsGone) {
+  auto loop = fml::ConcurrentMessageLoop::Create(2);
+  auto task_runner = loop->GetTaskRunner();
+  loop.reset();
+  std::set<std::thread::id> thread_ids;
+  task_runner->ParallelFor(
+      4, [&](size_t) { thread_ids.insert(std::this_thread::get_id()); });
+  ASSERT_EQ(thread_ids.size(), 1u);
+  ASSERT_EQ(*thread_ids.begin(), std::this_thread::get_id());
+}
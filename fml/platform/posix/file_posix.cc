@@ -10,6 +10,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <memory>
 #include <sstream>
 
@@ -157,6 +158,36 @@ bool TruncateFile(const fml::UniqueFD& file, size_t size) {
   return ::ftruncate(file.get(), size) == 0;
 }
 
+std::unique_ptr<Mapping> ReadFileRange(const fml::UniqueFD& file,
+                                       size_t offset,
+                                       size_t length) {
+  struct stat stat_buffer = {};
+  if (!file.is_valid() || ::fstat(file.get(), &stat_buffer) != 0) {
+    return nullptr;
+  }
+  const size_t size = stat_buffer.st_size;
+  if (offset > size) {
+    return nullptr;
+  }
+
+  std::vector<uint8_t> data(std::min(length, size - offset));
+  size_t read = 0;
+  while (read < data.size()) {
+    const ssize_t result = FML_HANDLE_EINTR(::pread(
+        file.get(), data.data() + read, data.size() - read, offset + read));
+    if (result == -1) {
+      return nullptr;
+    }
+    if (result == 0) {
+      // The file was truncated since its size was read.
+      data.resize(read);
+      break;
+    }
+    read += result;
+  }
+  return std::make_unique<DataMapping>(std::move(data));
+}
+
 bool UnlinkDirectory(const char* path) {
   return UnlinkDirectory(fml::UniqueFD{AT_FDCWD}, path);
 }
@@ -328,6 +328,48 @@ bool TruncateFile(const fml::UniqueFD& file, size_t size) {
   return true;
 }
 
+std::unique_ptr<Mapping> ReadFileRange(const fml::UniqueFD& file,
+                                       size_t offset,
+                                       size_t length) {
+  LARGE_INTEGER file_size;
+  if (!file.is_valid() || !::GetFileSizeEx(file.get(), &file_size)) {
+    FML_DLOG(ERROR) << "Could not get file size. " << GetLastErrorMessage();
+    return nullptr;
+  }
+  const size_t size = file_size.QuadPart;
+  if (offset > size) {
+    return nullptr;
+  }
+
+  std::vector<uint8_t> data(std::min(length, size - offset));
+  size_t read = 0;
+  while (read < data.size()) {
+    const uint64_t position = offset + read;
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = static_cast<DWORD>(position);
+    overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+    const DWORD bytes_to_read =
+        static_cast<DWORD>(std::min<size_t>(data.size() - read, MAXDWORD));
+    DWORD bytes_read = 0;
+    if (!::ReadFile(file.get(), data.data() + read, bytes_to_read, &bytes_read,
+                    &overlapped)) {
+      if (::GetLastError() == ERROR_HANDLE_EOF) {
+        bytes_read = 0;
+      } else {
+        FML_DLOG(ERROR) << "Could not read file. " << GetLastErrorMessage();
+        return nullptr;
+      }
+    }
+    if (bytes_read == 0) {
+      // The file was truncated since its size was read.
+      data.resize(read);
+      break;
+    }
+    read += bytes_read;
+  }
+  return std::make_unique<DataMapping>(std::move(data));
+}
+
 bool FileExists(const fml::UniqueFD& base_directory, const char* path) {
   return GetFileAttributesForUtf8Path(base_directory, path) !=
          INVALID_FILE_ATTRIBUTES;
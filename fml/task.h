@@ -0,0 +1,155 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FML_TASK_H_
+#define FLUTTER_FML_TASK_H_
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/macros.h"
+
+namespace fml {
+
+//------------------------------------------------------------------------------
+/// @brief      A move-only `void()` callable posted to a task runner.
+///
+///             Unlike `fml::closure`, a task never copies the callable it
+///             wraps, so it may wrap move-only callables (lambdas capturing a
+///             `std::unique_ptr` for instance) without `fml::MakeCopyable`.
+///             Callables that fit in `kInlineSize` bytes and can be moved
+///             without throwing are stored inline, so posting most tasks does
+///             not allocate. Larger callables are stored on the heap and moving
+///             the task only moves the pointer to them.
+///
+class Task {
+ public:
+  static constexpr size_t kInlineSize = 6 * sizeof(void*);
+
+  Task() = default;
+
+  Task(std::nullptr_t) {}
+
+  template <typename Callable,
+            typename Functor = std::decay_t<Callable>,
+            typename = std::enable_if_t<!std::is_same_v<Functor, Task> &&
+                                        std::is_invocable_r_v<void, Functor&>>>
+  Task(Callable&& callable) {
+    // Empty `std::function`s and null function pointers make empty tasks.
+    if constexpr (std::is_constructible_v<bool, const Functor&>) {
+      if (!static_cast<bool>(callable)) {
+        return;
+      }
+    }
+    if constexpr (IsStoredInline<Functor>()) {
+      new (&storage_) Functor(std::forward<Callable>(callable));
+      ops_ = &InlineOps<Functor>::kOps;
+    } else {
+      new (&storage_) Functor*(new Functor(std::forward<Callable>(callable)));
+      ops_ = &HeapOps<Functor>::kOps;
+    }
+  }
+
+  Task(Task&& other) noexcept { MoveFrom(other); }
+
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  Task& operator=(std::nullptr_t) {
+    Reset();
+    return *this;
+  }
+
+  ~Task() { Reset(); }
+
+  explicit operator bool() const { return ops_ != nullptr; }
+
+  void operator()() const {
+    FML_DCHECK(ops_ != nullptr);
+    ops_->invoke(&storage_);
+  }
+
+ private:
+  struct Ops {
+    void (*invoke)(void* storage);
+    // Move constructs the callable in |to| and destroys the one in |from|.
+    void (*relocate)(void* from, void* to);
+    void (*destroy)(void* storage);
+  };
+
+  template <typename Functor>
+  static constexpr bool IsStoredInline() {
+    return sizeof(Functor) <= kInlineSize &&
+           alignof(std::max_align_t) % alignof(Functor) == 0 &&
+           std::is_nothrow_move_constructible_v<Functor>;
+  }
+
+  template <typename Functor>
+  struct InlineOps {
+    static void Invoke(void* storage) { (*static_cast<Functor*>(storage))(); }
+
+    static void Relocate(void* from, void* to) {
+      Functor* functor = static_cast<Functor*>(from);
+      new (to) Functor(std::move(*functor));
+      functor->~Functor();
+    }
+
+    static void Destroy(void* storage) {
+      static_cast<Functor*>(storage)->~Functor();
+    }
+
+    static constexpr Ops kOps = {&Invoke, &Relocate, &Destroy};
+  };
+
+  template <typename Functor>
+  struct HeapOps {
+    static void Invoke(void* storage) { (**static_cast<Functor**>(storage))(); }
+
+    static void Relocate(void* from, void* to) {
+      new (to) Functor*(*static_cast<Functor**>(from));
+    }
+
+    static void Destroy(void* storage) {
+      delete *static_cast<Functor**>(storage);
+    }
+
+    static constexpr Ops kOps = {&Invoke, &Relocate, &Destroy};
+  };
+
+  void MoveFrom(Task& other) {
+    if (other.ops_ != nullptr) {
+      other.ops_->relocate(&other.storage_, &storage_);
+      ops_ = other.ops_;
+      other.ops_ = nullptr;
+    }
+  }
+
+  void Reset() {
+    if (ops_ != nullptr) {
+      // Clear the task first in case the destructor of the callable resets it
+      // again.
+      const Ops* ops = ops_;
+      ops_ = nullptr;
+      ops->destroy(&storage_);
+    }
+  }
+
+  const Ops* ops_ = nullptr;
+  mutable std::aligned_storage_t<kInlineSize, alignof(std::max_align_t)>
+      storage_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(Task);
+};
+
+}  // namespace fml
+
+#endif  // FLUTTER_FML_TASK_H_
@@ -0,0 +1,138 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/fml/closure.h"
+#include "flutter/fml/message_loop_task_queues.h"
+#include "flutter/fml/task.h"
+
+namespace {
+
+// The number of heap allocations made by this process so far.
+std::atomic_size_t g_allocation_count = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+  g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  void* allocation = std::malloc(size == 0 ? 1 : size);
+  if (allocation == nullptr) {
+    std::abort();
+  }
+  return allocation;
+}
+
+void operator delete(void* allocation) noexcept {
+  std::free(allocation);
+}
+
+void operator delete(void* allocation, size_t) noexcept {
+  std::free(allocation);
+}
+
+namespace fml {
+namespace benchmarking {
+
+namespace {
+
+// Tasks capturing |CaptureSize| bytes. Posting a weak pointer, a ref-counted
+// pointer and a couple of scalars is common on the platform channel and
+// pointer paths.
+template <size_t CaptureSize>
+auto MakeLambda(size_t& counter) {
+  std::array<char, CaptureSize - sizeof(size_t*)> padding = {};
+  return [&counter, padding]() { counter += padding.size(); };
+}
+
+void ReportAllocationsPerTask(benchmark::State& state,
+                              size_t allocation_count,
+                              size_t tasks_per_iteration) {
+  state.counters["AllocationsPerTask"] =
+      static_cast<double>(allocation_count) /
+      (state.iterations() * tasks_per_iteration);
+}
+
+}  // namespace
+
+template <size_t CaptureSize>
+static void BM_ClosureConstructAndInvoke(benchmark::State& state) {
+  size_t counter = 0;
+  const size_t allocations_before = g_allocation_count;
+  while (state.KeepRunning()) {
+    fml::closure closure = MakeLambda<CaptureSize>(counter);
+    fml::closure copy = closure;
+    copy();
+  }
+  ReportAllocationsPerTask(state, g_allocation_count - allocations_before, 1);
+  benchmark::DoNotOptimize(counter);
+}
+
+template <size_t CaptureSize>
+static void BM_TaskConstructAndInvoke(benchmark::State& state) {
+  size_t counter = 0;
+  const size_t allocations_before = g_allocation_count;
+  while (state.KeepRunning()) {
+    fml::Task task = MakeLambda<CaptureSize>(counter);
+    fml::Task moved = std::move(task);
+    moved();
+  }
+  ReportAllocationsPerTask(state, g_allocation_count - allocations_before, 1);
+  benchmark::DoNotOptimize(counter);
+}
+
+// Posts batches of tasks to a queue and runs them, as a message loop does.
+template <size_t CaptureSize>
+static void BM_RegisterAndRunTasks(benchmark::State& state) {
+  const size_t tasks_per_iteration = 64;
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  const auto queue_id = task_queue->CreateTaskQueue();
+  const fml::TimePoint past = fml::TimePoint::Now();
+  size_t counter = 0;
+  std::vector<fml::Task> invocations;
+  invocations.reserve(tasks_per_iteration);
+
+  // Let the queue reach its steady state size before counting.
+  for (size_t i = 0; i < tasks_per_iteration; i++) {
+    task_queue->RegisterTask(queue_id, MakeLambda<CaptureSize>(counter), past);
+  }
+  task_queue->GetTasksToRunNow(queue_id, fml::FlushType::kAll, invocations);
+  invocations.clear();
+
+  const size_t allocations_before = g_allocation_count;
+  while (state.KeepRunning()) {
+    for (size_t i = 0; i < tasks_per_iteration; i++) {
+      task_queue->RegisterTask(queue_id, MakeLambda<CaptureSize>(counter),
+                               past);
+    }
+    task_queue->GetTasksToRunNow(queue_id, fml::FlushType::kAll, invocations);
+    for (const auto& invocation : invocations) {
+      invocation();
+    }
+    invocations.clear();
+  }
+  ReportAllocationsPerTask(state, g_allocation_count - allocations_before,
+                           tasks_per_iteration);
+  state.SetItemsProcessed(state.iterations() * tasks_per_iteration);
+  task_queue->Dispose(queue_id);
+  benchmark::DoNotOptimize(counter);
+}
+
+BENCHMARK_TEMPLATE(BM_ClosureConstructAndInvoke, 16);
+BENCHMARK_TEMPLATE(BM_ClosureConstructAndInvoke, 32);
+BENCHMARK_TEMPLATE(BM_ClosureConstructAndInvoke, 48);
+BENCHMARK_TEMPLATE(BM_TaskConstructAndInvoke, 16);
+BENCHMARK_TEMPLATE(BM_TaskConstructAndInvoke, 32);
+BENCHMARK_TEMPLATE(BM_TaskConstructAndInvoke, 48);
+BENCHMARK_TEMPLATE(BM_RegisterAndRunTasks, 16);
+BENCHMARK_TEMPLATE(BM_RegisterAndRunTasks, 32);
+BENCHMARK_TEMPLATE(BM_RegisterAndRunTasks, 48);
+
+}  // namespace benchmarking
+}  // namespace fml
@@ -0,0 +1,35 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FML_TASK_PRIORITY_H_
+#define FLUTTER_FML_TASK_PRIORITY_H_
+
+#include <cstddef>
+
+namespace fml {
+
+// The priority of a task posted to a message loop. Among the tasks whose
+// target time has expired, the tasks with a higher priority run first. Tasks
+// with the same priority run in the order of their target times, and then in
+// the order they were posted.
+//
+// Tasks that have been waiting to run for a while are promoted to avoid
+// starving them, see |MessageLoopTaskQueues::GetTasksToRunNow|.
+enum class TaskPriority {
+  // Tasks that produce the next frame, such as the vsync callback.
+  kFrame,
+  // Tasks that deliver user input.
+  kInput,
+  // The priority of all tasks posted without an explicit priority.
+  kNormal,
+  // Tasks that can wait until there is no other work to do.
+  kIdle,
+};
+
+constexpr size_t kTaskPriorityCount =
+    static_cast<size_t>(TaskPriority::kIdle) + 1;
+
+}  // namespace fml
+
+#endif  // FLUTTER_FML_TASK_PRIORITY_H_
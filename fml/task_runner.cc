@@ -21,18 +21,31 @@ TaskRunner::TaskRunner(fml::RefPtr<MessageLoopImpl> loop)
 
 TaskRunner::~TaskRunner() = default;
 
-void TaskRunner::PostTask(const fml::closure& task) {
-  loop_->PostTask(task, fml::TimePoint::Now());
+void TaskRunner::PostTask(fml::Task task) {
+  loop_->PostTask(std::move(task), fml::TimePoint::Now());
 }
 
-void TaskRunner::PostTaskForTime(const fml::closure& task,
-                                 fml::TimePoint target_time) {
-  loop_->PostTask(task, target_time);
+void TaskRunner::PostTaskForTime(fml::Task task, fml::TimePoint target_time) {
+  loop_->PostTask(std::move(task), target_time);
 }
 
-void TaskRunner::PostDelayedTask(const fml::closure& task,
-                                 fml::TimeDelta delay) {
-  loop_->PostTask(task, fml::TimePoint::Now() + delay);
+void TaskRunner::PostDelayedTask(fml::Task task, fml::TimeDelta delay) {
+  loop_->PostTask(std::move(task), fml::TimePoint::Now() + delay);
+}
+
+void TaskRunner::PostTaskWithPriority(fml::Task task, TaskPriority priority) {
+  PostTaskForTimeWithPriority(std::move(task), fml::TimePoint::Now(),
+                              priority);
+}
+
+void TaskRunner::PostTaskForTimeWithPriority(fml::Task task,
+                                             fml::TimePoint target_time,
+                                             TaskPriority priority) {
+  if (!loop_) {
+    PostTaskForTime(std::move(task), target_time);
+    return;
+  }
+  loop_->PostTask(std::move(task), target_time, priority);
 }
 
 TaskQueueId TaskRunner::GetTaskQueueId() {
@@ -53,7 +66,7 @@ bool TaskRunner::RunsTasksOnCurrentThread() {
 }
 
 void TaskRunner::RunNowOrPostTask(fml::RefPtr<fml::TaskRunner> runner,
-                                  const fml::closure& task) {
+                                  fml::Task task) {
   FML_DCHECK(runner);
   if (runner->RunsTasksOnCurrentThread()) {
     task();
@@ -10,6 +10,8 @@
 #include "flutter/fml/memory/ref_counted.h"
 #include "flutter/fml/memory/ref_ptr.h"
 #include "flutter/fml/message_loop_task_queues.h"
+#include "flutter/fml/task.h"
+#include "flutter/fml/task_priority.h"
 #include "flutter/fml/time/time_point.h"
 
 namespace fml {
@@ -20,19 +22,27 @@ class TaskRunner : public fml::RefCountedThreadSafe<TaskRunner> {
  public:
   virtual ~TaskRunner();
 
-  virtual void PostTask(const fml::closure& task);
+  virtual void PostTask(fml::Task task);
 
-  virtual void PostTaskForTime(const fml::closure& task,
-                               fml::TimePoint target_time);
+  virtual void PostTaskForTime(fml::Task task, fml::TimePoint target_time);
 
-  virtual void PostDelayedTask(const fml::closure& task, fml::TimeDelta delay);
+  virtual void PostDelayedTask(fml::Task task, fml::TimeDelta delay);
+
+  // Posts a task that runs ahead of the expired tasks with a lower priority.
+  // Task runners that are not backed by a |MessageLoopImpl| (i.e. where the
+  // embedder schedules the tasks) ignore the priority.
+  virtual void PostTaskWithPriority(fml::Task task, TaskPriority priority);
+
+  virtual void PostTaskForTimeWithPriority(fml::Task task,
+                                           fml::TimePoint target_time,
+                                           TaskPriority priority);
 
   virtual bool RunsTasksOnCurrentThread();
 
   virtual TaskQueueId GetTaskQueueId();
 
   static void RunNowOrPostTask(fml::RefPtr<fml::TaskRunner> runner,
-                               const fml::closure& task);
+                               fml::Task task);
 
  protected:
   TaskRunner(fml::RefPtr<MessageLoopImpl> loop);
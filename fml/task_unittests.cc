@@ -0,0 +1,79 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/task.h"
+
+#include <array>
+#include <functional>
+#include <memory>
+
+#include "gtest/gtest.h"
+
+namespace fml {
+namespace testing {
+
+TEST(TaskTest, DefaultConstructedTaskIsEmpty) {
+  Task task;
+  ASSERT_FALSE(task);
+  Task null_task = nullptr;
+  ASSERT_FALSE(null_task);
+}
+
+TEST(TaskTest, EmptyClosureMakesEmptyTask) {
+  std::function<void()> closure;
+  Task task = closure;
+  ASSERT_FALSE(task);
+  void (*function)() = nullptr;
+  Task function_task = function;
+  ASSERT_FALSE(function_task);
+}
+
+TEST(TaskTest, CanWrapMoveOnlyCallable) {
+  auto value = std::make_unique<int>(42);
+  int result = 0;
+  Task task = [value = std::move(value), &result]() { result = *value; };
+  ASSERT_TRUE(task);
+  task();
+  ASSERT_EQ(result, 42);
+}
+
+TEST(TaskTest, MovingInlineTaskMovesCallable) {
+  auto counter = std::make_shared<int>(0);
+  Task task = [counter]() { ++*counter; };
+  Task moved = std::move(task);
+  ASSERT_FALSE(task);
+  ASSERT_TRUE(moved);
+  moved();
+  ASSERT_EQ(*counter, 1);
+  moved = nullptr;
+  ASSERT_EQ(counter.use_count(), 1);
+}
+
+TEST(TaskTest, MovingHeapTaskMovesCallable) {
+  auto counter = std::make_shared<int>(0);
+  std::array<char, Task::kInlineSize> padding = {};
+  Task task = [counter, padding]() { *counter += padding.size(); };
+  Task moved = std::move(task);
+  ASSERT_FALSE(task);
+  ASSERT_TRUE(moved);
+  moved();
+  ASSERT_EQ(*counter, static_cast<int>(Task::kInlineSize));
+  moved = nullptr;
+  ASSERT_EQ(counter.use_count(), 1);
+}
+
+TEST(TaskTest, DestroysCallableOnce) {
+  auto counter = std::make_shared<int>(0);
+  {
+    Task task = [counter]() {};
+    Task other = std::move(task);
+    Task another;
+    another = std::move(other);
+    ASSERT_EQ(counter.use_count(), 2);
+  }
+  ASSERT_EQ(counter.use_count(), 1);
+}
+
+}  // namespace testing
+}  // namespace fml
@@ -65,3 +65,14 @@ Future<void> encodeImageProducesExternalUint8List() async {
 void _encodeImage(Image i, int format, void Function(Uint8List result))
   native 'EncodeImage';
 void _validateExternal(Uint8List result) native 'ValidateExternal';
+
+@pragma('vm:entry-point')
+TiledImage createTiledImage(Uint8List list, int tileSize, int maxBytes) {
+  return TiledImage(list, tileSize: tileSize, maxBytes: maxBytes);
+}
+
+@pragma('vm:entry-point')
+void tileCallback(Image image) {
+  _onTile(image);
+}
+void _onTile(Image image) native 'OnTile';
@@ -1693,11 +1693,67 @@ class Codec extends NativeFieldWrapperClass2 {
   /// Returns an error message on failure, null on success.
   String _getNextFrame(_Callback<FrameInfo> callback) native 'Codec_getNextFrame';
 
+  /// Sets the priority of decoding the frames of this codec relative to the
+  /// frames of other codecs.
+  ///
+  /// Decodes with a higher priority are started first. Of the decodes with the
+  /// same priority, the one requested last is started first. For example, an
+  /// image that scrolls out of view can be given a lower priority than the
+  /// visible ones. The priority of a decode can only be changed until it
+  /// starts.
+  void setDecodePriority(int priority) native 'Codec_setDecodePriority';
+
   /// Release the resources used by this object. The object is no longer usable
   /// after this method is called.
+  ///
+  /// A frame that is still being decoded is abandoned, and the futures
+  /// returned by [getNextFrame] for it never complete.
   void dispose() native 'Codec_dispose';
 }
 
+/// A [Codec] that decodes an image while its encoded bytes are still arriving,
+/// for example from the network.
+///
+/// Add the bytes with [addBytes] as they arrive, and call [close] after the
+/// last of them. The image is decoded as the bytes arrive, and each call to
+/// [getNextFrame] completes with a frame that shows more of the image than the
+/// previous one, once there is more to show. Parts of the image that haven't
+/// been decoded yet are transparent. Once the image is complete, every call
+/// completes with the complete image.
+///
+/// PNG and GIF images are decoded incrementally, which also shows the passes
+/// of interlaced images as they arrive. Other formats are decoded again from
+/// the start as more of their bytes arrive. Images with an EXIF orientation
+/// are only decoded once all of their bytes have arrived. Only the first frame
+/// of animated images is decoded.
+@pragma('vm:entry-point')
+class IncrementalCodec extends Codec {
+  /// Creates a codec without any bytes.
+  @pragma('vm:entry-point')
+  IncrementalCodec() : super._() {
+    _constructor();
+  }
+  void _constructor() native 'IncrementalCodec_constructor';
+
+  /// Appends the next chunk of the encoded image.
+  ///
+  /// Throws a [StateError] if the codec has been closed.
+  void addBytes(Uint8List bytes) {
+    final String? error = _addBytes(bytes);
+    if (error != null)
+      throw StateError(error);
+  }
+
+  /// Returns an error message on failure, null on success.
+  String? _addBytes(Uint8List bytes) native 'IncrementalCodec_addBytes';
+
+  /// Signals that all the bytes of the image have been added.
+  ///
+  /// If the bytes end before the image does, the image is completed with the
+  /// part of it that could be decoded.
+  void close() native 'IncrementalCodec_close';
+}
+
 /// Instantiates an image [Codec].
 ///
 /// The `list` parameter is the binary image data (e.g a PNG or GIF binary data).
@@ -1831,6 +1887,72 @@ void decodeImageFromPixels(
       .then((FrameInfo frameInfo) => callback(frameInfo.image));
 }
 
+/// An image that is too large to decode at once, decoded one tile at a time.
+///
+/// The image is divided into square tiles of [tileSize] pixels, except for the
+/// tiles at its right and bottom edges, which may be smaller. Only the part of
+/// the encoded image that a tile covers is decoded, where the format of the
+/// image allows that, so even very large images can be viewed without decoding
+/// them whole.
+///
+/// Decoded tiles are kept until they take up more than `maxBytes`, at which
+/// point the least recently used tiles are released.
+@pragma('vm:entry-point')
+class TiledImage extends NativeFieldWrapperClass2 {
+  /// Creates a tiled image from the binary image data in `list`.
+  ///
+  /// Throws an [Exception] if the data is not an image in a supported format.
+  @pragma('vm:entry-point')
+  TiledImage(Uint8List list, {int tileSize = 512, int maxBytes = 64 << 20}) {
+    _constructor();
+    final String? error = _init(list, tileSize, maxBytes);
+    if (error != null)
+      throw Exception(error);
+  }
+  void _constructor() native 'TiledImage_constructor';
+  String? _init(Uint8List list, int tileSize, int maxBytes) native 'TiledImage_init';
+
+  /// The width of the image, in image pixels.
+  int get width native 'TiledImage_width';
+
+  /// The height of the image, in image pixels.
+  int get height native 'TiledImage_height';
+
+  /// The width and height of the tiles, in image pixels.
+  int get tileSize native 'TiledImage_tileSize';
+
+  /// The number of columns of tiles.
+  int get columnCount => (width + tileSize - 1) ~/ tileSize;
+
+  /// The number of rows of tiles.
+  int get rowCount => (height + tileSize - 1) ~/ tileSize;
+
+  /// Decodes the tile at the given column and row.
+  ///
+  /// The tile is resized by `scale`, which must be greater than zero and at
+  /// most one. Decoding a tile at a smaller scale takes less time and memory.
+  ///
+  /// Tiles with a higher `priority` are decoded first, like the frames of
+  /// codecs with a higher [Codec.setDecodePriority].
+  ///
+  /// The returned future can complete with an error if the decoding has
+  /// failed.
+  Future<Image> getTile(int column, int row, {double scale = 1.0, int priority = 0}) {
+    return _futurize((_Callback<Image> callback) => _getTile(column, row, scale, priority, callback));
+  }
+
+  /// Returns an error message on failure, null on success.
+  String? _getTile(int column, int row, double scale, int priority, _Callback<Image> callback) native 'TiledImage_getTile';
+
+  /// Release the resources used by this object. The object is no longer usable
+  /// after this method is called.
+  ///
+  /// The futures returned by [getTile] for tiles that are still being decoded
+  /// never complete. The images of the tiles that were already returned remain
+  /// valid.
+  void dispose() native 'TiledImage_dispose';
+}
+
 /// Determines the winding rule that decides how the interior of a [Path] is
 /// calculated.
 ///
@@ -0,0 +1,283 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/animated_frame_cache.h"
+
+#include <algorithm>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+AnimatedFrameCache::AnimatedFrameCache(
+    sk_sp<SkData> data,
+    std::unique_ptr<SkCodec> codec,
+    fml::RefPtr<fml::TaskRunner> io_task_runner,
+    std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
+    fml::WeakPtr<IOManager> io_manager,
+    size_t lookahead)
+    : data_(std::move(data)),
+      codec_(std::move(codec)),
+      frame_count_(std::max(codec_->getFrameCount(), 1)),
+      repetition_count_(codec_->getRepetitionCount()),
+      io_task_runner_(std::move(io_task_runner)),
+      concurrent_task_runner_(std::move(concurrent_task_runner)),
+      io_manager_(std::move(io_manager)),
+      lookahead_(lookahead),
+      slots_(std::min<size_t>(lookahead, frame_count_ - 1) + 1) {}
+
+AnimatedFrameCache::~AnimatedFrameCache() {
+  // The tasks that decode and deliver the frames keep the cache alive, so
+  // results are only left here if those tasks were dropped, e.g. during
+  // shutdown.
+  for (auto& waiting_result : waiting_results_) {
+    waiting_result.second(nullptr, 0);
+  }
+}
+
+void AnimatedFrameCache::GetFrame(int index, FrameResult result) {
+  std::scoped_lock lock(mutex_);
+  position_ = index;
+  if (FindSlot(index) >= 0) {
+    io_task_runner_->PostTask(
+        [cache = shared_from_this(), index, result = std::move(result)]() {
+          cache->DeliverFrame(index, result);
+        });
+  } else {
+    waiting_results_.emplace(index, std::move(result));
+  }
+  ScheduleDecodes(index);
+}
+
+bool AnimatedFrameCache::IsAtPosition(int index) {
+  std::scoped_lock lock(mutex_);
+  return position_ < 0 || index == position_ ||
+         index == (position_ + 1) % frame_count_;
+}
+
+std::shared_ptr<AnimatedFrameCache> AnimatedFrameCache::CreateUnshared()
+    const {
+  if (!data_) {
+    return nullptr;
+  }
+  auto codec = SkCodec::MakeFromData(data_);
+  if (!codec) {
+    return nullptr;
+  }
+  return std::make_shared<AnimatedFrameCache>(
+      data_, std::move(codec), io_task_runner_, concurrent_task_runner_,
+      io_manager_, lookahead_);
+}
+
+int AnimatedFrameCache::FindSlot(int index) const {
+  for (size_t i = 0; i < slots_.size(); i++) {
+    if (slots_[i].index == index) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+void AnimatedFrameCache::ScheduleDecodes(int index) {
+  // Decode the frames of the window from the first one that is neither cached
+  // nor being decoded.
+  const int window_size = static_cast<int>(slots_.size());
+  window_start_ = index;
+  decodes_remaining_ = 0;
+  for (int offset = 0; offset < window_size; offset++) {
+    const int frame = (index + offset) % frame_count_;
+    if (frame != decoding_index_ && FindSlot(frame) < 0) {
+      next_decode_ = frame;
+      decodes_remaining_ = window_size - offset;
+      break;
+    }
+  }
+
+  if (decodes_remaining_ == 0 || decoding_) {
+    return;
+  }
+  decoding_ = true;
+  auto task = [cache = shared_from_this()]() { cache->DecodeFrames(); };
+  if (concurrent_task_runner_) {
+    concurrent_task_runner_->PostTask(task);
+  } else {
+    io_task_runner_->PostTask(task);
+  }
+}
+
+void AnimatedFrameCache::DecodeFrames() {
+  TRACE_EVENT0("flutter", "AnimatedFrameCache::DecodeFrames");
+  while (true) {
+    int index = 0;
+    size_t slot_index = 0;
+    SkBitmap bitmap;
+    {
+      std::scoped_lock lock(mutex_);
+      if (decodes_remaining_ == 0 && !waiting_results_.empty()) {
+        // A later request has moved the window away from a frame that is
+        // still awaited.
+        ScheduleDecodes(waiting_results_.begin()->first);
+      }
+      if (decodes_remaining_ == 0) {
+        decoding_ = false;
+        return;
+      }
+      index = next_decode_;
+      next_decode_ = (next_decode_ + 1) % frame_count_;
+      decodes_remaining_--;
+      if (FindSlot(index) >= 0) {
+        continue;
+      }
+
+      // Replace the frame furthest after the start of the window, which is
+      // the one that will be shown last.
+      int furthest = -1;
+      for (size_t i = 0; i < slots_.size(); i++) {
+        const int distance =
+            slots_[i].index < 0
+                ? frame_count_
+                : (slots_[i].index - window_start_ + frame_count_) %
+                      frame_count_;
+        if (distance > furthest) {
+          furthest = distance;
+          slot_index = i;
+        }
+      }
+      Slot& slot = slots_[slot_index];
+      slot.index = -1;
+      slot.image.reset();
+      bitmap = slot.bitmap;
+      decoding_index_ = index;
+    }
+
+    int duration = 0;
+    const bool decoded = DecodeFrame(index, &bitmap, &duration);
+
+    std::vector<FrameResult> results;
+    {
+      std::scoped_lock lock(mutex_);
+      decoding_index_ = -1;
+      Slot& slot = slots_[slot_index];
+      slot.bitmap = bitmap;
+      if (decoded) {
+        slot.index = index;
+        slot.duration = duration;
+      }
+      auto range = waiting_results_.equal_range(index);
+      for (auto it = range.first; it != range.second; ++it) {
+        results.push_back(std::move(it->second));
+      }
+      waiting_results_.erase(range.first, range.second);
+    }
+
+    for (auto& result : results) {
+      io_task_runner_->PostTask([cache = shared_from_this(), index, decoded,
+                                 result = std::move(result)]() {
+        if (decoded) {
+          cache->DeliverFrame(index, result);
+        } else {
+          result(nullptr, 0);
+        }
+      });
+    }
+  }
+}
+
+bool AnimatedFrameCache::DecodeFrame(int index,
+                                     SkBitmap* bitmap,
+                                     int* duration) {
+  TRACE_EVENT0("flutter", "AnimatedFrameCache::DecodeFrame");
+  SkImageInfo info = codec_->getInfo().makeColorType(kN32_SkColorType);
+  if (info.alphaType() == kUnpremul_SkAlphaType) {
+    info = info.makeAlphaType(kPremul_SkAlphaType);
+  }
+  // Reuse the pixels of the frame that was in the slot before.
+  if (bitmap->info() != info && !bitmap->tryAllocPixels(info)) {
+    FML_LOG(ERROR) << "Failed to allocate memory for frame " << index;
+    return false;
+  }
+
+  SkCodec::Options options;
+  options.fFrameIndex = index;
+  SkCodec::FrameInfo frameInfo;
+  codec_->getFrameInfo(index, &frameInfo);
+  const int requiredFrameIndex = frameInfo.fRequiredFrame;
+  if (requiredFrameIndex != SkCodec::kNoFrame) {
+    // Only a cached copy of the required frame itself can be drawn over.
+    // Otherwise the codec decodes the required frames again on its own.
+    if (required_frame_index_ == requiredFrameIndex &&
+        required_frame_.readPixels(bitmap->pixmap())) {
+      options.fPriorFrame = requiredFrameIndex;
+    } else {
+      FML_DLOG(INFO) << "Required frame " << requiredFrameIndex
+                     << " is not cached. Decoding it again for frame "
+                     << index;
+    }
+  }
+  if (options.fPriorFrame == SkCodec::kNoFrame) {
+    // Clear what the previous frame in the slot left behind.
+    bitmap->eraseColor(SK_ColorTRANSPARENT);
+  }
+
+  if (SkCodec::kSuccess != codec_->getPixels(info, bitmap->getPixels(),
+                                             bitmap->rowBytes(), &options)) {
+    FML_LOG(ERROR) << "Could not getPixels for frame " << index;
+    return false;
+  }
+
+  // Hold onto this if we need it to decode future frames. It is copied, since
+  // the pixels of the slot are reused by later frames.
+  if (frameInfo.fDisposalMethod == SkCodecAnimation::DisposalMethod::kKeep) {
+    required_frame_index_ = -1;
+    const bool allocated =
+        required_frame_.info() == info || required_frame_.tryAllocPixels(info);
+    if (allocated && bitmap->readPixels(required_frame_.pixmap())) {
+      required_frame_index_ = index;
+    }
+  }
+
+  *duration = frameInfo.fDuration;
+  return true;
+}
+
+static sk_sp<SkImage> UploadFrame(const SkBitmap& bitmap,
+                                  fml::WeakPtr<GrContext> resource_context) {
+  if (resource_context) {
+    return SkImage::MakeCrossContextFromPixmap(resource_context.get(),
+                                               bitmap.pixmap(), true);
+  }
+  // Defer the upload until the frame is drawn on the raster thread. Can happen
+  // when GL operations are currently forbidden such as in the background on
+  // iOS. The pixels are copied since the slot reuses them.
+  return SkImage::MakeRasterCopy(bitmap.pixmap());
+}
+
+void AnimatedFrameCache::DeliverFrame(int index, FrameResult result) {
+  sk_sp<SkImage> image;
+  int duration = 0;
+  {
+    std::scoped_lock lock(mutex_);
+    const int slot_index = FindSlot(index);
+    if (slot_index < 0) {
+      // The frame was replaced before it could be uploaded.
+      waiting_results_.emplace(index, std::move(result));
+      ScheduleDecodes(index);
+      return;
+    }
+    Slot& slot = slots_[slot_index];
+    if (!slot.image) {
+      fml::WeakPtr<GrContext> resource_context;
+      if (io_manager_) {
+        resource_context = io_manager_->GetResourceContext();
+      }
+      slot.image = UploadFrame(slot.bitmap, std::move(resource_context));
+    }
+    image = slot.image;
+    duration = slot.duration;
+  }
+  result(std::move(image), duration);
+}
+
+}  // namespace flutter
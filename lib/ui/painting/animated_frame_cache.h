@@ -0,0 +1,139 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_ANIMATED_FRAME_CACHE_H_
+#define FLUTTER_LIB_UI_PAINTING_ANIMATED_FRAME_CACHE_H_
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/memory/weak_ptr.h"
+#include "flutter/fml/task_runner.h"
+#include "flutter/lib/ui/io_manager.h"
+#include "third_party/skia/include/codec/SkCodec.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkImage.h"
+
+namespace flutter {
+
+// The decoded frames of an animated image, shared by all the codecs that play
+// the image.
+//
+// Frames are decoded in order on the concurrent worker pool, starting with the
+// requested frame and continuing with the |lookahead| frames after it, into a
+// ring of |lookahead| + 1 slots. The pixels of a slot are reused by the frames
+// decoded into it later. A frame is uploaded on the IO task runner when it is
+// first requested, and the uploaded image is kept with the frame for the
+// other codecs that request it.
+//
+// The window of frames and the frame required to decode the next one follow a
+// single position in the animation. Only codecs that play the image at the
+// same position can share the cache, see |IsAtPosition|.
+//
+// This class is thread-safe.
+class AnimatedFrameCache
+    : public std::enable_shared_from_this<AnimatedFrameCache> {
+ public:
+  // Called with the frame and its duration in milliseconds, or with a null
+  // image if the frame could not be decoded.
+  using FrameResult = std::function<void(sk_sp<SkImage> image, int duration)>;
+
+  // Decodes on the IO task runner if |concurrent_task_runner| is null.
+  AnimatedFrameCache(
+      sk_sp<SkData> data,
+      std::unique_ptr<SkCodec> codec,
+      fml::RefPtr<fml::TaskRunner> io_task_runner,
+      std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
+      fml::WeakPtr<IOManager> io_manager,
+      size_t lookahead);
+
+  ~AnimatedFrameCache();
+
+  // The encoded image, or null if the frames are not shared.
+  const sk_sp<SkData>& GetData() const { return data_; }
+
+  int GetFrameCount() const { return frame_count_; }
+
+  int GetRepetitionCount() const { return repetition_count_; }
+
+  // Calls |result| on the IO task runner with frame |index|, decoding it and
+  // the frames after it first if they aren't cached yet. |result| is always
+  // called, on the thread that collects the cache if that happens first.
+  void GetFrame(int index, FrameResult result);
+
+  // Whether frame |index| is at the position of the codecs that share the
+  // cache, i.e. whether it is the frame requested last or the one after it.
+  // Always true if no frame has been requested yet. A codec that requests any
+  // other frame plays the image at another position and must not share the
+  // cache, as the codecs would keep evicting each other's frames.
+  bool IsAtPosition(int index);
+
+  // Creates a cache of the same image that is not shared yet, for a codec
+  // that plays it at another position. Returns null if the image can't be
+  // decoded again.
+  std::shared_ptr<AnimatedFrameCache> CreateUnshared() const;
+
+ private:
+  struct Slot {
+    // The frame held in the slot, or -1 if there is none.
+    int index = -1;
+    SkBitmap bitmap;
+    int duration = 0;
+    // The frame uploaded for the first codec that requested it.
+    sk_sp<SkImage> image;
+  };
+
+  const sk_sp<SkData> data_;
+  const std::unique_ptr<SkCodec> codec_;
+  const int frame_count_;
+  const int repetition_count_;
+  const fml::RefPtr<fml::TaskRunner> io_task_runner_;
+  const std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner_;
+  const fml::WeakPtr<IOManager> io_manager_;
+  const size_t lookahead_;
+
+  std::mutex mutex_;
+  std::vector<Slot> slots_;
+  std::unordered_multimap<int, FrameResult> waiting_results_;
+  // The frame requested last, or -1 if there is none.
+  int position_ = -1;
+  // The frames the decode task decodes next.
+  int window_start_ = 0;
+  int next_decode_ = 0;
+  int decodes_remaining_ = 0;
+  bool decoding_ = false;
+  // The frame being decoded, or -1 if there is none.
+  int decoding_index_ = -1;
+
+  // The members below are only accessed by the decode task, which never runs
+  // more than once at a time.
+  //
+  // The last decoded frame that's required to decode any subsequent frames.
+  SkBitmap required_frame_;
+  int required_frame_index_ = -1;
+
+  // Must be called with |mutex_| held.
+  int FindSlot(int index) const;
+
+  // Must be called with |mutex_| held.
+  void ScheduleDecodes(int index);
+
+  void DecodeFrames();
+
+  bool DecodeFrame(int index, SkBitmap* bitmap, int* duration);
+
+  void DeliverFrame(int index, FrameResult result);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(AnimatedFrameCache);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_ANIMATED_FRAME_CACHE_H_
@@ -229,6 +229,10 @@ static void InstantiateImageCodec(Dart_NativeArguments args) {
     descriptor.data = std::move(buffer);
 
     ui_codec = fml::MakeRefCounted<SingleFrameCodec>(std::move(descriptor));
+  } else if (auto decoder = UIDartState::Current()->GetImageDecoder()) {
+    // Codecs of the same animated image share its decoded frames.
+    ui_codec = fml::MakeRefCounted<MultiFrameCodec>(
+        decoder->GetAnimatedFrameCache(std::move(buffer), std::move(codec)));
   } else {
     ui_codec = fml::MakeRefCounted<MultiFrameCodec>(std::move(codec));
   }
@@ -238,14 +242,17 @@ static void InstantiateImageCodec(Dart_NativeArguments args) {
 
 IMPLEMENT_WRAPPERTYPEINFO(ui, Codec);
 
-#define FOR_EACH_BINDING(V) \
-  V(Codec, getNextFrame)    \
-  V(Codec, frameCount)      \
-  V(Codec, repetitionCount) \
+#define FOR_EACH_BINDING(V)   \
+  V(Codec, getNextFrame)      \
+  V(Codec, frameCount)        \
+  V(Codec, repetitionCount)   \
+  V(Codec, setDecodePriority) \
   V(Codec, dispose)
 
 FOR_EACH_BINDING(DART_NATIVE_CALLBACK)
 
+void Codec::setDecodePriority(int priority) {}
+
 void Codec::dispose() {
   ClearDartWrapper();
 }
@@ -32,7 +32,11 @@ class Codec : public RefCountedDartWrappable<Codec> {
 
   virtual Dart_Handle getNextFrame(Dart_Handle callback_handle) = 0;
 
-  void dispose();
+  // Sets the priority of the decodes of the codec that have not started yet.
+  // Codecs that don't use the image decoder ignore it.
+  virtual void setDecodePriority(int priority);
+
+  virtual void dispose();
 
   static void RegisterNatives(tonic::DartLibraryNatives* natives);
 };
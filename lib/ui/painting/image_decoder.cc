@@ -5,8 +5,12 @@
 #include "flutter/lib/ui/painting/image_decoder.h"
 
 #include <algorithm>
+#include <string_view>
+#include <thread>
 
+#include "flutter/fml/hash_combine.h"
 #include "flutter/fml/make_copyable.h"
+#include "third_party/skia/include/codec/SkAndroidCodec.h"
 #include "third_party/skia/include/codec/SkCodec.h"
 #include "third_party/skia/src/codec/SkCodecImageGenerator.h"
 
@@ -15,6 +19,25 @@ namespace {
 
 constexpr double kAspectRatioChangedThreshold = 0.01;
 
+// The number of bytes hashed at either end of the encoded data. Hashing all of
+// it would take milliseconds on the UI thread for large images.
+constexpr size_t kHashedByteCount = 4096;
+
+// Images with less data than this are compared on the UI thread. The data of
+// larger ones is only shared if it is the same buffer.
+constexpr size_t kMaxComparedByteCount = 64 * 1024;
+
+size_t HashData(const SkData& data) {
+  const char* bytes = reinterpret_cast<const char*>(data.bytes());
+  const size_t size = data.size();
+  const size_t head = std::min(size, kHashedByteCount);
+  const size_t tail = std::min(size - head, kHashedByteCount);
+  return fml::HashCombine(
+      size, std::hash<std::string_view>()(std::string_view(bytes, head)),
+      std::hash<std::string_view>()(
+          std::string_view(bytes + size - tail, tail)));
+}
+
 }  // namespace
 
 ImageDecoder::ImageDecoder(
@@ -24,13 +47,176 @@ ImageDecoder::ImageDecoder(
     : runners_(std::move(runners)),
       concurrent_task_runner_(std::move(concurrent_task_runner)),
       io_manager_(std::move(io_manager)),
+      max_decodes_in_flight_(
+          std::max<size_t>(std::thread::hardware_concurrency(), 1)),
       weak_factory_(this) {
   FML_DCHECK(runners_.IsValid());
   FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread())
       << "The image decoder must be created & collected on the UI thread.";
 }
 
-ImageDecoder::~ImageDecoder() = default;
+ImageDecoder::~ImageDecoder() {
+  // Decodes that haven't started yet would otherwise never complete, and the
+  // callers of |Decode| may be holding on to state until they do.
+  auto pending_decodes = std::move(pending_decodes_);
+  for (auto& pending : pending_decodes) {
+    pending.second.result({}, std::move(pending.second.flow));
+  }
+}
+
+void ImageDecoder::SetCacheMaxBytes(size_t max_bytes) {
+  FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+  cache_max_bytes_ = max_bytes;
+  EvictCachedImages(cache_max_bytes_);
+}
+
+std::shared_ptr<AnimatedFrameCache> ImageDecoder::GetAnimatedFrameCache(
+    sk_sp<SkData> data,
+    std::unique_ptr<SkCodec> codec) {
+  FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+  // Forget the images that no codec plays anymore.
+  for (auto it = animated_frame_caches_.begin();
+       it != animated_frame_caches_.end();) {
+    if (it->second.expired()) {
+      it = animated_frame_caches_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  const size_t hash = HashData(*data);
+  auto range = animated_frame_caches_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    auto frames = it->second.lock();
+    // Codecs that have started playing the image are at another position
+    // than the new codec.
+    if (!frames || !frames->IsAtPosition(0)) {
+      continue;
+    }
+    const auto& frames_data = frames->GetData();
+    if (frames_data == data ||
+        (data->size() <= kMaxComparedByteCount &&
+         frames_data->equals(data.get()))) {
+      return frames;
+    }
+  }
+
+  auto frames = std::make_shared<AnimatedFrameCache>(
+      std::move(data), std::move(codec), runners_.GetIOTaskRunner(),
+      concurrent_task_runner_, io_manager_, animated_image_lookahead_);
+  animated_frame_caches_.emplace(hash, frames);
+  return frames;
+}
+
+void ImageDecoder::SetAnimatedImageLookahead(size_t frame_count) {
+  FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+  animated_image_lookahead_ = frame_count;
+}
+
+void ImageDecoder::PurgeCache() {
+  FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+  TRACE_EVENT0("flutter", "ImageDecoder::PurgeCache");
+  EvictCachedImages(0);
+}
+
+ImageDecoder::CacheStats ImageDecoder::GetCacheStats() const {
+  FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+  CacheStats stats = cache_stats_;
+  stats.entry_count = cache_.size();
+  return stats;
+}
+
+void ImageDecoder::TraceCacheStatsToTimeline() const {
+#if !FLUTTER_RELEASE
+  if (cache_max_bytes_ == 0) {
+    return;
+  }
+  FML_TRACE_COUNTER("flutter", "ImageDecoderCache", 0,         //
+                    "Entries", cache_.size(),                  //
+                    "MBytes", cache_stats_.byte_count * 1e-6,  //
+                    "Hits", cache_stats_.hits,                 //
+                    "Misses", cache_stats_.misses,             //
+                    "Evictions", cache_stats_.evictions        //
+  );
+#endif  // !FLUTTER_RELEASE
+}
+
+std::vector<std::list<ImageDecoder::CacheEntry>::iterator>
+ImageDecoder::FindCachedImages(const ImageDescriptor& descriptor,
+                               size_t hash) {
+  std::vector<std::list<CacheEntry>::iterator> entries;
+  auto range = cache_index_.equal_range(hash);
+  for (auto indexed = range.first; indexed != range.second; ++indexed) {
+    auto entry = indexed->second;
+    if (entry->target_width == descriptor.target_width &&
+        entry->target_height == descriptor.target_height &&
+        entry->image_upscaling == descriptor.image_upscaling &&
+        entry->data->size() == descriptor.data->size()) {
+      entries.push_back(entry);
+    }
+  }
+  return entries;
+}
+
+void ImageDecoder::CacheImage(const ImageDescriptor& descriptor,
+                              size_t hash,
+                              const SkiaGPUObject<SkImage>& image) {
+  for (auto entry : FindCachedImages(descriptor, hash)) {
+    if (image.get() && entry->image.get() == image.get()) {
+      cache_stats_.hits++;
+      cache_.splice(cache_.begin(), cache_, entry);
+      return;
+    }
+  }
+  cache_stats_.misses++;
+
+  // Images without an unref queue can't be shared safely.
+  if (!image.get() || !image.queue()) {
+    return;
+  }
+  for (auto entry : FindCachedImages(descriptor, hash)) {
+    // Another decode of the same data has completed first.
+    if (entry->data == descriptor.data) {
+      return;
+    }
+  }
+  const size_t byte_count =
+      image.get()->imageInfo().computeMinByteSize() + descriptor.data->size();
+  if (byte_count > cache_max_bytes_) {
+    return;
+  }
+  EvictCachedImages(cache_max_bytes_ - byte_count);
+
+  CacheEntry entry;
+  entry.hash = hash;
+  entry.data = descriptor.data;
+  entry.target_width = descriptor.target_width;
+  entry.target_height = descriptor.target_height;
+  entry.image_upscaling = descriptor.image_upscaling;
+  entry.image = {image.get(), image.queue()};
+  entry.byte_count = byte_count;
+  cache_.push_front(std::move(entry));
+  cache_index_.emplace(hash, cache_.begin());
+  cache_stats_.byte_count += byte_count;
+}
+
+void ImageDecoder::EvictCachedImages(size_t max_bytes) {
+  while (cache_stats_.byte_count > max_bytes) {
+    auto entry = std::prev(cache_.end());
+    auto range = cache_index_.equal_range(entry->hash);
+    for (auto indexed = range.first; indexed != range.second; ++indexed) {
+      if (indexed->second == entry) {
+        cache_index_.erase(indexed);
+        break;
+      }
+    }
+    cache_stats_.byte_count -= entry->byte_count;
+    cache_stats_.evictions++;
+    // The texture of the image is released on the IO thread by its unref
+    // queue.
+    cache_.erase(entry);
+  }
+}
 
 static double AspectRatio(const SkISize& size) {
   return static_cast<double>(size.width()) / size.height();
@@ -248,6 +434,126 @@ sk_sp<SkImage> ImageFromCompressedData(sk_sp<SkData> data,
   return ResizeRasterImage(std::move(image), resized_dimensions, flow);
 }
 
+sk_sp<SkImage> ImageRegionFromCompressedData(
+    sk_sp<SkData> data,
+    const SkIRect& region,
+    std::optional<uint32_t> target_width,
+    std::optional<uint32_t> target_height,
+    ImageUpscalingMode image_upscaling,
+    const fml::tracing::TraceFlow& flow) {
+  TRACE_EVENT0("flutter", __FUNCTION__);
+  flow.Step(__FUNCTION__);
+
+  auto codec = SkCodec::MakeFromData(data);
+  if (codec == nullptr) {
+    return nullptr;
+  }
+
+  // The region is in the coordinates of the oriented image, which the codec
+  // can't decode subsets of. Decode the whole image instead.
+  if (codec->getOrigin() != kTopLeft_SkEncodedOrigin) {
+    auto image = SkImage::MakeFromEncoded(std::move(data));
+    SkIRect subset = region;
+    if (!image || !subset.intersect(image->bounds())) {
+      return nullptr;
+    }
+    auto resized_dimensions = GetResizedDimensions(
+        subset.size(), target_width, target_height, image_upscaling);
+    return ResizeRasterImage(image->makeSubset(subset), resized_dimensions,
+                             flow);
+  }
+
+  SkIRect subset = region;
+  if (!subset.intersect(SkIRect::MakeSize(codec->dimensions()))) {
+    FML_LOG(ERROR) << "The region to decode is outside of the image.";
+    return nullptr;
+  }
+
+  auto resized_dimensions = GetResizedDimensions(
+      subset.size(), target_width, target_height, image_upscaling);
+  if (resized_dimensions.isEmpty()) {
+    return nullptr;
+  }
+
+  // Skip the rows and columns of the region that don't contribute to the
+  // resized image. Codecs decode them cheaply when the sample size is a power
+  // of two.
+  const double scale =
+      std::max(static_cast<double>(resized_dimensions.width()) /
+                   subset.width(),
+               static_cast<double>(resized_dimensions.height()) /
+                   subset.height());
+  int sample_size = 1;
+  while (sample_size * 2 <= 1.0 / scale) {
+    sample_size *= 2;
+  }
+
+  auto android_codec = SkAndroidCodec::MakeFromCodec(std::move(codec));
+  if (android_codec == nullptr) {
+    return nullptr;
+  }
+
+  // Codecs may only support subsets with aligned edges, so the decoded subset
+  // can be larger than the region.
+  SkIRect decode_subset = subset;
+  if (!android_codec->getSupportedSubset(&decode_subset)) {
+    FML_LOG(ERROR) << "The codec can't decode a region of the image.";
+    return nullptr;
+  }
+
+  const auto decode_info =
+      android_codec->getInfo()
+          .makeDimensions(android_codec->getSampledSubsetDimensions(
+              sample_size, decode_subset))
+          .makeColorType(kN32_SkColorType)
+          .makeAlphaType(android_codec->computeOutputAlphaType(false));
+
+  SkBitmap decoded_bitmap;
+  if (!decoded_bitmap.tryAllocPixels(decode_info)) {
+    FML_LOG(ERROR) << "Failed to allocate memory for bitmap of size "
+                   << decode_info.computeMinByteSize() << "B";
+    return nullptr;
+  }
+
+  SkAndroidCodec::AndroidOptions options;
+  options.fSampleSize = sample_size;
+  options.fSubset = &decode_subset;
+  const auto result = android_codec->getAndroidPixels(
+      decode_info, decoded_bitmap.getPixels(), decoded_bitmap.rowBytes(),
+      &options);
+  if (result != SkCodec::kSuccess && result != SkCodec::kIncompleteInput) {
+    FML_LOG(ERROR) << "Could not decode the region of the image.";
+    return nullptr;
+  }
+
+  // Marking this as immutable makes the MakeFromBitmap call share the pixels
+  // instead of copying.
+  decoded_bitmap.setImmutable();
+  auto decoded_image = SkImage::MakeFromBitmap(decoded_bitmap);
+  if (!decoded_image) {
+    return nullptr;
+  }
+
+  SkIRect crop =
+      SkRect::MakeXYWH(
+          static_cast<float>(subset.x() - decode_subset.x()) / sample_size,
+          static_cast<float>(subset.y() - decode_subset.y()) / sample_size,
+          static_cast<float>(subset.width()) / sample_size,
+          static_cast<float>(subset.height()) / sample_size)
+          .roundOut();
+  if (!crop.intersect(decoded_image->bounds())) {
+    return nullptr;
+  }
+  if (crop != decoded_image->bounds()) {
+    decoded_image = decoded_image->makeSubset(crop);
+    if (!decoded_image) {
+      return nullptr;
+    }
+  }
+
+  return ResizeRasterImage(std::move(decoded_image), resized_dimensions, flow);
+}
+
 static SkiaGPUObject<SkImage> UploadRasterImage(
     sk_sp<SkImage> image,
     fml::WeakPtr<IOManager> io_manager,
@@ -304,58 +610,203 @@ static SkiaGPUObject<SkImage> UploadRasterImage(
   return result;
 }
 
-void ImageDecoder::Decode(ImageDescriptor descriptor,
-                          const ImageResult& callback) {
+ImageDecoder::DecodeId ImageDecoder::Decode(ImageDescriptor descriptor,
+                                            const ImageResult& callback) {
   TRACE_EVENT0("flutter", __FUNCTION__);
   fml::tracing::TraceFlow flow(__FUNCTION__);
 
   FML_DCHECK(callback);
   FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
 
+  const DecodeId id = ++last_decode_id_;
+
+  // Images decoded from pixels are not cached, since hashing them would cost
+  // about as much as decoding them. Neither are regions, which are decoded
+  // from large images that their tiled images cache the regions of.
+  const bool cacheable = cache_max_bytes_ > 0 && descriptor.data &&
+                         descriptor.data->size() > 0 &&
+                         !descriptor.decompressed_image_info &&
+                         !descriptor.region;
+  ImageResult on_result = callback;
+  std::optional<SkiaGPUObject<SkImage>> cached_image;
+  std::vector<CachedCandidate> cached_candidates;
+  if (cacheable) {
+    // Only the same data buffer is a hit here. Comparing all of the data of
+    // the other candidates would stall the UI thread, so the worker does that.
+    const size_t hash = HashData(*descriptor.data);
+    for (auto entry : FindCachedImages(descriptor, hash)) {
+      if (entry->data == descriptor.data) {
+        cache_stats_.hits++;
+        cache_.splice(cache_.begin(), cache_, entry);
+        cached_image.emplace(entry->image.get(), entry->image.queue());
+        break;
+      }
+      cached_candidates.push_back(
+          {entry->data, {entry->image.get(), entry->image.queue()}});
+    }
+    if (!cached_image) {
+      ImageDescriptor key;
+      key.data = descriptor.data;
+      key.target_width = descriptor.target_width;
+      key.target_height = descriptor.target_height;
+      key.image_upscaling = descriptor.image_upscaling;
+      on_result = [decoder = GetWeakPtr(), key = std::move(key), hash,
+                   callback](SkiaGPUObject<SkImage> image) {
+        if (decoder) {
+          decoder->CacheImage(key, hash, image);
+        }
+        callback(std::move(image));
+      };
+    }
+  }
+
   // Always service the callback on the UI thread.
-  auto result = [callback, ui_runner = runners_.GetUITaskRunner()](
-                    SkiaGPUObject<SkImage> image,
-                    fml::tracing::TraceFlow flow) {
-    ui_runner->PostTask(fml::MakeCopyable(
-        [callback, image = std::move(image), flow = std::move(flow)]() mutable {
-          // We are going to terminate the trace flow here. Flows cannot
-          // terminate without a base trace. Add one explicitly.
-          TRACE_EVENT0("flutter", "ImageDecodeCallback");
-          flow.End();
-          callback(std::move(image));
-        }));
+  auto result = [callback = std::move(on_result),
+                 ui_runner = runners_.GetUITaskRunner(), decoder = GetWeakPtr(),
+                 id](SkiaGPUObject<SkImage> image,
+                     fml::tracing::TraceFlow flow) {
+    ui_runner->PostTask(fml::MakeCopyable([callback, image = std::move(image),
+                                           flow = std::move(flow), decoder,
+                                           id]() mutable {
+      // We are going to terminate the trace flow here. Flows cannot
+      // terminate without a base trace. Add one explicitly.
+      TRACE_EVENT0("flutter", "ImageDecodeCallback");
+      flow.End();
+      // The callback may collect the decoder, so the next decode is started
+      // first.
+      if (decoder) {
+        decoder->in_flight_decodes_.erase(id);
+        decoder->DispatchDecodes();
+      }
+      callback(std::move(image));
+    }));
   };
 
   if (!descriptor.data || descriptor.data->size() == 0) {
     result({}, std::move(flow));
+    return id;
+  }
+
+  if (cached_image) {
+    result(std::move(cached_image.value()), std::move(flow));
+    return id;
+  }
+
+  pending_decodes_.emplace(
+      id, PendingDecode{std::move(descriptor), std::move(result),
+                        std::move(flow), std::move(cached_candidates)});
+  DispatchDecodes();
+  return id;
+}
+
+void ImageDecoder::SetDecodePriority(DecodeId id, int priority) {
+  FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+  auto found = pending_decodes_.find(id);
+  if (found != pending_decodes_.end()) {
+    found->second.descriptor.priority = priority;
+  }
+}
+
+void ImageDecoder::CancelDecode(DecodeId id) {
+  FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+  auto pending = pending_decodes_.find(id);
+  if (pending != pending_decodes_.end()) {
+    TRACE_EVENT0("flutter", "ImageDecoder::CancelPendingDecode");
+    auto cancelled = std::move(pending->second);
+    pending_decodes_.erase(pending);
+    cancelled.result({}, std::move(cancelled.flow));
     return;
   }
+  auto in_flight = in_flight_decodes_.find(id);
+  if (in_flight != in_flight_decodes_.end()) {
+    in_flight->second->store(true);
+  }
+}
 
+void ImageDecoder::SetMaxDecodesInFlight(size_t max_decodes_in_flight) {
+  FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+  max_decodes_in_flight_ = std::max<size_t>(max_decodes_in_flight, 1);
+  DispatchDecodes();
+}
+
+void ImageDecoder::DispatchDecodes() {
+  while (in_flight_decodes_.size() < max_decodes_in_flight_ &&
+         !pending_decodes_.empty()) {
+    // Start the decode with the highest priority, and of those, the one
+    // requested last. While scrolling, the images requested last are the ones
+    // most likely to still be visible when they are ready.
+    auto next = pending_decodes_.begin();
+    for (auto pending = next; pending != pending_decodes_.end(); ++pending) {
+      if (pending->second.descriptor.priority >=
+          next->second.descriptor.priority) {
+        next = pending;
+      }
+    }
+    auto cancelled = std::make_shared<std::atomic_bool>(false);
+    in_flight_decodes_.emplace(next->first, cancelled);
+    auto decode = std::move(next->second);
+    pending_decodes_.erase(next);
+    StartDecode(std::move(decode), std::move(cancelled));
+  }
+}
+
+void ImageDecoder::StartDecode(PendingDecode decode,
+                               std::shared_ptr<std::atomic_bool> cancelled) {
   concurrent_task_runner_->PostTask(
-      fml::MakeCopyable([descriptor,                              //
-                         io_manager = io_manager_,                //
-                         io_runner = runners_.GetIOTaskRunner(),  //
-                         result,                                  //
-                         flow = std::move(flow)                   //
+      fml::MakeCopyable([descriptor = std::move(decode.descriptor),         //
+                         io_manager = io_manager_,                          //
+                         io_runner = runners_.GetIOTaskRunner(),            //
+                         result = std::move(decode.result),                 //
+                         flow = std::move(decode.flow),                     //
+                         candidates = std::move(decode.cached_candidates),  //
+                         cancelled                                          //
   ]() mutable {
+        if (cancelled->load()) {
+          result({}, std::move(flow));
+          return;
+        }
+
+        // Step 0: Look for a cached image decoded from the same data.
+        // On Worker.
+
+        for (auto& candidate : candidates) {
+          if (candidate.data->equals(descriptor.data.get())) {
+            result(std::move(candidate.image), std::move(flow));
+            return;
+          }
+        }
+        candidates.clear();
+
         // Step 1: Decompress the image.
         // On Worker.
 
-        auto decompressed =
-            descriptor.decompressed_image_info
-                ? ImageFromDecompressedData(
-                      std::move(descriptor.data),                  //
-                      descriptor.decompressed_image_info.value(),  //
-                      descriptor.target_width,                     //
-                      descriptor.target_height,                    //
-                      descriptor.image_upscaling,                  //
-                      flow                                         //
-                      )
-                : ImageFromCompressedData(std::move(descriptor.data),  //
-                                          descriptor.target_width,     //
-                                          descriptor.target_height,    //
-                                          descriptor.image_upscaling,  //
-                                          flow);
+        sk_sp<SkImage> decompressed;
+        if (descriptor.decompressed_image_info) {
+          decompressed = ImageFromDecompressedData(
+              std::move(descriptor.data),                  //
+              descriptor.decompressed_image_info.value(),  //
+              descriptor.target_width,                     //
+              descriptor.target_height,                    //
+              descriptor.image_upscaling,                  //
+              flow                                         //
+          );
+        } else if (descriptor.region) {
+          decompressed = ImageRegionFromCompressedData(
+              std::move(descriptor.data),  //
+              descriptor.region.value(),   //
+              descriptor.target_width,     //
+              descriptor.target_height,    //
+              descriptor.image_upscaling,  //
+              flow                         //
+          );
+        } else {
+          decompressed =
+              ImageFromCompressedData(std::move(descriptor.data),  //
+                                      descriptor.target_width,     //
+                                      descriptor.target_height,    //
+                                      descriptor.image_upscaling,  //
+                                      flow);
+        }
 
         if (!decompressed) {
           FML_LOG(ERROR) << "Could not decompress image.";
@@ -367,8 +818,14 @@ void ImageDecoder::Decode(ImageDescriptor descriptor,
         // On IO Thread.
 
         io_runner->PostTask(fml::MakeCopyable([io_manager, decompressed, result,
+                                               cancelled,
                                                flow =
                                                    std::move(flow)]() mutable {
+          if (cancelled->load()) {
+            result({}, std::move(flow));
+            return;
+          }
+
           if (!io_manager) {
             FML_LOG(ERROR) << "Could not acquire IO manager.";
             return result({}, std::move(flow));
@@ -5,8 +5,13 @@
 #ifndef FLUTTER_LIB_UI_PAINTING_IMAGE_DECODER_H_
 #define FLUTTER_LIB_UI_PAINTING_IMAGE_DECODER_H_
 
+#include <atomic>
+#include <list>
+#include <map>
 #include <memory>
 #include <optional>
+#include <unordered_map>
+#include <vector>
 
 #include "flutter/common/task_runners.h"
 #include "flutter/flow/skia_gpu_object.h"
@@ -15,9 +20,11 @@
 #include "flutter/fml/mapping.h"
 #include "flutter/fml/trace_event.h"
 #include "flutter/lib/ui/io_manager.h"
+#include "flutter/lib/ui/painting/animated_frame_cache.h"
 #include "third_party/skia/include/core/SkData.h"
 #include "third_party/skia/include/core/SkImage.h"
 #include "third_party/skia/include/core/SkImageInfo.h"
+#include "third_party/skia/include/core/SkRect.h"
 #include "third_party/skia/include/core/SkRefCnt.h"
 #include "third_party/skia/include/core/SkSize.h"
 
@@ -31,6 +38,14 @@ enum class ImageUpscalingMode { kAllowed, kNotAllowed };
 // accessed and collected on the UI thread (typically the engine or its runtime
 // controller). None of the expensive operations performed by this component
 // occur in a frame pipeline.
+//
+// The images decoded from compressed data are cached by the contents of the
+// data and the requested dimensions, so decoding the same image again returns
+// the image that is already resident instead of decoding and uploading it
+// again.
+//
+// Only a limited number of decodes are in flight at once. The others wait on
+// the UI thread, where they can still be reprioritized or cancelled cheaply.
 class ImageDecoder {
  public:
   ImageDecoder(
@@ -48,28 +63,138 @@ class ImageDecoder {
   struct ImageDescriptor {
     sk_sp<SkData> data;
     std::optional<ImageInfo> decompressed_image_info;
+    // Only decode this rectangle of the compressed image, in image pixels.
+    // The target dimensions are those of the decoded region.
+    std::optional<SkIRect> region;
     std::optional<uint32_t> target_width;
     std::optional<uint32_t> target_height;
     ImageUpscalingMode image_upscaling = ImageUpscalingMode::kNotAllowed;
+    // Decodes with a higher priority are started first. Of the decodes with
+    // the same priority, the one requested last is started first.
+    int priority = 0;
   };
 
   using ImageResult = std::function<void(SkiaGPUObject<SkImage>)>;
 
+  using DecodeId = uint64_t;
+
   // Takes an image descriptor and returns a handle to a texture resident on the
   // GPU. All image decompression and resizes are done on a worker thread
   // concurrently. Texture upload is done on the IO thread and the result
   // returned back on the UI thread. On error, the texture is null but the
   // callback is guaranteed to return on the UI thread.
-  void Decode(ImageDescriptor descriptor, const ImageResult& result);
+  DecodeId Decode(ImageDescriptor descriptor, const ImageResult& result);
+
+  // Changes the priority of a decode that has not started yet.
+  void SetDecodePriority(DecodeId id, int priority);
+
+  // Cancels a decode. Its callback is invoked with a null texture unless the
+  // decode has already completed.
+  void CancelDecode(DecodeId id);
+
+  // Limits the number of decodes in flight on the worker pool and the IO
+  // thread. Defaults to the number of hardware threads.
+  void SetMaxDecodesInFlight(size_t max_decodes_in_flight);
 
   fml::WeakPtr<ImageDecoder> GetWeakPtr() const;
 
+  struct CacheStats {
+    size_t entry_count = 0;
+    size_t byte_count = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+  };
+
+  // Limits the memory used by the cached images, evicting the least recently
+  // used ones. Zero disables the cache.
+  void SetCacheMaxBytes(size_t max_bytes);
+
+  // Evicts all the cached images, e.g. when memory is low.
+  void PurgeCache();
+
+  CacheStats GetCacheStats() const;
+
+  // Emits the size and hit rate of the cache as timeline counters.
+  void TraceCacheStatsToTimeline() const;
+
+  // Returns the frames of the animated image |data|, which are shared by the
+  // codecs of the image that are alive and about to show its first frame.
+  // |codec| decodes the frames if there are no such codecs.
+  std::shared_ptr<AnimatedFrameCache> GetAnimatedFrameCache(
+      sk_sp<SkData> data,
+      std::unique_ptr<SkCodec> codec);
+
+  // Sets the number of frames of animated images that are decoded ahead of the
+  // frame being shown. Zero decodes each frame when it is requested. Only
+  // affects the frames of images that are not being played yet.
+  void SetAnimatedImageLookahead(size_t frame_count);
+
  private:
+  struct CacheEntry {
+    size_t hash = 0;
+    sk_sp<SkData> data;
+    std::optional<uint32_t> target_width;
+    std::optional<uint32_t> target_height;
+    ImageUpscalingMode image_upscaling = ImageUpscalingMode::kNotAllowed;
+    SkiaGPUObject<SkImage> image;
+    size_t byte_count = 0;
+  };
+
+  // A cached image that may have been decoded from the same data as a pending
+  // decode. The data is compared on the worker before decoding.
+  struct CachedCandidate {
+    sk_sp<SkData> data;
+    SkiaGPUObject<SkImage> image;
+  };
+
+  struct PendingDecode {
+    ImageDescriptor descriptor;
+    std::function<void(SkiaGPUObject<SkImage>, fml::tracing::TraceFlow)>
+        result;
+    fml::tracing::TraceFlow flow;
+    std::vector<CachedCandidate> cached_candidates;
+  };
+
   TaskRunners runners_;
   std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner_;
   fml::WeakPtr<IOManager> io_manager_;
+  size_t max_decodes_in_flight_;
+  DecodeId last_decode_id_ = 0;
+  std::map<DecodeId, PendingDecode> pending_decodes_;
+  std::unordered_map<DecodeId, std::shared_ptr<std::atomic_bool>>
+      in_flight_decodes_;
+  // The cached images, most recently used first.
+  std::list<CacheEntry> cache_;
+  std::unordered_multimap<size_t, std::list<CacheEntry>::iterator>
+      cache_index_;
+  size_t cache_max_bytes_ = 0;
+  CacheStats cache_stats_;
+  std::unordered_multimap<size_t, std::weak_ptr<AnimatedFrameCache>>
+      animated_frame_caches_;
+  size_t animated_image_lookahead_ = 0;
   fml::WeakPtrFactory<ImageDecoder> weak_factory_;
 
+  // Returns the images cached for the dimensions of |descriptor| whose data
+  // has the same size and |hash| as its data. Their data may still differ.
+  std::vector<std::list<CacheEntry>::iterator> FindCachedImages(
+      const ImageDescriptor& descriptor,
+      size_t hash);
+
+  // Records the result of a decode that missed the cache on the UI thread.
+  // |image| is either a cached image whose data turned out to be the same, or
+  // a newly decoded image that is cached.
+  void CacheImage(const ImageDescriptor& descriptor,
+                  size_t hash,
+                  const SkiaGPUObject<SkImage>& image);
+
+  void EvictCachedImages(size_t max_bytes);
+
+  void DispatchDecodes();
+
+  void StartDecode(PendingDecode decode,
+                   std::shared_ptr<std::atomic_bool> cancelled);
+
   FML_DISALLOW_COPY_AND_ASSIGN(ImageDecoder);
 };
 
@@ -79,6 +204,17 @@ sk_sp<SkImage> ImageFromCompressedData(sk_sp<SkData> data,
                                        ImageUpscalingMode image_upscaling,
                                        const fml::tracing::TraceFlow& flow);
 
+// Decodes the |region| of the compressed image without decoding the rest of
+// it where the codec supports that, skipping the rows and columns that the
+// resized region doesn't need.
+sk_sp<SkImage> ImageRegionFromCompressedData(
+    sk_sp<SkData> data,
+    const SkIRect& region,
+    std::optional<uint32_t> target_width,
+    std::optional<uint32_t> target_height,
+    ImageUpscalingMode image_upscaling,
+    const fml::tracing::TraceFlow& flow);
+
 }  // namespace flutter
 
 #endif  // FLUTTER_LIB_UI_PAINTING_IMAGE_DECODER_H_
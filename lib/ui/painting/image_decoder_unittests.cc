@@ -2,11 +2,20 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <cmath>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+
 #include "flutter/common/task_runners.h"
 #include "flutter/fml/mapping.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
 #include "flutter/fml/synchronization/waitable_event.h"
+#include "flutter/lib/ui/painting/image.h"
 #include "flutter/lib/ui/painting/image_decoder.h"
+#include "flutter/lib/ui/painting/incremental_codec.h"
 #include "flutter/lib/ui/painting/multi_frame_codec.h"
+#include "flutter/lib/ui/painting/tiled_image.h"
 #include "flutter/runtime/dart_vm.h"
 #include "flutter/runtime/dart_vm_lifecycle.h"
 #include "flutter/testing/dart_isolate_runner.h"
@@ -16,6 +25,8 @@
 #include "flutter/testing/test_gl_surface.h"
 #include "flutter/testing/testing.h"
 #include "third_party/skia/include/codec/SkCodec.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/tonic/converter/dart_converter.h"
 
 namespace flutter {
 namespace testing {
@@ -320,6 +331,532 @@ TEST_F(ImageDecoderFixtureTest, CanDecodeWithoutAGPUContext) {
   latch.Wait();
 }
 
+TEST_F(ImageDecoderFixtureTest, DecodedImagesAreCached) {
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  TaskRunners runners(GetCurrentTestName(),         // label
+                      CreateNewThread("platform"),  // platform
+                      CreateNewThread("raster"),    // raster
+                      CreateNewThread("ui"),        // ui
+                      CreateNewThread("io")         // io
+  );
+
+  fml::AutoResetWaitableEvent latch;
+
+  std::unique_ptr<IOManager> io_manager;
+  std::unique_ptr<ImageDecoder> image_decoder;
+  sk_sp<SkImage> first_image;
+
+  auto release_io_manager = [&]() {
+    io_manager.reset();
+    latch.Signal();
+  };
+
+  auto make_descriptor = [](sk_sp<SkData> data) {
+    ImageDecoder::ImageDescriptor image_descriptor;
+    image_descriptor.data = std::move(data);
+    image_descriptor.target_width = 100;
+    return image_descriptor;
+  };
+
+  auto decode_image = [&]() {
+    image_decoder = std::make_unique<ImageDecoder>(
+        runners, loop->GetTaskRunner(), io_manager->GetWeakIOManager());
+    image_decoder->SetCacheMaxBytes(16 * 1024 * 1024);
+
+    auto data = OpenFixtureAsSkData("DashInNooglerHat.jpg");
+    ASSERT_TRUE(data);
+
+    // The second decode of a copy of the same data returns the same image.
+    ImageDecoder::ImageResult second_callback =
+        [&, data](SkiaGPUObject<SkImage> image) {
+          ASSERT_TRUE(image.get());
+          ASSERT_EQ(image.get(), first_image);
+          auto stats = image_decoder->GetCacheStats();
+          ASSERT_EQ(stats.entry_count, 1u);
+          ASSERT_EQ(stats.hits, 1u);
+          ASSERT_EQ(stats.misses, 1u);
+
+          // A different target size is decoded again.
+          auto resized = make_descriptor(data);
+          resized.target_width = 50;
+          image_decoder->Decode(
+              std::move(resized), [&](SkiaGPUObject<SkImage> image) {
+                ASSERT_TRUE(image.get());
+                ASSERT_NE(image.get(), first_image);
+                ASSERT_EQ(image_decoder->GetCacheStats().entry_count, 2u);
+
+                image_decoder->PurgeCache();
+                auto stats = image_decoder->GetCacheStats();
+                ASSERT_EQ(stats.entry_count, 0u);
+                ASSERT_EQ(stats.byte_count, 0u);
+                ASSERT_EQ(stats.evictions, 2u);
+                image_decoder.reset();
+                first_image.reset();
+                runners.GetIOTaskRunner()->PostTask(release_io_manager);
+              });
+        };
+
+    ImageDecoder::ImageResult first_callback =
+        [&, data, second_callback](SkiaGPUObject<SkImage> image) {
+          ASSERT_TRUE(image.get());
+          first_image = image.get();
+          image_decoder->Decode(
+              make_descriptor(SkData::MakeWithCopy(data->data(), data->size())),
+              second_callback);
+        };
+    image_decoder->Decode(make_descriptor(data), first_callback);
+  };
+
+  auto setup_io_manager_and_decode = [&]() {
+    io_manager =
+        std::make_unique<TestIOManager>(runners.GetIOTaskRunner(), false);
+    runners.GetUITaskRunner()->PostTask(decode_image);
+  };
+
+  runners.GetIOTaskRunner()->PostTask(setup_io_manager_and_decode);
+
+  latch.Wait();
+}
+
+// Returns an uncompressed 24-bit BMP of a black 64x64 image with one white
+// pixel in the row |white_row|. Images that only differ in the middle rows
+// have the same size and the same bytes at either end.
+static sk_sp<SkData> MakeBmpData(int white_row) {
+  constexpr int kSize = 64;
+  constexpr uint32_t kHeaderSize = 54;
+  constexpr uint32_t kPixelsSize = kSize * kSize * 3;
+  std::vector<uint8_t> bytes(kHeaderSize + kPixelsSize, 0);
+  auto put = [&bytes](size_t offset, uint32_t value, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+      bytes[offset + i] = (value >> (8 * i)) & 0xFF;
+    }
+  };
+  bytes[0] = 'B';
+  bytes[1] = 'M';
+  put(2, kHeaderSize + kPixelsSize, 4);  // File size.
+  put(10, kHeaderSize, 4);               // Offset of the pixels.
+  put(14, 40, 4);                        // Info header size.
+  put(18, kSize, 4);                     // Width.
+  put(22, kSize, 4);                     // Height.
+  put(26, 1, 2);                         // Planes.
+  put(28, 24, 2);                        // Bits per pixel.
+  put(34, kPixelsSize, 4);               // Pixels size.
+  put(kHeaderSize + white_row * kSize * 3, 0xFFFFFF, 3);
+  return SkData::MakeWithCopy(bytes.data(), bytes.size());
+}
+
+TEST_F(ImageDecoderFixtureTest, CachedImagesAreMatchedByAllOfTheirData) {
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  TaskRunners runners(GetCurrentTestName(),         // label
+                      CreateNewThread("platform"),  // platform
+                      CreateNewThread("raster"),    // raster
+                      CreateNewThread("ui"),        // ui
+                      CreateNewThread("io")         // io
+  );
+
+  fml::AutoResetWaitableEvent latch;
+
+  std::unique_ptr<IOManager> io_manager;
+  std::unique_ptr<ImageDecoder> image_decoder;
+  sk_sp<SkData> first_data = MakeBmpData(0);
+  sk_sp<SkImage> first_image;
+
+  auto release_io_manager = [&]() {
+    io_manager.reset();
+    latch.Signal();
+  };
+
+  auto make_descriptor = [](sk_sp<SkData> data) {
+    ImageDecoder::ImageDescriptor image_descriptor;
+    image_descriptor.data = std::move(data);
+    return image_descriptor;
+  };
+
+  auto decode_image = [&]() {
+    image_decoder = std::make_unique<ImageDecoder>(
+        runners, loop->GetTaskRunner(), io_manager->GetWeakIOManager());
+    image_decoder->SetCacheMaxBytes(16 * 1024 * 1024);
+
+    // The data of the second image only differs from that of the first in
+    // the bytes that aren't hashed, so it is decoded again.
+    ImageDecoder::ImageResult second_callback =
+        [&](SkiaGPUObject<SkImage> image) {
+          ASSERT_TRUE(image.get());
+          ASSERT_NE(image.get(), first_image);
+          auto stats = image_decoder->GetCacheStats();
+          ASSERT_EQ(stats.entry_count, 2u);
+          ASSERT_EQ(stats.hits, 0u);
+          ASSERT_EQ(stats.misses, 2u);
+
+          // The same data buffer is a hit without a decode.
+          image_decoder->Decode(
+              make_descriptor(first_data), [&](SkiaGPUObject<SkImage> image) {
+                ASSERT_EQ(image.get(), first_image);
+                ASSERT_EQ(image_decoder->GetCacheStats().hits, 1u);
+                image_decoder.reset();
+                first_image.reset();
+                runners.GetIOTaskRunner()->PostTask(release_io_manager);
+              });
+        };
+
+    ImageDecoder::ImageResult first_callback =
+        [&, second_callback](SkiaGPUObject<SkImage> image) {
+          ASSERT_TRUE(image.get());
+          first_image = image.get();
+          image_decoder->Decode(make_descriptor(MakeBmpData(32)),
+                                second_callback);
+        };
+    image_decoder->Decode(make_descriptor(first_data), first_callback);
+  };
+
+  auto setup_io_manager_and_decode = [&]() {
+    io_manager =
+        std::make_unique<TestIOManager>(runners.GetIOTaskRunner(), false);
+    runners.GetUITaskRunner()->PostTask(decode_image);
+  };
+
+  runners.GetIOTaskRunner()->PostTask(setup_io_manager_and_decode);
+
+  latch.Wait();
+}
+
+TEST_F(ImageDecoderFixtureTest, DecodesArePrioritizedAndCancellable) {
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  TaskRunners runners(GetCurrentTestName(),         // label
+                      CreateNewThread("platform"),  // platform
+                      CreateNewThread("raster"),    // raster
+                      CreateNewThread("ui"),        // ui
+                      CreateNewThread("io")         // io
+  );
+
+  fml::AutoResetWaitableEvent latch;
+
+  std::unique_ptr<IOManager> io_manager;
+  std::unique_ptr<ImageDecoder> image_decoder;
+  std::vector<std::string> decoded;
+  bool cancelled_decode_failed = false;
+
+  auto release_io_manager = [&]() {
+    io_manager.reset();
+    latch.Signal();
+  };
+
+  auto decode_image = [&]() {
+    image_decoder = std::make_unique<ImageDecoder>(
+        runners, loop->GetTaskRunner(), io_manager->GetWeakIOManager());
+    image_decoder->SetCacheMaxBytes(0);
+    image_decoder->SetMaxDecodesInFlight(1);
+
+    auto data = OpenFixtureAsSkData("DashInNooglerHat.jpg");
+    ASSERT_TRUE(data);
+
+    auto decode = [&, data](std::string name, int priority) {
+      ImageDecoder::ImageDescriptor image_descriptor;
+      image_descriptor.data = data;
+      image_descriptor.priority = priority;
+      return image_decoder->Decode(
+          std::move(image_descriptor),
+          [&, name](SkiaGPUObject<SkImage> image) {
+            ASSERT_TRUE(image.get());
+            decoded.push_back(name);
+            if (decoded.size() == 4) {
+              image_decoder.reset();
+              runners.GetIOTaskRunner()->PostTask(release_io_manager);
+            }
+          });
+    };
+
+    // "a" starts right away. The others wait for it, and start in order of
+    // priority, the last requested first.
+    decode("a", 0);
+    decode("b", 0);
+    auto c = decode("c", 0);
+    decode("d", 0);
+    image_decoder->SetDecodePriority(c, 1);
+
+    ImageDecoder::ImageDescriptor cancelled_descriptor;
+    cancelled_descriptor.data = data;
+    auto cancelled = image_decoder->Decode(
+        std::move(cancelled_descriptor), [&](SkiaGPUObject<SkImage> image) {
+          cancelled_decode_failed = image.get() == nullptr;
+        });
+    image_decoder->CancelDecode(cancelled);
+  };
+
+  auto setup_io_manager_and_decode = [&]() {
+    io_manager =
+        std::make_unique<TestIOManager>(runners.GetIOTaskRunner(), false);
+    runners.GetUITaskRunner()->PostTask(decode_image);
+  };
+
+  runners.GetIOTaskRunner()->PostTask(setup_io_manager_and_decode);
+
+  latch.Wait();
+
+  ASSERT_EQ(decoded, (std::vector<std::string>{"a", "c", "d", "b"}));
+  ASSERT_TRUE(cancelled_decode_failed);
+}
+
+TEST_F(ImageDecoderFixtureTest, PendingDecodesFailWhenDecoderIsCollected) {
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  TaskRunners runners(GetCurrentTestName(),         // label
+                      CreateNewThread("platform"),  // platform
+                      CreateNewThread("raster"),    // raster
+                      CreateNewThread("ui"),        // ui
+                      CreateNewThread("io")         // io
+  );
+
+  fml::AutoResetWaitableEvent latch;
+
+  std::unique_ptr<IOManager> io_manager;
+  std::vector<std::string> failed;
+  size_t completed = 0;
+
+  auto release_io_manager = [&]() {
+    io_manager.reset();
+    latch.Signal();
+  };
+
+  auto decode_image = [&]() {
+    auto image_decoder = std::make_unique<ImageDecoder>(
+        runners, loop->GetTaskRunner(), io_manager->GetWeakIOManager());
+    image_decoder->SetMaxDecodesInFlight(1);
+
+    auto data = OpenFixtureAsSkData("DashInNooglerHat.jpg");
+    ASSERT_TRUE(data);
+
+    for (std::string name : {"a", "b", "c"}) {
+      ImageDecoder::ImageDescriptor image_descriptor;
+      image_descriptor.data = data;
+      image_decoder->Decode(
+          std::move(image_descriptor),
+          [&, name](SkiaGPUObject<SkImage> image) {
+            EXPECT_TRUE(runners.GetUITaskRunner()->RunsTasksOnCurrentThread());
+            if (!image.get()) {
+              failed.push_back(name);
+            }
+            if (++completed == 3) {
+              runners.GetIOTaskRunner()->PostTask(release_io_manager);
+            }
+          });
+    }
+
+    // "a" is in flight, while "b" and "c" still wait for it.
+    image_decoder.reset();
+  };
+
+  auto setup_io_manager_and_decode = [&]() {
+    io_manager =
+        std::make_unique<TestIOManager>(runners.GetIOTaskRunner(), false);
+    runners.GetUITaskRunner()->PostTask(decode_image);
+  };
+
+  runners.GetIOTaskRunner()->PostTask(setup_io_manager_and_decode);
+
+  latch.Wait();
+
+  ASSERT_EQ(completed, 3u);
+  ASSERT_EQ(failed, (std::vector<std::string>{"b", "c"}));
+}
+
+// Decodes every frame of |data| in order, each one drawn over the frame it
+// requires, which is how the frames were decoded before they were cached.
+static std::vector<SkBitmap> DecodeFramesSequentially(sk_sp<SkData> data) {
+  auto codec = SkCodec::MakeFromData(std::move(data));
+  std::vector<SkBitmap> frames;
+  if (!codec) {
+    return frames;
+  }
+  SkImageInfo info = codec->getInfo().makeColorType(kN32_SkColorType);
+  if (info.alphaType() == kUnpremul_SkAlphaType) {
+    info = info.makeAlphaType(kPremul_SkAlphaType);
+  }
+  for (int i = 0; i < codec->getFrameCount(); i++) {
+    SkCodec::FrameInfo frame_info;
+    codec->getFrameInfo(i, &frame_info);
+    SkCodec::Options options;
+    options.fFrameIndex = i;
+    SkBitmap bitmap;
+    bitmap.allocPixels(info);
+    if (frame_info.fRequiredFrame == SkCodec::kNoFrame) {
+      bitmap.eraseColor(SK_ColorTRANSPARENT);
+    } else {
+      frames[frame_info.fRequiredFrame].readPixels(bitmap.pixmap());
+      options.fPriorFrame = frame_info.fRequiredFrame;
+    }
+    EXPECT_EQ(codec->getPixels(info, bitmap.getPixels(), bitmap.rowBytes(),
+                               &options),
+              SkCodec::kSuccess);
+    frames.push_back(std::move(bitmap));
+  }
+  return frames;
+}
+
+static bool HasSamePixels(const sk_sp<SkImage>& image,
+                          const SkBitmap& expected) {
+  SkBitmap actual;
+  actual.allocPixels(expected.info());
+  if (!image->readPixels(actual.pixmap(), 0, 0)) {
+    return false;
+  }
+  for (int y = 0; y < expected.height(); y++) {
+    if (memcmp(actual.getAddr(0, y), expected.getAddr(0, y),
+               expected.info().minRowBytes()) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TEST_F(ImageDecoderFixtureTest, AnimatedFramesAreSharedAndDecodedAhead) {
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  TaskRunners runners(GetCurrentTestName(),         // label
+                      CreateNewThread("platform"),  // platform
+                      CreateNewThread("raster"),    // raster
+                      CreateNewThread("ui"),        // ui
+                      CreateNewThread("io")         // io
+  );
+
+  fml::AutoResetWaitableEvent latch;
+  std::unique_ptr<IOManager> io_manager;
+  std::shared_ptr<AnimatedFrameCache> frames;
+
+  runners.GetIOTaskRunner()->PostTask([&]() {
+    io_manager =
+        std::make_unique<TestIOManager>(runners.GetIOTaskRunner(), false);
+    latch.Signal();
+  });
+  latch.Wait();
+
+  runners.GetUITaskRunner()->PostTask([&]() {
+    ImageDecoder image_decoder(runners, loop->GetTaskRunner(),
+                               io_manager->GetWeakIOManager());
+    image_decoder.SetAnimatedImageLookahead(2);
+    auto data = OpenFixtureAsSkData("hello_loop_2.gif");
+    EXPECT_TRUE(data);
+    if (data) {
+      frames = image_decoder.GetAnimatedFrameCache(
+          data, SkCodec::MakeFromData(data));
+
+      // A copy of the same image shares the frames.
+      auto copy = SkData::MakeWithCopy(data->data(), data->size());
+      EXPECT_EQ(image_decoder.GetAnimatedFrameCache(
+                    copy, SkCodec::MakeFromData(copy)),
+                frames);
+    }
+    latch.Signal();
+  });
+  latch.Wait();
+  ASSERT_TRUE(frames);
+
+  const int frame_count = frames->GetFrameCount();
+  ASSERT_GT(frame_count, 1);
+
+  // Request every frame starting with the last one, so that the first frames
+  // decoded can't draw over the frames they require, and then the last one
+  // again as another codec would.
+  std::mutex mutex;
+  std::vector<sk_sp<SkImage>> images(frame_count + 1);
+  int remaining = frame_count + 1;
+  auto frame_index = [frame_count](int i) {
+    return (frame_count - 1 + i) % frame_count;
+  };
+  for (int i = 0; i <= frame_count; i++) {
+    frames->GetFrame(frame_index(i), [&, i](sk_sp<SkImage> image, int) {
+      EXPECT_TRUE(runners.GetIOTaskRunner()->RunsTasksOnCurrentThread());
+      std::scoped_lock lock(mutex);
+      images[i] = std::move(image);
+      if (--remaining == 0) {
+        latch.Signal();
+      }
+    });
+  }
+  latch.Wait();
+
+  const auto expected_frames =
+      DecodeFramesSequentially(OpenFixtureAsSkData("hello_loop_2.gif"));
+  ASSERT_EQ(static_cast<int>(expected_frames.size()), frame_count);
+  for (int i = 0; i <= frame_count; i++) {
+    ASSERT_TRUE(images[i]);
+    ASSERT_EQ(images[i]->dimensions(), SkISize::Make(640, 88));
+    EXPECT_TRUE(HasSamePixels(images[i], expected_frames[frame_index(i)]))
+        << "Frame " << frame_index(i) << " differs";
+  }
+
+  images.clear();
+  frames.reset();
+  runners.GetIOTaskRunner()->PostTask([&]() {
+    io_manager.reset();
+    latch.Signal();
+  });
+  latch.Wait();
+}
+
+TEST_F(ImageDecoderFixtureTest, AnimatedFramesAreOnlySharedAtTheSamePosition) {
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  TaskRunners runners(GetCurrentTestName(),         // label
+                      CreateNewThread("platform"),  // platform
+                      CreateNewThread("raster"),    // raster
+                      CreateNewThread("ui"),        // ui
+                      CreateNewThread("io")         // io
+  );
+
+  fml::AutoResetWaitableEvent latch;
+  std::unique_ptr<IOManager> io_manager;
+
+  runners.GetIOTaskRunner()->PostTask([&]() {
+    io_manager =
+        std::make_unique<TestIOManager>(runners.GetIOTaskRunner(), false);
+    latch.Signal();
+  });
+  latch.Wait();
+
+  fml::CountDownLatch frames_latch(2);
+  auto count_down = [&frames_latch](sk_sp<SkImage> image, int) {
+    EXPECT_TRUE(image);
+    frames_latch.CountDown();
+  };
+  runners.GetUITaskRunner()->PostTask([&]() {
+    ImageDecoder image_decoder(runners, loop->GetTaskRunner(),
+                               io_manager->GetWeakIOManager());
+    image_decoder.SetAnimatedImageLookahead(2);
+    auto data = OpenFixtureAsSkData("hello_loop_2.gif");
+    auto frames = image_decoder.GetAnimatedFrameCache(
+        data, SkCodec::MakeFromData(data));
+    frames->GetFrame(0, count_down);
+    frames->GetFrame(1, count_down);
+
+    // Only the frame requested last and the one after it are at the position
+    // of the codecs playing the frames.
+    EXPECT_TRUE(frames->IsAtPosition(1));
+    EXPECT_TRUE(frames->IsAtPosition(2));
+    EXPECT_FALSE(frames->IsAtPosition(0));
+    EXPECT_FALSE(frames->IsAtPosition(3));
+
+    // A new codec starts at the first frame, so it gets frames of its own.
+    auto other_frames = image_decoder.GetAnimatedFrameCache(
+        data, SkCodec::MakeFromData(data));
+    EXPECT_NE(other_frames, frames);
+    EXPECT_TRUE(other_frames->IsAtPosition(0));
+
+    auto unshared_frames = frames->CreateUnshared();
+    EXPECT_TRUE(unshared_frames);
+    EXPECT_NE(unshared_frames, frames);
+    if (unshared_frames) {
+      EXPECT_EQ(unshared_frames->GetFrameCount(), frames->GetFrameCount());
+    }
+    latch.Signal();
+  });
+  latch.Wait();
+  frames_latch.Wait();
+
+  runners.GetIOTaskRunner()->PostTask([&]() {
+    io_manager.reset();
+    latch.Signal();
+  });
+  latch.Wait();
+}
+
 TEST_F(ImageDecoderFixtureTest, CanDecodeWithResizes) {
   const auto image_dimensions =
       SkImage::MakeFromEncoded(OpenFixtureAsSkData("DashInNooglerHat.jpg"))
@@ -539,6 +1076,127 @@ TEST(ImageDecoderTest, VerifySimpleDecoding) {
             SkISize::Make(6, 2));
 }
 
+TEST(ImageDecoderTest, VerifyRegionDecoding) {
+  auto data = OpenFixtureAsSkData("DashInNooglerHat.jpg");
+  auto image = SkImage::MakeFromEncoded(data);
+  ASSERT_TRUE(image != nullptr);
+  const auto region = SkIRect::MakeXYWH(10, 20, 100, 60);
+
+  // A region at full scale has the pixels of that part of the image.
+  auto decoded_region = ImageRegionFromCompressedData(
+      data, region, std::nullopt, std::nullopt,
+      ImageUpscalingMode::kNotAllowed, fml::tracing::TraceFlow(""));
+  ASSERT_TRUE(decoded_region != nullptr);
+  ASSERT_EQ(decoded_region->dimensions(), region.size());
+
+  // A region is resized to the target dimensions.
+  ASSERT_EQ(ImageRegionFromCompressedData(data, region, 25, 15,
+                                          ImageUpscalingMode::kNotAllowed,
+                                          fml::tracing::TraceFlow(""))
+                ->dimensions(),
+            SkISize::Make(25, 15));
+
+  // Regions are clipped to the image.
+  const auto corner = SkIRect::MakeXYWH(image->width() - 10,
+                                        image->height() - 10, 100, 100);
+  ASSERT_EQ(ImageRegionFromCompressedData(data, corner, std::nullopt,
+                                          std::nullopt,
+                                          ImageUpscalingMode::kNotAllowed,
+                                          fml::tracing::TraceFlow(""))
+                ->dimensions(),
+            SkISize::Make(10, 10));
+  ASSERT_EQ(ImageRegionFromCompressedData(
+                data, SkIRect::MakeXYWH(image->width(), 0, 10, 10),
+                std::nullopt, std::nullopt, ImageUpscalingMode::kNotAllowed,
+                fml::tracing::TraceFlow("")),
+            nullptr);
+}
+
+TEST(ImageDecoderTest, VerifyRegionDecodingRespectsExifOrientation) {
+  auto data = OpenFixtureAsSkData("Horizontal.jpg");
+  auto image = SkImage::MakeFromEncoded(data);
+  ASSERT_TRUE(image != nullptr);
+  ASSERT_EQ(SkISize::Make(600, 200), image->dimensions());
+
+  ASSERT_EQ(ImageRegionFromCompressedData(
+                data, SkIRect::MakeXYWH(500, 0, 200, 200), 50, std::nullopt,
+                ImageUpscalingMode::kNotAllowed, fml::tracing::TraceFlow(""))
+                ->dimensions(),
+            SkISize::Make(50, 100));
+}
+
+TEST(ImageDecoderTest, IncrementalDecodingShowsPartialImages) {
+  auto data = OpenFixtureAsSkData("Horizontal.png");
+  ASSERT_TRUE(data != nullptr);
+  const size_t half = data->size() / 2;
+
+  IncrementalImageDecoder decoder;
+  ASSERT_FALSE(decoder.Decode());
+  ASSERT_EQ(decoder.GetImage(), nullptr);
+
+  decoder.AddBytes(data->bytes(), half);
+  ASSERT_TRUE(decoder.Decode());
+  ASSERT_FALSE(decoder.IsComplete());
+  auto partial_image = decoder.GetImage();
+  ASSERT_TRUE(partial_image != nullptr);
+  ASSERT_EQ(partial_image->dimensions(), SkISize::Make(300, 100));
+
+  // Nothing more can be decoded until more bytes arrive.
+  ASSERT_FALSE(decoder.Decode());
+
+  decoder.AddBytes(data->bytes() + half, data->size() - half);
+  decoder.Close();
+  ASSERT_TRUE(decoder.Decode());
+  ASSERT_TRUE(decoder.IsComplete());
+  ASSERT_FALSE(decoder.HasFailed());
+  ASSERT_EQ(decoder.GetImage()->dimensions(), SkISize::Make(300, 100));
+}
+
+TEST(ImageDecoderTest, IncrementalDecodingRedecodesNonIncrementalFormats) {
+  auto data = OpenFixtureAsSkData("DashInNooglerHat.jpg");
+  ASSERT_TRUE(data != nullptr);
+  const size_t half = data->size() / 2;
+
+  IncrementalImageDecoder decoder;
+  decoder.AddBytes(data->bytes(), half);
+  ASSERT_TRUE(decoder.Decode());
+  ASSERT_FALSE(decoder.IsComplete());
+  ASSERT_TRUE(decoder.GetImage() != nullptr);
+
+  decoder.AddBytes(data->bytes() + half, data->size() - half);
+  decoder.Close();
+  ASSERT_TRUE(decoder.Decode());
+  ASSERT_TRUE(decoder.IsComplete());
+  ASSERT_EQ(decoder.GetImage()->dimensions(),
+            SkImage::MakeFromEncoded(data)->dimensions());
+}
+
+TEST(ImageDecoderTest, IncrementalDecodingCompletesTruncatedImages) {
+  auto data = OpenFixtureAsSkData("Horizontal.png");
+  ASSERT_TRUE(data != nullptr);
+
+  IncrementalImageDecoder truncated;
+  truncated.AddBytes(data->bytes(), data->size() / 2);
+  truncated.Close();
+  ASSERT_TRUE(truncated.Decode());
+  ASSERT_TRUE(truncated.IsComplete());
+  ASSERT_TRUE(truncated.GetImage() != nullptr);
+
+  // Bytes added after the decoder is closed are ignored.
+  truncated.AddBytes(data->bytes(), data->size());
+  ASSERT_FALSE(truncated.Decode());
+
+  const std::string garbage = "not an image";
+  IncrementalImageDecoder invalid;
+  invalid.AddBytes(garbage.data(), garbage.size());
+  ASSERT_FALSE(invalid.Decode());
+  ASSERT_FALSE(invalid.HasFailed());
+  invalid.Close();
+  ASSERT_FALSE(invalid.Decode());
+  ASSERT_TRUE(invalid.HasFailed());
+  ASSERT_EQ(invalid.GetImage(), nullptr);
+}
+
 TEST(ImageDecoderTest, VerifySimpleDecodingNoUpscaling) {
   auto data = OpenFixtureAsSkData("Horizontal.jpg");
   auto image = SkImage::MakeFromEncoded(data);
@@ -697,5 +1355,286 @@ TEST_F(ImageDecoderFixtureTest,
   latch.Wait();
 }
 
+// Runs tiled images of DashInNooglerHat.jpg in the fixture isolate, with an
+// image decoder that decodes one tile at a time. The tiles that the tiled
+// images call back with are recorded in order.
+class TiledImageTest : public ImageDecoderFixtureTest {
+ public:
+  static constexpr int kTileSize = 64;
+
+  TiledImageTest()
+      : settings_(CreateSettingsForFixture()),
+        vm_ref_(DartVMRef::Create(settings_)),
+        runners_(GetCurrentTestName(),         // label
+                 CreateNewThread("platform"),  // platform
+                 CreateNewThread("raster"),    // raster
+                 CreateNewThread("ui"),        // ui
+                 CreateNewThread("io")         // io
+                 ),
+        loop_(fml::ConcurrentMessageLoop::Create()),
+        data_(OpenFixtureAsSkData("DashInNooglerHat.jpg")) {}
+
+  void SetUp() override {
+    AddNativeCallback(
+        "OnTile", CREATE_NATIVE_ENTRY([&](Dart_NativeArguments args) {
+          Dart_Handle handle = Dart_GetNativeArgument(args, 0);
+          sk_sp<SkImage> image;
+          if (!Dart_IsNull(handle)) {
+            intptr_t peer = 0;
+            ASSERT_FALSE(Dart_IsError(Dart_GetNativeInstanceField(
+                handle, tonic::DartWrappable::kPeerIndex, &peer)));
+            image = reinterpret_cast<CanvasImage*>(peer)->image();
+          }
+          std::scoped_lock lock(tiles_mutex_);
+          tiles_.push_back(std::move(image));
+          tiles_changed_.notify_all();
+        }));
+
+    fml::AutoResetWaitableEvent latch;
+    runners_.GetIOTaskRunner()->PostTask([&]() {
+      io_manager_ =
+          std::make_unique<TestIOManager>(runners_.GetIOTaskRunner(), false);
+      latch.Signal();
+    });
+    latch.Wait();
+    runners_.GetUITaskRunner()->PostTask([&]() {
+      decoder_ = std::make_unique<ImageDecoder>(
+          runners_, loop_->GetTaskRunner(), io_manager_->GetWeakIOManager());
+      decoder_->SetMaxDecodesInFlight(1);
+      latch.Signal();
+    });
+    latch.Wait();
+
+    isolate_ = RunDartCodeInIsolate(
+        vm_ref_, settings_, runners_, "main", {}, GetFixturesPath(),
+        io_manager_->GetWeakIOManager(), decoder_->GetWeakPtr());
+    ASSERT_TRUE(isolate_);
+    ASSERT_TRUE(data_);
+  }
+
+  void TearDown() override {
+    if (isolate_) {
+      RunInIsolate([&]() {
+        tiled_images_.clear();
+        wrappers_.clear();
+      });
+      isolate_.reset();
+    }
+
+    fml::AutoResetWaitableEvent latch;
+    runners_.GetUITaskRunner()->PostTask([&]() {
+      decoder_.reset();
+      latch.Signal();
+    });
+    latch.Wait();
+    runners_.GetIOTaskRunner()->PostTask([&]() {
+      io_manager_.reset();
+      latch.Signal();
+    });
+    latch.Wait();
+  }
+
+ protected:
+  void RunInIsolate(const std::function<void()>& closure) {
+    ASSERT_TRUE(isolate_->RunInIsolateScope([&]() {
+      closure();
+      return true;
+    }));
+  }
+
+  TiledImage* CreateTiledImage(int max_bytes) {
+    TiledImage* tiled_image = nullptr;
+    RunInIsolate([&]() {
+      Dart_Handle args[] = {
+          Dart_NewExternalTypedData(Dart_TypedData_kUint8,
+                                    const_cast<void*>(data_->data()),
+                                    data_->size()),
+          tonic::ToDart(kTileSize),
+          tonic::ToDart(max_bytes),
+      };
+      Dart_Handle handle =
+          Dart_Invoke(Dart_RootLibrary(), tonic::ToDart("createTiledImage"),
+                      3, args);
+      ASSERT_FALSE(Dart_IsError(handle));
+      intptr_t peer = 0;
+      ASSERT_FALSE(Dart_IsError(Dart_GetNativeInstanceField(
+          handle, tonic::DartWrappable::kPeerIndex, &peer)));
+      tiled_image = reinterpret_cast<TiledImage*>(peer);
+      tiled_images_.push_back(fml::Ref(tiled_image));
+      // Keeps the wrapper alive, so that the tiled image can be disposed of.
+      wrappers_.push_back(std::make_unique<DartPersistentValue>(
+          tonic::DartState::Current(), handle));
+    });
+    return tiled_image;
+  }
+
+  // Requests a tile, and returns the error message, or an empty string on
+  // success. Must be called in |RunInIsolate|.
+  std::string GetTileInIsolate(TiledImage* tiled_image,
+                               int column,
+                               int row,
+                               double scale = 1.0,
+                               int priority = 0) {
+    Dart_Handle callback = Dart_GetField(
+        Dart_RootLibrary(), Dart_NewStringFromCString("tileCallback"));
+    EXPECT_TRUE(Dart_IsClosure(callback));
+    Dart_Handle result =
+        tiled_image->getTile(column, row, scale, priority, callback);
+    return Dart_IsNull(result) ? "" : tonic::StdStringFromDart(result);
+  }
+
+  std::string GetTile(TiledImage* tiled_image,
+                      int column,
+                      int row,
+                      double scale = 1.0,
+                      int priority = 0) {
+    std::string error;
+    RunInIsolate([&]() {
+      error = GetTileInIsolate(tiled_image, column, row, scale, priority);
+    });
+    return error;
+  }
+
+  std::vector<sk_sp<SkImage>> WaitForTiles(size_t count) {
+    std::unique_lock lock(tiles_mutex_);
+    tiles_changed_.wait(lock, [&]() { return tiles_.size() >= count; });
+    return tiles_;
+  }
+
+  size_t GetTileCount() {
+    std::scoped_lock lock(tiles_mutex_);
+    return tiles_.size();
+  }
+
+  // The bytes of the decoded tiles that |tiled_image| keeps.
+  size_t GetTileBytes(TiledImage* tiled_image) {
+    size_t allocation_size = 0;
+    RunInIsolate(
+        [&]() { allocation_size = tiled_image->GetAllocationSize(); });
+    return allocation_size - data_->size() - sizeof(TiledImage);
+  }
+
+  std::vector<fml::RefPtr<TiledImage>> tiled_images_;
+
+ private:
+  Settings settings_;
+  DartVMRef vm_ref_;
+  TaskRunners runners_;
+  std::shared_ptr<fml::ConcurrentMessageLoop> loop_;
+  sk_sp<SkData> data_;
+  std::unique_ptr<TestIOManager> io_manager_;
+  std::unique_ptr<ImageDecoder> decoder_;
+  std::unique_ptr<AutoIsolateShutdown> isolate_;
+  std::vector<std::unique_ptr<DartPersistentValue>> wrappers_;
+  std::mutex tiles_mutex_;
+  std::condition_variable tiles_changed_;
+  std::vector<sk_sp<SkImage>> tiles_;
+};
+
+TEST_F(TiledImageTest, EvictsLeastRecentlyUsedTilesOverBudget) {
+  const size_t tile_bytes =
+      SkImageInfo::MakeN32Premul(kTileSize, kTileSize).computeMinByteSize();
+  TiledImage* tiled_image = CreateTiledImage(tile_bytes * 2);
+
+  ASSERT_EQ(GetTile(tiled_image, 0, 0), "");
+  ASSERT_EQ(WaitForTiles(1)[0]->dimensions(),
+            SkISize::Make(kTileSize, kTileSize));
+  ASSERT_EQ(GetTile(tiled_image, 1, 0), "");
+  WaitForTiles(2);
+  ASSERT_EQ(GetTileBytes(tiled_image), tile_bytes * 2);
+
+  // Cached tiles are returned right away.
+  ASSERT_EQ(GetTile(tiled_image, 0, 0), "");
+  ASSERT_EQ(GetTileCount(), 3u);
+
+  // Tile (1, 0) is now the least recently used, and makes room for (2, 0).
+  ASSERT_EQ(GetTile(tiled_image, 2, 0), "");
+  WaitForTiles(4);
+  ASSERT_EQ(GetTileBytes(tiled_image), tile_bytes * 2);
+  ASSERT_EQ(GetTile(tiled_image, 0, 0), "");
+  ASSERT_EQ(GetTileCount(), 5u);
+  ASSERT_EQ(GetTile(tiled_image, 1, 0), "");
+  ASSERT_EQ(GetTileCount(), 5u);
+  ASSERT_TRUE(WaitForTiles(6)[5]);
+}
+
+TEST_F(TiledImageTest, MergesAndReprioritizesPendingTiles) {
+  TiledImage* tiled_image = CreateTiledImage(0);
+
+  // Tile (0, 0) starts right away. The others wait for it, and start in
+  // order of priority, the last requested first. The scales tell the tiles
+  // apart.
+  RunInIsolate([&]() {
+    EXPECT_EQ(GetTileInIsolate(tiled_image, 0, 0, 1.0), "");
+    EXPECT_EQ(GetTileInIsolate(tiled_image, 1, 0, 0.5), "");
+    EXPECT_EQ(GetTileInIsolate(tiled_image, 2, 0, 0.25), "");
+    EXPECT_EQ(GetTileInIsolate(tiled_image, 1, 0, 0.5, 1), "");
+  });
+
+  auto tiles = WaitForTiles(4);
+  ASSERT_EQ(tiles.size(), 4u);
+  for (const auto& tile : tiles) {
+    ASSERT_TRUE(tile);
+  }
+  ASSERT_EQ(tiles[0]->width(), kTileSize);
+  ASSERT_EQ(tiles[1]->width(), kTileSize / 2);
+  ASSERT_EQ(tiles[2]->width(), kTileSize / 2);
+  ASSERT_EQ(tiles[3]->width(), kTileSize / 4);
+  // Both requests for tile (1, 0) were served by the same decode.
+  ASSERT_EQ(tiles[1], tiles[2]);
+}
+
+TEST_F(TiledImageTest, DisposeCancelsPendingTiles) {
+  TiledImage* tiled_image = CreateTiledImage(0);
+  RunInIsolate([&]() {
+    EXPECT_EQ(GetTileInIsolate(tiled_image, 0, 0), "");
+    EXPECT_EQ(GetTileInIsolate(tiled_image, 1, 0), "");
+    EXPECT_EQ(GetTileInIsolate(tiled_image, 2, 0), "");
+    tiled_image->dispose();
+  });
+  ASSERT_EQ(GetTile(tiled_image, 0, 0),
+            "The tiled image has been disposed of.");
+
+  // Decodes run one at a time, so the tile of another image is only decoded
+  // once the decodes of the disposed image have completed.
+  ASSERT_EQ(GetTile(CreateTiledImage(0), 0, 0), "");
+  auto tiles = WaitForTiles(1);
+  ASSERT_EQ(tiles.size(), 1u);
+  ASSERT_TRUE(tiles[0]);
+  // The decodes no longer hold on to the disposed image.
+  ASSERT_TRUE(tiled_images_[0]->HasOneRef());
+}
+
+TEST_F(TiledImageTest, RejectsTilesOutsideOfTheImage) {
+  TiledImage* tiled_image = CreateTiledImage(0);
+  const int columns = (tiled_image->width() + kTileSize - 1) / kTileSize;
+  const int rows = (tiled_image->height() + kTileSize - 1) / kTileSize;
+  const int max_int = std::numeric_limits<int>::max();
+  const char* outside = "The tile is outside of the image.";
+
+  ASSERT_EQ(GetTile(tiled_image, -1, 0), outside);
+  ASSERT_EQ(GetTile(tiled_image, 0, -1), outside);
+  ASSERT_EQ(GetTile(tiled_image, columns, 0), outside);
+  ASSERT_EQ(GetTile(tiled_image, 0, rows), outside);
+  // These overflow an int when multiplied by the tile size.
+  ASSERT_EQ(GetTile(tiled_image, max_int / kTileSize + 1, 0), outside);
+  ASSERT_EQ(GetTile(tiled_image, 0, max_int), outside);
+
+  const char* bad_scale = "scale must be greater than zero and at most one";
+  ASSERT_EQ(GetTile(tiled_image, 0, 0, 0.0), bad_scale);
+  ASSERT_EQ(GetTile(tiled_image, 0, 0, -1.0), bad_scale);
+  ASSERT_EQ(GetTile(tiled_image, 0, 0, 1.5), bad_scale);
+  ASSERT_EQ(GetTile(tiled_image, 0, 0, std::nan("")), bad_scale);
+
+  // The last tile is smaller when the image isn't a multiple of the tile size.
+  ASSERT_EQ(GetTile(tiled_image, columns - 1, rows - 1), "");
+  auto tiles = WaitForTiles(1);
+  ASSERT_TRUE(tiles[0]);
+  ASSERT_EQ(tiles[0]->width(),
+            tiled_image->width() - (columns - 1) * kTileSize);
+  ASSERT_EQ(tiles[0]->height(),
+            tiled_image->height() - (rows - 1) * kTileSize);
+}
+
 }  // namespace testing
 }  // namespace flutter
@@ -0,0 +1,490 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/incremental_codec.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "flutter/fml/make_copyable.h"
+#include "flutter/fml/trace_event.h"
+#include "flutter/lib/ui/painting/frame_info.h"
+#include "flutter/lib/ui/painting/image_decoder.h"
+#include "flutter/lib/ui/ui_dart_state.h"
+#include "third_party/skia/include/core/SkStream.h"
+#include "third_party/tonic/converter/dart_converter.h"
+#include "third_party/tonic/dart_args.h"
+#include "third_party/tonic/dart_binding_macros.h"
+#include "third_party/tonic/dart_library_natives.h"
+#include "third_party/tonic/logging/dart_invoke.h"
+
+using tonic::ToDart;
+
+namespace flutter {
+
+// A stream over the bytes that have arrived so far. Codecs that decode
+// incrementally read the bytes that arrive later on their next decode.
+class IncrementalImageDecoder::Stream : public SkStream {
+ public:
+  explicit Stream(std::shared_ptr<const Buffer> buffer)
+      : buffer_(std::move(buffer)) {}
+
+  // |SkStream|
+  size_t read(void* buffer, size_t size) override {
+    const size_t read = buffer_->Read(position_, buffer, size);
+    position_ += read;
+    return read;
+  }
+
+  // |SkStream|
+  size_t peek(void* buffer, size_t size) const override {
+    return buffer_->Read(position_, buffer, size);
+  }
+
+  // |SkStream|
+  bool isAtEnd() const override {
+    std::scoped_lock lock(buffer_->mutex);
+    return buffer_->closed && position_ >= buffer_->bytes.size();
+  }
+
+  // |SkStream|
+  bool rewind() override {
+    position_ = 0;
+    return true;
+  }
+
+ private:
+  const std::shared_ptr<const Buffer> buffer_;
+  size_t position_ = 0;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(Stream);
+};
+
+size_t IncrementalImageDecoder::Buffer::Read(size_t offset,
+                                             void* dst,
+                                             size_t size) const {
+  std::scoped_lock lock(mutex);
+  if (offset >= bytes.size()) {
+    return 0;
+  }
+  size = std::min(size, bytes.size() - offset);
+  // Streams skip bytes by reading them into a null buffer.
+  if (dst != nullptr) {
+    ::memcpy(dst, bytes.data() + offset, size);
+  }
+  return size;
+}
+
+sk_sp<SkData> IncrementalImageDecoder::Buffer::Snapshot() const {
+  std::scoped_lock lock(mutex);
+  return SkData::MakeWithCopy(bytes.data(), bytes.size());
+}
+
+IncrementalImageDecoder::IncrementalImageDecoder()
+    : buffer_(std::make_shared<Buffer>()) {}
+
+IncrementalImageDecoder::~IncrementalImageDecoder() = default;
+
+void IncrementalImageDecoder::AddBytes(const void* bytes, size_t length) {
+  std::scoped_lock lock(buffer_->mutex);
+  if (buffer_->closed) {
+    return;
+  }
+  const auto* begin = static_cast<const uint8_t*>(bytes);
+  buffer_->bytes.insert(buffer_->bytes.end(), begin, begin + length);
+}
+
+void IncrementalImageDecoder::Close() {
+  std::scoped_lock lock(buffer_->mutex);
+  buffer_->closed = true;
+}
+
+bool IncrementalImageDecoder::Decode() {
+  TRACE_EVENT0("flutter", __FUNCTION__);
+  if (complete_ || failed_) {
+    return false;
+  }
+
+  size_t size = 0;
+  bool closed = false;
+  {
+    std::scoped_lock lock(buffer_->mutex);
+    size = buffer_->bytes.size();
+    closed = buffer_->closed;
+  }
+  if (size == decoded_size_ && !closed) {
+    return false;
+  }
+
+  if (!codec_ && !CreateCodec()) {
+    // The header of the image may not have arrived yet.
+    decoded_size_ = size;
+    if (closed) {
+      FML_LOG(ERROR) << "Could not instantiate image codec.";
+      failed_ = true;
+    }
+    return false;
+  }
+  if (failed_) {
+    return false;
+  }
+
+  if (oriented_) {
+    if (!closed) {
+      return false;
+    }
+    image_ = ImageFromCompressedData(buffer_->Snapshot(), std::nullopt,
+                                     std::nullopt,
+                                     ImageUpscalingMode::kNotAllowed,
+                                     fml::tracing::TraceFlow(__FUNCTION__));
+    complete_ = image_ != nullptr;
+    failed_ = !complete_;
+    return complete_;
+  }
+
+  return incremental_ ? DecodeIncrementally(size, closed)
+                      : DecodeFromStart(size, closed);
+}
+
+bool IncrementalImageDecoder::CreateCodec() {
+  codec_ = SkCodec::MakeFromStream(std::make_unique<Stream>(buffer_));
+  if (!codec_) {
+    return false;
+  }
+
+  // Rows decoded before the image is rotated would end up in the wrong place,
+  // so oriented images are only decoded once they are complete.
+  if (codec_->getOrigin() != kTopLeft_SkEncodedOrigin) {
+    oriented_ = true;
+    return true;
+  }
+
+  info_ = codec_->getInfo().makeColorType(kN32_SkColorType);
+  if (info_.alphaType() == kUnpremul_SkAlphaType) {
+    info_ = info_.makeAlphaType(kPremul_SkAlphaType);
+  }
+  if (!bitmap_.tryAllocPixels(info_)) {
+    FML_LOG(ERROR) << "Failed to allocate memory for bitmap of size "
+                   << info_.computeMinByteSize() << "B";
+    failed_ = true;
+    return true;
+  }
+  // Codecs leave the rows they haven't decoded yet untouched.
+  bitmap_.eraseColor(SK_ColorTRANSPARENT);
+
+  incremental_ = codec_->startIncrementalDecode(info_, bitmap_.getPixels(),
+                                                bitmap_.rowBytes()) ==
+                 SkCodec::kSuccess;
+  return true;
+}
+
+bool IncrementalImageDecoder::DecodeIncrementally(size_t size, bool closed) {
+  const bool has_new_bytes = size > decoded_size_;
+  decoded_size_ = size;
+
+  int rows_decoded = 0;
+  switch (codec_->incrementalDecode(&rows_decoded)) {
+    case SkCodec::kSuccess:
+      has_decoded_rows_ = true;
+      complete_ = true;
+      return true;
+    case SkCodec::kIncompleteInput:
+      has_decoded_rows_ = has_decoded_rows_ || rows_decoded > 0;
+      // A truncated image is complete once no more bytes will arrive.
+      if (closed) {
+        complete_ = has_decoded_rows_;
+        failed_ = !has_decoded_rows_;
+      }
+      return has_new_bytes && rows_decoded > 0;
+    default:
+      FML_LOG(ERROR) << "Could not decode the image incrementally.";
+      failed_ = true;
+      return false;
+  }
+}
+
+bool IncrementalImageDecoder::DecodeFromStart(size_t size, bool closed) {
+  // Decoding again only once the number of bytes has doubled keeps the total
+  // work linear in the size of the image.
+  if (!closed && size < 2 * decoded_size_) {
+    return false;
+  }
+  decoded_size_ = size;
+
+  auto codec = SkCodec::MakeFromData(buffer_->Snapshot());
+  if (!codec) {
+    failed_ = closed;
+    return false;
+  }
+
+  switch (codec->getPixels(info_, bitmap_.getPixels(), bitmap_.rowBytes())) {
+    case SkCodec::kSuccess:
+      has_decoded_rows_ = true;
+      complete_ = true;
+      return true;
+    case SkCodec::kIncompleteInput:
+      // The codec fills in the rows it couldn't decode.
+      has_decoded_rows_ = true;
+      complete_ = closed;
+      return true;
+    default:
+      if (closed) {
+        FML_LOG(ERROR) << "Could not decode the image.";
+        failed_ = true;
+      }
+      return false;
+  }
+}
+
+sk_sp<SkImage> IncrementalImageDecoder::GetImage() const {
+  if (image_) {
+    return image_;
+  }
+  SkPixmap pixmap;
+  if (!has_decoded_rows_ || !bitmap_.peekPixels(&pixmap)) {
+    return nullptr;
+  }
+  return SkImage::MakeRasterCopy(pixmap);
+}
+
+static void IncrementalCodec_constructor(Dart_NativeArguments args) {
+  UIDartState::ThrowIfUIOperationsProhibited();
+  DartCallConstructor(&IncrementalCodec::Create, args);
+}
+
+IMPLEMENT_WRAPPERTYPEINFO(ui, IncrementalCodec);
+
+#define FOR_EACH_BINDING(V)    \
+  V(IncrementalCodec, addBytes) \
+  V(IncrementalCodec, close)
+
+FOR_EACH_BINDING(DART_NATIVE_CALLBACK)
+
+void IncrementalCodec::RegisterNatives(tonic::DartLibraryNatives* natives) {
+  natives->Register(
+      {{"IncrementalCodec_constructor", IncrementalCodec_constructor, 1, true},
+       FOR_EACH_BINDING(DART_REGISTER_NATIVE)});
+}
+
+fml::RefPtr<IncrementalCodec> IncrementalCodec::Create() {
+  return fml::MakeRefCounted<IncrementalCodec>();
+}
+
+IncrementalCodec::IncrementalCodec()
+    : state_(std::make_shared<State>(
+          UIDartState::Current()->GetTaskRunners().GetUITaskRunner(),
+          UIDartState::Current()->GetTaskRunners().GetIOTaskRunner(),
+          UIDartState::Current()->GetConcurrentTaskRunner())) {}
+
+IncrementalCodec::~IncrementalCodec() = default;
+
+IncrementalCodec::State::State(
+    fml::RefPtr<fml::TaskRunner> ui_task_runner,
+    fml::RefPtr<fml::TaskRunner> io_task_runner,
+    std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner)
+    : ui_task_runner_(std::move(ui_task_runner)),
+      io_task_runner_(std::move(io_task_runner)),
+      concurrent_task_runner_(std::move(concurrent_task_runner)) {}
+
+IncrementalCodec::State::~State() {
+  // The state can be released on the IO task runner, but the callbacks must
+  // be cleared on the UI task runner.
+  for (auto& callback : callbacks_) {
+    ui_task_runner_->PostTask(fml::MakeCopyable(
+        [callback = std::move(callback)]() { callback->Clear(); }));
+  }
+}
+
+static void InvokeNextFrameCallback(
+    fml::RefPtr<FrameInfo> frameInfo,
+    std::unique_ptr<DartPersistentValue> callback) {
+  std::shared_ptr<tonic::DartState> dart_state = callback->dart_state().lock();
+  if (!dart_state) {
+    FML_DLOG(ERROR) << "Could not acquire Dart state while attempting to fire "
+                       "next frame callback.";
+    return;
+  }
+  tonic::DartState::Scope scope(dart_state);
+  if (!frameInfo) {
+    tonic::DartInvoke(callback->value(), {Dart_Null()});
+  } else {
+    tonic::DartInvoke(callback->value(), {ToDart(frameInfo)});
+  }
+}
+
+static sk_sp<SkImage> UploadImage(sk_sp<SkImage> image,
+                                  fml::WeakPtr<GrContext> resourceContext) {
+  SkPixmap pixmap;
+  if (!image || !resourceContext || !image->peekPixels(&pixmap)) {
+    // Defer the upload until the image is drawn on the raster thread, like the
+    // frames of the MultiFrameCodec.
+    return image;
+  }
+  return SkImage::MakeCrossContextFromPixmap(resourceContext.get(), pixmap,
+                                             true);
+}
+
+void IncrementalCodec::State::DecodeAndInvokeCallbacks(
+    fml::WeakPtr<IOManager> io_manager) {
+  FML_DCHECK(io_task_runner_->RunsTasksOnCurrentThread());
+  if (done_) {
+    InvokeCallbacks(complete_image_, io_manager->GetSkiaUnrefQueue());
+    return;
+  }
+  if (decoding_) {
+    decode_again_ = true;
+    return;
+  }
+  decoding_ = true;
+  decode_again_ = false;
+
+  // The decoded image is only copied if there are callbacks to show it.
+  const bool wants_image = !callbacks_.empty();
+  concurrent_task_runner_->PostTask([weak_state = weak_from_this(),
+                                     had_new_rows = has_new_rows_,
+                                     wants_image, io_manager]() {
+    auto state = weak_state.lock();
+    if (!state) {
+      return;
+    }
+    auto& decoder = state->decoder_;
+    const bool has_new_rows = decoder.Decode();
+    const bool done = decoder.IsComplete() || decoder.HasFailed();
+    sk_sp<SkImage> image;
+    if (done || (wants_image && (had_new_rows || has_new_rows))) {
+      image = decoder.GetImage();
+    }
+    state->io_task_runner_->PostTask(
+        [weak_state, has_new_rows, done, image = std::move(image),
+         io_manager]() mutable {
+          if (auto state = weak_state.lock()) {
+            state->OnDecoded(has_new_rows, done, std::move(image),
+                             io_manager);
+          }
+        });
+  });
+}
+
+void IncrementalCodec::State::OnDecoded(bool has_new_rows,
+                                        bool done,
+                                        sk_sp<SkImage> image,
+                                        fml::WeakPtr<IOManager> io_manager) {
+  FML_DCHECK(io_task_runner_->RunsTasksOnCurrentThread());
+  decoding_ = false;
+  has_new_rows_ = has_new_rows_ || has_new_rows;
+  image = UploadImage(std::move(image), io_manager->GetResourceContext());
+  if (done) {
+    done_ = true;
+    complete_image_ = image;
+  }
+
+  if (image || done) {
+    InvokeCallbacks(std::move(image), io_manager->GetSkiaUnrefQueue());
+  }
+  // Decode the bytes that arrived during the decode, or the rows that the
+  // callbacks added during the decode are waiting for.
+  if (!done && (decode_again_ || (!callbacks_.empty() && has_new_rows_))) {
+    DecodeAndInvokeCallbacks(std::move(io_manager));
+  }
+}
+
+void IncrementalCodec::State::InvokeCallbacks(
+    sk_sp<SkImage> image,
+    fml::RefPtr<flutter::SkiaUnrefQueue> unref_queue) {
+  if (callbacks_.empty()) {
+    return;
+  }
+  has_new_rows_ = false;
+
+  fml::RefPtr<FrameInfo> frameInfo;
+  if (image) {
+    fml::RefPtr<CanvasImage> canvas_image = CanvasImage::Create();
+    canvas_image->set_image({std::move(image), std::move(unref_queue)});
+    frameInfo = fml::MakeRefCounted<FrameInfo>(std::move(canvas_image), 0);
+  }
+
+  std::vector<std::unique_ptr<DartPersistentValue>> callbacks;
+  callbacks.swap(callbacks_);
+  ui_task_runner_->PostTask(fml::MakeCopyable(
+      [callbacks = std::move(callbacks), frameInfo]() mutable {
+        for (auto& callback : callbacks) {
+          InvokeNextFrameCallback(frameInfo, std::move(callback));
+        }
+      }));
+}
+
+Dart_Handle IncrementalCodec::addBytes(const tonic::Uint8List& list) {
+  if (closed_) {
+    return ToDart("Bytes can't be added after the codec is closed.");
+  }
+  state_->decoder_.AddBytes(list.data(), list.num_elements());
+  PostDecode();
+  return Dart_Null();
+}
+
+void IncrementalCodec::close() {
+  if (closed_) {
+    return;
+  }
+  closed_ = true;
+  state_->decoder_.Close();
+  PostDecode();
+}
+
+void IncrementalCodec::PostDecode() {
+  auto* dart_state = UIDartState::Current();
+  dart_state->GetTaskRunners().GetIOTaskRunner()->PostTask(
+      [weak_state = std::weak_ptr<State>(state_),
+       io_manager = dart_state->GetIOManager()]() {
+        auto state = weak_state.lock();
+        if (!state) {
+          return;
+        }
+        state->DecodeAndInvokeCallbacks(io_manager);
+      });
+}
+
+int IncrementalCodec::frameCount() const {
+  return 1;
+}
+
+int IncrementalCodec::repetitionCount() const {
+  return 0;
+}
+
+Dart_Handle IncrementalCodec::getNextFrame(Dart_Handle callback_handle) {
+  if (!Dart_IsClosure(callback_handle)) {
+    return ToDart("Callback must be a function");
+  }
+
+  auto* dart_state = UIDartState::Current();
+
+  const auto& task_runners = dart_state->GetTaskRunners();
+
+  task_runners.GetIOTaskRunner()->PostTask(fml::MakeCopyable(
+      [callback = std::make_unique<DartPersistentValue>(
+           tonic::DartState::Current(), callback_handle),
+       weak_state = std::weak_ptr<State>(state_),
+       ui_task_runner = task_runners.GetUITaskRunner(),
+       io_manager = dart_state->GetIOManager()]() mutable {
+        auto state = weak_state.lock();
+        if (!state) {
+          ui_task_runner->PostTask(fml::MakeCopyable(
+              [callback = std::move(callback)]() { callback->Clear(); }));
+          return;
+        }
+        state->callbacks_.push_back(std::move(callback));
+        state->DecodeAndInvokeCallbacks(std::move(io_manager));
+      }));
+
+  return Dart_Null();
+}
+
+void IncrementalCodec::dispose() {
+  // Frames that are still waiting for bytes are abandoned.
+  state_.reset();
+  Codec::dispose();
+}
+
+}  // namespace flutter
@@ -0,0 +1,186 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_INCREMENTAL_CODEC_H_
+#define FLUTTER_LIB_UI_PAINTING_INCREMENTAL_CODEC_H_
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/macros.h"
+#include "flutter/lib/ui/io_manager.h"
+#include "flutter/lib/ui/painting/codec.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/tonic/typed_data/typed_list.h"
+
+namespace flutter {
+
+// Decodes an image from encoded bytes that arrive over time, for example
+// from the network.
+//
+// Each call to |Decode| decodes as much of the image as the bytes added so far
+// allow. Codecs that support incremental decoding, such as PNG and GIF,
+// resume where the last call stopped, which also refines interlaced images
+// pass by pass. Other formats, such as JPEG, are decoded again from the start
+// once enough new bytes have arrived, which yields as much as the codec can
+// make of the truncated image. Images with an EXIF orientation are only
+// decoded once all bytes have arrived.
+class IncrementalImageDecoder {
+ public:
+  IncrementalImageDecoder();
+
+  ~IncrementalImageDecoder();
+
+  // Appends bytes of the encoded image. Bytes added after |Close| are
+  // ignored. Can be called on any thread.
+  void AddBytes(const void* bytes, size_t length);
+
+  // Signals that all bytes of the encoded image have been added. Can be called
+  // on any thread.
+  void Close();
+
+  // Decodes the bytes added since the last call. Returns true if more of the
+  // image has been decoded. Must not be called on multiple threads at once.
+  bool Decode();
+
+  // Returns a copy of the part of the image decoded so far, with the parts
+  // that haven't been decoded yet left transparent, or null if nothing has
+  // been decoded.
+  sk_sp<SkImage> GetImage() const;
+
+  // Whether the image has been decoded from all of its bytes.
+  bool IsComplete() const { return complete_; }
+
+  // Whether decoding the image has failed. The parts of the image decoded
+  // before the failure are still available from |GetImage|.
+  bool HasFailed() const { return failed_; }
+
+ private:
+  class Stream;
+
+  // The encoded bytes, shared with the streams the codecs read from.
+  struct Buffer {
+    mutable std::mutex mutex;
+    std::vector<uint8_t> bytes;
+    bool closed = false;
+
+    size_t Read(size_t offset, void* dst, size_t size) const;
+
+    sk_sp<SkData> Snapshot() const;
+  };
+
+  const std::shared_ptr<Buffer> buffer_;
+  std::unique_ptr<SkCodec> codec_;
+  SkImageInfo info_;
+  SkBitmap bitmap_;
+  // The image of codecs that are only decoded once all bytes have arrived.
+  sk_sp<SkImage> image_;
+  bool incremental_ = false;
+  bool oriented_ = false;
+  bool has_decoded_rows_ = false;
+  bool complete_ = false;
+  bool failed_ = false;
+  // The number of bytes that had arrived at the last decode.
+  size_t decoded_size_ = 0;
+
+  bool CreateCodec();
+
+  bool DecodeIncrementally(size_t size, bool closed);
+
+  bool DecodeFromStart(size_t size, bool closed);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(IncrementalImageDecoder);
+};
+
+// A codec of a single frame image whose encoded bytes are added while it is
+// being decoded.
+//
+// Each frame returned by |getNextFrame| shows more of the image than the
+// previous one, until the image is complete. Decoding happens on the
+// concurrent task runner as the bytes arrive, one decode at a time, and only
+// the upload of the decoded image happens on the IO task runner.
+class IncrementalCodec : public Codec {
+  DEFINE_WRAPPERTYPEINFO();
+  FML_FRIEND_MAKE_REF_COUNTED(IncrementalCodec);
+
+ public:
+  ~IncrementalCodec() override;
+
+  static fml::RefPtr<IncrementalCodec> Create();
+
+  // Returns an error message on failure, null on success.
+  Dart_Handle addBytes(const tonic::Uint8List& list);
+
+  void close();
+
+  // |Codec|
+  int frameCount() const override;
+
+  // |Codec|
+  int repetitionCount() const override;
+
+  // |Codec|
+  Dart_Handle getNextFrame(Dart_Handle callback_handle) override;
+
+  // |Codec|
+  void dispose() override;
+
+  static void RegisterNatives(tonic::DartLibraryNatives* natives);
+
+ private:
+  // Captures the state shared between the UI, IO and worker task runners,
+  // like the state of the |MultiFrameCodec|. Only the decoder's |AddBytes| and
+  // |Close| are called on the UI task runner. Its |Decode| is called on the
+  // worker task runner, by one task at a time.
+  struct State : public std::enable_shared_from_this<State> {
+    State(fml::RefPtr<fml::TaskRunner> ui_task_runner,
+          fml::RefPtr<fml::TaskRunner> io_task_runner,
+          std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner);
+
+    ~State();
+
+    IncrementalImageDecoder decoder_;
+    const fml::RefPtr<fml::TaskRunner> ui_task_runner_;
+    const fml::RefPtr<fml::TaskRunner> io_task_runner_;
+    const std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner_;
+
+    // The members below are only accessed on the IO task runner.
+    std::vector<std::unique_ptr<DartPersistentValue>> callbacks_;
+    // Whether more of the image has been decoded since the last frame.
+    bool has_new_rows_ = false;
+    // Whether the image is complete or has failed to decode, in which case
+    // |complete_image_| is all there is to show.
+    bool done_ = false;
+    sk_sp<SkImage> complete_image_;
+    // Whether a decode is running on the worker task runner, and whether
+    // bytes or callbacks have been added since it started.
+    bool decoding_ = false;
+    bool decode_again_ = false;
+
+    // Decodes the bytes added so far on the worker task runner, unless a
+    // decode is running already, and invokes the callbacks with the result.
+    void DecodeAndInvokeCallbacks(fml::WeakPtr<IOManager> io_manager);
+
+    void OnDecoded(bool has_new_rows,
+                   bool done,
+                   sk_sp<SkImage> image,
+                   fml::WeakPtr<IOManager> io_manager);
+
+    void InvokeCallbacks(sk_sp<SkImage> image,
+                         fml::RefPtr<flutter::SkiaUnrefQueue> unref_queue);
+  };
+
+  std::shared_ptr<State> state_;
+  bool closed_ = false;
+
+  IncrementalCodec();
+
+  void PostDecode();
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_INCREMENTAL_CODEC_H_
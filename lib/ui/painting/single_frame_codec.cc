@@ -57,10 +57,16 @@ Dart_Handle SingleFrameCodec::getNextFrame(Dart_Handle callback_handle) {
   fml::RefPtr<SingleFrameCodec>* raw_codec_ref =
       new fml::RefPtr<SingleFrameCodec>(this);
 
-  decoder->Decode(descriptor_, [raw_codec_ref](auto image) {
+  decoder_ = decoder;
+  decode_id_ = decoder->Decode(descriptor_, [raw_codec_ref](auto image) {
     std::unique_ptr<fml::RefPtr<SingleFrameCodec>> codec_ref(raw_codec_ref);
     fml::RefPtr<SingleFrameCodec> codec(std::move(*codec_ref));
 
+    if (codec->pending_callbacks_.empty()) {
+      // The codec was disposed of while the image was being decoded.
+      return;
+    }
+
     auto state = codec->pending_callbacks_.front().dart_state().lock();
 
     if (!state) {
@@ -101,6 +107,22 @@ Dart_Handle SingleFrameCodec::getNextFrame(Dart_Handle callback_handle) {
   return Dart_Null();
 }
 
+void SingleFrameCodec::setDecodePriority(int priority) {
+  descriptor_.priority = priority;
+  if (status_ == Status::kInProgress && decoder_) {
+    decoder_->SetDecodePriority(decode_id_, priority);
+  }
+}
+
+void SingleFrameCodec::dispose() {
+  if (status_ == Status::kInProgress && decoder_) {
+    // Nobody is left to receive the frame, so the decode is abandoned.
+    pending_callbacks_.clear();
+    decoder_->CancelDecode(decode_id_);
+  }
+  Codec::dispose();
+}
+
 size_t SingleFrameCodec::GetAllocationSize() const {
   const auto& data = descriptor_.data;
   const auto data_byte_size = data ? data->size() : 0;
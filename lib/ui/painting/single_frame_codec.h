@@ -27,6 +27,12 @@ class SingleFrameCodec : public Codec {
   // |Codec|
   Dart_Handle getNextFrame(Dart_Handle args) override;
 
+  // |Codec|
+  void setDecodePriority(int priority) override;
+
+  // |Codec|
+  void dispose() override;
+
   // |DartWrappable|
   size_t GetAllocationSize() const override;
 
@@ -36,6 +42,8 @@ class SingleFrameCodec : public Codec {
   ImageDecoder::ImageDescriptor descriptor_;
   fml::RefPtr<FrameInfo> cached_frame_;
   std::vector<DartPersistentValue> pending_callbacks_;
+  fml::WeakPtr<ImageDecoder> decoder_;
+  ImageDecoder::DecodeId decode_id_ = 0;
 
   FML_FRIEND_MAKE_REF_COUNTED(SingleFrameCodec);
   FML_FRIEND_REF_COUNTED_THREAD_SAFE(SingleFrameCodec);
@@ -0,0 +1,230 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/tiled_image.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "flutter/fml/hash_combine.h"
+#include "flutter/lib/ui/painting/image.h"
+#include "flutter/lib/ui/ui_dart_state.h"
+#include "third_party/skia/include/codec/SkCodec.h"
+#include "third_party/skia/include/codec/SkEncodedOrigin.h"
+#include "third_party/tonic/converter/dart_converter.h"
+#include "third_party/tonic/dart_args.h"
+#include "third_party/tonic/dart_binding_macros.h"
+#include "third_party/tonic/dart_library_natives.h"
+#include "third_party/tonic/logging/dart_invoke.h"
+
+using tonic::ToDart;
+
+namespace flutter {
+
+static void TiledImage_constructor(Dart_NativeArguments args) {
+  UIDartState::ThrowIfUIOperationsProhibited();
+  DartCallConstructor(&TiledImage::Create, args);
+}
+
+IMPLEMENT_WRAPPERTYPEINFO(ui, TiledImage);
+
+#define FOR_EACH_BINDING(V) \
+  V(TiledImage, init)       \
+  V(TiledImage, width)      \
+  V(TiledImage, height)     \
+  V(TiledImage, tileSize)   \
+  V(TiledImage, getTile)    \
+  V(TiledImage, dispose)
+
+FOR_EACH_BINDING(DART_NATIVE_CALLBACK)
+
+void TiledImage::RegisterNatives(tonic::DartLibraryNatives* natives) {
+  natives->Register(
+      {{"TiledImage_constructor", TiledImage_constructor, 1, true},
+       FOR_EACH_BINDING(DART_REGISTER_NATIVE)});
+}
+
+fml::RefPtr<TiledImage> TiledImage::Create() {
+  return fml::MakeRefCounted<TiledImage>();
+}
+
+TiledImage::TiledImage() = default;
+
+TiledImage::~TiledImage() = default;
+
+size_t TiledImage::TileKeyHash::operator()(const TileKey& key) const {
+  return fml::HashCombine(key.column, key.row, key.scale);
+}
+
+Dart_Handle TiledImage::init(const tonic::Uint8List& list,
+                             int tile_size,
+                             int max_bytes) {
+  if (tile_size <= 0) {
+    return ToDart("tileSize must be greater than zero");
+  }
+  if (max_bytes < 0) {
+    return ToDart("maxBytes must not be negative");
+  }
+
+  data_ = SkData::MakeWithCopy(list.data(), list.num_elements());
+  auto codec = SkCodec::MakeFromData(data_);
+  if (!codec) {
+    data_.reset();
+    return ToDart("Could not instantiate image codec.");
+  }
+  dimensions_ = codec->dimensions();
+  if (SkEncodedOriginSwapsWidthHeight(codec->getOrigin())) {
+    dimensions_ = SkISize::Make(dimensions_.height(), dimensions_.width());
+  }
+  tile_size_ = tile_size;
+  max_bytes_ = max_bytes;
+  decoder_ = UIDartState::Current()->GetImageDecoder();
+  return Dart_Null();
+}
+
+Dart_Handle TiledImage::getTile(int column,
+                                int row,
+                                double scale,
+                                int priority,
+                                Dart_Handle callback_handle) {
+  if (!Dart_IsClosure(callback_handle)) {
+    return ToDart("Callback must be a function");
+  }
+  if (!data_) {
+    return ToDart("The tiled image has been disposed of.");
+  }
+  // Computed in 64 bits, since the tiles far outside of the image are at
+  // offsets that don't fit in an int.
+  const int64_t left = static_cast<int64_t>(column) * tile_size_;
+  const int64_t top = static_cast<int64_t>(row) * tile_size_;
+  if (column < 0 || row < 0 || left >= dimensions_.width() ||
+      top >= dimensions_.height()) {
+    return ToDart("The tile is outside of the image.");
+  }
+  const SkIRect tile_region = SkIRect::MakeLTRB(
+      static_cast<int>(left), static_cast<int>(top),
+      static_cast<int>(
+          std::min<int64_t>(left + tile_size_, dimensions_.width())),
+      static_cast<int>(
+          std::min<int64_t>(top + tile_size_, dimensions_.height())));
+  if (!(scale > 0.0 && scale <= 1.0)) {
+    return ToDart("scale must be greater than zero and at most one");
+  }
+
+  const TileKey key = {column, row, scale};
+  auto cached = tile_index_.find(key);
+  if (cached != tile_index_.end()) {
+    tiles_.splice(tiles_.begin(), tiles_, cached->second);
+    const auto& image = cached->second->image;
+    auto canvas_image = CanvasImage::Create();
+    canvas_image->set_image({image.get(), image.queue()});
+    tonic::DartInvoke(callback_handle, {ToDart(canvas_image)});
+    return Dart_Null();
+  }
+
+  auto dart_state = UIDartState::Current();
+  auto pending = pending_tiles_.find(key);
+  if (pending != pending_tiles_.end()) {
+    pending->second.callbacks.emplace_back(dart_state, callback_handle);
+    if (decoder_) {
+      decoder_->SetDecodePriority(pending->second.decode_id, priority);
+    }
+    return Dart_Null();
+  }
+
+  if (!decoder_) {
+    return ToDart("Image decoder not available.");
+  }
+
+  ImageDecoder::ImageDescriptor descriptor;
+  descriptor.data = data_;
+  descriptor.region = tile_region;
+  descriptor.target_width =
+      std::max(1, static_cast<int>(std::round(tile_region.width() * scale)));
+  descriptor.target_height =
+      std::max(1, static_cast<int>(std::round(tile_region.height() * scale)));
+  descriptor.priority = priority;
+
+  PendingTile& pending_tile = pending_tiles_[key];
+  pending_tile.callbacks.emplace_back(dart_state, callback_handle);
+
+  // The tiled image must be deleted on the UI thread. Allocate a RefPtr on
+  // the heap to ensure that it remains alive until the decoder callback is
+  // invoked on the UI thread.
+  fml::RefPtr<TiledImage>* raw_tiled_image_ref =
+      new fml::RefPtr<TiledImage>(this);
+  pending_tile.decode_id = decoder_->Decode(
+      std::move(descriptor), [raw_tiled_image_ref, key](auto image) {
+        std::unique_ptr<fml::RefPtr<TiledImage>> tiled_image_ref(
+            raw_tiled_image_ref);
+        (*tiled_image_ref)->OnTileDecoded(key, std::move(image));
+      });
+  return Dart_Null();
+}
+
+void TiledImage::OnTileDecoded(const TileKey& key,
+                               SkiaGPUObject<SkImage> image) {
+  auto pending = pending_tiles_.find(key);
+  if (pending == pending_tiles_.end()) {
+    // The tiled image was disposed of while the tile was being decoded.
+    return;
+  }
+  auto callbacks = std::move(pending->second.callbacks);
+  pending_tiles_.erase(pending);
+
+  auto state = callbacks.front().dart_state().lock();
+  if (!state) {
+    // This is probably because the isolate has been terminated before the
+    // tile could be decoded.
+    return;
+  }
+  tonic::DartState::Scope scope(state.get());
+
+  fml::RefPtr<CanvasImage> canvas_image;
+  if (image.get()) {
+    const size_t byte_count = image.get()->imageInfo().computeMinByteSize();
+    // Images without an unref queue can't be shared safely.
+    if (image.queue() && byte_count <= max_bytes_) {
+      EvictTiles(max_bytes_ - byte_count);
+      tiles_.push_front({key, {image.get(), image.queue()}, byte_count});
+      tile_index_[key] = tiles_.begin();
+      byte_count_ += byte_count;
+    }
+    canvas_image = CanvasImage::Create();
+    canvas_image->set_image(std::move(image));
+  }
+
+  Dart_Handle tile = ToDart(canvas_image);
+  for (const DartPersistentValue& callback : callbacks) {
+    tonic::DartInvoke(callback.value(), {tile});
+  }
+}
+
+void TiledImage::EvictTiles(size_t max_bytes) {
+  while (byte_count_ > max_bytes) {
+    const Tile& tile = tiles_.back();
+    tile_index_.erase(tile.key);
+    byte_count_ -= tile.byte_count;
+    // The texture of the tile is released on the IO thread by its unref queue.
+    tiles_.pop_back();
+  }
+}
+
+void TiledImage::dispose() {
+  if (decoder_) {
+    for (const auto& pending : pending_tiles_) {
+      decoder_->CancelDecode(pending.second.decode_id);
+    }
+  }
+  pending_tiles_.clear();
+  EvictTiles(0);
+  data_.reset();
+  ClearDartWrapper();
+}
+
+size_t TiledImage::GetAllocationSize() const {
+  return (data_ ? data_->size() : 0) + byte_count_ + sizeof(TiledImage);
+}
+
+}  // namespace flutter
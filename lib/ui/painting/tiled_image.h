@@ -0,0 +1,113 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_TILED_IMAGE_H_
+#define FLUTTER_LIB_UI_PAINTING_TILED_IMAGE_H_
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "flutter/flow/skia_gpu_object.h"
+#include "flutter/lib/ui/dart_wrapper.h"
+#include "flutter/lib/ui/painting/image_decoder.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkSize.h"
+#include "third_party/tonic/typed_data/typed_list.h"
+
+namespace tonic {
+class DartLibraryNatives;
+}  // namespace tonic
+
+namespace flutter {
+
+// An image that is too large to decode at once, decoded one tile at a time.
+//
+// Tiles are decoded on demand by the image decoder, which only decodes the
+// region of the image covered by the tile. The decoded tiles are kept until
+// they exceed the byte budget of the image, least recently used first.
+class TiledImage : public RefCountedDartWrappable<TiledImage> {
+  DEFINE_WRAPPERTYPEINFO();
+  FML_FRIEND_MAKE_REF_COUNTED(TiledImage);
+
+ public:
+  ~TiledImage() override;
+
+  static fml::RefPtr<TiledImage> Create();
+
+  // Returns an error message on failure, null on success.
+  Dart_Handle init(const tonic::Uint8List& list, int tile_size, int max_bytes);
+
+  int width() const { return dimensions_.width(); }
+
+  int height() const { return dimensions_.height(); }
+
+  int tileSize() const { return tile_size_; }
+
+  // Invokes the callback with the tile at |column| and |row|, resized by
+  // |scale|, or with null if it could not be decoded. Returns an error
+  // message on failure, null on success.
+  Dart_Handle getTile(int column,
+                      int row,
+                      double scale,
+                      int priority,
+                      Dart_Handle callback_handle);
+
+  void dispose();
+
+  // |DartWrappable|
+  size_t GetAllocationSize() const override;
+
+  static void RegisterNatives(tonic::DartLibraryNatives* natives);
+
+ private:
+  struct TileKey {
+    int column = 0;
+    int row = 0;
+    double scale = 1.0;
+
+    bool operator==(const TileKey& other) const {
+      return column == other.column && row == other.row &&
+             scale == other.scale;
+    }
+  };
+
+  struct TileKeyHash {
+    size_t operator()(const TileKey& key) const;
+  };
+
+  struct Tile {
+    TileKey key;
+    SkiaGPUObject<SkImage> image;
+    size_t byte_count = 0;
+  };
+
+  struct PendingTile {
+    ImageDecoder::DecodeId decode_id = 0;
+    std::vector<DartPersistentValue> callbacks;
+  };
+
+  sk_sp<SkData> data_;
+  SkISize dimensions_ = SkISize::MakeEmpty();
+  int tile_size_ = 0;
+  size_t max_bytes_ = 0;
+  size_t byte_count_ = 0;
+  fml::WeakPtr<ImageDecoder> decoder_;
+  // The decoded tiles, most recently used first.
+  std::list<Tile> tiles_;
+  std::unordered_map<TileKey, std::list<Tile>::iterator, TileKeyHash>
+      tile_index_;
+  std::unordered_map<TileKey, PendingTile, TileKeyHash> pending_tiles_;
+
+  TiledImage();
+
+  void OnTileDecoded(const TileKey& key, SkiaGPUObject<SkImage> image);
+
+  void EvictTiles(size_t max_bytes);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_TILED_IMAGE_H_
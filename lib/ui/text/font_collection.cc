@@ -6,10 +6,12 @@
 
 #include <mutex>
 
+#include "flutter/fml/trace_event.h"
 #include "flutter/lib/ui/text/asset_manager_font_provider.h"
 #include "flutter/lib/ui/ui_dart_state.h"
 #include "flutter/lib/ui/window/window.h"
 #include "flutter/runtime/test_font_data.h"
+#include "minikin/Layout.h"
 #include "rapidjson/document.h"
 #include "rapidjson/rapidjson.h"
 #include "third_party/skia/include/core/SkFontMgr.h"
@@ -56,6 +58,23 @@ FontCollection::~FontCollection() {
   SkGraphics::PurgeFontCache();
 }
 
+void FontCollection::SetLayoutCacheMaxBytes(size_t max_bytes) {
+  minikin::Layout::setCacheMaxBytes(max_bytes);
+}
+
+void FontCollection::TraceLayoutCacheStatsToTimeline() {
+#if !FLUTTER_RELEASE
+  minikin::LayoutCacheStats stats = minikin::Layout::getCacheStats();
+  FML_TRACE_COUNTER("flutter", "TextLayoutCache", 0,   //
+                    "Entries", stats.entryCount,       //
+                    "MBytes", stats.byteCount * 1e-6,  //
+                    "Hits", stats.hits,                //
+                    "Misses", stats.misses,            //
+                    "Evictions", stats.evictions       //
+  );
+#endif  // !FLUTTER_RELEASE
+}
+
 void FontCollection::RegisterNatives(tonic::DartLibraryNatives* natives) {
   natives->Register({
       {"loadFontFromList", _LoadFontFromList, 3, true},
@@ -27,6 +27,14 @@ class FontCollection {
 
   static void RegisterNatives(tonic::DartLibraryNatives* natives);
 
+  // Limits the memory used by the cache of shaped words of the text engine,
+  // which is shared by all the font collections in the process.
+  static void SetLayoutCacheMaxBytes(size_t max_bytes);
+
+  // Emits the size and hit rate of the cache of shaped words as timeline
+  // counters.
+  static void TraceLayoutCacheStatsToTimeline();
+
   std::shared_ptr<txt::FontCollection> GetFontCollection() const;
 
   void SetupDefaultFontManager();
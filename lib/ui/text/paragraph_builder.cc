@@ -495,7 +495,10 @@ Dart_Handle ParagraphBuilder::addPlaceholder(double width,
 }
 
 void ParagraphBuilder::build(Dart_Handle paragraph_handle) {
-  Paragraph::Create(paragraph_handle, m_paragraphBuilder->Build());
+  std::unique_ptr<txt::Paragraph> paragraph = m_paragraphBuilder->Build();
+  paragraph->SetConcurrentTaskRunner(
+      UIDartState::Current()->GetConcurrentTaskRunner());
+  Paragraph::Create(paragraph_handle, std::move(paragraph));
 }
 
 }  // namespace flutter
@@ -26,6 +26,7 @@ UIDartState::UIDartState(
     std::string logger_prefix,
     UnhandledExceptionCallback unhandled_exception_callback,
     std::shared_ptr<IsolateNameServer> isolate_name_server,
+    std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
     bool is_root_isolate)
     : task_runners_(std::move(task_runners)),
       add_callback_(std::move(add_callback)),
@@ -39,7 +40,8 @@ UIDartState::UIDartState(
       logger_prefix_(std::move(logger_prefix)),
       is_root_isolate_(is_root_isolate),
       unhandled_exception_callback_(unhandled_exception_callback),
-      isolate_name_server_(std::move(isolate_name_server)) {
+      isolate_name_server_(std::move(isolate_name_server)),
+      concurrent_task_runner_(std::move(concurrent_task_runner)) {
   AddOrRemoveTaskObserver(true /* add */);
 }
 
@@ -146,6 +148,11 @@ std::shared_ptr<IsolateNameServer> UIDartState::GetIsolateNameServer() const {
   return isolate_name_server_;
 }
 
+std::shared_ptr<fml::ConcurrentTaskRunner>
+UIDartState::GetConcurrentTaskRunner() const {
+  return concurrent_task_runner_;
+}
+
 tonic::DartErrorHandleType UIDartState::GetLastError() {
   tonic::DartErrorHandleType error = message_handler().isolate_last_error();
   if (error == tonic::kNoError) {
@@ -13,6 +13,7 @@
 #include "flutter/common/task_runners.h"
 #include "flutter/flow/skia_gpu_object.h"
 #include "flutter/fml/build_config.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/memory/weak_ptr.h"
 #include "flutter/fml/synchronization/waitable_event.h"
 #include "flutter/lib/ui/io_manager.h"
@@ -64,6 +65,10 @@ class UIDartState : public tonic::DartState {
 
   std::shared_ptr<IsolateNameServer> GetIsolateNameServer() const;
 
+  // The task runner of the worker pool of the VM. Used to spread expensive
+  // work, such as shaping long paragraphs, across the workers.
+  std::shared_ptr<fml::ConcurrentTaskRunner> GetConcurrentTaskRunner() const;
+
   tonic::DartErrorHandleType GetLastError();
 
   void ReportUnhandledException(const std::string& error,
@@ -93,6 +98,7 @@ class UIDartState : public tonic::DartState {
               std::string logger_prefix,
               UnhandledExceptionCallback unhandled_exception_callback,
               std::shared_ptr<IsolateNameServer> isolate_name_server,
+              std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
               bool is_root_isolate_);
 
   ~UIDartState() override;
@@ -123,6 +129,7 @@ class UIDartState : public tonic::DartState {
   tonic::DartMicrotaskQueue microtask_queue_;
   UnhandledExceptionCallback unhandled_exception_callback_;
   const std::shared_ptr<IsolateNameServer> isolate_name_server_;
+  const std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner_;
 
   void AddOrRemoveTaskObserver(bool add);
 };
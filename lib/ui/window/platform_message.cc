@@ -9,19 +9,30 @@
 namespace flutter {
 
 PlatformMessage::PlatformMessage(std::string channel,
-                                 std::vector<uint8_t> data,
+                                 std::unique_ptr<fml::Mapping> data,
                                  fml::RefPtr<PlatformMessageResponse> response)
     : channel_(std::move(channel)),
       data_(std::move(data)),
-      hasData_(true),
       response_(std::move(response)) {}
 PlatformMessage::PlatformMessage(std::string channel,
+                                 std::vector<uint8_t> data,
                                  fml::RefPtr<PlatformMessageResponse> response)
-    : channel_(std::move(channel)),
-      data_(),
-      hasData_(false),
-      response_(std::move(response)) {}
+    : PlatformMessage(std::move(channel),
+                      std::make_unique<fml::DataMapping>(std::move(data)),
+                      std::move(response)) {}
+PlatformMessage::PlatformMessage(std::string channel,
+                                 fml::RefPtr<PlatformMessageResponse> response)
+    : channel_(std::move(channel)), response_(std::move(response)) {}
 
 PlatformMessage::~PlatformMessage() = default;
 
+const fml::Mapping& PlatformMessage::data() const {
+  static const fml::Mapping* empty_data = new fml::NonOwnedMapping(nullptr, 0);
+  return data_ ? *data_ : *empty_data;
+}
+
+std::unique_ptr<fml::Mapping> PlatformMessage::releaseData() {
+  return std::move(data_);
+}
+
 }  // namespace flutter
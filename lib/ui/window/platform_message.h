@@ -5,9 +5,11 @@
 #ifndef FLUTTER_LIB_UI_PLATFORM_PLATFORM_MESSAGE_H_
 #define FLUTTER_LIB_UI_PLATFORM_PLATFORM_MESSAGE_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "flutter/fml/mapping.h"
 #include "flutter/fml/memory/ref_counted.h"
 #include "flutter/fml/memory/ref_ptr.h"
 #include "flutter/lib/ui/window/platform_message_response.h"
@@ -20,14 +22,25 @@ class PlatformMessage : public fml::RefCountedThreadSafe<PlatformMessage> {
 
  public:
   const std::string& channel() const { return channel_; }
-  const std::vector<uint8_t>& data() const { return data_; }
-  bool hasData() { return hasData_; }
+
+  // The payload of the message. Empty if the message has no data or the data
+  // has been released.
+  const fml::Mapping& data() const;
+
+  bool hasData() const { return data_ != nullptr; }
+
+  // Transfers the payload to the caller without copying it, e.g. to hand it to
+  // the Dart isolate. The message has no data afterwards.
+  std::unique_ptr<fml::Mapping> releaseData();
 
   const fml::RefPtr<PlatformMessageResponse>& response() const {
     return response_;
   }
 
  private:
+  PlatformMessage(std::string channel,
+                  std::unique_ptr<fml::Mapping> data,
+                  fml::RefPtr<PlatformMessageResponse> response);
   PlatformMessage(std::string channel,
                   std::vector<uint8_t> data,
                   fml::RefPtr<PlatformMessageResponse> response);
@@ -36,8 +49,7 @@ class PlatformMessage : public fml::RefCountedThreadSafe<PlatformMessage> {
   ~PlatformMessage();
 
   std::string channel_;
-  std::vector<uint8_t> data_;
-  bool hasData_;
+  std::unique_ptr<fml::Mapping> data_;
   fml::RefPtr<PlatformMessageResponse> response_;
 };
 
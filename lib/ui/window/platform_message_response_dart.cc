@@ -14,6 +14,40 @@
 
 namespace flutter {
 
+namespace {
+
+// Smaller payloads are copied into the Dart heap, which is cheaper than
+// tracking an external allocation.
+constexpr size_t kMinExternalByteDataSize = 1000;
+
+void FinalizeMapping(void* isolate_callback_data,
+                     Dart_WeakPersistentHandle handle,
+                     void* peer) {
+  delete reinterpret_cast<fml::Mapping*>(peer);
+}
+
+}  // namespace
+
+Dart_Handle MappingToByteData(std::unique_ptr<fml::Mapping> data) {
+  // Dart may write to the ByteData, so only bytes the mapping owns and that
+  // are writable are handed over. Read-only bytes, such as memory mapped
+  // assets or buffers lent by the embedder, are copied.
+  uint8_t* bytes = data->GetOwnedMutableMapping();
+  if (bytes == nullptr || data->GetSize() < kMinExternalByteDataSize) {
+    return tonic::DartByteData::Create(data->GetMapping(), data->GetSize());
+  }
+
+  const intptr_t length = data->GetSize();
+  Dart_Handle byte_data = Dart_NewExternalTypedDataWithFinalizer(
+      Dart_TypedData_kByteData, bytes, length, data.get(), length,
+      FinalizeMapping);
+  if (!Dart_IsError(byte_data)) {
+    // The finalizer of the ByteData owns the mapping now.
+    data.release();
+  }
+  return byte_data;
+}
+
 PlatformMessageResponseDart::PlatformMessageResponseDart(
     tonic::DartPersistentValue callback,
     fml::RefPtr<fml::TaskRunner> ui_task_runner)
@@ -40,8 +74,7 @@ void PlatformMessageResponseDart::Complete(std::unique_ptr<fml::Mapping> data) {
           return;
         tonic::DartState::Scope scope(dart_state);
 
-        Dart_Handle byte_buffer =
-            tonic::DartByteData::Create(data->GetMapping(), data->GetSize());
+        Dart_Handle byte_buffer = MappingToByteData(std::move(data));
         tonic::DartInvoke(callback.Release(), {byte_buffer});
       }));
 }
@@ -11,6 +11,12 @@
 
 namespace flutter {
 
+// Wraps platform message data in a Dart ByteData. Large payloads whose bytes
+// |data| owns and may write to are not copied: the ByteData refers to the
+// bytes of |data|, which is collected along with it. Everything else is
+// copied. Must be called on the UI thread with the isolate entered.
+Dart_Handle MappingToByteData(std::unique_ptr<fml::Mapping> data);
+
 class PlatformMessageResponseDart : public PlatformMessageResponse {
   FML_FRIEND_MAKE_REF_COUNTED(PlatformMessageResponseDart);
 
@@ -94,6 +94,9 @@ class CkAnimatedImageCodec implements ui.Codec {
   @override
   int get repetitionCount => animatedImage!.repetitionCount;
 
+  @override
+  void setDecodePriority(int priority) {}
+
   @override
   Future<ui.FrameInfo> getNextFrame() {
     final Duration duration = animatedImage!.decodeNextFrame();
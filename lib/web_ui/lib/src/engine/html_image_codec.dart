@@ -90,6 +90,9 @@ class HtmlCodec implements ui.Codec {
     imgElement.src = src;
   }
 
+  @override
+  void setDecodePriority(int priority) {}
+
   @override
   void dispose() {}
 }
@@ -1561,11 +1561,31 @@ class Codec {
   /// Returns an error message on failure, null on success.
   String? _getNextFrame(engine.Callback<FrameInfo> callback) => null;
 
+  /// Sets the priority of decoding the frames of this codec relative to the
+  /// frames of other codecs. The browser schedules image decodes on the web,
+  /// so this has no effect.
+  void setDecodePriority(int priority) {}
+
   /// Release the resources used by this object. The object is no longer usable
   /// after this method is called.
   void dispose() {}
 }
 
+/// A [Codec] that decodes an image while its encoded bytes are still arriving.
+///
+/// Incremental decoding is not supported on the web.
+class IncrementalCodec extends Codec {
+  IncrementalCodec() : super._() {
+    throw UnsupportedError('IncrementalCodec is not supported on the web.');
+  }
+
+  /// Appends the next chunk of the encoded image.
+  void addBytes(Uint8List bytes) {}
+
+  /// Signals that all the bytes of the image have been added.
+  void close() {}
+}
+
 /// Instantiates an image codec [Codec] object.
 ///
 /// [list] is the binary image data (e.g a PNG or GIF binary data).
@@ -1662,6 +1682,40 @@ void decodeImageFromPixels(
       .then((FrameInfo frameInfo) => callback(frameInfo.image));
 }
 
+/// An image that is too large to decode at once, decoded one tile at a time.
+///
+/// Tiled decoding is not supported on the web.
+class TiledImage {
+  TiledImage(Uint8List list, {int tileSize = 512, int maxBytes = 64 << 20}) {
+    throw UnsupportedError('TiledImage is not supported on the web.');
+  }
+
+  /// The width of the image, in image pixels.
+  int get width => 0;
+
+  /// The height of the image, in image pixels.
+  int get height => 0;
+
+  /// The width and height of the tiles, in image pixels.
+  int get tileSize => 0;
+
+  /// The number of columns of tiles.
+  int get columnCount => 0;
+
+  /// The number of rows of tiles.
+  int get rowCount => 0;
+
+  /// Decodes the tile at the given column and row.
+  Future<Image> getTile(int column, int row,
+      {double scale = 1.0, int priority = 0}) {
+    throw UnsupportedError('TiledImage is not supported on the web.');
+  }
+
+  /// Release the resources used by this object. The object is no longer usable
+  /// after this method is called.
+  void dispose() {}
+}
+
 /// A single shadow.
 ///
 /// Multiple shadows are stacked together in a [TextStyle].
@@ -137,6 +137,7 @@ DartIsolate::DartIsolate(const Settings& settings,
                   settings.log_tag,
                   settings.unhandled_exception_callback,
                   DartVMRef::GetIsolateNameServer(),
+                  DartVMRef::GetConcurrentWorkerTaskRunner(),
                   is_root_isolate),
       disable_http_(settings.disable_http) {
   phase_ = Phase::Uninitialized;
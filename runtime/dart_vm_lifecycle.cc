@@ -6,6 +6,8 @@
 
 #include <mutex>
 
+#include "flutter/fml/concurrent_message_loop.h"
+
 namespace flutter {
 
 // We need to explicitly put the constructor and destructor of the DartVM in the
@@ -24,6 +26,7 @@ static std::mutex gVMDependentsMutex;
 static std::weak_ptr<const DartVMData> gVMData;
 static std::weak_ptr<ServiceProtocol> gVMServiceProtocol;
 static std::weak_ptr<IsolateNameServer> gVMIsolateNameServer;
+static std::weak_ptr<fml::ConcurrentMessageLoop> gVMConcurrentMessageLoop;
 
 DartVMRef::DartVMRef(std::shared_ptr<DartVM> vm) : vm_(vm) {}
 
@@ -69,6 +72,7 @@ DartVMRef DartVMRef::Create(Settings settings,
   gVMData.reset();
   gVMServiceProtocol.reset();
   gVMIsolateNameServer.reset();
+  gVMConcurrentMessageLoop.reset();
   gVM.reset();
 
   // If there is no VM in the process. Initialize one, hold the weak reference
@@ -88,6 +92,7 @@ DartVMRef DartVMRef::Create(Settings settings,
   gVMData = vm->GetVMData();
   gVMServiceProtocol = vm->GetServiceProtocol();
   gVMIsolateNameServer = isolate_name_server;
+  gVMConcurrentMessageLoop = vm->GetConcurrentMessageLoop();
   gVM = vm;
 
   if (settings.leak_vm) {
@@ -117,6 +122,13 @@ std::shared_ptr<IsolateNameServer> DartVMRef::GetIsolateNameServer() {
   return gVMIsolateNameServer.lock();
 }
 
+std::shared_ptr<fml::ConcurrentTaskRunner>
+DartVMRef::GetConcurrentWorkerTaskRunner() {
+  std::scoped_lock lock(gVMDependentsMutex);
+  auto loop = gVMConcurrentMessageLoop.lock();
+  return loop ? loop->GetTaskRunner() : nullptr;
+}
+
 DartVM* DartVMRef::GetRunningVM() {
   std::scoped_lock lock(gVMMutex);
   auto vm = gVM.lock().get();
@@ -46,6 +46,9 @@ class DartVMRef {
 
   static std::shared_ptr<IsolateNameServer> GetIsolateNameServer();
 
+  static std::shared_ptr<fml::ConcurrentTaskRunner>
+  GetConcurrentWorkerTaskRunner();
+
   operator bool() const { return static_cast<bool>(vm_); }
 
   DartVM* get() {
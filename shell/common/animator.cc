@@ -21,25 +21,15 @@ constexpr fml::TimeDelta kNotifyIdleTaskWaitTime =
 
 Animator::Animator(Delegate& delegate,
                    TaskRunners task_runners,
-                   std::unique_ptr<VsyncWaiter> waiter)
+                   std::unique_ptr<VsyncWaiter> waiter,
+                   const Settings& settings)
     : delegate_(delegate),
       task_runners_(std::move(task_runners)),
       waiter_(std::move(waiter)),
       last_frame_begin_time_(),
       last_frame_target_time_(),
       dart_frame_deadline_(0),
-#if FLUTTER_SHELL_ENABLE_METAL
-      layer_tree_pipeline_(fml::MakeRefCounted<LayerTreePipeline>(2)),
-#else   // FLUTTER_SHELL_ENABLE_METAL
-      // TODO(dnfield): We should remove this logic and set the pipeline depth
-      // back to 2 in this case. See
-      // https://github.com/flutter/engine/pull/9132 for discussion.
-      layer_tree_pipeline_(fml::MakeRefCounted<LayerTreePipeline>(
-          task_runners.GetPlatformTaskRunner() ==
-                  task_runners.GetRasterTaskRunner()
-              ? 1
-              : 2)),
-#endif  // FLUTTER_SHELL_ENABLE_METAL
+      layer_tree_pipeline_(CreateLayerTreePipeline(task_runners_, settings)),
       pending_frame_semaphore_(1),
       frame_number_(1),
       paused_(false),
@@ -52,6 +42,35 @@ Animator::Animator(Delegate& delegate,
 
 Animator::~Animator() = default;
 
+fml::RefPtr<Animator::LayerTreePipeline> Animator::CreateLayerTreePipeline(
+    const TaskRunners& task_runners,
+    const Settings& settings) {
+  uint32_t depth = settings.frame_pipeline_depth;
+  if (depth == 0) {
+#if FLUTTER_SHELL_ENABLE_METAL
+    depth = 2;
+#else   // FLUTTER_SHELL_ENABLE_METAL
+    // TODO(dnfield): We should remove this logic and set the pipeline depth
+    // back to 2 in this case. See
+    // https://github.com/flutter/engine/pull/9132 for discussion.
+    depth = task_runners.GetPlatformTaskRunner() ==
+                    task_runners.GetRasterTaskRunner()
+                ? 1
+                : 2;
+#endif  // FLUTTER_SHELL_ENABLE_METAL
+  }
+
+  auto pipeline = fml::MakeRefCounted<LayerTreePipeline>(depth);
+  if (settings.drop_stale_frames) {
+    // A frame that missed its target time while a newer frame is waiting
+    // behind it would only be presented late and then immediately replaced.
+    pipeline->SetStaleItemPredicate([](const LayerTree& layer_tree) {
+      return layer_tree.target_time() < fml::TimePoint::Now();
+    });
+  }
+  return pipeline;
+}
+
 float Animator::GetDisplayRefreshRate() const {
   return waiter_->GetDisplayRefreshRate();
 }
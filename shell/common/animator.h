@@ -7,6 +7,7 @@
 
 #include <deque>
 
+#include "flutter/common/settings.h"
 #include "flutter/common/task_runners.h"
 #include "flutter/fml/memory/ref_ptr.h"
 #include "flutter/fml/memory/weak_ptr.h"
@@ -43,7 +44,8 @@ class Animator final {
 
   Animator(Delegate& delegate,
            TaskRunners task_runners,
-           std::unique_ptr<VsyncWaiter> waiter);
+           std::unique_ptr<VsyncWaiter> waiter,
+           const Settings& settings);
 
   ~Animator();
 
@@ -83,6 +85,10 @@ class Animator final {
  private:
   using LayerTreePipeline = Pipeline<flutter::LayerTree>;
 
+  static fml::RefPtr<LayerTreePipeline> CreateLayerTreePipeline(
+      const TaskRunners& task_runners,
+      const Settings& settings);
+
   void BeginFrame(fml::TimePoint frame_start_time,
                   fml::TimePoint frame_target_time);
 
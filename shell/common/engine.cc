@@ -29,6 +29,7 @@
 namespace flutter {
 
 static constexpr char kAssetChannel[] = "flutter/assets";
+static constexpr char kAssetRangeChannel[] = "flutter/assets/range";
 static constexpr char kLifecycleChannel[] = "flutter/lifecycle";
 static constexpr char kNavigationChannel[] = "flutter/navigation";
 static constexpr char kLocalizationChannel[] = "flutter/localization";
@@ -78,6 +79,14 @@ Engine::Engine(Delegate& delegate,
   );
 
   pointer_data_dispatcher_ = dispatcher_maker(*this);
+
+  if (settings_.text_layout_cache_max_bytes > 0) {
+    FontCollection::SetLayoutCacheMaxBytes(
+        settings_.text_layout_cache_max_bytes);
+  }
+  image_decoder_.SetCacheMaxBytes(settings_.decoded_image_cache_max_bytes);
+  image_decoder_.SetAnimatedImageLookahead(
+      settings_.animated_image_lookahead_frames);
 }
 
 Engine::~Engine() = default;
@@ -227,6 +236,8 @@ Engine::RunStatus Engine::PrepareAndLaunchIsolate(
 void Engine::BeginFrame(fml::TimePoint frame_time) {
   TRACE_EVENT0("flutter", "Engine::BeginFrame");
   runtime_controller_->BeginFrame(frame_time);
+  FontCollection::TraceLayoutCacheStatsToTimeline();
+  image_decoder_.TraceCacheStatsToTimeline();
 }
 
 void Engine::ReportTimings(std::vector<int64_t> timings) {
@@ -234,6 +245,10 @@ void Engine::ReportTimings(std::vector<int64_t> timings) {
   runtime_controller_->ReportTimings(std::move(timings));
 }
 
+void Engine::NotifyLowMemoryWarning() {
+  image_decoder_.PurgeCache();
+}
+
 void Engine::NotifyIdle(int64_t deadline) {
   auto trace_event = std::to_string(deadline - Dart_TimelineGetMicros());
   TRACE_EVENT1("flutter", "Engine::NotifyIdle", "deadline_now_delta",
@@ -316,7 +331,8 @@ void Engine::DispatchPlatformMessage(fml::RefPtr<PlatformMessage> message) {
 
 bool Engine::HandleLifecyclePlatformMessage(PlatformMessage* message) {
   const auto& data = message->data();
-  std::string state(reinterpret_cast<const char*>(data.data()), data.size());
+  std::string state(reinterpret_cast<const char*>(data.GetMapping()),
+                    data.GetSize());
   if (state == "AppLifecycleState.paused" ||
       state == "AppLifecycleState.detached") {
     activity_running_ = false;
@@ -343,7 +359,8 @@ bool Engine::HandleNavigationPlatformMessage(
   const auto& data = message->data();
 
   rapidjson::Document document;
-  document.Parse(reinterpret_cast<const char*>(data.data()), data.size());
+  document.Parse(reinterpret_cast<const char*>(data.GetMapping()),
+                 data.GetSize());
   if (document.HasParseError() || !document.IsObject())
     return false;
   auto root = document.GetObject();
@@ -359,7 +376,8 @@ bool Engine::HandleLocalizationPlatformMessage(PlatformMessage* message) {
   const auto& data = message->data();
 
   rapidjson::Document document;
-  document.Parse(reinterpret_cast<const char*>(data.data()), data.size());
+  document.Parse(reinterpret_cast<const char*>(data.GetMapping()),
+                 data.GetSize());
   if (document.HasParseError() || !document.IsObject())
     return false;
   auto root = document.GetObject();
@@ -394,7 +412,8 @@ bool Engine::HandleLocalizationPlatformMessage(PlatformMessage* message) {
 
 void Engine::HandleSettingsPlatformMessage(PlatformMessage* message) {
   const auto& data = message->data();
-  std::string jsonData(reinterpret_cast<const char*>(data.data()), data.size());
+  std::string jsonData(reinterpret_cast<const char*>(data.GetMapping()),
+                       data.GetSize());
   if (runtime_controller_->SetUserSettingsData(std::move(jsonData)) &&
       have_surface_) {
     ScheduleFrame();
@@ -464,6 +483,8 @@ void Engine::UpdateSemantics(SemanticsNodeUpdates update,
 void Engine::HandlePlatformMessage(fml::RefPtr<PlatformMessage> message) {
   if (message->channel() == kAssetChannel) {
     HandleAssetPlatformMessage(std::move(message));
+  } else if (message->channel() == kAssetRangeChannel) {
+    HandleAssetRangePlatformMessage(std::move(message));
   } else {
     delegate_.OnEngineHandlePlatformMessage(std::move(message));
   }
@@ -505,8 +526,8 @@ void Engine::HandleAssetPlatformMessage(fml::RefPtr<PlatformMessage> message) {
     return;
   }
   const auto& data = message->data();
-  std::string asset_name(reinterpret_cast<const char*>(data.data()),
-                         data.size());
+  std::string asset_name(reinterpret_cast<const char*>(data.GetMapping()),
+                         data.GetSize());
 
   if (asset_manager_) {
     std::unique_ptr<fml::Mapping> asset_mapping =
@@ -520,6 +541,59 @@ void Engine::HandleAssetPlatformMessage(fml::RefPtr<PlatformMessage> message) {
   response->CompleteEmpty();
 }
 
+// Reads |{"method": "getRange", "args": {"name": ..., "offset": ...,
+// "length": ...}}| and responds with the bytes of that range of the asset. A
+// response shorter than the requested length means the asset ended, so large
+// assets are read by requesting consecutive ranges until then. Each range is
+// read on the IO thread, and only when the previous one has been consumed.
+void Engine::HandleAssetRangePlatformMessage(
+    fml::RefPtr<PlatformMessage> message) {
+  fml::RefPtr<PlatformMessageResponse> response = message->response();
+  if (!response) {
+    return;
+  }
+  const auto& data = message->data();
+
+  rapidjson::Document document;
+  document.Parse(reinterpret_cast<const char*>(data.GetMapping()),
+                 data.GetSize());
+  if (document.HasParseError() || !document.IsObject() || !asset_manager_) {
+    response->CompleteEmpty();
+    return;
+  }
+  auto root = document.GetObject();
+  auto method = root.FindMember("method");
+  auto args = root.FindMember("args");
+  if (method == root.MemberEnd() || method->value != "getRange" ||
+      args == root.MemberEnd() || !args->value.IsObject()) {
+    response->CompleteEmpty();
+    return;
+  }
+  auto name = args->value.FindMember("name");
+  auto offset = args->value.FindMember("offset");
+  auto length = args->value.FindMember("length");
+  if (name == args->value.MemberEnd() || !name->value.IsString() ||
+      offset == args->value.MemberEnd() || !offset->value.IsUint64() ||
+      length == args->value.MemberEnd() || !length->value.IsUint64()) {
+    response->CompleteEmpty();
+    return;
+  }
+
+  task_runners_.GetIOTaskRunner()->PostTask(
+      [asset_manager = asset_manager_,
+       asset_name = std::string(name->value.GetString()),
+       offset = static_cast<size_t>(offset->value.GetUint64()),
+       length = static_cast<size_t>(length->value.GetUint64()), response]() {
+        auto mapping =
+            asset_manager->GetRangeAsMapping(asset_name, offset, length);
+        if (mapping) {
+          response->Complete(std::move(mapping));
+        } else {
+          response->CompleteEmpty();
+        }
+      });
+}
+
 const std::string& Engine::GetLastEntrypoint() const {
   return last_entry_point_;
 }
@@ -494,6 +494,12 @@ class Engine final : public RuntimeDelegate, PointerDataDispatcher::Delegate {
   ///
   void NotifyIdle(int64_t deadline);
 
+  //----------------------------------------------------------------------------
+  /// @brief      Notifies the engine that there is a low memory situation. The
+  ///             images cached by the image decoder are released.
+  ///
+  void NotifyLowMemoryWarning();
+
   //----------------------------------------------------------------------------
   /// @brief      Dart code cannot fully measure the time it takes for a
   ///             specific frame to be rendered. This is because Dart code only
@@ -811,6 +817,8 @@ class Engine final : public RuntimeDelegate, PointerDataDispatcher::Delegate {
 
   void HandleAssetPlatformMessage(fml::RefPtr<PlatformMessage> message);
 
+  void HandleAssetRangePlatformMessage(fml::RefPtr<PlatformMessage> message);
+
   bool GetAssetAsBuffer(const std::string& name, std::vector<uint8_t>* data);
 
   RunStatus PrepareAndLaunchIsolate(RunConfiguration configuration);
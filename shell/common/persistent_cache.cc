@@ -50,6 +50,7 @@ bool PersistentCache::gIsReadOnly = false;
 
 std::atomic<bool> PersistentCache::cache_sksl_ = false;
 std::atomic<bool> PersistentCache::strategy_set_ = false;
+std::atomic<size_t> PersistentCache::max_bytes_ = 0;
 
 void PersistentCache::SetCacheSkSL(bool value) {
   if (strategy_set_ && value != cache_sksl_) {
@@ -128,6 +129,57 @@ static std::shared_ptr<fml::UniqueFD> MakeCacheDirectory(
     return std::make_shared<fml::UniqueFD>();
   }
 }
+
+// Moves the entries stored as files of their own by older engines into
+// |store|.
+static void MigrateCacheFiles(const fml::UniqueFD& cache_directory,
+                              PersistentCacheStore& store) {
+  std::vector<std::string> file_names;
+  fml::VisitFiles(cache_directory, [&file_names](const fml::UniqueFD& directory,
+                                                 const std::string& filename) {
+    // Skip the store itself, the SkSL subdirectory, SKP dumps and temporary
+    // files, none of which have Base32 encoded names.
+    std::pair<bool, std::string> decode_result = fml::Base32Decode(filename);
+    if (decode_result.first && !decode_result.second.empty() &&
+        !fml::IsDirectory(directory, filename.c_str())) {
+      file_names.push_back(filename);
+    }
+    return true;
+  });
+  if (file_names.empty()) {
+    return;
+  }
+
+  TRACE_EVENT0("flutter", "PersistentCache::MigrateCacheFiles");
+  for (const auto& file_name : file_names) {
+    auto mapping = fml::FileMapping::CreateReadOnly(cache_directory, file_name);
+    std::string key = fml::Base32Decode(file_name).second;
+    if (mapping != nullptr && mapping->GetSize() > 0 &&
+        !store.Put(*SkData::MakeWithoutCopy(key.data(), key.size()),
+                   *SkData::MakeWithoutCopy(mapping->GetMapping(),
+                                            mapping->GetSize()))) {
+      // Leave the remaining files where they are for the next attempt.
+      FML_LOG(ERROR) << "Could not move " << file_name
+                     << " into the persistent cache store.";
+      return;
+    }
+    fml::UnlinkFile(cache_directory, file_name.c_str());
+  }
+}
+
+static std::shared_ptr<PersistentCacheStore> OpenCacheStore(
+    const std::shared_ptr<fml::UniqueFD>& cache_directory,
+    bool read_only) {
+  if (!cache_directory || !cache_directory->is_valid()) {
+    return nullptr;
+  }
+  std::shared_ptr<PersistentCacheStore> store = PersistentCacheStore::Open(
+      cache_directory, PersistentCache::kStoreFileName, read_only);
+  if (store != nullptr && !read_only) {
+    MigrateCacheFiles(*cache_directory, *store);
+  }
+  return store;
+}
 }  // namespace
 
 sk_sp<SkData> ParseBase32(const std::string& input) {
@@ -156,6 +208,9 @@ std::vector<PersistentCache::SkSLCache> PersistentCache::LoadSkSLs() {
   std::vector<PersistentCache::SkSLCache> result;
   fml::FileVisitor visitor = [&result](const fml::UniqueFD& directory,
                                        const std::string& filename) {
+    if (filename == kStoreFileName) {
+      return true;
+    }
     sk_sp<SkData> key = ParseBase32(filename);
     sk_sp<SkData> data = LoadFile(directory, filename);
     if (key != nullptr && data != nullptr) {
@@ -170,7 +225,16 @@ std::vector<PersistentCache::SkSLCache> PersistentCache::LoadSkSLs() {
   // However, we'd like to continue visit the asset dir even if this persistent
   // cache is invalid.
   if (IsValid()) {
-    fml::VisitFiles(*sksl_cache_directory_, visitor);
+    if (sksl_cache_store_ != nullptr) {
+      // Tools may still drop SkSLs into the directory as individual files.
+      if (!is_read_only_) {
+        MigrateCacheFiles(*sksl_cache_directory_, *sksl_cache_store_);
+      }
+      result = sksl_cache_store_->GetEntries();
+    }
+    if (is_read_only_ || sksl_cache_store_ == nullptr) {
+      fml::VisitFiles(*sksl_cache_directory_, visitor);
+    }
   }
 
   std::unique_ptr<fml::Mapping> mapping = nullptr;
@@ -207,7 +271,9 @@ PersistentCache::PersistentCache(bool read_only)
     : is_read_only_(read_only),
       cache_directory_(MakeCacheDirectory(cache_base_path_, read_only, false)),
       sksl_cache_directory_(
-          MakeCacheDirectory(cache_base_path_, read_only, true)) {
+          MakeCacheDirectory(cache_base_path_, read_only, true)),
+      cache_store_(OpenCacheStore(cache_directory_, read_only)),
+      sksl_cache_store_(OpenCacheStore(sksl_cache_directory_, read_only)) {
   if (!IsValid()) {
     FML_LOG(WARNING) << "Could not acquire the persistent cache directory. "
                         "Caching of GPU resources on disk is disabled.";
@@ -239,24 +305,45 @@ sk_sp<SkData> PersistentCache::load(const SkData& key) {
   if (!IsValid()) {
     return nullptr;
   }
-  auto file_name = SkKeyToFilePath(key);
-  if (file_name.size() == 0) {
-    return nullptr;
+  sk_sp<SkData> result;
+  if (cache_store_ != nullptr) {
+    result = cache_store_->Get(key);
+  }
+  // Read-only caches may have been generated by engines without stores.
+  if (result == nullptr && (is_read_only_ || cache_store_ == nullptr)) {
+    auto file_name = SkKeyToFilePath(key);
+    if (file_name.size() != 0) {
+      result = PersistentCache::LoadFile(*cache_directory_, file_name);
+    }
   }
-  auto result = PersistentCache::LoadFile(*cache_directory_, file_name);
   if (result != nullptr) {
     TRACE_EVENT0("flutter", "PersistentCacheLoadHit");
   } else {
-    FML_LOG(INFO) << "PersistentCache::load failed: " << file_name;
+    FML_LOG(INFO) << "PersistentCache::load failed: " << SkKeyToFilePath(key);
   }
   return result;
 }
 
-static void PersistentCacheStore(fml::RefPtr<fml::TaskRunner> worker,
-                                 std::shared_ptr<fml::UniqueFD> cache_directory,
-                                 std::string key,
-                                 std::unique_ptr<fml::Mapping> value) {
-  auto task =
+static void PerformOnWorker(fml::RefPtr<fml::TaskRunner> worker,
+                            fml::closure task) {
+  if (!worker) {
+    FML_LOG(WARNING)
+        << "The persistent cache has no available workers. Performing the task "
+           "on the current thread. This slow operation is going to occur on a "
+           "frame workload.";
+    task();
+  } else {
+    worker->PostTask(std::move(task));
+  }
+}
+
+static void PersistentCacheWriteFile(
+    fml::RefPtr<fml::TaskRunner> worker,
+    std::shared_ptr<fml::UniqueFD> cache_directory,
+    std::string key,
+    std::unique_ptr<fml::Mapping> value) {
+  PerformOnWorker(
+      std::move(worker),
       fml::MakeCopyable([cache_directory,             //
                          file_name = std::move(key),  //
                          mapping = std::move(value)   //
@@ -269,17 +356,7 @@ static void PersistentCacheStore(fml::RefPtr<fml::TaskRunner> worker,
           FML_DLOG(WARNING)
               << "Could not write cache contents to persistent store.";
         }
-      });
-
-  if (!worker) {
-    FML_LOG(WARNING)
-        << "The persistent cache has no available workers. Performing the task "
-           "on the current thread. This slow operation is going to occur on a "
-           "frame workload.";
-    task();
-  } else {
-    worker->PostTask(std::move(task));
-  }
+      }));
 }
 
 // |GrContextOptions::PersistentCache|
@@ -294,22 +371,38 @@ void PersistentCache::store(const SkData& key, const SkData& data) {
     return;
   }
 
-  auto file_name = SkKeyToFilePath(key);
-
-  if (file_name.size() == 0) {
+  if (key.size() == 0 || data.size() == 0) {
     return;
   }
 
-  auto mapping = std::make_unique<fml::DataMapping>(
-      std::vector<uint8_t>{data.bytes(), data.bytes() + data.size()});
-
-  if (mapping == nullptr || mapping->GetSize() == 0) {
+  std::shared_ptr<PersistentCacheStore> cache_store =
+      cache_sksl_ ? sksl_cache_store_ : cache_store_;
+  if (cache_store == nullptr) {
+    auto file_name = SkKeyToFilePath(key);
+    if (file_name.size() == 0) {
+      return;
+    }
+    auto mapping = std::make_unique<fml::DataMapping>(
+        std::vector<uint8_t>{data.bytes(), data.bytes() + data.size()});
+    PersistentCacheWriteFile(
+        GetWorkerTaskRunner(),
+        cache_sksl_ ? sksl_cache_directory_ : cache_directory_,
+        std::move(file_name), std::move(mapping));
     return;
   }
 
-  PersistentCacheStore(GetWorkerTaskRunner(),
-                       cache_sksl_ ? sksl_cache_directory_ : cache_directory_,
-                       std::move(file_name), std::move(mapping));
+  PerformOnWorker(
+      GetWorkerTaskRunner(),
+      [cache_store, max_bytes = max_bytes_.load(),
+       key_data = SkData::MakeWithCopy(key.data(), key.size()),
+       value_data = SkData::MakeWithCopy(data.data(), data.size())]() {
+        TRACE_EVENT0("flutter", "PersistentCacheStore");
+        cache_store->SetMaxBytes(max_bytes);
+        if (!cache_store->Put(*key_data, *value_data)) {
+          FML_DLOG(WARNING)
+              << "Could not write cache contents to persistent store.";
+        }
+      });
 }
 
 void PersistentCache::DumpSkp(const SkData& data) {
@@ -326,8 +419,8 @@ void PersistentCache::DumpSkp(const SkData& data) {
   FML_LOG(INFO) << "Dumping " << file_name;
   auto mapping = std::make_unique<fml::DataMapping>(
       std::vector<uint8_t>{data.bytes(), data.bytes() + data.size()});
-  PersistentCacheStore(GetWorkerTaskRunner(), cache_directory_,
-                       std::move(file_name), std::move(mapping));
+  PersistentCacheWriteFile(GetWorkerTaskRunner(), cache_directory_,
+                           std::move(file_name), std::move(mapping));
 }
 
 void PersistentCache::AddWorkerTaskRunner(
@@ -13,6 +13,7 @@
 #include "flutter/fml/macros.h"
 #include "flutter/fml/task_runner.h"
 #include "flutter/fml/unique_fd.h"
+#include "flutter/shell/common/persistent_cache_store.h"
 #include "third_party/skia/include/gpu/GrContextOptions.h"
 
 namespace flutter {
@@ -74,8 +75,17 @@ class PersistentCache : public GrContextOptions::PersistentCache {
   static void SetCacheSkSL(bool value);
   static void MarkStrategySet() { strategy_set_ = true; }
 
+  // Limits the size of each of the stores of the cache, see
+  // |Settings::persistent_cache_max_bytes|. 0 means no limit.
+  static void SetMaxBytes(size_t max_bytes) { max_bytes_ = max_bytes; }
+
   static constexpr char kSkSLSubdirName[] = "sksl";
   static constexpr char kAssetFileName[] = "io.flutter.shaders.json";
+  // The file in each cache directory that holds the entries of the cache.
+  // Older engines stored each entry in a file of its own, named after the
+  // Base32 encoding of its key. Such files are moved into the store when it is
+  // opened, unless the cache is read-only.
+  static constexpr char kStoreFileName[] = "io.flutter.persistent_cache";
 
  private:
   static std::string cache_base_path_;
@@ -95,9 +105,15 @@ class PersistentCache : public GrContextOptions::PersistentCache {
   // strategy_set_ becomes true.
   static std::atomic<bool> strategy_set_;
 
+  static std::atomic<size_t> max_bytes_;
+
   const bool is_read_only_;
   const std::shared_ptr<fml::UniqueFD> cache_directory_;
   const std::shared_ptr<fml::UniqueFD> sksl_cache_directory_;
+  // These are null if the cache is invalid, or if it is read-only and was
+  // generated by an engine that didn't have stores.
+  const std::shared_ptr<PersistentCacheStore> cache_store_;
+  const std::shared_ptr<PersistentCacheStore> sksl_cache_store_;
   mutable std::mutex worker_task_runners_mutex_;
   std::multiset<fml::RefPtr<fml::TaskRunner>> worker_task_runners_;
 
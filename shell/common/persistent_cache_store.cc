@@ -0,0 +1,424 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/persistent_cache_store.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "flutter/fml/file.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr char kFileMagic[8] = {'F', 'L', 'T', 'C', 'A', 'C', 'H', 'E'};
+constexpr uint32_t kFileVersion = 1;
+constexpr uint32_t kRecordMagic = 0x52435046;  // "FPCR"
+
+// The file grows by at least this much at a time so that putting entries
+// doesn't remap the file every time.
+constexpr size_t kMinFileGrowth = 64 * 1024;
+
+// Dead records are only compacted away once they take up this much space.
+constexpr size_t kMinCompactionBytes = 64 * 1024;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+};
+
+// Followed by the key and then the value. A record without a value removes
+// the key from the store.
+struct RecordHeader {
+  uint32_t magic;
+  uint32_t key_size;
+  uint32_t value_size;
+  // The checksum of the key and the value.
+  uint32_t checksum;
+};
+
+// FNV-1a.
+uint32_t Checksum(const uint8_t* key,
+                  size_t key_size,
+                  const uint8_t* value,
+                  size_t value_size) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < key_size; i++) {
+    hash = (hash ^ key[i]) * 16777619u;
+  }
+  for (size_t i = 0; i < value_size; i++) {
+    hash = (hash ^ value[i]) * 16777619u;
+  }
+  return hash;
+}
+
+size_t RecordSize(size_t key_size, size_t value_size) {
+  return sizeof(RecordHeader) + key_size + value_size;
+}
+
+std::string ToKey(const SkData& data) {
+  return std::string(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+}  // namespace
+
+std::unique_ptr<PersistentCacheStore> PersistentCacheStore::Open(
+    std::shared_ptr<fml::UniqueFD> directory,
+    std::string file_name,
+    bool read_only) {
+  if (!directory || !directory->is_valid() || file_name.empty()) {
+    return nullptr;
+  }
+  std::unique_ptr<PersistentCacheStore> store(new PersistentCacheStore(
+      std::move(directory), std::move(file_name), read_only));
+  std::scoped_lock lock(store->mutex_);
+  if (!store->Load()) {
+    return nullptr;
+  }
+  if (!read_only && store->ShouldCompact()) {
+    store->CompactLocked();
+  }
+  return store;
+}
+
+PersistentCacheStore::PersistentCacheStore(
+    std::shared_ptr<fml::UniqueFD> directory,
+    std::string file_name,
+    bool read_only)
+    : directory_(std::move(directory)),
+      file_name_(std::move(file_name)),
+      read_only_(read_only) {}
+
+PersistentCacheStore::~PersistentCacheStore() = default;
+
+bool PersistentCacheStore::Load() {
+  TRACE_EVENT0("flutter", "PersistentCacheStore::Load");
+  mapping_.reset();
+  index_.clear();
+  live_bytes_ = 0;
+  end_offset_ = 0;
+
+  file_ = read_only_
+              ? fml::OpenFileReadOnly(*directory_, file_name_.c_str())
+              : fml::OpenFile(*directory_, file_name_.c_str(), true,
+                              fml::FilePermission::kReadWrite);
+  if (!file_.is_valid() || !Map()) {
+    return false;
+  }
+
+  const uint8_t* data = mapping_->GetMapping();
+  const size_t size = mapping_->GetSize();
+  FileHeader file_header;
+  if (size < sizeof(FileHeader)) {
+    return read_only_ ? false : Reset();
+  }
+  std::memcpy(&file_header, data, sizeof(FileHeader));
+  if (std::memcmp(file_header.magic, kFileMagic, sizeof(kFileMagic)) != 0 ||
+      file_header.version != kFileVersion) {
+    FML_LOG(WARNING) << "Discarding the persistent cache store "
+                     << file_name_ << " of an unknown format.";
+    return read_only_ ? false : Reset();
+  }
+
+  // The records are scanned in the order they were appended, which is the
+  // order they were last used in when the file was compacted.
+  size_t offset = sizeof(FileHeader);
+  while (size - offset >= sizeof(RecordHeader)) {
+    RecordHeader header;
+    std::memcpy(&header, data + offset, sizeof(RecordHeader));
+    if (header.magic != kRecordMagic || header.key_size == 0) {
+      break;
+    }
+    const size_t remaining = size - offset - sizeof(RecordHeader);
+    if (header.key_size > remaining ||
+        header.value_size > remaining - header.key_size) {
+      break;
+    }
+    const uint8_t* key = data + offset + sizeof(RecordHeader);
+    const uint8_t* value = key + header.key_size;
+    if (Checksum(key, header.key_size, value, header.value_size) !=
+        header.checksum) {
+      break;
+    }
+    std::string key_string(reinterpret_cast<const char*>(key), header.key_size);
+    if (header.value_size == 0) {
+      RemoveFromIndex(key_string);
+    } else {
+      AddToIndex(key_string, {offset, header.key_size, header.value_size,
+                              ++use_count_});
+    }
+    offset += RecordSize(header.key_size, header.value_size);
+  }
+  end_offset_ = offset;
+  return true;
+}
+
+bool PersistentCacheStore::Reset() {
+  FML_DCHECK(!read_only_);
+  mapping_.reset();
+  index_.clear();
+  live_bytes_ = 0;
+  end_offset_ = 0;
+  if (!fml::TruncateFile(file_, 0) || !EnsureCapacity(sizeof(FileHeader))) {
+    return false;
+  }
+  FileHeader header = {};
+  std::memcpy(header.magic, kFileMagic, sizeof(kFileMagic));
+  header.version = kFileVersion;
+  std::memcpy(mapping_->GetMutableMapping(), &header, sizeof(FileHeader));
+  end_offset_ = sizeof(FileHeader);
+  return true;
+}
+
+bool PersistentCacheStore::Map() {
+  if (read_only_) {
+    mapping_ = std::make_unique<fml::FileMapping>(file_);
+  } else {
+    mapping_ = std::make_unique<fml::FileMapping>(
+        file_, std::initializer_list<fml::FileMapping::Protection>{
+                   fml::FileMapping::Protection::kRead,
+                   fml::FileMapping::Protection::kWrite});
+  }
+  if (!mapping_->IsValid()) {
+    mapping_.reset();
+    return false;
+  }
+  return true;
+}
+
+bool PersistentCacheStore::EnsureCapacity(size_t size) {
+  const size_t capacity = mapping_ ? mapping_->GetSize() : 0;
+  if (capacity >= size) {
+    return true;
+  }
+  const size_t new_capacity =
+      std::max({size, capacity * 2, capacity + kMinFileGrowth});
+  // Unmap the file while resizing it, some platforms don't allow resizing
+  // mapped files.
+  mapping_.reset();
+  const bool resized = fml::TruncateFile(file_, new_capacity);
+  if (!Map() || !resized) {
+    FML_LOG(ERROR) << "Could not grow the persistent cache store "
+                   << file_name_;
+    return false;
+  }
+  return mapping_->GetSize() >= size;
+}
+
+bool PersistentCacheStore::AppendRecord(const std::string& key,
+                                        const uint8_t* value,
+                                        size_t value_size) {
+  if (read_only_ || key.size() > UINT32_MAX || value_size > UINT32_MAX) {
+    return false;
+  }
+  const size_t record_size = RecordSize(key.size(), value_size);
+  if (!EnsureCapacity(end_offset_ + record_size)) {
+    return false;
+  }
+
+  const uint8_t* key_bytes = reinterpret_cast<const uint8_t*>(key.data());
+  RecordHeader header;
+  header.magic = kRecordMagic;
+  header.key_size = static_cast<uint32_t>(key.size());
+  header.value_size = static_cast<uint32_t>(value_size);
+  header.checksum = Checksum(key_bytes, key.size(), value, value_size);
+
+  // The header goes in last, so a record that is only partially written
+  // before a crash is likely to have no header at all.
+  uint8_t* destination = mapping_->GetMutableMapping() + end_offset_;
+  std::memcpy(destination + sizeof(RecordHeader), key_bytes, key.size());
+  if (value_size > 0) {
+    std::memcpy(destination + sizeof(RecordHeader) + key.size(), value,
+                value_size);
+  }
+  std::memcpy(destination, &header, sizeof(RecordHeader));
+  end_offset_ += record_size;
+  return true;
+}
+
+void PersistentCacheStore::AddToIndex(const std::string& key,
+                                      const IndexEntry& entry) {
+  RemoveFromIndex(key);
+  index_[key] = entry;
+  live_bytes_ += RecordSize(entry.key_size, entry.value_size);
+}
+
+void PersistentCacheStore::RemoveFromIndex(const std::string& key) {
+  auto found = index_.find(key);
+  if (found == index_.end()) {
+    return;
+  }
+  live_bytes_ -= RecordSize(found->second.key_size, found->second.value_size);
+  index_.erase(found);
+}
+
+sk_sp<SkData> PersistentCacheStore::Get(const SkData& key) {
+  std::scoped_lock lock(mutex_);
+  auto found = index_.find(ToKey(key));
+  if (found == index_.end() || !mapping_) {
+    return nullptr;
+  }
+  IndexEntry& entry = found->second;
+  entry.last_use = ++use_count_;
+  return SkData::MakeWithCopy(mapping_->GetMapping() + entry.offset +
+                                  sizeof(RecordHeader) + entry.key_size,
+                              entry.value_size);
+}
+
+bool PersistentCacheStore::Put(const SkData& key, const SkData& value) {
+  if (key.size() == 0 || value.size() == 0) {
+    return false;
+  }
+  TRACE_EVENT0("flutter", "PersistentCacheStore::Put");
+  std::scoped_lock lock(mutex_);
+  const std::string key_string = ToKey(key);
+  const size_t offset = end_offset_;
+  if (!AppendRecord(key_string, value.bytes(), value.size())) {
+    return false;
+  }
+  AddToIndex(key_string,
+             {offset, static_cast<uint32_t>(key.size()),
+              static_cast<uint32_t>(value.size()), ++use_count_});
+
+  // Never evict the entry that was just put, even if it alone is over the
+  // limit.
+  while (max_bytes_ > 0 && live_bytes_ > max_bytes_ && index_.size() > 1) {
+    EvictLeastRecentlyUsed();
+  }
+
+  if (ShouldCompact()) {
+    CompactLocked();
+  }
+  return true;
+}
+
+bool PersistentCacheStore::Remove(const SkData& key) {
+  std::scoped_lock lock(mutex_);
+  const std::string key_string = ToKey(key);
+  if (read_only_ || index_.find(key_string) == index_.end()) {
+    return false;
+  }
+  RemoveFromIndex(key_string);
+  // Even if the removal can't be recorded, the entry is gone until the store
+  // is opened again.
+  AppendRecord(key_string, nullptr, 0);
+  if (ShouldCompact()) {
+    CompactLocked();
+  }
+  return true;
+}
+
+void PersistentCacheStore::EvictLeastRecentlyUsed() {
+  auto oldest = std::min_element(
+      index_.begin(), index_.end(), [](const auto& a, const auto& b) {
+        return a.second.last_use < b.second.last_use;
+      });
+  if (oldest == index_.end()) {
+    return;
+  }
+  const std::string key = oldest->first;
+  RemoveFromIndex(key);
+  AppendRecord(key, nullptr, 0);
+}
+
+std::vector<PersistentCacheStore::Entry> PersistentCacheStore::GetEntries()
+    const {
+  std::scoped_lock lock(mutex_);
+  std::vector<Entry> entries;
+  if (!mapping_) {
+    return entries;
+  }
+  entries.reserve(index_.size());
+  for (const auto& [key, entry] : GetSortedIndex()) {
+    const uint8_t* record =
+        mapping_->GetMapping() + entry.offset + sizeof(RecordHeader);
+    entries.emplace_back(
+        SkData::MakeWithCopy(record, entry.key_size),
+        SkData::MakeWithCopy(record + entry.key_size, entry.value_size));
+  }
+  return entries;
+}
+
+std::vector<std::pair<std::string, PersistentCacheStore::IndexEntry>>
+PersistentCacheStore::GetSortedIndex() const {
+  std::vector<std::pair<std::string, IndexEntry>> sorted(index_.begin(),
+                                                         index_.end());
+  std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+    return a.second.last_use < b.second.last_use;
+  });
+  return sorted;
+}
+
+void PersistentCacheStore::SetMaxBytes(size_t max_bytes) {
+  std::scoped_lock lock(mutex_);
+  max_bytes_ = max_bytes;
+}
+
+bool PersistentCacheStore::ShouldCompact() const {
+  if (end_offset_ < sizeof(FileHeader)) {
+    return false;
+  }
+  const size_t dead_bytes = end_offset_ - sizeof(FileHeader) - live_bytes_;
+  return dead_bytes >= kMinCompactionBytes && dead_bytes > live_bytes_;
+}
+
+bool PersistentCacheStore::Compact() {
+  std::scoped_lock lock(mutex_);
+  return CompactLocked();
+}
+
+bool PersistentCacheStore::CompactLocked() {
+  if (read_only_ || !mapping_) {
+    return false;
+  }
+  TRACE_EVENT0("flutter", "PersistentCacheStore::Compact");
+
+  // The live records are written least recently used first, which is how
+  // their use order survives the store being opened again.
+  std::vector<uint8_t> data(sizeof(FileHeader) + live_bytes_);
+  std::memcpy(data.data(), mapping_->GetMapping(), sizeof(FileHeader));
+  size_t offset = sizeof(FileHeader);
+  for (const auto& [key, entry] : GetSortedIndex()) {
+    const size_t record_size = RecordSize(entry.key_size, entry.value_size);
+    std::memcpy(data.data() + offset, mapping_->GetMapping() + entry.offset,
+                record_size);
+    offset += record_size;
+  }
+  FML_DCHECK(offset == data.size());
+
+  // The file is replaced by renaming the new one over it, which some
+  // platforms don't allow while the file is open. If writing the new file
+  // fails, the old one is opened again and compacted on a later attempt.
+  mapping_.reset();
+  file_.reset();
+  fml::DataMapping new_file(std::move(data));
+  const bool written =
+      fml::WriteAtomically(*directory_, file_name_.c_str(), new_file);
+  if (!written) {
+    FML_LOG(ERROR) << "Could not compact the persistent cache store "
+                   << file_name_;
+  }
+  return Load() && written;
+}
+
+size_t PersistentCacheStore::GetEntryCount() const {
+  std::scoped_lock lock(mutex_);
+  return index_.size();
+}
+
+size_t PersistentCacheStore::GetLiveBytes() const {
+  std::scoped_lock lock(mutex_);
+  return live_bytes_;
+}
+
+size_t PersistentCacheStore::GetUsedBytes() const {
+  std::scoped_lock lock(mutex_);
+  return end_offset_;
+}
+
+}  // namespace flutter
@@ -0,0 +1,138 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_COMMON_PERSISTENT_CACHE_STORE_H_
+#define FLUTTER_SHELL_COMMON_PERSISTENT_CACHE_STORE_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/fml/unique_fd.h"
+#include "third_party/skia/include/core/SkData.h"
+
+namespace flutter {
+
+/// A file of key-value records that entries are only ever appended to.
+///
+/// The persistent cache keeps all the entries of a cache directory in one such
+/// file instead of one file per entry. The file is memory-mapped and indexed
+/// when it is opened, so looking up an entry doesn't touch the file system.
+///
+/// Replacing or evicting an entry leaves its old record in the file. Once
+/// these dead records take up most of the file, the live entries are written
+/// to a new file that atomically replaces the old one.
+///
+/// Every record is checksummed. A record torn by a crash is dropped together
+/// with everything after it when the file is opened, and is overwritten by the
+/// next entry put in the store.
+///
+/// This class is thread-safe.
+class PersistentCacheStore {
+ public:
+  using Entry = std::pair<sk_sp<SkData>, sk_sp<SkData>>;
+
+  /// Opens the store in the file |file_name| of |directory|, creating the file
+  /// unless |read_only| is true. Returns nullptr if the file can't be opened,
+  /// or if a read-only file doesn't hold a store.
+  static std::unique_ptr<PersistentCacheStore> Open(
+      std::shared_ptr<fml::UniqueFD> directory,
+      std::string file_name,
+      bool read_only);
+
+  ~PersistentCacheStore();
+
+  /// Returns a copy of the value of |key|, or nullptr if there is none.
+  sk_sp<SkData> Get(const SkData& key);
+
+  /// Sets the value of |key|, evicting the least recently used entries if the
+  /// store gets larger than the limit set by |SetMaxBytes|. Empty keys and
+  /// values are not allowed.
+  bool Put(const SkData& key, const SkData& value);
+
+  /// Removes the entry of |key|. Returns false if there is none.
+  bool Remove(const SkData& key);
+
+  /// Returns copies of all the entries, least recently used first.
+  std::vector<Entry> GetEntries() const;
+
+  /// Limits the size of the live records of the store. 0 means no limit.
+  void SetMaxBytes(size_t max_bytes);
+
+  /// Rewrites the file with the live entries only.
+  bool Compact();
+
+  size_t GetEntryCount() const;
+
+  /// The size of the records of the live entries.
+  size_t GetLiveBytes() const;
+
+  /// The size of the part of the file that holds records, including dead
+  /// ones.
+  size_t GetUsedBytes() const;
+
+ private:
+  struct IndexEntry {
+    size_t offset = 0;
+    uint32_t key_size = 0;
+    uint32_t value_size = 0;
+    // The value of |use_count_| when the entry was last used.
+    uint64_t last_use = 0;
+  };
+
+  const std::shared_ptr<fml::UniqueFD> directory_;
+  const std::string file_name_;
+  const bool read_only_;
+  mutable std::mutex mutex_;
+  fml::UniqueFD file_;
+  std::unique_ptr<fml::FileMapping> mapping_;
+  std::unordered_map<std::string, IndexEntry> index_;
+  size_t end_offset_ = 0;
+  size_t live_bytes_ = 0;
+  uint64_t use_count_ = 0;
+  size_t max_bytes_ = 0;
+
+  PersistentCacheStore(std::shared_ptr<fml::UniqueFD> directory,
+                       std::string file_name,
+                       bool read_only);
+
+  // Opens the file and builds the index of its records.
+  bool Load();
+
+  // Discards the contents of the file and writes an empty store to it.
+  bool Reset();
+
+  bool Map();
+
+  bool EnsureCapacity(size_t size);
+
+  // Appends a record for |key|. A record without a value removes the key.
+  bool AppendRecord(const std::string& key,
+                    const uint8_t* value,
+                    size_t value_size);
+
+  void AddToIndex(const std::string& key, const IndexEntry& entry);
+
+  void RemoveFromIndex(const std::string& key);
+
+  void EvictLeastRecentlyUsed();
+
+  bool ShouldCompact() const;
+
+  bool CompactLocked();
+
+  std::vector<std::pair<std::string, IndexEntry>> GetSortedIndex() const;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PersistentCacheStore);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_COMMON_PERSISTENT_CACHE_STORE_H_
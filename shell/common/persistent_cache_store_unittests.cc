@@ -0,0 +1,170 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+#include <string>
+
+#include "flutter/fml/file.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/shell/common/persistent_cache_store.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+constexpr char kStoreFileName[] = "store";
+
+sk_sp<SkData> MakeData(const std::string& string) {
+  return SkData::MakeWithCopy(string.data(), string.size());
+}
+
+std::string ToString(const sk_sp<SkData>& data) {
+  if (data == nullptr) {
+    return "";
+  }
+  return std::string(reinterpret_cast<const char*>(data->data()),
+                     data->size());
+}
+
+}  // namespace
+
+class PersistentCacheStoreTest : public ::testing::Test {
+ protected:
+  fml::ScopedTemporaryDirectory dir_;
+
+  std::unique_ptr<PersistentCacheStore> OpenStore(bool read_only = false) {
+    return PersistentCacheStore::Open(
+        std::make_shared<fml::UniqueFD>(
+            fml::OpenDirectory(dir_.path().c_str(), false,
+                               fml::FilePermission::kReadWrite)),
+        kStoreFileName, read_only);
+  }
+
+  // |testing::Test|
+  void TearDown() override { fml::RemoveFilesInDirectory(dir_.fd()); }
+};
+
+TEST_F(PersistentCacheStoreTest, EntriesArePersisted) {
+  {
+    auto store = OpenStore();
+    ASSERT_NE(store, nullptr);
+    ASSERT_TRUE(store->Put(*MakeData("a"), *MakeData("x")));
+    ASSERT_TRUE(store->Put(*MakeData("b"), *MakeData("y")));
+    ASSERT_TRUE(store->Put(*MakeData("a"), *MakeData("z")));
+    ASSERT_TRUE(store->Put(*MakeData("c"), *MakeData("w")));
+    ASSERT_TRUE(store->Remove(*MakeData("c")));
+    ASSERT_EQ(ToString(store->Get(*MakeData("a"))), "z");
+  }
+
+  auto store = OpenStore();
+  ASSERT_NE(store, nullptr);
+  ASSERT_EQ(store->GetEntryCount(), 2u);
+  ASSERT_EQ(ToString(store->Get(*MakeData("a"))), "z");
+  ASSERT_EQ(ToString(store->Get(*MakeData("b"))), "y");
+  ASSERT_EQ(store->Get(*MakeData("c")), nullptr);
+  ASSERT_FALSE(store->Put(*MakeData("d"), *MakeData("")));
+}
+
+TEST_F(PersistentCacheStoreTest, ReadOnlyStoreIsNotCreated) {
+  ASSERT_EQ(OpenStore(true), nullptr);
+  ASSERT_FALSE(fml::FileExists(dir_.fd(), kStoreFileName));
+
+  ASSERT_TRUE(OpenStore()->Put(*MakeData("a"), *MakeData("x")));
+  auto store = OpenStore(true);
+  ASSERT_NE(store, nullptr);
+  ASSERT_EQ(ToString(store->Get(*MakeData("a"))), "x");
+  ASSERT_FALSE(store->Put(*MakeData("b"), *MakeData("y")));
+}
+
+TEST_F(PersistentCacheStoreTest, EvictsLeastRecentlyUsedEntries) {
+  auto store = OpenStore();
+  ASSERT_NE(store, nullptr);
+  const std::string value(1000, 'v');
+  ASSERT_TRUE(store->Put(*MakeData("a"), *MakeData(value)));
+  ASSERT_TRUE(store->Put(*MakeData("b"), *MakeData(value)));
+  ASSERT_TRUE(store->Put(*MakeData("c"), *MakeData(value)));
+  store->SetMaxBytes(store->GetLiveBytes());
+
+  // Using "a" makes "b" the least recently used entry.
+  ASSERT_NE(store->Get(*MakeData("a")), nullptr);
+  ASSERT_TRUE(store->Put(*MakeData("d"), *MakeData(value)));
+  ASSERT_EQ(store->GetEntryCount(), 3u);
+  ASSERT_EQ(store->Get(*MakeData("b")), nullptr);
+
+  // Compacting the store keeps the use order when it is opened again.
+  ASSERT_TRUE(store->Compact());
+  store = OpenStore();
+  ASSERT_EQ(store->Get(*MakeData("b")), nullptr);
+  store->SetMaxBytes(store->GetLiveBytes());
+  ASSERT_TRUE(store->Put(*MakeData("e"), *MakeData(value)));
+  ASSERT_EQ(store->Get(*MakeData("c")), nullptr);
+  ASSERT_NE(store->Get(*MakeData("a")), nullptr);
+  ASSERT_NE(store->Get(*MakeData("d")), nullptr);
+}
+
+TEST_F(PersistentCacheStoreTest, DeadRecordsAreCompacted) {
+  auto store = OpenStore();
+  ASSERT_NE(store, nullptr);
+  const std::string value(10000, 'v');
+  for (int i = 0; i < 100; i++) {
+    ASSERT_TRUE(
+        store->Put(*MakeData(std::to_string(i % 2)), *MakeData(value)));
+  }
+  ASSERT_EQ(store->GetEntryCount(), 2u);
+  ASSERT_LT(store->GetUsedBytes(), 20 * value.size());
+
+  store = OpenStore();
+  ASSERT_EQ(store->GetEntryCount(), 2u);
+  ASSERT_EQ(ToString(store->Get(*MakeData("1"))), value);
+}
+
+TEST_F(PersistentCacheStoreTest, TornRecordsAreDropped) {
+  size_t first_record_end = 0;
+  {
+    auto store = OpenStore();
+    ASSERT_TRUE(store->Put(*MakeData("a"), *MakeData("x")));
+    first_record_end = store->GetUsedBytes();
+    ASSERT_TRUE(store->Put(*MakeData("b"), *MakeData("y")));
+  }
+
+  {
+    // Corrupt the value of the second record.
+    auto file = fml::OpenFile(dir_.fd(), kStoreFileName, false,
+                              fml::FilePermission::kReadWrite);
+    fml::FileMapping mapping(file, {fml::FileMapping::Protection::kRead,
+                                    fml::FileMapping::Protection::kWrite});
+    ASSERT_TRUE(mapping.IsValid());
+    uint8_t* second_record = mapping.GetMutableMapping() + first_record_end;
+    second_record[sizeof(uint32_t) * 4 + 1] ^= 0xff;
+  }
+
+  auto store = OpenStore();
+  ASSERT_NE(store, nullptr);
+  ASSERT_EQ(store->GetUsedBytes(), first_record_end);
+  ASSERT_EQ(ToString(store->Get(*MakeData("a"))), "x");
+  ASSERT_EQ(store->Get(*MakeData("b")), nullptr);
+
+  // The torn record is overwritten by the next entry.
+  ASSERT_TRUE(store->Put(*MakeData("c"), *MakeData("zzz")));
+  store = OpenStore();
+  ASSERT_EQ(store->GetEntryCount(), 2u);
+  ASSERT_EQ(ToString(store->Get(*MakeData("c"))), "zzz");
+}
+
+TEST_F(PersistentCacheStoreTest, FilesOfUnknownFormatAreDiscarded) {
+  const std::string garbage = "not a persistent cache store";
+  fml::DataMapping data(std::vector<uint8_t>{garbage.begin(), garbage.end()});
+  ASSERT_TRUE(fml::WriteAtomically(dir_.fd(), kStoreFileName, data));
+
+  ASSERT_EQ(OpenStore(true), nullptr);
+  auto store = OpenStore();
+  ASSERT_NE(store, nullptr);
+  ASSERT_EQ(store->GetEntryCount(), 0u);
+  ASSERT_TRUE(store->Put(*MakeData("a"), *MakeData("x")));
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -240,5 +240,35 @@ TEST_F(ShellTest, CanRemoveOldPersistentCache) {
   fml::RemoveFilesInDirectory(base_dir.fd());
 }
 
+TEST_F(ShellTest, MigratesCacheFilesIntoStore) {
+  fml::ScopedTemporaryDirectory base_dir;
+  ASSERT_TRUE(base_dir.fd().is_valid());
+
+  // Older engines stored each entry in a file named after the Base32 encoding
+  // of its key. "IE" is the encoding of "A".
+  auto cache_dir = fml::CreateDirectory(
+      base_dir.fd(),
+      {"flutter_engine", GetFlutterEngineVersion(), "skia", GetSkiaVersion()},
+      fml::FilePermission::kReadWrite);
+  ASSERT_TRUE(cache_dir.is_valid());
+  const std::string x = "x";
+  fml::DataMapping x_data(std::vector<uint8_t>{x.begin(), x.end()});
+  ASSERT_TRUE(fml::WriteAtomically(cache_dir, "IE", x_data));
+
+  PersistentCache::SetCacheDirectoryPath(base_dir.path());
+  PersistentCache::ResetCacheForProcess();
+
+  ASSERT_FALSE(fml::FileExists(cache_dir, "IE"));
+  ASSERT_TRUE(fml::FileExists(cache_dir, PersistentCache::kStoreFileName));
+  const std::string a = "A";
+  sk_sp<SkData> loaded = PersistentCache::GetCacheForProcess()->load(
+      *SkData::MakeWithCopy(a.data(), a.size()));
+  ASSERT_NE(loaded, nullptr);
+  CheckTextSkData(loaded, "x");
+
+  // Cleanup
+  fml::RemoveFilesInDirectory(base_dir.fd());
+}
+
 }  // namespace testing
 }  // namespace flutter
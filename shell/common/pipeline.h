@@ -8,11 +8,15 @@
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/ref_counted.h"
 #include "flutter/fml/synchronization/semaphore.h"
+#include "flutter/fml/time/time_point.h"
 #include "flutter/fml/trace_event.h"
 
+#include <atomic>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 namespace flutter {
 
@@ -26,6 +30,11 @@ size_t GetNextPipelineTraceID();
 
 /// A thread-safe queue of resources for a single consumer and a single
 /// producer.
+///
+/// The producer may work on up to |depth| resources ahead of the consumer. If
+/// a stale item predicate is set, the consumer skips the stale items at the
+/// front of the queue when newer items are queued behind them, so that it
+/// catches up with the producer instead of working through a backlog.
 template <class R>
 class Pipeline : public fml::RefCountedThreadSafe<Pipeline<R>> {
  public:
@@ -97,6 +106,18 @@ class Pipeline : public fml::RefCountedThreadSafe<Pipeline<R>> {
 
   bool IsValid() const { return empty_.IsValid() && available_.IsValid(); }
 
+  using StaleItemPredicate = std::function<bool(const Resource&)>;
+
+  /// Sets the predicate |Consume| uses to decide whether the item at the front
+  /// of the queue may be skipped. The newest item is never skipped.
+  void SetStaleItemPredicate(StaleItemPredicate is_stale) {
+    std::scoped_lock lock(queue_mutex_);
+    is_stale_ = std::move(is_stale);
+  }
+
+  /// The number of items skipped by |Consume| because they were stale.
+  size_t GetDroppedItemCount() const { return dropped_items_.load(); }
+
   ProducerContinuation Produce() {
     if (!empty_.TryWait()) {
       return {};
@@ -145,44 +166,90 @@ class Pipeline : public fml::RefCountedThreadSafe<Pipeline<R>> {
       return PipelineConsumeResult::NoneAvailable;
     }
 
-    ResourcePtr resource;
-    size_t trace_id = 0;
+    QueueItem item;
     size_t items_count = 0;
+    // Destroyed after the queue mutex has been released.
+    std::vector<QueueItem> stale_items;
 
     {
       std::scoped_lock lock(queue_mutex_);
-      std::tie(resource, trace_id) = std::move(queue_.front());
+      // Items committed after the semaphore was acquired may not have been
+      // signaled yet, in which case they aren't accounted for and can't be
+      // skipped.
+      while (is_stale_ && queue_.size() > 1 && queue_.front().resource &&
+             is_stale_(*queue_.front().resource) && available_.TryWait()) {
+        stale_items.emplace_back(std::move(queue_.front()));
+        queue_.pop_front();
+      }
+      item = std::move(queue_.front());
       queue_.pop_front();
       items_count = queue_.size();
     }
 
+    if (!stale_items.empty()) {
+      TRACE_EVENT0("flutter", "PipelineDropStaleItems");
+      dropped_items_ += stale_items.size();
+      for (const auto& stale_item : stale_items) {
+        EndItem(stale_item.trace_id);
+      }
+      stale_items.clear();
+    }
+
+    TraceConsumedItem(item, items_count);
+
     {
       TRACE_EVENT0("flutter", "PipelineConsume");
-      consumer(std::move(resource));
+      consumer(std::move(item.resource));
     }
 
-    empty_.Signal();
-    --inflight_;
-
-    TRACE_FLOW_END("flutter", "PipelineItem", trace_id);
-    TRACE_EVENT_ASYNC_END0("flutter", "PipelineItem", trace_id);
+    EndItem(item.trace_id);
 
     return items_count > 0 ? PipelineConsumeResult::MoreAvailable
                            : PipelineConsumeResult::Done;
   }
 
  private:
+  struct QueueItem {
+    ResourcePtr resource;
+    size_t trace_id = 0;
+    fml::TimePoint commit_time;
+  };
+
   const uint32_t depth_;
   fml::Semaphore empty_;
   fml::Semaphore available_;
   std::atomic<int> inflight_;
+  std::atomic<size_t> dropped_items_ = 0;
   std::mutex queue_mutex_;
-  std::deque<std::pair<ResourcePtr, size_t>> queue_;
+  std::deque<QueueItem> queue_;
+  StaleItemPredicate is_stale_;
+
+  // Releases the spot of a consumed or dropped item to the producer.
+  void EndItem(size_t trace_id) {
+    empty_.Signal();
+    --inflight_;
+
+    TRACE_FLOW_END("flutter", "PipelineItem", trace_id);
+    TRACE_EVENT_ASYNC_END0("flutter", "PipelineItem", trace_id);
+  }
+
+  void TraceConsumedItem(const QueueItem& item, size_t items_count) {
+#if !FLUTTER_RELEASE
+    const int64_t age_us =
+        (fml::TimePoint::Now() - item.commit_time).ToMicroseconds();
+    FML_TRACE_COUNTER("flutter", "Pipeline Queue",
+                      reinterpret_cast<int64_t>(this),        //
+                      "items queued", items_count,            //
+                      "consumed item age (us)", age_us,       //
+                      "items dropped", dropped_items_.load()  //
+    );
+#endif  // !FLUTTER_RELEASE
+  }
 
   bool ProducerCommit(ResourcePtr resource, size_t trace_id) {
     {
       std::scoped_lock lock(queue_mutex_);
-      queue_.emplace_back(std::move(resource), trace_id);
+      queue_.push_back({std::move(resource), trace_id, fml::TimePoint::Now()});
     }
 
     // Ensure the queue mutex is not held as that would be a pessimization.
@@ -199,7 +266,7 @@ class Pipeline : public fml::RefCountedThreadSafe<Pipeline<R>> {
         empty_.Signal();
         return false;
       }
-      queue_.emplace_back(std::move(resource), trace_id);
+      queue_.push_back({std::move(resource), trace_id, fml::TimePoint::Now()});
     }
 
     // Ensure the queue mutex is not held as that would be a pessimization.
@@ -7,6 +7,7 @@
 #include <functional>
 #include <future>
 #include <memory>
+#include <vector>
 
 #include "flutter/shell/common/pipeline.h"
 #include "gtest/gtest.h"
@@ -130,5 +131,61 @@ TEST(PipelineTest, ProduceIfEmptySuccessfulIfQueueIsEmpty) {
   ASSERT_EQ(consume_result_1, PipelineConsumeResult::Done);
 }
 
+TEST(PipelineTest, ProducerCanRunAheadByDepth) {
+  const int depth = 3;
+  fml::RefPtr<IntPipeline> pipeline = fml::MakeRefCounted<IntPipeline>(depth);
+
+  std::vector<Continuation> continuations;
+  for (int i = 0; i < depth; i++) {
+    continuations.emplace_back(pipeline->Produce());
+    ASSERT_TRUE(continuations.back());
+  }
+  ASSERT_FALSE(pipeline->Produce());
+
+  for (int i = 0; i < depth; i++) {
+    ASSERT_TRUE(continuations[i].Complete(std::make_unique<int>(i)));
+  }
+
+  for (int i = 0; i < depth; i++) {
+    PipelineConsumeResult consume_result = pipeline->Consume(
+        [i](std::unique_ptr<int> v) { ASSERT_EQ(*v, i); });
+    ASSERT_EQ(consume_result, i + 1 < depth
+                                  ? PipelineConsumeResult::MoreAvailable
+                                  : PipelineConsumeResult::Done);
+  }
+  ASSERT_TRUE(pipeline->Produce());
+}
+
+TEST(PipelineTest, StaleItemsAreSkippedWhenNewerItemsAreQueued) {
+  const int depth = 4;
+  fml::RefPtr<IntPipeline> pipeline = fml::MakeRefCounted<IntPipeline>(depth);
+  // Odd values are stale.
+  pipeline->SetStaleItemPredicate([](const int& v) { return v % 2 == 1; });
+
+  for (int value : {1, 3, 4, 5}) {
+    Continuation continuation = pipeline->Produce();
+    ASSERT_TRUE(continuation.Complete(std::make_unique<int>(value)));
+  }
+
+  std::vector<int> consumed;
+  auto consumer = [&consumed](std::unique_ptr<int> v) {
+    consumed.push_back(*v);
+  };
+  ASSERT_EQ(pipeline->Consume(consumer), PipelineConsumeResult::MoreAvailable);
+  // The last item is stale too, but there is nothing newer to replace it.
+  ASSERT_EQ(pipeline->Consume(consumer), PipelineConsumeResult::Done);
+  ASSERT_EQ(pipeline->Consume(consumer), PipelineConsumeResult::NoneAvailable);
+
+  ASSERT_EQ(consumed, std::vector<int>({4, 5}));
+  ASSERT_EQ(pipeline->GetDroppedItemCount(), 2u);
+
+  // The spots of the skipped items are available to the producer again.
+  std::vector<Continuation> continuations;
+  for (int i = 0; i < depth; i++) {
+    continuations.emplace_back(pipeline->Produce());
+    ASSERT_TRUE(continuations.back());
+  }
+}
+
 }  // namespace testing
 }  // namespace flutter
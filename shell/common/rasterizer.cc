@@ -422,10 +422,25 @@ RasterStatus Rasterizer::DrawToSurface(flutter::LayerTree& layer_tree) {
   );
 
   if (compositor_frame) {
-    RasterStatus raster_status = compositor_frame->Raster(layer_tree, false);
+    // Damage is only tracked when the frame is drawn into a single surface
+    // that makes use of it. External view embedders split the frame across
+    // multiple surfaces. Partial repaint is only possible when that surface
+    // still holds the previously rasterized frame, but the damage is reported
+    // either way.
+    FrameDamage frame_damage;
+    FrameDamage* frame_damage_ptr = nullptr;
+    if (external_view_embedder == nullptr && frame->wants_damage()) {
+      frame_damage.prev_layer_tree = last_layer_tree_.get();
+      frame_damage.repaint_entire_frame = !frame->retains_previous_contents();
+      frame_damage_ptr = &frame_damage;
+    }
+
+    RasterStatus raster_status =
+        compositor_frame->Raster(layer_tree, false, frame_damage_ptr);
     if (raster_status == RasterStatus::kFailed) {
       return raster_status;
     }
+    frame->set_damage(frame_damage.damage);
     if (external_view_embedder != nullptr) {
       FML_DCHECK(!frame->IsSubmitted());
       external_view_embedder->SubmitFrame(surface_->GetContext(),
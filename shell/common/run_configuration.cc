@@ -7,6 +7,7 @@
 #include <sstream>
 
 #include "flutter/assets/directory_asset_bundle.h"
+#include "flutter/assets/packed_asset_bundle.h"
 #include "flutter/fml/file.h"
 #include "flutter/fml/unique_fd.h"
 #include "flutter/runtime/dart_vm.h"
@@ -14,19 +15,29 @@
 
 namespace flutter {
 
+// Adds the assets of |directory|, preferring the ones in its packed bundle.
+static void PushBackAssetDirectory(AssetManager& asset_manager,
+                                   fml::UniqueFD directory) {
+  if (directory.is_valid()) {
+    asset_manager.PushBack(PackedAssetBundle::Open(directory));
+  }
+  asset_manager.PushBack(
+      std::make_unique<DirectoryAssetBundle>(std::move(directory)));
+}
+
 RunConfiguration RunConfiguration::InferFromSettings(
     const Settings& settings,
     fml::RefPtr<fml::TaskRunner> io_worker) {
   auto asset_manager = std::make_shared<AssetManager>();
 
   if (fml::UniqueFD::traits_type::IsValid(settings.assets_dir)) {
-    asset_manager->PushBack(std::make_unique<DirectoryAssetBundle>(
-        fml::Duplicate(settings.assets_dir)));
+    PushBackAssetDirectory(*asset_manager,
+                           fml::Duplicate(settings.assets_dir));
   }
 
-  asset_manager->PushBack(
-      std::make_unique<DirectoryAssetBundle>(fml::OpenDirectory(
-          settings.assets_path.c_str(), false, fml::FilePermission::kRead)));
+  PushBackAssetDirectory(
+      *asset_manager, fml::OpenDirectory(settings.assets_path.c_str(), false,
+                                         fml::FilePermission::kRead));
 
   return {IsolateConfiguration::InferFromSettings(settings, asset_manager,
                                                   io_worker),
@@ -39,6 +39,13 @@ constexpr char kSystemChannel[] = "flutter/system";
 constexpr char kTypeKey[] = "type";
 constexpr char kFontChange[] = "fontsChange";
 
+// The priority of the events that the platform view dispatches to the engine.
+// Pointer data packets run ahead of the other tasks on the UI task runner, but
+// must still be delivered in order with the metrics, platform messages and
+// semantics changes dispatched before them. Tasks of the same priority run in
+// the order they are posted, so all of those events share one priority.
+constexpr fml::TaskPriority kPlatformEventPriority = fml::TaskPriority::kInput;
+
 std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
     DartVMRef vm,
     TaskRunners task_runners,
@@ -68,6 +75,21 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
   ]() {
         TRACE_EVENT0("flutter", "ShellSetupGPUSubsystem");
         std::unique_ptr<Rasterizer> rasterizer(on_create_rasterizer(*shell));
+        const Settings& settings = shell->GetSettings();
+        rasterizer->compositor_context()->raster_cache().SetRetentionPolicy(
+            settings.raster_cache_max_idle_frames,
+            settings.raster_cache_max_bytes);
+        if (settings.concurrent_raster_cache_population) {
+          rasterizer->compositor_context()
+              ->raster_cache()
+              .SetConcurrentTaskRunner(
+                  shell->GetDartVM()->GetConcurrentWorkerTaskRunner());
+        }
+        if (settings.software_raster_tile_count > 1) {
+          rasterizer->compositor_context()->SetTiledRasterization(
+              shell->GetDartVM()->GetConcurrentWorkerTaskRunner(),
+              settings.software_raster_tile_count);
+        }
         snapshot_delegate_promise.set_value(rasterizer->GetSnapshotDelegate());
         rasterizer_promise.set_value(std::move(rasterizer));
       });
@@ -78,13 +100,6 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
     return nullptr;
   }
 
-  // Ask the platform view for the vsync waiter. This will be used by the engine
-  // to create the animator.
-  auto vsync_waiter = platform_view->CreateVSyncWaiter();
-  if (!vsync_waiter) {
-    return nullptr;
-  }
-
   // Create the IO manager on the IO thread. The IO manager must be initialized
   // first because it has state that the other subsystems depend on. It must
   // first be booted and the necessary references obtained to initialize the
@@ -121,6 +136,21 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
         io_manager_promise.set_value(std::move(io_manager));
       });
 
+  // Ask the platform view for the vsync waiter. This will be used by the engine
+  // to create the animator. The resource context is created on the IO thread
+  // in the meantime.
+  auto vsync_waiter = platform_view->CreateVSyncWaiter();
+  if (!vsync_waiter) {
+    // The IO subsystem refers to the promises on this stack. Once it is set
+    // up, the IO manager must be collected on the IO thread.
+    fml::TaskRunner::RunNowOrPostTask(
+        io_task_runner,
+        fml::MakeCopyable([io_manager = io_manager_future.get()]() mutable {
+          io_manager.reset();
+        }));
+    return nullptr;
+  }
+
   // Send dispatcher_maker to the engine constructor because shell won't have
   // platform_view set until Shell::Setup is called later.
   auto dispatcher_maker = platform_view->GetDispatcherMaker();
@@ -145,8 +175,10 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
 
         // The animator is owned by the UI thread but it gets its vsync pulses
         // from the platform.
-        auto animator = std::make_unique<Animator>(*shell, task_runners,
-                                                   std::move(vsync_waiter));
+        auto animator =
+            std::make_unique<Animator>(*shell, task_runners,
+                                       std::move(vsync_waiter),
+                                       shell->GetSettings());
 
         engine_promise.set_value(std::make_unique<Engine>(
             *shell,                         //
@@ -257,6 +289,7 @@ std::unique_ptr<Shell> Shell::Create(
     Shell::CreateCallback<Rasterizer> on_create_rasterizer) {
   PerformInitializationTasks(settings);
   PersistentCache::SetCacheSkSL(settings.cache_sksl);
+  PersistentCache::SetMaxBytes(settings.persistent_cache_max_bytes);
 
   TRACE_EVENT0("flutter", "Shell::Create");
 
@@ -285,6 +318,7 @@ std::unique_ptr<Shell> Shell::Create(
     DartVMRef vm) {
   PerformInitializationTasks(settings);
   PersistentCache::SetCacheSkSL(settings.cache_sksl);
+  PersistentCache::SetMaxBytes(settings.persistent_cache_max_bytes);
 
   TRACE_EVENT0("flutter", "Shell::CreateWithSnapshots");
 
@@ -384,30 +418,39 @@ Shell::~Shell() {
 
   fml::AutoResetWaitableEvent ui_latch, gpu_latch, platform_latch, io_latch;
 
-  fml::TaskRunner::RunNowOrPostTask(
-      task_runners_.GetUITaskRunner(),
-      fml::MakeCopyable([engine = std::move(engine_), &ui_latch]() mutable {
-        engine.reset();
-        ui_latch.Signal();
-      }));
-  ui_latch.Wait();
-
+  // The rasterizer only holds on to state of the raster thread, so it is torn
+  // down while the engine is torn down on the UI thread. |rasterizer_| is
+  // moved out right away, so code that runs on the UI thread must use
+  // |weak_rasterizer_| instead.
   fml::TaskRunner::RunNowOrPostTask(
       task_runners_.GetRasterTaskRunner(),
       fml::MakeCopyable([rasterizer = std::move(rasterizer_),
                          weak_factory_gpu = std::move(weak_factory_gpu_),
                          &gpu_latch]() mutable {
+        TRACE_EVENT0("flutter", "ShellTeardownGPUSubsystem");
         rasterizer.reset();
         weak_factory_gpu.reset();
         gpu_latch.Signal();
       }));
-  gpu_latch.Wait();
+
+  fml::TaskRunner::RunNowOrPostTask(
+      task_runners_.GetUITaskRunner(),
+      fml::MakeCopyable([engine = std::move(engine_), &ui_latch]() mutable {
+        TRACE_EVENT0("flutter", "ShellTeardownUISubsystem");
+        engine.reset();
+        ui_latch.Signal();
+      }));
+
+  // Shutting down the isolate releases the resources it uploaded through the
+  // IO manager, so the IO manager must outlive the engine.
+  ui_latch.Wait();
 
   fml::TaskRunner::RunNowOrPostTask(
       task_runners_.GetIOTaskRunner(),
       fml::MakeCopyable([io_manager = std::move(io_manager_),
                          platform_view = platform_view_.get(),
                          &io_latch]() mutable {
+        TRACE_EVENT0("flutter", "ShellTeardownIOSubsystem");
         io_manager.reset();
         if (platform_view) {
           platform_view->ReleaseResourceContext();
@@ -416,6 +459,7 @@ Shell::~Shell() {
       }));
 
   io_latch.Wait();
+  gpu_latch.Wait();
 
   // The platform view must go last because it may be holding onto platform side
   // counterparts to resources owned by subsystems running on other threads. For
@@ -424,6 +468,7 @@ Shell::~Shell() {
       task_runners_.GetPlatformTaskRunner(),
       fml::MakeCopyable([platform_view = std::move(platform_view_),
                          &platform_latch]() mutable {
+        TRACE_EVENT0("flutter", "ShellTeardownPlatformSubsystem");
         platform_view.reset();
         platform_latch.Signal();
       }));
@@ -440,6 +485,12 @@ void Shell::NotifyLowMemoryWarning() const {
   // running.
   ::Dart_NotifyLowMemory();
 
+  task_runners_.GetUITaskRunner()->PostTask([engine = weak_engine_]() {
+    if (engine) {
+      engine->NotifyLowMemoryWarning();
+    }
+  });
+
   task_runners_.GetRasterTaskRunner()->PostTask(
       [rasterizer = rasterizer_->GetWeakPtr(), trace_id = trace_id]() {
         if (rasterizer) {
@@ -784,12 +835,13 @@ void Shell::OnPlatformViewSetViewportMetrics(const ViewportMetrics& metrics) {
         }
       });
 
-  task_runners_.GetUITaskRunner()->PostTask(
+  task_runners_.GetUITaskRunner()->PostTaskWithPriority(
       [engine = engine_->GetWeakPtr(), metrics]() {
         if (engine) {
           engine->SetViewportMetrics(metrics);
         }
-      });
+      },
+      kPlatformEventPriority);
 }
 
 // |PlatformView::Delegate|
@@ -798,12 +850,13 @@ void Shell::OnPlatformViewDispatchPlatformMessage(
   FML_DCHECK(is_setup_);
   FML_DCHECK(task_runners_.GetPlatformTaskRunner()->RunsTasksOnCurrentThread());
 
-  task_runners_.GetUITaskRunner()->PostTask(
+  task_runners_.GetUITaskRunner()->PostTaskWithPriority(
       [engine = engine_->GetWeakPtr(), message = std::move(message)] {
         if (engine) {
           engine->DispatchPlatformMessage(std::move(message));
         }
-      });
+      },
+      kPlatformEventPriority);
 }
 
 // |PlatformView::Delegate|
@@ -813,13 +866,14 @@ void Shell::OnPlatformViewDispatchPointerDataPacket(
   TRACE_FLOW_BEGIN("flutter", "PointerEvent", next_pointer_flow_id_);
   FML_DCHECK(is_setup_);
   FML_DCHECK(task_runners_.GetPlatformTaskRunner()->RunsTasksOnCurrentThread());
-  task_runners_.GetUITaskRunner()->PostTask(
+  task_runners_.GetUITaskRunner()->PostTaskWithPriority(
       fml::MakeCopyable([engine = weak_engine_, packet = std::move(packet),
                          flow_id = next_pointer_flow_id_]() mutable {
         if (engine) {
           engine->DispatchPointerDataPacket(std::move(packet), flow_id);
         }
-      }));
+      }),
+      kPlatformEventPriority);
   next_pointer_flow_id_++;
 }
 
@@ -830,12 +884,13 @@ void Shell::OnPlatformViewDispatchSemanticsAction(int32_t id,
   FML_DCHECK(is_setup_);
   FML_DCHECK(task_runners_.GetPlatformTaskRunner()->RunsTasksOnCurrentThread());
 
-  task_runners_.GetUITaskRunner()->PostTask(
+  task_runners_.GetUITaskRunner()->PostTaskWithPriority(
       [engine = engine_->GetWeakPtr(), id, action, args = std::move(args)] {
         if (engine) {
           engine->DispatchSemanticsAction(id, action, std::move(args));
         }
-      });
+      },
+      kPlatformEventPriority);
 }
 
 // |PlatformView::Delegate|
@@ -843,12 +898,13 @@ void Shell::OnPlatformViewSetSemanticsEnabled(bool enabled) {
   FML_DCHECK(is_setup_);
   FML_DCHECK(task_runners_.GetPlatformTaskRunner()->RunsTasksOnCurrentThread());
 
-  task_runners_.GetUITaskRunner()->PostTask(
+  task_runners_.GetUITaskRunner()->PostTaskWithPriority(
       [engine = engine_->GetWeakPtr(), enabled] {
         if (engine) {
           engine->SetSemanticsEnabled(enabled);
         }
-      });
+      },
+      kPlatformEventPriority);
 }
 
 // |PlatformView::Delegate|
@@ -856,12 +912,13 @@ void Shell::OnPlatformViewSetAccessibilityFeatures(int32_t flags) {
   FML_DCHECK(is_setup_);
   FML_DCHECK(task_runners_.GetPlatformTaskRunner()->RunsTasksOnCurrentThread());
 
-  task_runners_.GetUITaskRunner()->PostTask(
+  task_runners_.GetUITaskRunner()->PostTaskWithPriority(
       [engine = engine_->GetWeakPtr(), flags] {
         if (engine) {
           engine->SetAccessibilityFeatures(flags);
         }
-      });
+      },
+      kPlatformEventPriority);
 }
 
 // |PlatformView::Delegate|
@@ -982,8 +1039,7 @@ void Shell::OnAnimatorDraw(fml::RefPtr<Pipeline<flutter::LayerTree>> pipeline,
   task_runners_.GetRasterTaskRunner()->PostTask(
       [&waiting_for_first_frame = waiting_for_first_frame_,
        &waiting_for_first_frame_condition = waiting_for_first_frame_condition_,
-       rasterizer = rasterizer_->GetWeakPtr(),
-       pipeline = std::move(pipeline)]() {
+       rasterizer = weak_rasterizer_, pipeline = std::move(pipeline)]() {
         if (rasterizer) {
           rasterizer->Draw(pipeline);
 
@@ -1000,7 +1056,7 @@ void Shell::OnAnimatorDrawLastLayerTree() {
   FML_DCHECK(is_setup_);
 
   task_runners_.GetRasterTaskRunner()->PostTask(
-      [rasterizer = rasterizer_->GetWeakPtr()]() {
+      [rasterizer = weak_rasterizer_]() {
         if (rasterizer) {
           rasterizer->DrawLastLayerTree();
         }
@@ -1045,7 +1101,8 @@ void Shell::HandleEngineSkiaMessage(fml::RefPtr<PlatformMessage> message) {
   const auto& data = message->data();
 
   rapidjson::Document document;
-  document.Parse(reinterpret_cast<const char*>(data.data()), data.size());
+  document.Parse(reinterpret_cast<const char*>(data.GetMapping()),
+                 data.GetSize());
   if (document.HasParseError() || !document.IsObject())
     return;
   auto root = document.GetObject();
@@ -1057,7 +1114,7 @@ void Shell::HandleEngineSkiaMessage(fml::RefPtr<PlatformMessage> message) {
     return;
 
   task_runners_.GetRasterTaskRunner()->PostTask(
-      [rasterizer = rasterizer_->GetWeakPtr(), max_bytes = args->value.GetInt(),
+      [rasterizer = weak_rasterizer_, max_bytes = args->value.GetInt(),
        response = std::move(message->response())] {
         if (rasterizer) {
           rasterizer->SetResourceCacheMaxBytes(static_cast<size_t>(max_bytes),
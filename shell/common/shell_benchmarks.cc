@@ -4,6 +4,8 @@
 
 #include "flutter/benchmarking/benchmarking.h"
 #include "flutter/fml/logging.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/time/time_point.h"
 #include "flutter/runtime/dart_vm.h"
 #include "flutter/shell/common/shell.h"
 #include "flutter/shell/common/thread_host.h"
@@ -12,14 +14,65 @@
 
 namespace flutter {
 
+namespace {
+
+// The time spent in the phases of shell startup and shutdown, summed over all
+// the iterations of a benchmark.
+struct ShellPhaseTimings {
+  fml::TimeDelta create_platform_view;
+  fml::TimeDelta create_rasterizer;
+  fml::TimeDelta create_shell;
+  fml::TimeDelta setup_ui_thread;
+  fml::TimeDelta teardown_subsystems;
+  fml::TimeDelta teardown_platform_view;
+
+  void Report(benchmark::State& state, bool startup, bool shutdown) const {
+    auto report = [&state](const char* name, fml::TimeDelta total) {
+      state.counters[name] = total.ToMicrosecondsF() / state.iterations();
+    };
+    if (startup) {
+      report("CreatePlatformViewUs", create_platform_view);
+      report("CreateRasterizerUs", create_rasterizer);
+      report("CreateShellUs", create_shell);
+      report("SetupUIThreadUs", setup_ui_thread);
+    }
+    if (shutdown) {
+      report("TeardownSubsystemsUs", teardown_subsystems);
+      report("TeardownPlatformViewUs", teardown_platform_view);
+    }
+  }
+};
+
+// A platform view that records when the shell starts to destroy it. The
+// platform view is the last subsystem torn down by the shell.
+class TimedPlatformView : public PlatformView {
+ public:
+  TimedPlatformView(Shell& shell, fml::TimePoint* destruction_start)
+      : PlatformView(shell, shell.GetTaskRunners()),
+        destruction_start_(destruction_start) {}
+
+  ~TimedPlatformView() override {
+    *destruction_start_ = fml::TimePoint::Now();
+  }
+
+ private:
+  fml::TimePoint* destruction_start_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(TimedPlatformView);
+};
+
+}  // namespace
+
 static void StartupAndShutdownShell(benchmark::State& state,
                                     bool measure_startup,
-                                    bool measure_shutdown) {
+                                    bool measure_shutdown,
+                                    ShellPhaseTimings& timings) {
   auto assets_dir = fml::OpenDirectory(testing::GetFixturesPath(), false,
                                        fml::FilePermission::kRead);
   std::unique_ptr<Shell> shell;
   std::unique_ptr<ThreadHost> thread_host;
   testing::ELFAOTSymbols aot_symbols;
+  fml::TimePoint platform_view_destruction_start;
 
   {
     benchmarking::ScopedPauseTiming pause(state, !measure_startup);
@@ -52,16 +105,28 @@ static void StartupAndShutdownShell(benchmark::State& state,
                              thread_host->ui_thread->GetTaskRunner(),
                              thread_host->io_thread->GetTaskRunner());
 
+    const auto create_start = fml::TimePoint::Now();
     shell = Shell::Create(
         std::move(task_runners), settings,
-        [](Shell& shell) {
-          return std::make_unique<PlatformView>(shell, shell.GetTaskRunners());
+        [&timings, &platform_view_destruction_start](Shell& shell) {
+          const auto start = fml::TimePoint::Now();
+          auto platform_view = std::make_unique<TimedPlatformView>(
+              shell, &platform_view_destruction_start);
+          timings.create_platform_view = timings.create_platform_view +
+                                         (fml::TimePoint::Now() - start);
+          return platform_view;
         },
-        [](Shell& shell) {
-          return std::make_unique<Rasterizer>(
+        [&timings](Shell& shell) {
+          const auto start = fml::TimePoint::Now();
+          auto rasterizer = std::make_unique<Rasterizer>(
               shell, shell.GetTaskRunners(),
               shell.GetIsGpuDisabledSyncSwitch());
+          timings.create_rasterizer =
+              timings.create_rasterizer + (fml::TimePoint::Now() - start);
+          return rasterizer;
         });
+    timings.create_shell =
+        timings.create_shell + (fml::TimePoint::Now() - create_start);
   }
 
   FML_CHECK(shell);
@@ -75,23 +140,34 @@ static void StartupAndShutdownShell(benchmark::State& state,
     // this time should still be included.
     benchmarking::ScopedPauseTiming pause(
         state, !measure_shutdown || !measure_startup);
+    const auto start = fml::TimePoint::Now();
     fml::AutoResetWaitableEvent latch;
     fml::TaskRunner::RunNowOrPostTask(thread_host->ui_thread->GetTaskRunner(),
                                       [&latch]() { latch.Signal(); });
     latch.Wait();
+    timings.setup_ui_thread =
+        timings.setup_ui_thread + (fml::TimePoint::Now() - start);
   }
 
   {
     benchmarking::ScopedPauseTiming pause(state, !measure_shutdown);
     // Shutdown must occur synchronously on the platform thread.
     fml::AutoResetWaitableEvent latch;
+    fml::TimePoint start;
+    fml::TimePoint end;
     fml::TaskRunner::RunNowOrPostTask(
         thread_host->platform_thread->GetTaskRunner(),
-        [&shell, &latch]() mutable {
+        [&shell, &latch, &start, &end]() mutable {
+          start = fml::TimePoint::Now();
           shell.reset();
+          end = fml::TimePoint::Now();
           latch.Signal();
         });
     latch.Wait();
+    timings.teardown_subsystems = timings.teardown_subsystems +
+                                  (platform_view_destruction_start - start);
+    timings.teardown_platform_view = timings.teardown_platform_view +
+                                     (end - platform_view_destruction_start);
     thread_host.reset();
   }
 
@@ -99,25 +175,31 @@ static void StartupAndShutdownShell(benchmark::State& state,
 }
 
 static void BM_ShellInitialization(benchmark::State& state) {
+  ShellPhaseTimings timings;
   while (state.KeepRunning()) {
-    StartupAndShutdownShell(state, true, false);
+    StartupAndShutdownShell(state, true, false, timings);
   }
+  timings.Report(state, true, false);
 }
 
 BENCHMARK(BM_ShellInitialization);
 
 static void BM_ShellShutdown(benchmark::State& state) {
+  ShellPhaseTimings timings;
   while (state.KeepRunning()) {
-    StartupAndShutdownShell(state, false, true);
+    StartupAndShutdownShell(state, false, true, timings);
   }
+  timings.Report(state, false, true);
 }
 
 BENCHMARK(BM_ShellShutdown);
 
 static void BM_ShellInitializationAndShutdown(benchmark::State& state) {
+  ShellPhaseTimings timings;
   while (state.KeepRunning()) {
-    StartupAndShutdownShell(state, true, true);
+    StartupAndShutdownShell(state, true, true, timings);
   }
+  timings.Report(state, true, true);
 }
 
 BENCHMARK(BM_ShellInitializationAndShutdown);
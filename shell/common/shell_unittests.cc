@@ -8,8 +8,12 @@
 #include <algorithm>
 #include <functional>
 #include <future>
+#include <map>
 #include <memory>
 
+#include "flutter/assets/asset_manager.h"
+#include "flutter/assets/directory_asset_bundle.h"
+#include "flutter/assets/packed_asset_bundle.h"
 #include "flutter/flow/layers/layer_tree.h"
 #include "flutter/flow/layers/picture_layer.h"
 #include "flutter/flow/layers/transform_layer.h"
@@ -1233,6 +1237,114 @@ TEST_F(ShellTest, CanDecompressImageFromAsset) {
   DestroyShell(std::move(shell));
 }
 
+TEST_F(ShellTest, AssetManagerReadsAssetRanges) {
+  fml::ScopedTemporaryDirectory asset_dir;
+  const std::string contents = "0123456789";
+  fml::DataMapping data(
+      std::vector<uint8_t>{contents.begin(), contents.end()});
+  ASSERT_TRUE(fml::WriteAtomically(asset_dir.fd(), "asset", data));
+
+  AssetManager asset_manager;
+  asset_manager.PushBack(
+      std::make_unique<DirectoryAssetBundle>(fml::OpenDirectory(
+          asset_dir.path().c_str(), false, fml::FilePermission::kRead)));
+
+  auto to_string = [](const std::unique_ptr<fml::Mapping>& mapping) {
+    return std::string(reinterpret_cast<const char*>(mapping->GetMapping()),
+                       mapping->GetSize());
+  };
+
+  // Reading consecutive ranges yields the whole asset, and the range that
+  // reaches past its end is cut short.
+  std::string read;
+  for (size_t offset = 0;; offset += 4) {
+    auto range = asset_manager.GetRangeAsMapping("asset", offset, 4);
+    ASSERT_NE(range, nullptr);
+    read += to_string(range);
+    if (range->GetSize() < 4) {
+      break;
+    }
+  }
+  ASSERT_EQ(read, contents);
+
+  auto end = asset_manager.GetRangeAsMapping("asset", contents.size(), 4);
+  ASSERT_NE(end, nullptr);
+  ASSERT_EQ(end->GetSize(), 0u);
+  ASSERT_EQ(asset_manager.GetRangeAsMapping("asset", contents.size() + 1, 4),
+            nullptr);
+  ASSERT_EQ(asset_manager.GetRangeAsMapping("missing", 0, 4), nullptr);
+
+  fml::UnlinkFile(asset_dir.fd(), "asset");
+}
+
+TEST_F(ShellTest, PackedAssetBundleResolvesAssets) {
+  std::map<std::string, std::unique_ptr<fml::Mapping>> assets;
+  assets["a"] = std::make_unique<fml::DataMapping>("abc");
+  assets["b/c"] = std::make_unique<fml::DataMapping>("defgh");
+  assets["empty"] = std::make_unique<fml::DataMapping>("");
+  auto packed = PackedAssetBundle::Pack(assets);
+
+  fml::ScopedTemporaryDirectory asset_dir;
+  ASSERT_TRUE(fml::WriteAtomically(asset_dir.fd(), PackedAssetBundle::kFileName,
+                                   *packed));
+  fml::DataMapping loose(std::string("loose"));
+  ASSERT_TRUE(fml::WriteAtomically(asset_dir.fd(), "a", loose));
+  ASSERT_TRUE(fml::WriteAtomically(asset_dir.fd(), "d", loose));
+
+  auto bundle = PackedAssetBundle::Open(asset_dir.fd());
+  ASSERT_NE(bundle, nullptr);
+  for (const auto& asset : assets) {
+    auto mapping = bundle->GetAsMapping(asset.first);
+    ASSERT_NE(mapping, nullptr);
+    ASSERT_EQ(std::string(reinterpret_cast<const char*>(mapping->GetMapping()),
+                          mapping->GetSize()),
+              std::string(
+                  reinterpret_cast<const char*>(asset.second->GetMapping()),
+                  asset.second->GetSize()));
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(mapping->GetMapping()) %
+                  PackedAssetBundle::kAlignment,
+              0u);
+  }
+  ASSERT_EQ(bundle->GetAsMapping("d"), nullptr);
+
+  // The packed bundle takes precedence over the loose files of its directory,
+  // which still resolve the assets it doesn't have.
+  auto settings = CreateSettingsForFixture();
+  settings.assets_path = asset_dir.path();
+  auto asset_manager =
+      RunConfiguration::InferFromSettings(settings).GetAssetManager();
+  ASSERT_EQ(asset_manager->GetAsMapping("a")->GetSize(), 3u);
+  ASSERT_EQ(asset_manager->GetAsMapping("d")->GetSize(), 5u);
+  auto range = asset_manager->GetRangeAsMapping("b/c", 1, 10);
+  ASSERT_EQ(std::string(reinterpret_cast<const char*>(range->GetMapping()),
+                        range->GetSize()),
+            "efgh");
+
+  // A range past the end of an asset isn't read from the asset it shadows,
+  // and doesn't change the resolver remembered for it.
+  ASSERT_EQ(asset_manager->GetRangeAsMapping("a", 4, 1), nullptr);
+  ASSERT_EQ(asset_manager->GetAsMapping("a")->GetSize(), 3u);
+  ASSERT_EQ(asset_manager->GetRangeAsMapping("a", 4, 1), nullptr);
+  ASSERT_EQ(asset_manager->GetRangeAsMapping("a", 3, 1)->GetSize(), 0u);
+  ASSERT_EQ(asset_manager->GetAsMapping("a")->GetSize(), 3u);
+  ASSERT_EQ(asset_manager->GetRangeAsMapping("missing", 0, 1), nullptr);
+
+  // Adding a resolver drops the resolvers remembered for the assets.
+  std::map<std::string, std::unique_ptr<fml::Mapping>> overrides;
+  overrides["d"] = std::make_unique<fml::DataMapping>("override");
+  asset_manager->PushFront(
+      std::make_unique<PackedAssetBundle>(PackedAssetBundle::Pack(overrides)));
+  ASSERT_EQ(asset_manager->GetAsMapping("d")->GetSize(), 8u);
+
+  auto corrupt = std::make_unique<fml::DataMapping>(std::vector<uint8_t>(
+      packed->GetMapping(), packed->GetMapping() + sizeof(uint32_t) * 4 + 1));
+  ASSERT_FALSE(PackedAssetBundle(std::move(corrupt)).IsValid());
+
+  fml::UnlinkFile(asset_dir.fd(), PackedAssetBundle::kFileName);
+  fml::UnlinkFile(asset_dir.fd(), "a");
+  fml::UnlinkFile(asset_dir.fd(), "d");
+}
+
 TEST_F(ShellTest, OnServiceProtocolGetSkSLsWorks) {
   // Create 2 dummpy SkSL cache file IE (base32 encoding of A), II (base32
   // encoding of B) with content x and y.
@@ -392,6 +392,87 @@ Settings SettingsFromCommandLine(const fml::CommandLine& command_line) {
   settings.cache_sksl =
       command_line.HasOption(FlagForSwitch(Switch::CacheSkSL));
 
+  if (command_line.HasOption(
+          FlagForSwitch(Switch::PersistentCacheMaxBytes))) {
+    if (!GetSwitchValue(command_line, Switch::PersistentCacheMaxBytes,
+                        &settings.persistent_cache_max_bytes)) {
+      FML_LOG(INFO) << "Persistent cache byte limit specified was malformed. "
+                       "Will default to "
+                    << settings.persistent_cache_max_bytes;
+    }
+  }
+
+  if (command_line.HasOption(FlagForSwitch(Switch::RasterCacheMaxBytes))) {
+    if (!GetSwitchValue(command_line, Switch::RasterCacheMaxBytes,
+                        &settings.raster_cache_max_bytes)) {
+      FML_LOG(INFO) << "Raster cache byte budget specified was malformed. "
+                       "Will default to "
+                    << settings.raster_cache_max_bytes;
+    }
+  }
+
+  if (command_line.HasOption(
+          FlagForSwitch(Switch::RasterCacheMaxIdleFrames))) {
+    if (!GetSwitchValue(command_line, Switch::RasterCacheMaxIdleFrames,
+                        &settings.raster_cache_max_idle_frames)) {
+      FML_LOG(INFO) << "Raster cache idle frames specified were malformed. "
+                       "Will default to "
+                    << settings.raster_cache_max_idle_frames;
+    }
+  }
+
+  settings.concurrent_raster_cache_population = command_line.HasOption(
+      FlagForSwitch(Switch::ConcurrentRasterCachePopulation));
+
+  if (command_line.HasOption(FlagForSwitch(Switch::SoftwareRasterTileCount))) {
+    if (!GetSwitchValue(command_line, Switch::SoftwareRasterTileCount,
+                        &settings.software_raster_tile_count)) {
+      FML_LOG(INFO) << "Software raster tile count specified was malformed. "
+                       "Will rasterize frames on the raster thread alone.";
+    }
+  }
+
+  if (command_line.HasOption(FlagForSwitch(Switch::FramePipelineDepth))) {
+    if (!GetSwitchValue(command_line, Switch::FramePipelineDepth,
+                        &settings.frame_pipeline_depth)) {
+      FML_LOG(INFO) << "Frame pipeline depth specified was malformed. Will "
+                       "default to the depth picked for the platform.";
+    }
+  }
+
+  settings.drop_stale_frames =
+      command_line.HasOption(FlagForSwitch(Switch::DropStaleFrames));
+
+  if (command_line.HasOption(
+          FlagForSwitch(Switch::TextLayoutCacheMaxBytes))) {
+    if (!GetSwitchValue(command_line, Switch::TextLayoutCacheMaxBytes,
+                        &settings.text_layout_cache_max_bytes)) {
+      FML_LOG(INFO) << "Text layout cache byte budget specified was "
+                       "malformed. Will default to the budget of the text "
+                       "engine.";
+    }
+  }
+
+  if (command_line.HasOption(
+          FlagForSwitch(Switch::DecodedImageCacheMaxBytes))) {
+    if (!GetSwitchValue(command_line, Switch::DecodedImageCacheMaxBytes,
+                        &settings.decoded_image_cache_max_bytes)) {
+      FML_LOG(INFO) << "Decoded image cache byte budget specified was "
+                       "malformed. Will default to "
+                    << settings.decoded_image_cache_max_bytes << " bytes.";
+    }
+  }
+
+  if (command_line.HasOption(
+          FlagForSwitch(Switch::AnimatedImageLookaheadFrames))) {
+    if (!GetSwitchValue(command_line, Switch::AnimatedImageLookaheadFrames,
+                        &settings.animated_image_lookahead_frames)) {
+      FML_LOG(INFO) << "Animated image lookahead specified was malformed. "
+                       "Will default to "
+                    << settings.animated_image_lookahead_frames << " frames.";
+    }
+  }
+
   return settings;
 }
 
@@ -148,6 +148,56 @@ DEF_SWITCH(CacheSkSL,
            "should only be used during development phases. The generated SkSLs "
            "can later be used in the release build for shader precompilation "
            "at launch in order to eliminate the shader-compile jank.")
+DEF_SWITCH(PersistentCacheMaxBytes,
+           "persistent-cache-max-bytes",
+           "The maximum number of bytes of shaders kept in the persistent "
+           "cache. The least recently used shaders are evicted when the limit "
+           "is exceeded. By default, the persistent cache has no limit.")
+DEF_SWITCH(RasterCacheMaxBytes,
+           "raster-cache-max-bytes",
+           "The maximum number of bytes of images held by the raster cache. "
+           "The least recently used entries are evicted when the budget is "
+           "exceeded. By default, the raster cache has no byte budget.")
+DEF_SWITCH(RasterCacheMaxIdleFrames,
+           "raster-cache-max-idle-frames",
+           "The number of consecutive frames a raster cache entry may go "
+           "unused before it is evicted. By default, entries that are not "
+           "used in a frame are evicted at the end of that frame.")
+DEF_SWITCH(ConcurrentRasterCachePopulation,
+           "concurrent-raster-cache-population",
+           "Rasterize raster cache entries for pictures on worker threads "
+           "instead of the raster thread. Pictures are drawn directly until "
+           "their cache entry is ready. Only applies to software rendering.")
+DEF_SWITCH(SoftwareRasterTileCount,
+           "software-raster-tile-count",
+           "Split frames rendered in software into this many horizontal bands "
+           "that are rasterized concurrently on worker threads. By default, "
+           "frames are rasterized on the raster thread alone.")
+DEF_SWITCH(FramePipelineDepth,
+           "frame-pipeline-depth",
+           "The number of frames the UI thread may produce ahead of the raster "
+           "thread. By default, a depth suitable for the platform is picked, "
+           "which is two frames in most configurations.")
+DEF_SWITCH(DropStaleFrames,
+           "drop-stale-frames",
+           "Skip rasterizing frames that have missed their target time when a "
+           "newer frame is already waiting to be rasterized.")
+DEF_SWITCH(TextLayoutCacheMaxBytes,
+           "text-layout-cache-max-bytes",
+           "The maximum number of bytes of shaped words held by the text "
+           "layout cache. The least recently used words are evicted when the "
+           "budget is exceeded. By default, the cache holds up to 2 MB.")
+DEF_SWITCH(DecodedImageCacheMaxBytes,
+           "decoded-image-cache-max-bytes",
+           "The maximum number of bytes of decoded images kept for decoding "
+           "the same encoded image again. The least recently used images are "
+           "evicted when the budget is exceeded. Zero disables the cache. By "
+           "default, the cache holds up to 16 MB.")
+DEF_SWITCH(AnimatedImageLookaheadFrames,
+           "animated-image-lookahead-frames",
+           "The number of frames of animated images that are decoded ahead of "
+           "the frame being shown. Zero decodes each frame when it is "
+           "requested. Defaults to 2.")
 DEF_SWITCH(
     TraceSystrace,
     "trace-systrace",
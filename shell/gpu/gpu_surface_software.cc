@@ -56,20 +56,51 @@ std::unique_ptr<SurfaceFrame> GPUSurfaceSoftware::AcquireFrame(
   SkCanvas* canvas = backing_store->getCanvas();
   canvas->resetMatrix();
 
+  const bool retains_previous_contents =
+      backing_store == last_presented_backing_store_;
+
   SurfaceFrame::SubmitCallback on_submit =
       [self = weak_factory_.GetWeakPtr()](const SurfaceFrame& surface_frame,
                                           SkCanvas* canvas) -> bool {
     // If the surface itself went away, there is nothing more to do.
-    if (!self || !self->IsValid() || canvas == nullptr) {
+    if (!self || !self->IsValid()) {
+      return false;
+    }
+
+    // The damage of the frame can only be presented on its own if the frame
+    // before it was presented.
+    const bool presented_previous_frame =
+        self->last_presented_backing_store_ != nullptr;
+
+    // Whatever happens below, the backing store no longer matches the last
+    // presented frame until this frame is presented successfully.
+    self->last_presented_backing_store_ = nullptr;
+
+    if (canvas == nullptr) {
       return false;
     }
 
     canvas->flush();
 
-    return self->delegate_->PresentBackingStore(surface_frame.SkiaSurface());
+    sk_sp<SkSurface> backing_store = surface_frame.SkiaSurface();
+    bool presented = false;
+    if (presented_previous_frame && surface_frame.damage()) {
+      presented = self->delegate_->PresentBackingStoreDamage(
+          backing_store, *surface_frame.damage());
+    } else {
+      presented = self->delegate_->PresentBackingStore(backing_store);
+    }
+
+    if (presented) {
+      self->last_presented_backing_store_ = std::move(backing_store);
+    }
+    return presented;
   };
 
-  return std::make_unique<SurfaceFrame>(backing_store, true, on_submit);
+  auto frame = std::make_unique<SurfaceFrame>(backing_store, true, on_submit);
+  frame->set_retains_previous_contents(retains_previous_contents);
+  frame->set_wants_damage(true);
+  return frame;
 }
 
 // |Surface|
@@ -41,6 +41,10 @@ class GPUSurfaceSoftware : public Surface {
   // hack to make avoid allocating resources for the root surface when an
   // external view embedder is present.
   const bool render_to_surface_;
+  // The backing store presented by the last frame. If the delegate hands out
+  // the same backing store again, it still contains the pixels of that frame
+  // and only the damaged area needs to be repainted.
+  sk_sp<SkSurface> last_presented_backing_store_;
   fml::TaskRunnerAffineWeakPtrFactory<GPUSurfaceSoftware> weak_factory_;
 
   FML_DISALLOW_COPY_AND_ASSIGN(GPUSurfaceSoftware);
@@ -52,6 +52,26 @@ class GPUSurfaceSoftwareDelegate : public GPUSurfaceDelegate {
   ///             the screen.
   ///
   virtual bool PresentBackingStore(sk_sp<SkSurface> backing_store) = 0;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Called instead of `PresentBackingStore` when only part of the
+  ///             frame changed since the previously presented frame. The
+  ///             backing store may differ from the one presented previously,
+  ///             e.g. if the platform hands out several backing stores in
+  ///             turn, but it holds the entire frame. Platforms that can
+  ///             update the screen partially may present just the damaged
+  ///             area. The default implementation presents the entire backing
+  ///             store.
+  ///
+  /// @param[in]  backing_store  The software backing store to present.
+  /// @param[in]  damage         The area of the frame that changed since the
+  ///                            previously presented frame, in pixels.
+  ///
+  /// @return     Returns if the platform could present the backing store onto
+  ///             the screen.
+  ///
+  virtual bool PresentBackingStoreDamage(sk_sp<SkSurface> backing_store,
+                                         const SkIRect& damage);
 };
 
 }  // namespace flutter
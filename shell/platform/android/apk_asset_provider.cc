@@ -1,6 +1,7 @@
 #include <unistd.h>
 #include <algorithm>
 #include <sstream>
+#include <vector>
 
 #include "flutter/fml/logging.h"
 #include "flutter/shell/platform/android/apk_asset_provider.h"
@@ -39,12 +40,17 @@ class APKAssetMapping : public fml::Mapping {
   FML_DISALLOW_COPY_AND_ASSIGN(APKAssetMapping);
 };
 
-std::unique_ptr<fml::Mapping> APKAssetProvider::GetAsMapping(
+std::string APKAssetProvider::GetAssetPath(
     const std::string& asset_name) const {
   std::stringstream ss;
   ss << directory_.c_str() << "/" << asset_name;
-  AAsset* asset =
-      AAssetManager_open(assetManager_, ss.str().c_str(), AASSET_MODE_BUFFER);
+  return ss.str();
+}
+
+std::unique_ptr<fml::Mapping> APKAssetProvider::GetAsMapping(
+    const std::string& asset_name) const {
+  AAsset* asset = AAssetManager_open(
+      assetManager_, GetAssetPath(asset_name).c_str(), AASSET_MODE_BUFFER);
   if (!asset) {
     return nullptr;
   }
@@ -52,4 +58,38 @@ std::unique_ptr<fml::Mapping> APKAssetProvider::GetAsMapping(
   return std::make_unique<APKAssetMapping>(asset);
 }
 
+std::unique_ptr<fml::Mapping> APKAssetProvider::GetRangeAsMapping(
+    const std::string& asset_name,
+    size_t offset,
+    size_t length) const {
+  // Only the requested bytes are read, instead of the whole asset, which may
+  // have to be decompressed to be mapped.
+  AAsset* asset = AAssetManager_open(
+      assetManager_, GetAssetPath(asset_name).c_str(), AASSET_MODE_RANDOM);
+  if (!asset) {
+    return nullptr;
+  }
+
+  std::unique_ptr<fml::Mapping> mapping;
+  const size_t size = AAsset_getLength64(asset);
+  if (offset <= size &&
+      AAsset_seek64(asset, offset, SEEK_SET) == static_cast<off64_t>(offset)) {
+    std::vector<uint8_t> data(std::min(length, size - offset));
+    size_t read = 0;
+    while (read < data.size()) {
+      const int result =
+          AAsset_read(asset, data.data() + read, data.size() - read);
+      if (result <= 0) {
+        break;
+      }
+      read += result;
+    }
+    if (read == data.size()) {
+      mapping = std::make_unique<fml::DataMapping>(std::move(data));
+    }
+  }
+  AAsset_close(asset);
+  return mapping;
+}
+
 }  // namespace flutter
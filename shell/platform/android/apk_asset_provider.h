@@ -33,6 +33,14 @@ class APKAssetProvider final : public AssetResolver {
   std::unique_ptr<fml::Mapping> GetAsMapping(
       const std::string& asset_name) const override;
 
+  // |flutter::AssetResolver|
+  std::unique_ptr<fml::Mapping> GetRangeAsMapping(
+      const std::string& asset_name,
+      size_t offset,
+      size_t length) const override;
+
+  std::string GetAssetPath(const std::string& asset_name) const;
+
   FML_DISALLOW_COPY_AND_ASSIGN(APKAssetProvider);
 };
 
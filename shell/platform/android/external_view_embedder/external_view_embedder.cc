@@ -4,6 +4,8 @@
 
 #include "flutter/shell/platform/android/external_view_embedder/external_view_embedder.h"
 
+#include <list>
+
 #include "flutter/fml/trace_event.h"
 
 namespace flutter {
@@ -112,7 +114,7 @@ bool AndroidExternalViewEmbedder::SubmitFrame(
       int64_t current_view_id = composition_order_[j];
       SkRect current_view_rect = GetViewRect(current_view_id);
       // Each rect corresponds to a native view that renders Flutter UI.
-      std::list<SkRect> intersection_rects =
+      std::vector<SkRect> intersection_rects =
           rtree->searchNonOverlappingDrawnRects(current_view_rect);
       auto allocation_size = intersection_rects.size();
 
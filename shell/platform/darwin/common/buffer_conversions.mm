@@ -20,7 +20,16 @@ std::unique_ptr<fml::Mapping> GetMappingFromNSData(NSData* data) {
 }
 
 NSData* GetNSDataFromMapping(std::unique_ptr<fml::Mapping> mapping) {
-  return [NSData dataWithBytes:mapping->GetMapping() length:mapping->GetSize()];
+  // The data refers to the bytes of the mapping, which is collected along with
+  // the data. NSData is immutable, so the bytes are never written to.
+  fml::Mapping* raw_mapping = mapping.release();
+  void* data = const_cast<uint8_t*>(raw_mapping->GetMapping());
+  auto deallocator = ^(void* bytes, NSUInteger length) {
+    delete raw_mapping;
+  };
+  return [[[NSData alloc] initWithBytesNoCopy:data
+                                       length:raw_mapping->GetSize()
+                                  deallocator:deallocator] autorelease];
 }
 
 }  // namespace flutter
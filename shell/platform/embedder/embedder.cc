@@ -104,7 +104,9 @@ static bool IsSoftwareRendererConfigValid(const FlutterRendererConfig* config) {
   const FlutterSoftwareRendererConfig* software_config = &config->software;
 
   if (SAFE_ACCESS(software_config, surface_present_callback, nullptr) ==
-      nullptr) {
+          nullptr &&
+      SAFE_ACCESS(software_config, surface_present_async_callback, nullptr) ==
+          nullptr) {
     return false;
   }
 
@@ -252,16 +254,53 @@ InferSoftwarePlatformViewCreationCallback(
     return nullptr;
   }
 
-  auto software_present_backing_store =
-      [ptr = config->software.surface_present_callback, user_data](
-          const void* allocation, size_t row_bytes, size_t height) -> bool {
-    return ptr(user_data, allocation, row_bytes, height);
-  };
+  const FlutterSoftwareRendererConfig* software_config = &config->software;
 
   flutter::EmbedderSurfaceSoftware::SoftwareDispatchTable
-      software_dispatch_table = {
-          software_present_backing_store,  // required
+      software_dispatch_table = {};
+
+  if (auto present_ptr =
+          SAFE_ACCESS(software_config, surface_present_callback, nullptr)) {
+    software_dispatch_table.software_present_backing_store =
+        [present_ptr, user_data](const void* allocation, size_t row_bytes,
+                                 size_t height) -> bool {
+      return present_ptr(user_data, allocation, row_bytes, height);
+    };
+  }
+
+  if (auto present_async_ptr = SAFE_ACCESS(
+          software_config, surface_present_async_callback, nullptr)) {
+    software_dispatch_table.software_present_backing_store_async =
+        [present_async_ptr, user_data](const void* allocation,
+                                       size_t row_bytes, size_t height,
+                                       const SkIRect& damage,
+                                       fml::closure release) -> bool {
+      auto captures = std::make_unique<fml::closure>(std::move(release));
+      FlutterSoftwarePresentInfo info = {};
+      info.struct_size = sizeof(FlutterSoftwarePresentInfo);
+      info.allocation = allocation;
+      info.row_bytes = row_bytes;
+      info.height = height;
+      info.damage.left = damage.left();
+      info.damage.top = damage.top();
+      info.damage.right = damage.right();
+      info.damage.bottom = damage.bottom();
+      info.release_callback = [](void* user_data) {
+        auto release = reinterpret_cast<fml::closure*>(user_data);
+        (*release)();
+        delete release;
       };
+      info.release_user_data = captures.get();
+      if (!present_async_ptr(user_data, &info)) {
+        return false;
+      }
+      // The embedder now owns the captures and collects them on release.
+      captures.release();
+      return true;
+    };
+    software_dispatch_table.buffer_count =
+        SAFE_ACCESS(software_config, surface_buffer_count, 0);
+  }
 
   return fml::MakeCopyable(
       [software_dispatch_table, platform_dispatch_table,
@@ -894,9 +933,11 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
           const FlutterPlatformMessage incoming_message = {
               sizeof(FlutterPlatformMessage),  // struct_size
               message->channel().c_str(),      // channel
-              message->data().data(),          // message
-              message->data().size(),          // message_size
+              message->data().GetMapping(),    // message
+              message->data().GetSize(),       // message_size
               handle,                          // response_handle
+              nullptr,                         // message_release_callback
+              nullptr,                         // message_release_user_data
           };
           handle->message = std::move(message);
           return ptr(&incoming_message, user_data);
@@ -1278,25 +1319,49 @@ FlutterEngineResult FlutterEngineSendPointerEvent(
                                   "running Flutter application.");
 }
 
+// Wraps a buffer handed over by the embedder. The release callback is
+// invoked when the mapping is collected.
+static std::unique_ptr<fml::Mapping> CreateEmbedderOwnedMapping(
+    const uint8_t* data,
+    size_t size,
+    VoidCallback release_callback,
+    void* release_user_data) {
+  return std::make_unique<fml::NonOwnedMapping>(
+      data, size,
+      [release_callback, release_user_data](const uint8_t* data, size_t size) {
+        release_callback(release_user_data);
+      });
+}
+
 FlutterEngineResult FlutterEngineSendPlatformMessage(
     FLUTTER_API_SYMBOL(FlutterEngine) engine,
     const FlutterPlatformMessage* flutter_message) {
-  if (engine == nullptr) {
-    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Invalid engine handle.");
-  }
-
   if (flutter_message == nullptr) {
     return LOG_EMBEDDER_ERROR(kInvalidArguments, "Invalid message argument.");
   }
 
+  size_t message_size = SAFE_ACCESS(flutter_message, message_size, 0);
+  const uint8_t* message_data = SAFE_ACCESS(flutter_message, message, nullptr);
+
+  // Messages handed over by the embedder are not copied. Their buffer is
+  // released along with this mapping, even if the message is not sent.
+  std::unique_ptr<fml::Mapping> message_mapping;
+  if (auto release_callback =
+          SAFE_ACCESS(flutter_message, message_release_callback, nullptr)) {
+    message_mapping = CreateEmbedderOwnedMapping(
+        message_data, message_size, release_callback,
+        SAFE_ACCESS(flutter_message, message_release_user_data, nullptr));
+  }
+
+  if (engine == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Invalid engine handle.");
+  }
+
   if (SAFE_ACCESS(flutter_message, channel, nullptr) == nullptr) {
     return LOG_EMBEDDER_ERROR(
         kInvalidArguments, "Message argument did not specify a valid channel.");
   }
 
-  size_t message_size = SAFE_ACCESS(flutter_message, message_size, 0);
-  const uint8_t* message_data = SAFE_ACCESS(flutter_message, message, nullptr);
-
   if (message_size != 0 && message_data == nullptr) {
     return LOG_EMBEDDER_ERROR(
         kInvalidArguments,
@@ -1315,6 +1380,9 @@ FlutterEngineResult FlutterEngineSendPlatformMessage(
   if (message_size == 0) {
     message = fml::MakeRefCounted<flutter::PlatformMessage>(
         flutter_message->channel, response);
+  } else if (message_mapping) {
+    message = fml::MakeRefCounted<flutter::PlatformMessage>(
+        flutter_message->channel, std::move(message_mapping), response);
   } else {
     message = fml::MakeRefCounted<flutter::PlatformMessage>(
         flutter_message->channel,
@@ -1406,6 +1474,43 @@ FlutterEngineResult FlutterEngineSendPlatformMessageResponse(
   return kSuccess;
 }
 
+FlutterEngineResult FlutterEngineSendPlatformMessageResponseNoCopy(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const FlutterPlatformMessageResponseHandle* handle,
+    const uint8_t* data,
+    size_t data_length,
+    VoidCallback release_callback,
+    void* release_user_data) {
+  if (release_callback == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "The release callback was null.");
+  }
+
+  // The data is released along with this mapping, even if the call fails.
+  std::unique_ptr<fml::Mapping> mapping = CreateEmbedderOwnedMapping(
+      data, data_length, release_callback, release_user_data);
+
+  if (data_length != 0 && data == nullptr) {
+    return LOG_EMBEDDER_ERROR(
+        kInvalidArguments,
+        "Data size was non zero but the pointer to the data was null.");
+  }
+
+  auto response = handle->message->response();
+
+  if (response) {
+    if (data_length == 0) {
+      response->CompleteEmpty();
+    } else {
+      response->Complete(std::move(mapping));
+    }
+  }
+
+  delete handle;
+
+  return kSuccess;
+}
+
 FlutterEngineResult __FlutterEngineFlushPendingTasksNow() {
   fml::MessageLoop::GetCurrent().RunExpiredTasksNow();
   return kSuccess;
@@ -209,6 +209,13 @@ typedef struct {
 
 typedef void (*VoidCallback)(void* /* user data */);
 
+typedef struct {
+  double left;
+  double top;
+  double right;
+  double bottom;
+} FlutterRect;
+
 typedef enum {
   /// Specifies an OpenGL texture target type. Textures are specified using
   /// the FlutterOpenGLTexture struct.
@@ -265,6 +272,37 @@ typedef bool (*SoftwareSurfacePresentCallback)(void* /* user data */,
                                                const void* /* allocation */,
                                                size_t /* row bytes */,
                                                size_t /* height */);
+
+typedef struct {
+  /// The size of this struct. Must be sizeof(FlutterSoftwarePresentInfo).
+  size_t struct_size;
+  /// The pixels of the frame in the native 32-bit RGBA format. The buffer is
+  /// owned by the Flutter engine. It may be read until the embedder calls the
+  /// release callback.
+  const void* allocation;
+  /// The number of bytes in each row of the buffer.
+  size_t row_bytes;
+  /// The number of rows in the buffer.
+  size_t height;
+  /// The area of the frame that changed since the previously presented frame,
+  /// in pixels. The embedder only needs to update this area on the screen.
+  /// This is the entire frame if the engine doesn't know what changed.
+  FlutterRect damage;
+  /// The callback the embedder must invoke, on any thread, once it no longer
+  /// reads the buffer. The engine doesn't render into a buffer before it is
+  /// released.
+  VoidCallback release_callback;
+  /// The user data to pass to the release callback.
+  void* release_user_data;
+} FlutterSoftwarePresentInfo;
+
+/// Presents a buffer without waiting for the embedder to consume it. If the
+/// callback returns false, the buffer is released right away and the
+/// embedder must not invoke the release callback of the buffer.
+typedef bool (*SoftwareSurfacePresentAsyncCallback)(
+    void* /* user data */,
+    const FlutterSoftwarePresentInfo* /* present info */);
+
 typedef void* (*ProcResolver)(void* /* user data */, const char* /* name */);
 typedef bool (*TextureFrameCallback)(void* /* user data */,
                                      int64_t /* texture identifier */,
@@ -319,6 +357,19 @@ typedef struct {
   /// format. The buffer is owned by the Flutter engine and must be copied in
   /// this callback if needed.
   SoftwareSurfacePresentCallback surface_present_callback;
+  /// The callback the engine invokes to hand a fully populated buffer to the
+  /// embedder, without holding up the rendering of the next frames until the
+  /// embedder has consumed it. The engine renders into a set of buffers in
+  /// turn, and only waits for the embedder to release a buffer when it holds
+  /// all of them. The callback also tells the embedder which area of the
+  /// frame changed. This callback is optional. If it is set, it is used
+  /// instead of `surface_present_callback`, which may be null.
+  SoftwareSurfacePresentAsyncCallback surface_present_async_callback;
+  /// The number of buffers the engine renders into in turn when presenting
+  /// buffers with `surface_present_async_callback`. More buffers allow the
+  /// engine to render further ahead of the embedder. If zero, two buffers are
+  /// used.
+  size_t surface_buffer_count;
 } FlutterSoftwareRendererConfig;
 
 typedef struct {
@@ -447,6 +498,16 @@ typedef struct {
   /// `FlutterEngineSendPlatformMessageResponse` will cause a memory leak. It is
   /// not safe to send multiple responses on a single response object.
   const FlutterPlatformMessageResponseHandle* response_handle;
+  /// Only used for messages sent to the engine. If set, the engine takes over
+  /// the `message` buffer instead of copying it, and the buffer must not be
+  /// modified until the engine invokes this callback. Since Dart may write to
+  /// the data it receives, the buffer is still copied once when the message
+  /// is handed to the Dart isolate. The callback is invoked
+  /// exactly once, on any thread, when the engine is done with the buffer.
+  /// This includes the case where the message could not be sent.
+  VoidCallback message_release_callback;
+  /// The user data passed to `message_release_callback`.
+  void* message_release_user_data;
 } FlutterPlatformMessage;
 
 typedef void (*FlutterPlatformMessageCallback)(
@@ -457,13 +518,6 @@ typedef void (*FlutterDataCallback)(const uint8_t* /* data */,
                                     size_t /* size */,
                                     void* /* user data */);
 
-typedef struct {
-  double left;
-  double top;
-  double right;
-  double bottom;
-} FlutterRect;
-
 typedef struct {
   double x;
   double y;
@@ -1405,6 +1459,36 @@ FlutterEngineResult FlutterEngineSendPlatformMessageResponse(
     const uint8_t* data,
     size_t data_length);
 
+//------------------------------------------------------------------------------
+/// @brief      Send a response from the native side to a platform message from
+///             the Dart Flutter application without copying the response data.
+///             The engine takes over the data buffer, which must not be
+///             modified until the engine is done with it. Since Dart may write
+///             to the data it receives, the buffer is still copied once when
+///             the response is handed to the Dart isolate.
+///
+/// @param[in]  engine            The running engine instance.
+/// @param[in]  handle            The platform message response handle.
+/// @param[in]  data              The data to associate with the platform
+///                               message response.
+/// @param[in]  data_length       The length of the platform message response
+///                               data.
+/// @param[in]  release_callback  Invoked exactly once, on any thread, when the
+///                               engine is done with `data`. This includes the
+///                               case where the call fails.
+/// @param[in]  release_user_data The user data passed to `release_callback`.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineSendPlatformMessageResponseNoCopy(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const FlutterPlatformMessageResponseHandle* handle,
+    const uint8_t* data,
+    size_t data_length,
+    VoidCallback release_callback,
+    void* release_user_data);
+
 //------------------------------------------------------------------------------
 /// @brief      This API is only meant to be used by platforms that need to
 ///             flush tasks on a message loop not controlled by the Flutter
@@ -4,17 +4,115 @@
 
 #include "flutter/shell/platform/embedder/embedder_surface_software.h"
 
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
 #include "flutter/fml/trace_event.h"
 #include "third_party/skia/include/gpu/GrContext.h"
 
 namespace flutter {
 
+static constexpr size_t kDefaultBufferCount = 2;
+
+static sk_sp<SkSurface> CreateBackingStore(const SkISize& size) {
+  SkImageInfo info = SkImageInfo::MakeN32(
+      size.fWidth, size.fHeight, kPremul_SkAlphaType, SkColorSpace::MakeSRGB());
+  return SkSurface::MakeRaster(info, nullptr);
+}
+
+// Hands out the backing stores that are presented asynchronously. A backing
+// store presented to the embedder is not handed out again before the embedder
+// releases it.
+class EmbedderSurfaceSoftware::BufferPool {
+ public:
+  explicit BufferPool(size_t buffer_count) : buffer_count_(buffer_count) {}
+
+  // Returns a backing store of |size| that the embedder doesn't hold, waiting
+  // for the embedder to release one if it holds all of them. The backing
+  // store presented last is preferred because it still holds the pixels of
+  // the last frame, so only the damaged area has to be repainted.
+  sk_sp<SkSurface> Acquire(const SkISize& size) {
+    std::unique_lock lock(mutex_);
+    if (size != size_) {
+      // Backing stores of the old size held by the embedder are collected
+      // when they are released.
+      buffers_.clear();
+      last_presented_ = nullptr;
+      size_ = size;
+    }
+    while (true) {
+      Buffer* free_buffer = nullptr;
+      for (Buffer& buffer : buffers_) {
+        if (!buffer.held && (free_buffer == nullptr ||
+                             buffer.surface == last_presented_)) {
+          free_buffer = &buffer;
+        }
+      }
+      if (free_buffer != nullptr) {
+        return free_buffer->surface;
+      }
+      if (buffers_.size() < buffer_count_) {
+        sk_sp<SkSurface> surface = CreateBackingStore(size);
+        if (surface != nullptr) {
+          buffers_.push_back({surface, false});
+        }
+        return surface;
+      }
+      TRACE_EVENT0("flutter", "EmbedderSurfaceSoftware::WaitForRelease");
+      released_.wait(lock);
+    }
+  }
+
+  // Marks |surface| as presented and held by the embedder.
+  void MarkPresented(const sk_sp<SkSurface>& surface) {
+    std::scoped_lock lock(mutex_);
+    last_presented_ = surface;
+    for (Buffer& buffer : buffers_) {
+      if (buffer.surface == surface) {
+        buffer.held = true;
+      }
+    }
+  }
+
+  // Makes |surface| available again. May be called on any thread.
+  void Release(const sk_sp<SkSurface>& surface) {
+    std::scoped_lock lock(mutex_);
+    for (Buffer& buffer : buffers_) {
+      if (buffer.surface == surface) {
+        buffer.held = false;
+      }
+    }
+    released_.notify_all();
+  }
+
+ private:
+  struct Buffer {
+    sk_sp<SkSurface> surface;
+    bool held = false;
+  };
+
+  const size_t buffer_count_;
+  std::mutex mutex_;
+  std::condition_variable released_;
+  SkISize size_ = SkISize::MakeEmpty();
+  std::vector<Buffer> buffers_;
+  sk_sp<SkSurface> last_presented_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(BufferPool);
+};
+
 EmbedderSurfaceSoftware::EmbedderSurfaceSoftware(
     SoftwareDispatchTable software_dispatch_table,
     std::unique_ptr<EmbedderExternalViewEmbedder> external_view_embedder)
     : software_dispatch_table_(software_dispatch_table),
       external_view_embedder_(std::move(external_view_embedder)) {
-  if (!software_dispatch_table_.software_present_backing_store) {
+  if (software_dispatch_table_.software_present_backing_store_async) {
+    buffer_pool_ = std::make_shared<BufferPool>(
+        software_dispatch_table_.buffer_count > 0
+            ? software_dispatch_table_.buffer_count
+            : kDefaultBufferCount);
+  } else if (!software_dispatch_table_.software_present_backing_store) {
     return;
   }
   valid_ = true;
@@ -57,15 +155,22 @@ sk_sp<SkSurface> EmbedderSurfaceSoftware::AcquireBackingStore(
     return nullptr;
   }
 
+  if (buffer_pool_) {
+    sk_sp<SkSurface> backing_store = buffer_pool_->Acquire(size);
+    if (backing_store == nullptr) {
+      FML_LOG(ERROR)
+          << "Could not create backing store for software rendering.";
+    }
+    return backing_store;
+  }
+
   if (sk_surface_ != nullptr &&
       SkISize::Make(sk_surface_->width(), sk_surface_->height()) == size) {
     // The old and new surface sizes are the same. Nothing to do here.
     return sk_surface_;
   }
 
-  SkImageInfo info = SkImageInfo::MakeN32(
-      size.fWidth, size.fHeight, kPremul_SkAlphaType, SkColorSpace::MakeSRGB());
-  sk_surface_ = SkSurface::MakeRaster(info, nullptr);
+  sk_surface_ = CreateBackingStore(size);
 
   if (sk_surface_ == nullptr) {
     FML_LOG(ERROR) << "Could not create backing store for software rendering.";
@@ -78,6 +183,20 @@ sk_sp<SkSurface> EmbedderSurfaceSoftware::AcquireBackingStore(
 // |GPUSurfaceSoftwareDelegate|
 bool EmbedderSurfaceSoftware::PresentBackingStore(
     sk_sp<SkSurface> backing_store) {
+  SkIRect damage =
+      SkIRect::MakeWH(backing_store->width(), backing_store->height());
+  return Present(std::move(backing_store), damage);
+}
+
+// |GPUSurfaceSoftwareDelegate|
+bool EmbedderSurfaceSoftware::PresentBackingStoreDamage(
+    sk_sp<SkSurface> backing_store,
+    const SkIRect& damage) {
+  return Present(std::move(backing_store), damage);
+}
+
+bool EmbedderSurfaceSoftware::Present(sk_sp<SkSurface> backing_store,
+                                      const SkIRect& damage) {
   if (!IsValid()) {
     FML_LOG(ERROR) << "Tried to present an invalid software surface.";
     return false;
@@ -99,11 +218,31 @@ bool EmbedderSurfaceSoftware::PresentBackingStore(
     return false;
   }
 
-  return software_dispatch_table_.software_present_backing_store(
-      pixmap.addr(),      //
-      pixmap.rowBytes(),  //
-      pixmap.height()     //
-  );
+  if (!buffer_pool_) {
+    return software_dispatch_table_.software_present_backing_store(
+        pixmap.addr(),      //
+        pixmap.rowBytes(),  //
+        pixmap.height()     //
+    );
+  }
+
+  // The closure keeps the backing store alive until the embedder releases it,
+  // even if the surface is collected or resized in the meantime.
+  buffer_pool_->MarkPresented(backing_store);
+  auto release = [pool = buffer_pool_, backing_store]() {
+    pool->Release(backing_store);
+  };
+  if (!software_dispatch_table_.software_present_backing_store_async(
+          pixmap.addr(),      //
+          pixmap.rowBytes(),  //
+          pixmap.height(),    //
+          damage,             //
+          release             //
+          )) {
+    release();
+    return false;
+  }
+  return true;
 }
 
 // |GPUSurfaceSoftwareDelegate|
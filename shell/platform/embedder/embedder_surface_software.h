@@ -5,6 +5,9 @@
 #ifndef FLUTTER_SHELL_PLATFORM_EMBEDDER_EMBEDDER_SURFACE_SOFTWARE_H_
 #define FLUTTER_SHELL_PLATFORM_EMBEDDER_EMBEDDER_SURFACE_SOFTWARE_H_
 
+#include <memory>
+
+#include "flutter/fml/closure.h"
 #include "flutter/fml/macros.h"
 #include "flutter/shell/gpu/gpu_surface_software.h"
 #include "flutter/shell/platform/embedder/embedder_external_view_embedder.h"
@@ -16,8 +19,21 @@ class EmbedderSurfaceSoftware final : public EmbedderSurface,
                                       public GPUSurfaceSoftwareDelegate {
  public:
   struct SoftwareDispatchTable {
+    // Required unless |software_present_backing_store_async| is set.
     std::function<bool(const void* allocation, size_t row_bytes, size_t height)>
-        software_present_backing_store;  // required
+        software_present_backing_store;
+    // Presents the backing store without waiting for the embedder to consume
+    // it. The embedder invokes the closure once it is done with the pixels.
+    // If the call fails, the closure must not be invoked.
+    std::function<bool(const void* allocation,
+                       size_t row_bytes,
+                       size_t height,
+                       const SkIRect& damage,
+                       fml::closure release)>
+        software_present_backing_store_async;  // optional
+    // The number of backing stores rendered into in turn when presenting
+    // asynchronously. Zero picks the default of two.
+    size_t buffer_count = 0;
   };
 
   EmbedderSurfaceSoftware(
@@ -27,9 +43,15 @@ class EmbedderSurfaceSoftware final : public EmbedderSurface,
   ~EmbedderSurfaceSoftware() override;
 
  private:
+  class BufferPool;
+
   bool valid_ = false;
   SoftwareDispatchTable software_dispatch_table_;
   sk_sp<SkSurface> sk_surface_;
+  // The backing stores handed out in turn when presenting asynchronously.
+  // Shared with the release closures of the presented backing stores, which
+  // may outlive this surface.
+  std::shared_ptr<BufferPool> buffer_pool_;
   std::unique_ptr<EmbedderExternalViewEmbedder> external_view_embedder_;
 
   // |EmbedderSurface|
@@ -47,9 +69,15 @@ class EmbedderSurfaceSoftware final : public EmbedderSurface,
   // |GPUSurfaceSoftwareDelegate|
   bool PresentBackingStore(sk_sp<SkSurface> backing_store) override;
 
+  // |GPUSurfaceSoftwareDelegate|
+  bool PresentBackingStoreDamage(sk_sp<SkSurface> backing_store,
+                                 const SkIRect& damage) override;
+
   // |GPUSurfaceSoftwareDelegate|
   ExternalViewEmbedder* GetExternalViewEmbedder() override;
 
+  bool Present(sk_sp<SkSurface> backing_store, const SkIRect& damage);
+
   FML_DISALLOW_COPY_AND_ASSIGN(EmbedderSurfaceSoftware);
 };
 
@@ -161,6 +161,14 @@ void platform_messages_response() {
   signalNativeTest();
 }
 
+@pragma('vm:entry-point')
+void platform_message_response_from_embedder() {
+  window.sendPlatformMessage('test_channel', null, (ByteData data) {
+    var list = data.buffer.asUint8List(data.offsetInBytes, data.lengthInBytes);
+    signalNativeMessage(utf8.decode(list));
+  });
+}
+
 @pragma('vm:entry-point')
 void platform_messages_no_response() {
   window.onPlatformMessage = (String name, ByteData data, PlatformMessageResponseCallback callback) {
@@ -560,6 +568,21 @@ void push_frames_over_and_over() {
   window.scheduleFrame();
 }
 
+@pragma('vm:entry-point')
+void render_frames_over_and_over() {
+  int frame = 0;
+  window.onBeginFrame = (Duration duration) {
+    SceneBuilder builder = SceneBuilder();
+    builder.pushOffset(0.0, 0.0);
+    // The box moves on every frame, so that every frame is damaged.
+    builder.addPicture(Offset((frame % 100).toDouble(), 0.0), CreateColoredBox(Color.fromARGB(255, 128, 128, 128), Size(100.0, 100.0)));
+    builder.pop();
+    window.render(builder.build());
+    frame++;
+    window.scheduleFrame();
+  };
+  window.scheduleFrame();
+}
 
 @pragma('vm:entry-point')
 void platform_view_mutators() {
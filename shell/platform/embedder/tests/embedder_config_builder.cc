@@ -109,6 +109,19 @@ void EmbedderConfigBuilder::SetSoftwareRendererConfig(SkISize surface_size) {
   context_.SetupOpenGLSurface(surface_size);
 }
 
+void EmbedderConfigBuilder::SetSoftwareRendererAsyncPresentConfig(
+    SkISize surface_size,
+    size_t buffer_count) {
+  SetSoftwareRendererConfig(surface_size);
+  renderer_config_.software.surface_present_callback = nullptr;
+  renderer_config_.software.surface_present_async_callback =
+      [](void* context, const FlutterSoftwarePresentInfo* info) -> bool {
+    return reinterpret_cast<EmbedderTestContext*>(context)
+        ->SoftwarePresentAsync(info);
+  };
+  renderer_config_.software.surface_buffer_count = buffer_count;
+}
+
 void EmbedderConfigBuilder::SetOpenGLRendererConfig(SkISize surface_size) {
   renderer_config_.type = FlutterRendererType::kOpenGL;
   renderer_config_.open_gl = opengl_renderer_config_;
@@ -47,6 +47,11 @@ class EmbedderConfigBuilder {
 
   void SetSoftwareRendererConfig(SkISize surface_size = SkISize::Make(1, 1));
 
+  // Like |SetSoftwareRendererConfig|, but frames are presented with the
+  // asynchronous present callback using |buffer_count| buffers.
+  void SetSoftwareRendererAsyncPresentConfig(SkISize surface_size,
+                                             size_t buffer_count);
+
   void SetOpenGLRendererConfig(SkISize surface_size);
 
   void SetAssetsPath();
@@ -133,6 +133,11 @@ void EmbedderTestContext::SetPlatformMessageCallback(
   platform_message_callback_ = callback;
 }
 
+void EmbedderTestContext::SetSoftwarePresentAsyncCallback(
+    const SoftwarePresentAsyncCallback& callback) {
+  software_present_async_callback_ = callback;
+}
+
 void EmbedderTestContext::PlatformMessageCallback(
     const FlutterPlatformMessage* message) {
   if (platform_message_callback_) {
@@ -250,6 +255,28 @@ bool EmbedderTestContext::SofwarePresent(sk_sp<SkImage> image) {
   return true;
 }
 
+bool EmbedderTestContext::SoftwarePresentAsync(
+    const FlutterSoftwarePresentInfo* info) {
+  if (software_present_async_callback_) {
+    software_surface_present_count_++;
+    last_software_surface_present_damage_ = info->damage;
+    return software_present_async_callback_(info);
+  }
+  auto image_info = SkImageInfo::MakeN32Premul(
+      SkISize::Make(info->row_bytes / 4, info->height));
+  // Copy the pixels so that the buffer can be released right away.
+  auto image = SkImage::MakeRasterCopy(
+      SkPixmap(image_info, info->allocation, info->row_bytes));
+  if (!image) {
+    FML_LOG(ERROR) << "Could not copy pixels for the software composition "
+                      "from the engine.";
+    return false;
+  }
+  info->release_callback(info->release_user_data);
+  last_software_surface_present_damage_ = info->damage;
+  return SofwarePresent(std::move(image));
+}
+
 size_t EmbedderTestContext::GetGLSurfacePresentCount() const {
   return gl_surface_present_count_;
 }
@@ -258,6 +285,10 @@ size_t EmbedderTestContext::GetSoftwareSurfacePresentCount() const {
   return software_surface_present_count_;
 }
 
+FlutterRect EmbedderTestContext::GetLastSoftwareSurfacePresentDamage() const {
+  return last_software_surface_present_damage_;
+}
+
 /// @note Procedure doesn't copy all closures.
 void EmbedderTestContext::FireRootSurfacePresentCallbackIfPresent(
     const std::function<sk_sp<SkImage>(void)>& image_callback) {
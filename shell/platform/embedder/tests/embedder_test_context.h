@@ -27,6 +27,8 @@ namespace testing {
 using SemanticsNodeCallback = std::function<void(const FlutterSemanticsNode*)>;
 using SemanticsActionCallback =
     std::function<void(const FlutterSemanticsCustomAction*)>;
+using SoftwarePresentAsyncCallback =
+    std::function<bool(const FlutterSoftwarePresentInfo*)>;
 
 struct AOTDataDeleter {
   void operator()(FlutterEngineAOTData aot_data) {
@@ -71,6 +73,12 @@ class EmbedderTestContext {
   void SetPlatformMessageCallback(
       const std::function<void(const FlutterPlatformMessage*)>& callback);
 
+  // Replaces the default handling of the buffers presented asynchronously by
+  // the software renderer, which copies the pixels and releases the buffer
+  // right away. The callback is responsible for releasing the buffers.
+  void SetSoftwarePresentAsyncCallback(
+      const SoftwarePresentAsyncCallback& callback);
+
   EmbedderTestCompositor& GetCompositor();
 
   std::future<sk_sp<SkImage>> GetNextSceneImage();
@@ -79,6 +87,8 @@ class EmbedderTestContext {
 
   size_t GetSoftwareSurfacePresentCount() const;
 
+  FlutterRect GetLastSoftwareSurfacePresentDamage() const;
+
  private:
   // This allows the builder to access the hooks.
   friend class EmbedderConfigBuilder;
@@ -97,12 +107,14 @@ class EmbedderTestContext {
   SemanticsNodeCallback update_semantics_node_callback_;
   SemanticsActionCallback update_semantics_custom_action_callback_;
   std::function<void(const FlutterPlatformMessage*)> platform_message_callback_;
+  SoftwarePresentAsyncCallback software_present_async_callback_;
   std::unique_ptr<TestGLSurface> gl_surface_;
   std::unique_ptr<EmbedderTestCompositor> compositor_;
   NextSceneCallback next_scene_callback_;
   SkMatrix root_surface_transformation_;
   size_t gl_surface_present_count_ = 0;
   size_t software_surface_present_count_ = 0;
+  FlutterRect last_software_surface_present_damage_ = {};
 
   static VoidCallback GetIsolateCreateCallbackHook();
 
@@ -142,6 +154,8 @@ class EmbedderTestContext {
 
   bool SofwarePresent(sk_sp<SkImage> image);
 
+  bool SoftwarePresentAsync(const FlutterSoftwarePresentInfo* info);
+
   void FireRootSurfacePresentCallbackIfPresent(
       const std::function<sk_sp<SkImage>(void)>& image_callback);
 
@@ -4,6 +4,7 @@
 
 #define FML_USED_ON_EMBEDDER
 
+#include <atomic>
 #include <string>
 
 #include "embedder.h"
@@ -442,6 +443,164 @@ TEST_F(EmbedderTest, PlatformMessagesCanBeSentWithoutResponseHandles) {
   message.Wait();
 }
 
+//------------------------------------------------------------------------------
+/// Tests that the buffer of a platform message handed over to the engine is
+/// delivered intact and released exactly once, whether or not the message
+/// could be sent.
+///
+TEST_F(EmbedderTest, PlatformMessagesCanBeSentWithoutCopies) {
+  auto& context = GetEmbedderContext();
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+  builder.SetDartEntrypoint("platform_messages_no_response");
+
+  // Large enough that the buffer would not be copied if Dart could write to
+  // it.
+  const std::string message_data(64 * 1024, 'x');
+
+  fml::AutoResetWaitableEvent ready, message;
+  context.AddNativeCallback(
+      "SignalNativeTest",
+      CREATE_NATIVE_ENTRY(
+          [&ready](Dart_NativeArguments args) { ready.Signal(); }));
+  context.AddNativeCallback(
+      "SignalNativeMessage",
+      CREATE_NATIVE_ENTRY(
+          ([&message, &message_data](Dart_NativeArguments args) {
+            auto received_message = tonic::DartConverter<std::string>::FromDart(
+                Dart_GetNativeArgument(args, 0));
+            ASSERT_EQ(received_message, message_data);
+            message.Signal();
+          })));
+
+  auto engine = builder.LaunchEngine();
+
+  ASSERT_TRUE(engine.is_valid());
+  ready.Wait();
+
+  std::atomic_int release_count(0);
+  FlutterPlatformMessage platform_message = {};
+  platform_message.struct_size = sizeof(FlutterPlatformMessage);
+  platform_message.channel = "test_channel";
+  platform_message.message =
+      reinterpret_cast<const uint8_t*>(message_data.data());
+  platform_message.message_size = message_data.size();
+  platform_message.message_release_callback = [](void* user_data) {
+    ++*reinterpret_cast<std::atomic_int*>(user_data);
+  };
+  platform_message.message_release_user_data = &release_count;
+
+  // A message that can't be sent is released right away.
+  ASSERT_EQ(FlutterEngineSendPlatformMessage(nullptr, &platform_message),
+            kInvalidArguments);
+  ASSERT_EQ(release_count, 1);
+
+  auto result =
+      FlutterEngineSendPlatformMessage(engine.get(), &platform_message);
+  ASSERT_EQ(result, kSuccess);
+  message.Wait();
+
+  // The buffer is read-only to the engine, so it is copied into the Dart heap
+  // and released before the message reaches Dart.
+  ASSERT_EQ(release_count, 2);
+  engine.reset();
+  ASSERT_EQ(release_count, 2);
+}
+
+//------------------------------------------------------------------------------
+/// Tests that the buffer of a response sent without a copy is released exactly
+/// once with its user data, both when the response is sent and when sending it
+/// fails.
+///
+TEST_F(EmbedderTest, PlatformMessageResponsesCanBeSentWithoutCopies) {
+  auto& context = GetEmbedderContext();
+
+  // Large enough that the buffer would not be copied if Dart could write to
+  // it.
+  const std::string response_data(64 * 1024, 'x');
+
+  fml::AutoResetWaitableEvent message_latch, response_latch;
+  const FlutterPlatformMessageResponseHandle* response_handle = nullptr;
+  context.AddNativeCallback(
+      "SignalNativeMessage",
+      CREATE_NATIVE_ENTRY(
+          ([&response_latch, &response_data](Dart_NativeArguments args) {
+            auto received_response =
+                tonic::DartConverter<std::string>::FromDart(
+                    Dart_GetNativeArgument(args, 0));
+            ASSERT_EQ(received_response, response_data);
+            response_latch.Signal();
+          })));
+
+  // The platform message callback runs on the platform task runner, which is
+  // the thread the engine is launched on.
+  fml::Thread thread;
+  UniqueEngine engine;
+  thread.GetTaskRunner()->PostTask([&]() {
+    EmbedderConfigBuilder builder(context);
+    builder.SetSoftwareRendererConfig();
+    builder.SetDartEntrypoint("platform_message_response_from_embedder");
+    builder.SetPlatformMessageCallback(
+        [&](const FlutterPlatformMessage* message) {
+          if (strcmp(message->channel, "test_channel") == 0) {
+            response_handle = message->response_handle;
+            message_latch.Signal();
+          }
+        });
+    engine = builder.LaunchEngine();
+    ASSERT_TRUE(engine.is_valid());
+  });
+
+  message_latch.Wait();
+  ASSERT_TRUE(engine.is_valid());
+  ASSERT_NE(response_handle, nullptr);
+
+  struct ReleaseCaptures {
+    std::atomic_int count{0};
+    std::atomic<void*> user_data{nullptr};
+  };
+  auto release_callback = [](void* user_data) {
+    auto captures = reinterpret_cast<ReleaseCaptures*>(user_data);
+    captures->user_data = user_data;
+    captures->count++;
+  };
+
+  // A response that can't be sent is released right away, and the handle
+  // stays valid.
+  ReleaseCaptures failed_release;
+  ASSERT_EQ(FlutterEngineSendPlatformMessageResponseNoCopy(
+                engine.get(), response_handle, nullptr, response_data.size(),
+                release_callback, &failed_release),
+            kInvalidArguments);
+  ASSERT_EQ(failed_release.count, 1);
+  ASSERT_EQ(failed_release.user_data.load(), &failed_release);
+
+  ReleaseCaptures release;
+  ASSERT_EQ(FlutterEngineSendPlatformMessageResponseNoCopy(
+                engine.get(), response_handle,
+                reinterpret_cast<const uint8_t*>(response_data.data()),
+                response_data.size(), release_callback, &release),
+            kSuccess);
+  response_latch.Wait();
+
+  // The buffer is read-only to the engine, so it is copied into the Dart heap
+  // and released before the response reaches Dart.
+  ASSERT_EQ(release.count, 1);
+
+  // Since the engine was started on its own thread, it must be killed there as
+  // well.
+  fml::AutoResetWaitableEvent kill_latch;
+  thread.GetTaskRunner()->PostTask([&engine, &kill_latch]() {
+    engine.reset();
+    kill_latch.Signal();
+  });
+  kill_latch.Wait();
+
+  ASSERT_EQ(release.count, 1);
+  ASSERT_EQ(release.user_data.load(), &release);
+  ASSERT_EQ(failed_release.count, 1);
+}
+
 //------------------------------------------------------------------------------
 /// Tests that a null platform message can be sent.
 ///
@@ -2058,6 +2217,117 @@ TEST_F(EmbedderTest, CanRenderGradientWithoutCompositor) {
   ASSERT_TRUE(ImageMatchesFixture("gradient.png", renderered_scene));
 }
 
+TEST_F(EmbedderTest, CanRenderSceneWithSoftwareAsyncPresent) {
+  auto& context = GetEmbedderContext();
+
+  EmbedderConfigBuilder builder(context);
+
+  builder.SetDartEntrypoint("can_render_scene_without_custom_compositor");
+  builder.SetSoftwareRendererAsyncPresentConfig(SkISize::Make(800, 600), 3);
+
+  auto renderered_scene = context.GetNextSceneImage();
+
+  auto engine = builder.LaunchEngine();
+  ASSERT_TRUE(engine.is_valid());
+
+  // Send a window metrics events so frames may be scheduled.
+  FlutterWindowMetricsEvent event = {};
+  event.struct_size = sizeof(event);
+  event.width = 800;
+  event.height = 600;
+  event.pixel_ratio = 1.0;
+  ASSERT_EQ(FlutterEngineSendWindowMetricsEvent(engine.get(), &event),
+            kSuccess);
+
+  auto image = renderered_scene.get();
+  ASSERT_NE(image, nullptr);
+  ASSERT_EQ(image->width(), 800);
+  ASSERT_EQ(image->height(), 600);
+
+  // Nothing was presented before the first frame, so all of it is damaged.
+  FlutterRect damage = context.GetLastSoftwareSurfacePresentDamage();
+  ASSERT_EQ(damage.left, 0.0);
+  ASSERT_EQ(damage.top, 0.0);
+  ASSERT_EQ(damage.right, 800.0);
+  ASSERT_EQ(damage.bottom, 600.0);
+}
+
+TEST_F(EmbedderTest, SoftwareAsyncPresentWaitsForAndReusesReleasedBuffers) {
+  auto& context = GetEmbedderContext();
+
+  EmbedderConfigBuilder builder(context);
+
+  builder.SetDartEntrypoint("render_frames_over_and_over");
+  builder.SetSoftwareRendererAsyncPresentConfig(SkISize::Make(800, 600), 2);
+
+  // The first buffer is released asynchronously once both buffers have been
+  // presented. The second buffer is held until the end of the test, so all
+  // later frames have to wait for the first buffer to be released again.
+  constexpr size_t frames_expected = 6;
+  auto release_task_runner = CreateNewThread("release");
+  std::mutex mutex;
+  std::vector<const void*> allocations;
+  std::function<void()> first_release;
+  std::function<void()> held_release;
+  bool first_buffer_released = false;
+  fml::CountDownLatch frame_latch(frames_expected);
+  context.SetSoftwarePresentAsyncCallback(
+      [&](const FlutterSoftwarePresentInfo* info) {
+        std::scoped_lock lock(mutex);
+        const size_t frame = allocations.size();
+        allocations.push_back(info->allocation);
+        std::function<void()> release = [callback = info->release_callback,
+                                          user_data =
+                                              info->release_user_data]() {
+          callback(user_data);
+        };
+        if (frame == 0) {
+          first_release = release;
+        } else if (frame == 1) {
+          held_release = release;
+          release_task_runner->PostTask([&, release = first_release]() {
+            {
+              std::scoped_lock lock(mutex);
+              first_buffer_released = true;
+            }
+            release();
+          });
+        } else {
+          EXPECT_TRUE(first_buffer_released);
+          release_task_runner->PostTask(release);
+        }
+        if (frame < frames_expected) {
+          frame_latch.CountDown();
+        }
+        return true;
+      });
+
+  auto engine = builder.LaunchEngine();
+  ASSERT_TRUE(engine.is_valid());
+
+  // Send a window metrics events so frames may be scheduled.
+  FlutterWindowMetricsEvent event = {};
+  event.struct_size = sizeof(event);
+  event.width = 800;
+  event.height = 600;
+  event.pixel_ratio = 1.0;
+  ASSERT_EQ(FlutterEngineSendWindowMetricsEvent(engine.get(), &event),
+            kSuccess);
+
+  frame_latch.Wait();
+
+  {
+    std::scoped_lock lock(mutex);
+    ASSERT_GE(allocations.size(), frames_expected);
+    ASSERT_NE(allocations[0], allocations[1]);
+    for (size_t i = 2; i < frames_expected; i++) {
+      ASSERT_EQ(allocations[i], allocations[0]);
+    }
+  }
+
+  held_release();
+}
+
 TEST_F(EmbedderTest, CanRenderGradientWithoutCompositorWithXform) {
   auto& context = GetEmbedderContext();
 
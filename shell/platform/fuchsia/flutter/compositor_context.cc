@@ -30,7 +30,8 @@ class ScopedFrame final : public flutter::CompositorContext::ScopedFrame {
   SessionConnection& session_connection_;
 
   flutter::RasterStatus Raster(flutter::LayerTree& layer_tree,
-                               bool ignore_raster_cache) override {
+                               bool ignore_raster_cache,
+                               flutter::FrameDamage* frame_damage) override {
     if (!session_connection_.has_metrics()) {
       return flutter::RasterStatus::kSuccess;
     }
@@ -54,7 +54,8 @@ void RunDartCodeInIsolate(DartVMRef& vm_ref,
                           std::string entrypoint,
                           const std::vector<std::string>& args,
                           const std::string& fixtures_path,
-                          fml::WeakPtr<IOManager> io_manager) {
+                          fml::WeakPtr<IOManager> io_manager,
+                          fml::WeakPtr<ImageDecoder> image_decoder) {
   FML_CHECK(task_runners.GetUITaskRunner()->RunsTasksOnCurrentThread());
 
   if (!vm_ref) {
@@ -75,7 +76,7 @@ void RunDartCodeInIsolate(DartVMRef& vm_ref,
       {},                                 // snapshot delegate
       io_manager,                         // io manager
       {},                                 // unref queue
-      {},                                 // image decoder
+      image_decoder,                      // image decoder
       "main.dart",                        // advisory uri
       "main",                             // advisory entrypoint
       nullptr,                            // flags
@@ -159,13 +160,14 @@ std::unique_ptr<AutoIsolateShutdown> RunDartCodeInIsolate(
     std::string entrypoint,
     const std::vector<std::string>& args,
     const std::string& fixtures_path,
-    fml::WeakPtr<IOManager> io_manager) {
+    fml::WeakPtr<IOManager> io_manager,
+    fml::WeakPtr<ImageDecoder> image_decoder) {
   std::unique_ptr<AutoIsolateShutdown> result;
   fml::AutoResetWaitableEvent latch;
   fml::TaskRunner::RunNowOrPostTask(
       task_runners.GetUITaskRunner(), fml::MakeCopyable([&]() mutable {
         RunDartCodeInIsolate(vm_ref, result, settings, task_runners, entrypoint,
-                             args, fixtures_path, io_manager);
+                             args, fixtures_path, io_manager, image_decoder);
         latch.Signal();
       }));
   latch.Wait();
@@ -49,7 +49,8 @@ void RunDartCodeInIsolate(DartVMRef& vm_ref,
                           std::string entrypoint,
                           const std::vector<std::string>& args,
                           const std::string& fixtures_path,
-                          fml::WeakPtr<IOManager> io_manager = {});
+                          fml::WeakPtr<IOManager> io_manager = {},
+                          fml::WeakPtr<ImageDecoder> image_decoder = {});
 
 std::unique_ptr<AutoIsolateShutdown> RunDartCodeInIsolate(
     DartVMRef& vm_ref,
@@ -58,7 +59,8 @@ std::unique_ptr<AutoIsolateShutdown> RunDartCodeInIsolate(
     std::string entrypoint,
     const std::vector<std::string>& args,
     const std::string& fixtures_path,
-    fml::WeakPtr<IOManager> io_manager = {});
+    fml::WeakPtr<IOManager> io_manager = {},
+    fml::WeakPtr<ImageDecoder> image_decoder = {});
 
 }  // namespace testing
 }  // namespace flutter
@@ -15,6 +15,7 @@
  */
 
 #include <minikin/Layout.h>
+#include <cmath>
 
 #include "flutter/fml/command_line.h"
 #include "flutter/fml/logging.h"
@@ -243,6 +244,113 @@ BENCHMARK_REGISTER_F(ParagraphFixture, StylesBigO)
     ->Range(1 << 3, 1 << 12)
     ->Complexity(benchmark::oN);
 
+// Lays out the same paragraph at alternating widths, as happens when its
+// constraints change, for example while a window is resized. Relayout at
+// another width reuses the measured and shaped text, unless the paragraph is
+// made dirty before each layout (range(1) == 1).
+BENCHMARK_DEFINE_F(ParagraphFixture, RelayoutAtVaryingWidths)
+(benchmark::State& state) {
+  std::vector<uint16_t> text;
+  for (uint16_t i = 0; i < state.range(0); ++i) {
+    text.push_back(i % 5 == 0 ? ' ' : i);
+  }
+  std::u16string u16_text(text.data(), text.data() + text.size());
+
+  txt::ParagraphStyle paragraph_style;
+  paragraph_style.font_family = "Roboto";
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilderTxt builder(paragraph_style, font_collection_);
+
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+  paragraph->Layout(300);
+  bool dirty = state.range(1) != 0;
+  double width = 300;
+  while (state.KeepRunning()) {
+    if (dirty) {
+      paragraph->SetDirty();
+    }
+    width = width == 300 ? 200 : 300;
+    paragraph->Layout(width);
+  }
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK_REGISTER_F(ParagraphFixture, RelayoutAtVaryingWidths)
+    ->RangeMultiplier(4)
+    ->Ranges({{1 << 6, 1 << 14}, {0, 1}})
+    ->Complexity(benchmark::oN);
+
+// Builds a paragraph of |size| code units of words of varying length, as in
+// a long log message, and lays it out.
+static std::unique_ptr<ParagraphTxt> BuildLongParagraph(
+    std::shared_ptr<FontCollection> font_collection,
+    size_t size) {
+  std::u16string u16_text;
+  for (size_t i = 0; i < size; ++i) {
+    u16_text.push_back(i % 7 == 0 || i % 11 == 0 ? ' ' : 'a' + i % 26);
+  }
+
+  txt::ParagraphStyle paragraph_style;
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilderTxt builder(paragraph_style, font_collection);
+
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+  paragraph->Layout(300);
+  return paragraph;
+}
+
+BENCHMARK_DEFINE_F(ParagraphFixture, GetRectsForRangeLong)
+(benchmark::State& state) {
+  auto paragraph = BuildLongParagraph(font_collection_, state.range(0));
+  // A selection of a few lines that moves through the paragraph.
+  size_t start = 0;
+  while (state.KeepRunning()) {
+    start = (start + 997) % (state.range(0) - 200);
+    auto boxes = paragraph->GetRectsForRange(
+        start, start + 200, Paragraph::RectHeightStyle::kMax,
+        Paragraph::RectWidthStyle::kTight);
+    benchmark::DoNotOptimize(boxes);
+  }
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK_REGISTER_F(ParagraphFixture, GetRectsForRangeLong)
+    ->RangeMultiplier(10)
+    ->Range(1000, 100000)
+    ->Complexity(benchmark::oLogN);
+
+BENCHMARK_DEFINE_F(ParagraphFixture, GetGlyphPositionAtCoordinateLong)
+(benchmark::State& state) {
+  auto paragraph = BuildLongParagraph(font_collection_, state.range(0));
+  double height = paragraph->GetHeight();
+  // A caret dragged over the paragraph.
+  double dx = 0;
+  double dy = 0;
+  while (state.KeepRunning()) {
+    dx = fmod(dx + 37, 300);
+    dy = fmod(dy + 113, height);
+    auto position = paragraph->GetGlyphPositionAtCoordinate(dx, dy);
+    benchmark::DoNotOptimize(position);
+  }
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK_REGISTER_F(ParagraphFixture, GetGlyphPositionAtCoordinateLong)
+    ->RangeMultiplier(10)
+    ->Range(1000, 100000)
+    ->Complexity(benchmark::oLogN);
+
 BENCHMARK_F(ParagraphFixture, PaintSimple)(benchmark::State& state) {
   const char* text = "Hello world! This is a simple sentence to test drawing.";
   auto icu_text = icu::UnicodeString::fromUTF8(text);
@@ -20,8 +20,11 @@
 #include <unicode/ubidi.h>
 #include <unicode/utf16.h>
 #include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <iostream>  // for debugging
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -89,6 +92,8 @@ class LayoutCacheKey {
 
   android::hash_t hash() const { return mHash; }
 
+  size_t textBytes() const { return mNchars * sizeof(uint16_t); }
+
   void copyText() {
     uint16_t* charsCopy = new uint16_t[mNchars];
     memcpy(charsCopy, mChars, mNchars * sizeof(uint16_t));
@@ -129,53 +134,291 @@ class LayoutCacheKey {
   android::hash_t computeHash() const;
 };
 
-class LayoutCache : private android::OnEntryRemoved<LayoutCacheKey, Layout*> {
+// libtxt: The header of a shaped word in the layout cache. It is followed by
+// the faces, the glyphs and the advances of the word.
+struct RecordHeader {
+  float advance;
+  MinikinRect bounds;
+  uint32_t glyphCount;
+  uint32_t faceCount;
+  uint32_t advanceCount;
+};
+
+// libtxt: A LayoutGlyph of a shaped word in the layout cache.
+struct RecordGlyph {
+  uint32_t glyphId;
+  float x;
+  float y;
+  uint32_t cluster : 24;
+  uint32_t face : 8;
+};
+
+// libtxt: The cache of shaped words. The cache is split into shards that each
+// have their own lock, so that text can be laid out on several threads at once
+// without contending for a single lock, and words are shaped without holding
+// any lock.
+//
+// Each shard stores its words as compact records in an arena instead of as
+// individual Layout objects. Evicted records leave holes in the arena, which
+// is compacted once the holes take up most of it. The size of the cache is
+// limited in bytes, which keeps the number of entries high for text made of
+// short words, like CJK text where every ideograph is a word of its own.
+class LayoutCache {
  public:
-  LayoutCache() : mCache(kMaxEntries) {
-    mCache.setOnEntryRemovedListener(this);
+  LayoutCache() = default;
+
+  void clear() {
+    for (Shard& shard : mShards) {
+      std::scoped_lock _l(shard.mutex);
+      shard.clear();
+    }
+  }
+
+  // Appends the cached layout of |key| to |layout| and copies its advances
+  // into |advances|, either of which may be null. Returns false if the word
+  // isn't cached.
+  bool get(const LayoutCacheKey& key,
+           Layout* layout,
+           size_t bufStart,
+           float extraAdvance,
+           float* advances,
+           float* advance) {
+    Shard& shard = shardForKey(key);
+    std::scoped_lock _l(shard.mutex);
+    uint32_t slot = shard.entries.get(key);
+    if (slot == 0) {
+      shard.misses++;
+      return false;
+    }
+    shard.hits++;
+    const uint8_t* record = &shard.arena[shard.slots[slot - 1].offset];
+    const RecordHeader* header = reinterpret_cast<const RecordHeader*>(record);
+    if (layout) {
+      layout->appendRecord(record, bufStart, extraAdvance);
+    }
+    if (advances) {
+      memcpy(advances, recordAdvances(record),
+             header->advanceCount * sizeof(float));
+    }
+    *advance = header->advance;
+    return true;
   }
 
-  void clear() { mCache.clear(); }
+  void put(const LayoutCacheKey& key, const Layout& layout) {
+    if (layout.mFaces.size() > kMaxRecordFaces ||
+        layout.mAdvances.size() > kMaxRecordClusters) {
+      // The layout doesn't fit in a compact record.
+      return;
+    }
+    size_t recordSize = alignRecordSize(
+        sizeof(RecordHeader) + layout.mFaces.size() * sizeof(FakedFont) +
+        layout.mGlyphs.size() * sizeof(RecordGlyph) +
+        layout.mAdvances.size() * sizeof(float));
+    size_t entryBytes = recordSize + key.textBytes() + kEntryOverheadBytes;
+
+    Shard& shard = shardForKey(key);
+    std::scoped_lock _l(shard.mutex);
+    size_t shardMaxBytes = mMaxBytes / kShardCount;
+    if (entryBytes > shardMaxBytes || shard.entries.get(key) != 0) {
+      // Another thread may have laid out the same word in the meantime.
+      return;
+    }
+    while (shard.bytes + entryBytes > shardMaxBytes &&
+           shard.entries.removeOldest()) {
+      shard.evictions++;
+    }
+    shard.compactIfNeeded();
+
+    uint32_t slot = shard.allocateSlot();
+    Slot& entry = shard.slots[slot - 1];
+    entry.offset = shard.arena.size();
+    entry.recordSize = recordSize;
+    entry.entryBytes = entryBytes;
+    shard.arena.resize(shard.arena.size() + recordSize);
+    writeRecord(layout, &shard.arena[entry.offset]);
+    shard.liveArenaBytes += recordSize;
+    shard.bytes += entryBytes;
+
+    LayoutCacheKey storedKey = key;
+    storedKey.copyText();
+    shard.entries.put(storedKey, slot);
+  }
 
-  Layout* get(LayoutCacheKey& key,
-              LayoutContext* ctx,
-              const std::shared_ptr<FontCollection>& collection) {
-    Layout* layout = mCache.get(key);
-    if (layout == NULL) {
-      key.copyText();
-      layout = new Layout();
-      key.doLayout(layout, ctx, collection);
-      mCache.put(key, layout);
+  void setMaxBytes(size_t maxBytes) {
+    mMaxBytes = maxBytes;
+    size_t shardMaxBytes = maxBytes / kShardCount;
+    for (Shard& shard : mShards) {
+      std::scoped_lock _l(shard.mutex);
+      while (shard.bytes > shardMaxBytes && shard.entries.removeOldest()) {
+        shard.evictions++;
+      }
+      shard.compactIfNeeded();
     }
-    return layout;
+  }
+
+  LayoutCacheStats getStats() {
+    LayoutCacheStats stats;
+    stats.maxBytes = mMaxBytes;
+    for (Shard& shard : mShards) {
+      std::scoped_lock _l(shard.mutex);
+      stats.entryCount += shard.entries.size();
+      stats.byteCount += shard.bytes;
+      stats.hits += shard.hits;
+      stats.misses += shard.misses;
+      stats.evictions += shard.evictions;
+    }
+    return stats;
+  }
+
+  static const uint8_t* recordFaces(const uint8_t* record) {
+    return record + sizeof(RecordHeader);
+  }
+
+  static const RecordGlyph* recordGlyphs(const uint8_t* record) {
+    const RecordHeader* header = reinterpret_cast<const RecordHeader*>(record);
+    return reinterpret_cast<const RecordGlyph*>(
+        recordFaces(record) + header->faceCount * sizeof(FakedFont));
+  }
+
+  static const float* recordAdvances(const uint8_t* record) {
+    const RecordHeader* header = reinterpret_cast<const RecordHeader*>(record);
+    return reinterpret_cast<const float*>(recordGlyphs(record) +
+                                          header->glyphCount);
   }
 
  private:
-  // callback for OnEntryRemoved
-  void operator()(LayoutCacheKey& key, Layout*& value) {
-    key.freeText();
-    delete value;
+  // The location of a record in the arena of a shard.
+  struct Slot {
+    size_t offset = 0;
+    // Zero if the slot is free.
+    size_t recordSize = 0;
+    // The record, the text of the key and the bookkeeping of the entry.
+    size_t entryBytes = 0;
+  };
+
+  class Shard : private android::OnEntryRemoved<LayoutCacheKey, uint32_t> {
+   public:
+    std::mutex mutex;
+    // Maps words to their slot plus one, so that a missing word maps to zero.
+    android::LruCache<LayoutCacheKey, uint32_t> entries;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::vector<uint8_t> arena;
+    size_t liveArenaBytes = 0;
+    size_t bytes = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+
+    Shard() : entries(android::LruCache<LayoutCacheKey, uint32_t>::
+                          kUnlimitedCapacity) {
+      entries.setOnEntryRemovedListener(this);
+    }
+
+    ~Shard() { entries.clear(); }
+
+    void clear() {
+      entries.clear();
+      slots.clear();
+      freeSlots.clear();
+      arena.clear();
+      arena.shrink_to_fit();
+      liveArenaBytes = 0;
+    }
+
+    uint32_t allocateSlot() {
+      if (freeSlots.empty()) {
+        slots.emplace_back();
+        return slots.size();
+      }
+      uint32_t slot = freeSlots.back();
+      freeSlots.pop_back();
+      return slot;
+    }
+
+    // Moves the live records to a new arena once the holes left by evicted
+    // records take up more than half of the arena.
+    void compactIfNeeded() {
+      if (arena.size() < kMinCompactionBytes ||
+          liveArenaBytes * 2 > arena.size()) {
+        return;
+      }
+      std::vector<uint8_t> compacted;
+      compacted.reserve(liveArenaBytes * 2);
+      for (Slot& slot : slots) {
+        if (slot.recordSize == 0) {
+          continue;
+        }
+        size_t offset = compacted.size();
+        compacted.insert(compacted.end(), arena.begin() + slot.offset,
+                         arena.begin() + slot.offset + slot.recordSize);
+        slot.offset = offset;
+      }
+      arena.swap(compacted);
+    }
+
+   private:
+    // callback for OnEntryRemoved
+    void operator()(LayoutCacheKey& key, uint32_t& value) override {
+      key.freeText();
+      Slot& slot = slots[value - 1];
+      liveArenaBytes -= slot.recordSize;
+      bytes -= slot.entryBytes;
+      slot = Slot();
+      freeSlots.push_back(value);
+    }
+  };
+
+  // Records are aligned for the pointers of their faces.
+  static size_t alignRecordSize(size_t size) {
+    return (size + alignof(FakedFont) - 1) & ~(alignof(FakedFont) - 1);
   }
 
-  android::LruCache<LayoutCacheKey, Layout*> mCache;
+  static void writeRecord(const Layout& layout, uint8_t* record) {
+    RecordHeader* header = reinterpret_cast<RecordHeader*>(record);
+    header->advance = layout.mAdvance;
+    header->bounds = layout.mBounds;
+    header->glyphCount = layout.mGlyphs.size();
+    header->faceCount = layout.mFaces.size();
+    header->advanceCount = layout.mAdvances.size();
+    memcpy(record + sizeof(RecordHeader), layout.mFaces.data(),
+           layout.mFaces.size() * sizeof(FakedFont));
+    RecordGlyph* glyphs = const_cast<RecordGlyph*>(recordGlyphs(record));
+    for (size_t i = 0; i < layout.mGlyphs.size(); i++) {
+      const LayoutGlyph& glyph = layout.mGlyphs[i];
+      glyphs[i].glyphId = glyph.glyph_id;
+      glyphs[i].x = glyph.x;
+      glyphs[i].y = glyph.y;
+      glyphs[i].cluster = glyph.cluster;
+      glyphs[i].face = glyph.font_ix;
+    }
+    memcpy(const_cast<float*>(recordAdvances(record)), layout.mAdvances.data(),
+           layout.mAdvances.size() * sizeof(float));
+  }
 
-  // static const size_t kMaxEntries = LruCache<LayoutCacheKey,
-  // Layout*>::kUnlimitedCapacity;
+  Shard& shardForKey(const LayoutCacheKey& key) {
+    return mShards[key.hash() % kShardCount];
+  }
 
-  // TODO: eviction based on memory footprint; for now, we just use a constant
-  // number of strings
-  static const size_t kMaxEntries = 5000;
+  static const size_t kDefaultMaxBytes = 2 * 1024 * 1024;
+  static const size_t kShardCount = 16;
+  static const size_t kMaxRecordFaces = (1 << 8) - 1;
+  static const size_t kMaxRecordClusters = 1 << 24;
+  static const size_t kMinCompactionBytes = 64 * 1024;
+  // An estimate of the memory used by the LruCache for each entry.
+  static const size_t kEntryOverheadBytes =
+      sizeof(LayoutCacheKey) + 6 * sizeof(void*);
+
+  Shard mShards[kShardCount];
+  std::atomic<size_t> mMaxBytes{kDefaultMaxBytes};
 };
 
 class LayoutEngine {
  public:
   LayoutEngine() {
     unicodeFunctions = hb_unicode_funcs_create(hb_icu_get_unicode_funcs());
-    hbBuffer = hb_buffer_create();
-    hb_buffer_set_unicode_funcs(hbBuffer, unicodeFunctions);
   }
 
-  hb_buffer_t* hbBuffer;
   hb_unicode_funcs_t* unicodeFunctions;
   LayoutCache layoutCache;
 
@@ -183,6 +426,19 @@ class LayoutEngine {
     static LayoutEngine* instance = new LayoutEngine();
     return *instance;
   }
+
+  // libtxt: Each thread shapes text into its own buffer.
+  static hb_buffer_t* getHbBuffer() {
+    struct BufferHolder {
+      BufferHolder() : buffer(hb_buffer_create()) {
+        hb_buffer_set_unicode_funcs(buffer, getInstance().unicodeFunctions);
+      }
+      ~BufferHolder() { hb_buffer_destroy(buffer); }
+      hb_buffer_t* buffer;
+    };
+    static thread_local BufferHolder holder;
+    return holder.buffer;
+  }
 };
 
 bool LayoutCacheKey::operator==(const LayoutCacheKey& other) const {
@@ -316,7 +572,12 @@ int Layout::findFace(const FakedFont& face, LayoutContext* ctx) {
   // Note: ctx == NULL means we're copying from the cache, no need to create
   // corresponding hb_font object.
   if (ctx != NULL) {
-    hb_font_t* font = getHbFontLocked(face.font);
+    // libtxt: The cached hb_font_t is shared by all threads, so the paint of
+    // this layout is set on a sub font of it that only this layout uses.
+    std::scoped_lock _l(gMinikinLock);
+    hb_font_t* parent = getHbFontLocked(face.font);
+    hb_font_t* font = hb_font_create_sub_font(parent);
+    hb_font_destroy(parent);
     hb_font_set_funcs(font, getHbFontFuncs(isColorBitmapFont(font)),
                       &ctx->paint, 0);
     ctx->hbFonts.push_back(font);
@@ -325,10 +586,7 @@ int Layout::findFace(const FakedFont& face, LayoutContext* ctx) {
 }
 
 static hb_script_t codePointToScript(hb_codepoint_t codepoint) {
-  static hb_unicode_funcs_t* u = 0;
-  if (!u) {
-    u = LayoutEngine::getInstance().unicodeFunctions;
-  }
+  static hb_unicode_funcs_t* u = LayoutEngine::getInstance().unicodeFunctions;
   return hb_unicode_script(u, codepoint);
 }
 
@@ -588,8 +846,6 @@ void Layout::doLayout(const uint16_t* buf,
                       const FontStyle& style,
                       const MinikinPaint& paint,
                       const std::shared_ptr<FontCollection>& collection) {
-  std::scoped_lock _l(gMinikinLock);
-
   LayoutContext ctx;
   ctx.style = style;
   ctx.paint = paint;
@@ -612,8 +868,6 @@ float Layout::measureText(const uint16_t* buf,
                           const MinikinPaint& paint,
                           const std::shared_ptr<FontCollection>& collection,
                           float* advances) {
-  std::scoped_lock _l(gMinikinLock);
-
   LayoutContext ctx;
   ctx.style = style;
   ctx.paint = paint;
@@ -709,9 +963,14 @@ float Layout::doLayoutWord(const uint16_t* buf,
       count == 1 && isWordSpace(buf[start]) ? ctx->paint.wordSpacing : 0;
 
   float advance;
-  if (ctx->paint.skipCache()) {
+  bool skipCache = ctx->paint.skipCache();
+  if (skipCache ||
+      !cache.get(key, layout, bufStart, wordSpacing, advances, &advance)) {
     Layout layoutForWord;
     key.doLayout(&layoutForWord, ctx, collection);
+    if (!skipCache) {
+      cache.put(key, layoutForWord);
+    }
     if (layout) {
       layout->appendLayout(&layoutForWord, bufStart, wordSpacing);
     }
@@ -719,15 +978,6 @@ float Layout::doLayoutWord(const uint16_t* buf,
       layoutForWord.getAdvances(advances);
     }
     advance = layoutForWord.getAdvance();
-  } else {
-    Layout* layoutForWord = cache.get(key, ctx, collection);
-    if (layout) {
-      layout->appendLayout(layoutForWord, bufStart, wordSpacing);
-    }
-    if (advances) {
-      layoutForWord->getAdvances(advances);
-    }
-    advance = layoutForWord->getAdvance();
   }
 
   if (wordSpacing != 0) {
@@ -748,7 +998,7 @@ static void addFeatures(const std::string& str,
   const char* end = start + str.size();
 
   while (start < end) {
-    static hb_feature_t feature;
+    hb_feature_t feature;
     const char* p = strchr(start, ',');
     if (!p)
       p = end;
@@ -919,9 +1169,20 @@ void Layout::doLayoutRun(const uint16_t* buf,
                          bool isRtl,
                          LayoutContext* ctx,
                          const std::shared_ptr<FontCollection>& collection) {
-  hb_buffer_t* buffer = LayoutEngine::getInstance().hbBuffer;
+  hb_buffer_t* buffer = LayoutEngine::getHbBuffer();
   std::vector<FontCollection::Run> items;
-  collection->itemize(buf + start, count, ctx->style, &items);
+  // libtxt: Only font matching needs the global lock. The text is shaped
+  // without it.
+  std::vector<FontLanguage> langList;
+  {
+    std::scoped_lock _l(gMinikinLock);
+    collection->itemize(buf + start, count, ctx->style, &items);
+    const FontLanguages& languages =
+        FontLanguageListCache::getById(ctx->style.getLanguageListId());
+    for (size_t i = 0; i < languages.size(); ++i) {
+      langList.push_back(languages[i]);
+    }
+  }
 
   std::vector<hb_feature_t> features;
   // Disable default-on non-required ligature features if letter-spacing
@@ -1005,8 +1266,6 @@ void Layout::doLayoutRun(const uint16_t* buf,
       hb_buffer_set_script(buffer, script);
       hb_buffer_set_direction(buffer,
                               isRtl ? HB_DIRECTION_RTL : HB_DIRECTION_LTR);
-      const FontLanguages& langList =
-          FontLanguageListCache::getById(ctx->style.getLanguageListId());
       if (langList.size() != 0) {
         const FontLanguage* hbLanguage = &langList[0];
         for (size_t i = 0; i < langList.size(); ++i) {
@@ -1105,7 +1364,20 @@ void Layout::doLayoutRun(const uint16_t* buf,
   mAdvance = x;
 }
 
-void Layout::appendLayout(Layout* src, size_t start, float extraAdvance) {
+void Layout::doLayoutFromPieces(const Layout* const* pieces,
+                                const size_t* offsets,
+                                size_t pieceCount,
+                                size_t count) {
+  reset();
+  mAdvances.resize(count, 0);
+  for (size_t i = 0; i < pieceCount; i++) {
+    appendLayout(pieces[i], offsets[i], 0);
+  }
+}
+
+void Layout::appendLayout(const Layout* src,
+                          size_t start,
+                          float extraAdvance) {
   int fontMapStack[16];
   int* fontMap;
   if (src->mFaces.size() < sizeof(fontMapStack) / sizeof(fontMapStack[0])) {
@@ -1121,7 +1393,7 @@ void Layout::appendLayout(Layout* src, size_t start, float extraAdvance) {
   // jitter.
   float x0 = mAdvance;
   for (size_t i = 0; i < src->mGlyphs.size(); i++) {
-    LayoutGlyph& srcGlyph = src->mGlyphs[i];
+    const LayoutGlyph& srcGlyph = src->mGlyphs[i];
     int font_ix = fontMap[srcGlyph.font_ix];
     unsigned int glyph_id = srcGlyph.glyph_id;
     float x = x0 + srcGlyph.x;
@@ -1145,6 +1417,47 @@ void Layout::appendLayout(Layout* src, size_t start, float extraAdvance) {
   }
 }
 
+void Layout::appendRecord(const uint8_t* record,
+                          size_t start,
+                          float extraAdvance) {
+  const RecordHeader* header = reinterpret_cast<const RecordHeader*>(record);
+  const FakedFont* faces =
+      reinterpret_cast<const FakedFont*>(LayoutCache::recordFaces(record));
+  int fontMapStack[16];
+  int* fontMap;
+  if (header->faceCount < sizeof(fontMapStack) / sizeof(fontMapStack[0])) {
+    fontMap = fontMapStack;
+  } else {
+    fontMap = new int[header->faceCount];
+  }
+  for (size_t i = 0; i < header->faceCount; i++) {
+    fontMap[i] = findFace(faces[i], NULL);
+  }
+  float x0 = mAdvance;
+  const RecordGlyph* glyphs = LayoutCache::recordGlyphs(record);
+  for (size_t i = 0; i < header->glyphCount; i++) {
+    const RecordGlyph& srcGlyph = glyphs[i];
+    LayoutGlyph glyph = {fontMap[srcGlyph.face], srcGlyph.glyphId,
+                         x0 + srcGlyph.x, srcGlyph.y,
+                         static_cast<uint32_t>(srcGlyph.cluster + start)};
+    mGlyphs.push_back(glyph);
+  }
+  const float* advances = LayoutCache::recordAdvances(record);
+  for (size_t i = 0; i < header->advanceCount; i++) {
+    mAdvances[i + start] = advances[i];
+    if (i == 0)
+      mAdvances[i + start] += extraAdvance;
+  }
+  MinikinRect srcBounds(header->bounds);
+  srcBounds.offset(x0, 0);
+  mBounds.join(srcBounds);
+  mAdvance += header->advance + extraAdvance;
+
+  if (fontMap != fontMapStack) {
+    delete[] fontMap;
+  }
+}
+
 size_t Layout::nGlyphs() const {
   return mGlyphs.size();
 }
@@ -1184,7 +1497,7 @@ float Layout::getAdvance() const {
   return mAdvance;
 }
 
-void Layout::getAdvances(float* advances) {
+void Layout::getAdvances(float* advances) const {
   memcpy(advances, &mAdvances[0], mAdvances.size() * sizeof(float));
 }
 
@@ -1192,6 +1505,14 @@ void Layout::getBounds(MinikinRect* bounds) const {
   bounds->set(mBounds);
 }
 
+void Layout::setCacheMaxBytes(size_t maxBytes) {
+  LayoutEngine::getInstance().layoutCache.setMaxBytes(maxBytes);
+}
+
+LayoutCacheStats Layout::getCacheStats() {
+  return LayoutEngine::getInstance().layoutCache.getStats();
+}
+
 void Layout::purgeCaches() {
   std::scoped_lock _l(gMinikinLock);
   LayoutCache& layoutCache = LayoutEngine::getInstance().layoutCache;
@@ -57,6 +57,16 @@ enum {
   kBidi_Mask = 0x7
 };
 
+// libtxt extension: Statistics of the cache of shaped words.
+struct LayoutCacheStats {
+  size_t entryCount = 0;
+  size_t byteCount = 0;
+  size_t maxBytes = 0;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+};
+
 // Lifecycle and threading assumptions for Layout:
 // The object is assumed to be owned by a single thread; multiple threads
 // may not mutate it at the same time.
@@ -93,6 +103,17 @@ class Layout {
                            const std::shared_ptr<FontCollection>& collection,
                            float* advances);
 
+  // libtxt extension: Lays out |count| code units of text by appending the
+  // layouts of its pieces, each at the offset of the piece in the text, one
+  // after the other. This gives the same result as doLayout if each piece was
+  // laid out with doLayout from one of the words that doLayout splits the text
+  // into (see getNextWordBreakForCache), and the pieces are appended in the
+  // order doLayout lays the words out in, which is right to left for RTL text.
+  void doLayoutFromPieces(const Layout* const* pieces,
+                          const size_t* offsets,
+                          size_t pieceCount,
+                          size_t count);
+
   // public accessors
   size_t nGlyphs() const;
   const MinikinFont* getFont(int i) const;
@@ -106,7 +127,7 @@ class Layout {
 
   // Get advances, copying into caller-provided buffer. The size of this
   // buffer must match the length of the string (count arg to doLayout).
-  void getAdvances(float* advances);
+  void getAdvances(float* advances) const;
 
   // The i parameter is an offset within the buf relative to start, it is <
   // count, where start and count are the parameters to doLayout
@@ -117,7 +138,15 @@ class Layout {
   // Purge all caches, useful in low memory conditions
   static void purgeCaches();
 
+  // libtxt extension: Limits the memory used by the cache of shaped words,
+  // evicting the least recently used words if needed.
+  static void setCacheMaxBytes(size_t maxBytes);
+
+  // libtxt extension
+  static LayoutCacheStats getCacheStats();
+
  private:
+  friend class LayoutCache;
   friend class LayoutCacheKey;
 
   // Find a face in the mFaces vector, or create a new entry
@@ -163,7 +192,11 @@ class Layout {
                    const std::shared_ptr<FontCollection>& collection);
 
   // Append another layout (for example, cached value) into this one
-  void appendLayout(Layout* src, size_t start, float extraAdvance);
+  void appendLayout(const Layout* src, size_t start, float extraAdvance);
+
+  // libtxt extension: Append a shaped word record of the layout cache into
+  // this one
+  void appendRecord(const uint8_t* record, size_t start, float extraAdvance);
 
   std::vector<LayoutGlyph> mGlyphs;
   std::vector<float> mAdvances;
@@ -145,6 +145,16 @@ class LineBreaker {
                     size_t end,
                     bool isRtl);
 
+  // libtxt: Same as addStyleRun, but for text that has already been measured.
+  // The widths of its characters must have been copied into charWidths(). Used
+  // to break the same text again at another width without measuring it again.
+  void addMeasuredStyleRun(MinikinPaint* paint,
+                           const std::shared_ptr<FontCollection>& typeface,
+                           FontStyle style,
+                           size_t start,
+                           size_t end,
+                           bool isRtl);
+
   void addReplacement(size_t start, size_t end, float width);
 
   size_t computeBreaks();
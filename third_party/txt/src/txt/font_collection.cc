@@ -132,9 +132,12 @@ FontCollection::GetMinikinFontCollectionForFamilies(
     const std::string& locale) {
   // Look inside the font collections cache first.
   FamilyKey family_key(font_families, locale);
-  auto cached = font_collections_cache_.find(family_key);
-  if (cached != font_collections_cache_.end()) {
-    return cached->second;
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    auto cached = font_collections_cache_.find(family_key);
+    if (cached != font_collections_cache_.end()) {
+      return cached->second;
+    }
   }
 
   std::vector<std::shared_ptr<minikin::FontFamily>> minikin_families;
@@ -162,10 +165,12 @@ FontCollection::GetMinikinFontCollectionForFamilies(
   }
   // Default font family also not found. We fail to get a FontCollection.
   if (minikin_families.empty()) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
     font_collections_cache_[family_key] = nullptr;
     return nullptr;
   }
   if (enable_font_fallback_) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
     for (const std::string& fallback_family :
          fallback_fonts_for_locale_[locale]) {
       auto it = fallback_fonts_.find(fallback_family);
@@ -183,6 +188,7 @@ FontCollection::GetMinikinFontCollectionForFamilies(
   }
 
   // Cache the font collection for future queries.
+  std::lock_guard<std::mutex> lock(cache_mutex_);
   font_collections_cache_[family_key] = font_collection;
 
   return font_collection;
@@ -251,6 +257,7 @@ const std::shared_ptr<minikin::FontFamily>& FontCollection::MatchFallbackFont(
   // Check if the ch's matched font has been cached. We cache the results of
   // this method as repeated matchFamilyStyleCharacter calls can become
   // extremely laggy when typing a large number of complex emojis.
+  std::lock_guard<std::mutex> lock(cache_mutex_);
   auto lookup = fallback_match_cache_.find(ch);
   if (lookup != fallback_match_cache_.end()) {
     return *lookup->second;
@@ -312,6 +319,7 @@ FontCollection::GetFallbackFontFamily(const sk_sp<SkFontMgr>& manager,
 }
 
 void FontCollection::ClearFontFamilyCache() {
+  std::lock_guard<std::mutex> lock(cache_mutex_);
   font_collections_cache_.clear();
 }
 
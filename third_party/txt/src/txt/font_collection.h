@@ -18,6 +18,7 @@
 #define LIB_TXT_SRC_FONT_COLLECTION_H_
 
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -93,6 +94,11 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
   sk_sp<SkFontMgr> asset_font_manager_;
   sk_sp<SkFontMgr> dynamic_font_manager_;
   sk_sp<SkFontMgr> test_font_manager_;
+  // Guards the caches below, so that paragraphs using this collection can be
+  // laid out on several threads at once. It is never held while creating a
+  // minikin font collection, as minikin calls MatchFallbackFont while holding
+  // its own global lock.
+  std::mutex cache_mutex_;
   std::unordered_map<FamilyKey,
                      std::shared_ptr<minikin::FontCollection>,
                      FamilyKey::Hasher>
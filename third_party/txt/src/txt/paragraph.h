@@ -18,11 +18,17 @@
 #ifndef LIB_TXT_SRC_PARAGRAPH_H_
 #define LIB_TXT_SRC_PARAGRAPH_H_
 
+#include <memory>
+
 #include "line_metrics.h"
 #include "paragraph_style.h"
 
 class SkCanvas;
 
+namespace fml {
+class ConcurrentTaskRunner;
+}  // namespace fml
+
 namespace txt {
 
 // Interface for text layout engines.  The original implementation was based on
@@ -175,6 +181,11 @@ class Paragraph {
   virtual Range<size_t> GetWordBoundary(size_t offset) = 0;
 
   virtual std::vector<LineMetrics>& GetLineMetrics() = 0;
+
+  // Allows Layout() to spread the work of laying out long text over the
+  // workers of |task_runner|. Layout() still returns the finished layout.
+  virtual void SetConcurrentTaskRunner(
+      std::shared_ptr<fml::ConcurrentTaskRunner> task_runner) {}
 };
 
 }  // namespace txt
@@ -26,6 +26,7 @@
 #include <utility>
 #include <vector>
 
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/logging.h"
 #include "font_collection.h"
 #include "font_skia.h"
@@ -203,8 +204,19 @@ void ParagraphTxt::GlyphPosition::Shift(double delta) {
   x_pos.Shift(delta);
 }
 
-ParagraphTxt::GlyphLine::GlyphLine(std::vector<GlyphPosition>&& p, size_t tcu)
-    : positions(std::move(p)), total_code_units(tcu) {}
+ParagraphTxt::GlyphLine::GlyphLine(std::vector<GlyphPosition>&& p,
+                                   size_t tcu,
+                                   size_t start)
+    : positions(std::move(p)), total_code_units(tcu), start_code_unit(start) {
+  max_glyph_ends.reserve(positions.size());
+  double max_glyph_end = std::numeric_limits<double>::lowest();
+  for (size_t i = 0; i < positions.size(); ++i) {
+    double glyph_end = (i < positions.size() - 1) ? positions[i + 1].x_pos.start
+                                                  : positions[i].x_pos.end;
+    max_glyph_end = std::max(max_glyph_end, glyph_end);
+    max_glyph_ends.push_back(max_glyph_end);
+  }
+}
 
 ParagraphTxt::CodeUnitRun::CodeUnitRun(std::vector<GlyphPosition>&& p,
                                        Range<size_t> cu,
@@ -270,6 +282,7 @@ bool ParagraphTxt::ComputeLineBreaks() {
   // Calculate and add any breaks due to a line being too long.
   size_t run_index = 0;
   size_t inline_placeholder_index = 0;
+  size_t measured_run_index = 0;
   for (size_t newline_index = 0; newline_index < newline_positions.size();
        ++newline_index) {
     size_t block_start =
@@ -343,11 +356,26 @@ bool ParagraphTxt::ComputeLineBreaks() {
         breaker_.addStyleRun(nullptr, collection, font, run_start, run_end,
                              isRtl);
         inline_placeholder_index++;
+      } else if (shaping_cache_.valid) {
+        // Is a regular text run that was measured by a previous layout.
+        const MeasuredRun& measured_run =
+            shaping_cache_.measured_runs[measured_run_index++];
+        std::copy(measured_run.char_widths.begin(),
+                  measured_run.char_widths.end(),
+                  breaker_.charWidths() + run_start);
+        breaker_.addMeasuredStyleRun(&paint, collection, font, run_start,
+                                     run_end, isRtl);
+        block_total_width += measured_run.width;
       } else {
         // Is a regular text run.
         double run_width = breaker_.addStyleRun(&paint, collection, font,
                                                 run_start, run_end, isRtl);
         block_total_width += run_width;
+        const float* char_widths = breaker_.charWidths();
+        shaping_cache_.measured_runs.push_back(
+            {std::vector<float>(char_widths + run_start,
+                                char_widths + run_end),
+             run_width});
       }
 
       if (run.end > block_end)
@@ -512,6 +540,126 @@ bool ParagraphTxt::ComputeBidiRuns(std::vector<BidiRun>* result) {
   return true;
 }
 
+std::unique_ptr<ParagraphTxt::ShapedRun> ParagraphTxt::SplitIntoWords(
+    const BidiRun& bidi_run) const {
+  // Split the bidi run the same way minikin::Layout::doLayout does, so that
+  // each word is shaped with the same context.
+  auto shaped_run = std::make_unique<ShapedRun>();
+  size_t start = bidi_run.start();
+  size_t end = bidi_run.end();
+  while (start < end) {
+    size_t word_start, word_end;
+    if (bidi_run.is_rtl()) {
+      word_start =
+          std::max(start, minikin::getPrevWordBreakForCache(text_.data(), end,
+                                                            text_.size()));
+      word_end = end;
+      end = word_start;
+    } else {
+      word_start = start;
+      word_end = std::min(end, minikin::getNextWordBreakForCache(
+                                   text_.data(), start, text_.size()));
+      start = word_end;
+    }
+    shaped_run->words.push_back({word_start, word_end, minikin::Layout()});
+  }
+  return shaped_run;
+}
+
+void ParagraphTxt::ShapeWords(const BidiRun& bidi_run,
+                              ShapedRun* shaped_run,
+                              size_t start,
+                              size_t end) {
+  minikin::FontStyle minikin_font;
+  minikin::MinikinPaint minikin_paint;
+  GetFontAndMinikinPaint(bidi_run.style(), &minikin_font, &minikin_paint);
+  std::shared_ptr<minikin::FontCollection> minikin_font_collection =
+      GetMinikinFontCollectionForStyle(bidi_run.style());
+  for (size_t i = start; i < end; ++i) {
+    ShapedRun::Word& word = shaped_run->words[i];
+    word.layout.doLayout(text_.data(), word.start, word.end - word.start,
+                         text_.size(), bidi_run.is_rtl(), minikin_font,
+                         minikin_paint, minikin_font_collection);
+  }
+}
+
+void ParagraphTxt::ShapeBidiRunsConcurrently(size_t end) {
+  TRACE_EVENT0("flutter", "ParagraphTxt::ShapeBidiRunsConcurrently");
+  // Split the runs into words first, then shape batches of words in parallel.
+  struct ShapingTask {
+    size_t bidi_run_index;
+    size_t start;
+    size_t end;
+  };
+  std::vector<ShapingTask> tasks;
+  for (size_t i = 0; i < shaping_cache_.bidi_runs.size(); ++i) {
+    const BidiRun& bidi_run = shaping_cache_.bidi_runs[i];
+    if (bidi_run.start() >= end)
+      break;
+    std::unique_ptr<ShapedRun>& shaped_run = shaping_cache_.shaped_runs[i];
+    if (shaped_run != nullptr || bidi_run.is_placeholder_run())
+      continue;
+    shaped_run = SplitIntoWords(bidi_run);
+    for (size_t start = 0; start < shaped_run->words.size();
+         start += kWordsPerShapingTask) {
+      tasks.push_back(
+          {i, start,
+           std::min(start + kWordsPerShapingTask, shaped_run->words.size())});
+    }
+  }
+
+  concurrent_task_runner_->ParallelFor(tasks.size(), [&](size_t index) {
+    const ShapingTask& task = tasks[index];
+    ShapeWords(shaping_cache_.bidi_runs[task.bidi_run_index],
+               shaping_cache_.shaped_runs[task.bidi_run_index].get(),
+               task.start, task.end);
+  });
+}
+
+bool ParagraphTxt::LayoutFromShapedRun(size_t bidi_run_index,
+                                       const BidiRun& run,
+                                       minikin::Layout* layout) {
+  std::unique_ptr<ShapedRun>& shaped_run =
+      shaping_cache_.shaped_runs[bidi_run_index];
+  if (shaped_run == nullptr) {
+    const BidiRun& bidi_run = shaping_cache_.bidi_runs[bidi_run_index];
+    shaped_run = SplitIntoWords(bidi_run);
+    ShapeWords(bidi_run, shaped_run.get(), 0, shaped_run->words.size());
+  }
+
+  // Find the words that make up the part of the run being laid out. They are
+  // sorted by start index, in descending order for RTL runs.
+  const std::vector<ShapedRun::Word>& words = shaped_run->words;
+  auto first_word =
+      run.is_rtl()
+          ? std::lower_bound(words.begin(), words.end(), run.end(),
+                             [](const ShapedRun::Word& word, size_t index) {
+                               return word.end > index;
+                             })
+          : std::lower_bound(words.begin(), words.end(), run.start(),
+                             [](const ShapedRun::Word& word, size_t index) {
+                               return word.start < index;
+                             });
+  std::vector<const minikin::Layout*> word_layouts;
+  std::vector<size_t> word_offsets;
+  size_t covered_start = run.end();
+  size_t covered_end = run.start();
+  for (auto it = first_word; it != words.end() && it->start >= run.start() &&
+                             it->end <= run.end();
+       ++it) {
+    covered_start = std::min(covered_start, it->start);
+    covered_end = std::max(covered_end, it->end);
+    word_layouts.push_back(&it->layout);
+    word_offsets.push_back(it->start - run.start());
+  }
+  if (covered_start != run.start() || covered_end != run.end())
+    return false;
+
+  layout->doLayoutFromPieces(word_layouts.data(), word_offsets.data(),
+                             word_layouts.size(), run.size());
+  return true;
+}
+
 bool ParagraphTxt::IsStrutValid() const {
   // Font size must be positive.
   return (paragraph_style_.strut_enabled &&
@@ -666,11 +814,16 @@ void ParagraphTxt::Layout(double width) {
 
   width_ = rounded_width;
 
+  if (needs_layout_ || !shaping_cache_.valid)
+    shaping_cache_ = ShapingCache();
+
   needs_layout_ = false;
 
   records_.clear();
   glyph_lines_.clear();
   code_unit_runs_.clear();
+  code_unit_run_max_ends_.clear();
+  newline_x_positions_.clear();
   inline_placeholder_code_unit_runs_.clear();
   max_right_ = FLT_MIN;
   min_left_ = FLT_MAX;
@@ -679,9 +832,26 @@ void ParagraphTxt::Layout(double width) {
   if (!ComputeLineBreaks())
     return;
 
-  std::vector<BidiRun> bidi_runs;
-  if (!ComputeBidiRuns(&bidi_runs))
-    return;
+  if (!shaping_cache_.valid) {
+    if (!ComputeBidiRuns(&shaping_cache_.bidi_runs))
+      return;
+    shaping_cache_.shaped_runs.resize(shaping_cache_.bidi_runs.size());
+    shaping_cache_.valid = true;
+  }
+  const std::vector<BidiRun>& bidi_runs = shaping_cache_.bidi_runs;
+
+  // Paragraph bounds tracking.
+  size_t line_limit =
+      std::min(paragraph_style_.max_lines, line_metrics_.size());
+  did_exceed_max_lines_ = (line_metrics_.size() > paragraph_style_.max_lines);
+
+  // Shape long text on the workers of the concurrent task runner before
+  // laying out the lines. Only the lines that will be laid out are shaped.
+  if (concurrent_task_runner_ && text_.size() >= kMinConcurrentShapingSize &&
+      line_limit > 0) {
+    ShapeBidiRunsConcurrently(
+        line_metrics_[line_limit - 1].end_including_newline);
+  }
 
   SkFont font;
   font.setEdging(SkFont::Edging::kAntiAlias);
@@ -697,11 +867,6 @@ void ParagraphTxt::Layout(double width) {
   // Compute strut minimums according to paragraph_style_.
   ComputeStrut(&strut_, font);
 
-  // Paragraph bounds tracking.
-  size_t line_limit =
-      std::min(paragraph_style_.max_lines, line_metrics_.size());
-  did_exceed_max_lines_ = (line_metrics_.size() > paragraph_style_.max_lines);
-
   size_t placeholder_run_index = 0;
   for (size_t line_number = 0; line_number < line_limit; ++line_number) {
     LineMetrics& line_metrics = line_metrics_[line_number];
@@ -730,9 +895,11 @@ void ParagraphTxt::Layout(double width) {
             ? line_metrics.end_excluding_whitespace
             : line_metrics.end_index;
 
-    // Find the runs comprising this line.
+    // Find the runs comprising this line, and the bidi runs they are part of.
     std::vector<BidiRun> line_runs;
-    for (const BidiRun& bidi_run : bidi_runs) {
+    std::vector<size_t> line_run_bidi_indexes;
+    for (size_t bidi_index = 0; bidi_index < bidi_runs.size(); ++bidi_index) {
+      const BidiRun& bidi_run = bidi_runs[bidi_index];
       // A "ghost" run is a run that does not impact the layout, breaking,
       // alignment, width, etc but is still "visible" through getRectsForRange.
       // For example, trailing whitespace on centered text can be scrolled
@@ -755,6 +922,7 @@ void ParagraphTxt::Layout(double width) {
       // Include the ghost run before normal run if RTL
       if (bidi_run.direction() == TextDirection::rtl && ghost_run != nullptr) {
         line_runs.push_back(*ghost_run);
+        line_run_bidi_indexes.push_back(bidi_index);
       }
       // Emplace a normal line run.
       if (bidi_run.start() < line_end_index &&
@@ -775,10 +943,12 @@ void ParagraphTxt::Layout(double width) {
               std::min(bidi_run.end(), line_end_index), bidi_run.direction(),
               bidi_run.style());
         }
+        line_run_bidi_indexes.push_back(bidi_index);
       }
       // Include the ghost run after normal run if LTR
       if (bidi_run.direction() == TextDirection::ltr && ghost_run != nullptr) {
         line_runs.push_back(*ghost_run);
+        line_run_bidi_indexes.push_back(bidi_index);
       }
     }
     bool line_runs_all_rtl =
@@ -863,8 +1033,16 @@ void ParagraphTxt::Layout(double width) {
         }
       }
 
-      layout.doLayout(text_ptr, text_start, text_count, text_size, run.is_rtl(),
-                      minikin_font, minikin_paint, minikin_font_collection);
+      // Runs that were not ellipsized are laid out from the cached shaping
+      // results of their bidi run when possible.
+      if (!ellipsized_text.empty() || run.is_placeholder_run() ||
+          !LayoutFromShapedRun(
+              line_run_bidi_indexes[line_run_it - line_runs.begin()], run,
+              &layout)) {
+        layout.doLayout(text_ptr, text_start, text_count, text_size,
+                        run.is_rtl(), minikin_font, minikin_paint,
+                        minikin_font_collection);
+      }
 
       if (layout.nGlyphs() == 0)
         continue;
@@ -1095,8 +1273,13 @@ void ParagraphTxt::Layout(double width) {
     size_t next_line_start = (line_number < line_metrics_.size() - 1)
                                  ? line_metrics_[line_number + 1].start_index
                                  : text_.size();
+    size_t line_start_code_unit =
+        glyph_lines_.empty() ? 0
+                             : glyph_lines_.back().start_code_unit +
+                                   glyph_lines_.back().total_code_units;
     glyph_lines_.emplace_back(std::move(line_glyph_positions),
-                              next_line_start - line_metrics.start_index);
+                              next_line_start - line_metrics.start_index,
+                              line_start_code_unit);
     code_unit_runs_.insert(code_unit_runs_.end(), line_code_unit_runs.begin(),
                            line_code_unit_runs.end());
     inline_placeholder_code_unit_runs_.insert(
@@ -1173,6 +1356,20 @@ void ParagraphTxt::Layout(double width) {
               return a.code_units.start < b.code_units.start;
             });
 
+  // Index the runs for hit testing.
+  code_unit_run_max_ends_.reserve(code_unit_runs_.size());
+  newline_x_positions_.assign(line_metrics_.size(),
+                              std::numeric_limits<double>::quiet_NaN());
+  for (const CodeUnitRun& run : code_unit_runs_) {
+    code_unit_run_max_ends_.push_back(
+        code_unit_run_max_ends_.empty()
+            ? run.code_units.end
+            : std::max(code_unit_run_max_ends_.back(), run.code_units.end));
+    // Truncated to whole pixels, as the newline boxes have always been.
+    newline_x_positions_[run.line_number] = static_cast<size_t>(
+        run.direction == TextDirection::ltr ? run.x_pos.end : run.x_pos.start);
+  }
+
   longest_line_ = max_right_ - min_left_;
 }
 
@@ -1649,23 +1846,26 @@ std::vector<Paragraph::TextBox> ParagraphTxt::GetRectsForRange(
   // Text direction of the first line so we can extend the correct side for
   // RectWidthStyle::kMax.
   TextDirection first_line_dir = TextDirection::ltr;
-  std::map<size_t, size_t> newline_x_positions;
 
   // Lines that are actually in the requested range.
   size_t max_line = 0;
   size_t min_line = INT_MAX;
   size_t glyph_length = 0;
 
+  // Skip the runs that end before the range.
+  size_t first_run_index =
+      std::upper_bound(code_unit_run_max_ends_.begin(),
+                       code_unit_run_max_ends_.end(), start) -
+      code_unit_run_max_ends_.begin();
+
   // Generate initial boxes and calculate metrics.
-  for (const CodeUnitRun& run : code_unit_runs_) {
+  for (size_t run_index = first_run_index; run_index < code_unit_runs_.size();
+       ++run_index) {
+    const CodeUnitRun& run = code_unit_runs_[run_index];
     // Check to see if we are finished.
     if (run.code_units.start >= end)
       break;
 
-    // Update new line x position with the ending of last bidi run on the line
-    newline_x_positions[run.line_number] =
-        run.direction == TextDirection::ltr ? run.x_pos.end : run.x_pos.start;
-
     if (run.code_units.end <= start)
       continue;
 
@@ -1726,8 +1926,14 @@ std::vector<Paragraph::TextBox> ParagraphTxt::GetRectsForRange(
 
   // Add empty rectangles representing any newline characters within the
   // range.
-  for (size_t line_number = 0; line_number < line_metrics_.size();
-       ++line_number) {
+  size_t first_line_number =
+      std::upper_bound(line_metrics_.begin(), line_metrics_.end(), start,
+                       [](size_t index, const LineMetrics& line) {
+                         return index < line.end_including_newline;
+                       }) -
+      line_metrics_.begin();
+  for (size_t line_number = first_line_number;
+       line_number < line_metrics_.size(); ++line_number) {
     LineMetrics& line = line_metrics_[line_number];
     if (line.start_index >= end)
       break;
@@ -1737,9 +1943,9 @@ std::vector<Paragraph::TextBox> ParagraphTxt::GetRectsForRange(
       if (line.end_index != line.end_including_newline &&
           line.end_index >= start && line.end_including_newline <= end) {
         SkScalar x;
-        auto it = newline_x_positions.find(line_number);
-        if (it != newline_x_positions.end()) {
-          x = it->second;
+        if (line_number < newline_x_positions_.size() &&
+            !isnan(newline_x_positions_[line_number])) {
+          x = newline_x_positions_[line_number];
         } else {
           x = GetLineXOffset(0, false);
         }
@@ -1856,61 +2062,55 @@ Paragraph::PositionWithAffinity ParagraphTxt::GetGlyphPositionAtCoordinate(
   if (final_line_count_ <= 0)
     return PositionWithAffinity(0, DOWNSTREAM);
 
-  size_t y_index;
-  for (y_index = 0; y_index < final_line_count_ - 1; ++y_index) {
-    if (dy < line_metrics_[y_index].height)
-      break;
-  }
-
-  const std::vector<GlyphPosition>& line_glyph_position =
-      glyph_lines_[y_index].positions;
+  // Find the first line that ends below dy. The heights of the lines are
+  // cumulative.
+  size_t y_index =
+      std::upper_bound(line_metrics_.begin(),
+                       line_metrics_.begin() + final_line_count_ - 1, dy,
+                       [](double y, const LineMetrics& line) {
+                         return y < line.height;
+                       }) -
+      line_metrics_.begin();
+
+  const GlyphLine& glyph_line = glyph_lines_[y_index];
+  const std::vector<GlyphPosition>& line_glyph_position = glyph_line.positions;
   if (line_glyph_position.empty()) {
-    int line_start_index =
-        std::accumulate(glyph_lines_.begin(), glyph_lines_.begin() + y_index, 0,
-                        [](const int a, const GlyphLine& b) {
-                          return a + static_cast<int>(b.total_code_units);
-                        });
-    return PositionWithAffinity(line_start_index, DOWNSTREAM);
-  }
-
-  size_t x_index;
-  const GlyphPosition* gp = nullptr;
-  const GlyphPosition* gp_cluster = nullptr;
-  bool is_cluster_corection = false;
-  for (x_index = 0; x_index < line_glyph_position.size(); ++x_index) {
-    double glyph_end = (x_index < line_glyph_position.size() - 1)
-                           ? line_glyph_position[x_index + 1].x_pos.start
-                           : line_glyph_position[x_index].x_pos.end;
-    if (gp_cluster == nullptr ||
-        gp_cluster->cluster != line_glyph_position[x_index].cluster) {
-      gp_cluster = &line_glyph_position[x_index];
-    }
-    if (dx < glyph_end) {
-      // Check if the glyph position is part of a cluster. If it is,
-      // we assign the cluster's root GlyphPosition to represent it.
-      if (gp_cluster->cluster == line_glyph_position[x_index].cluster) {
-        gp = gp_cluster;
-        // Detect if the matching GlyphPosition was non-root for the cluster.
-        if (gp_cluster != &line_glyph_position[x_index]) {
-          is_cluster_corection = true;
-        }
-      } else {
-        gp = &line_glyph_position[x_index];
-      }
-      break;
-    }
+    return PositionWithAffinity(glyph_line.start_code_unit, DOWNSTREAM);
   }
 
-  if (gp == nullptr) {
+  // Find the first glyph that ends after dx.
+  size_t x_index = std::upper_bound(glyph_line.max_glyph_ends.begin(),
+                                    glyph_line.max_glyph_ends.end(), dx) -
+                   glyph_line.max_glyph_ends.begin();
+  if (x_index == line_glyph_position.size()) {
     const GlyphPosition& last_glyph = line_glyph_position.back();
     return PositionWithAffinity(last_glyph.code_units.end, UPSTREAM);
   }
 
-  // Find the direction of the run that contains this glyph.
+  // Check if the glyph position is part of a cluster. If it is, we assign the
+  // cluster's root GlyphPosition to represent it.
+  size_t cluster_index = x_index;
+  while (cluster_index > 0 &&
+         line_glyph_position[cluster_index - 1].cluster ==
+             line_glyph_position[x_index].cluster) {
+    cluster_index--;
+  }
+  const GlyphPosition* gp = &line_glyph_position[cluster_index];
+  // Detect if the matching GlyphPosition was non-root for the cluster.
+  bool is_cluster_corection = cluster_index != x_index;
+
+  // Find the direction of the run that contains this glyph, skipping the runs
+  // that end before it.
   TextDirection direction = TextDirection::ltr;
-  for (const CodeUnitRun& run : code_unit_runs_) {
-    if (gp->code_units.start >= run.code_units.start &&
-        gp->code_units.end <= run.code_units.end) {
+  for (size_t run_index =
+           std::lower_bound(code_unit_run_max_ends_.begin(),
+                            code_unit_run_max_ends_.end(), gp->code_units.end) -
+           code_unit_run_max_ends_.begin();
+       run_index < code_unit_runs_.size(); ++run_index) {
+    const CodeUnitRun& run = code_unit_runs_[run_index];
+    if (run.code_units.start > gp->code_units.start)
+      break;
+    if (gp->code_units.end <= run.code_units.end) {
       direction = run.direction;
       break;
     }
@@ -2005,6 +2205,21 @@ bool ParagraphTxt::DidExceedMaxLines() {
   return did_exceed_max_lines_;
 }
 
+void ParagraphTxt::SetConcurrentTaskRunner(
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner) {
+  concurrent_task_runner_ = std::move(task_runner);
+}
+
+void ParagraphTxt::LayoutAll(const std::vector<ParagraphTxt*>& paragraphs,
+                             const std::vector<double>& widths,
+                             fml::ConcurrentTaskRunner& task_runner) {
+  TRACE_EVENT0("flutter", "ParagraphTxt::LayoutAll");
+  FML_DCHECK(paragraphs.size() == widths.size());
+  task_runner.ParallelFor(paragraphs.size(), [&](size_t index) {
+    paragraphs[index]->Layout(widths[index]);
+  });
+}
+
 void ParagraphTxt::SetDirty(bool dirty) {
   needs_layout_ = dirty;
 }
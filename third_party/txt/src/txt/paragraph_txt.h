@@ -17,6 +17,7 @@
 #ifndef LIB_TXT_SRC_PARAGRAPH_TXT_H_
 #define LIB_TXT_SRC_PARAGRAPH_TXT_H_
 
+#include <memory>
 #include <set>
 #include <utility>
 #include <vector>
@@ -25,6 +26,7 @@
 #include "flutter/fml/macros.h"
 #include "font_collection.h"
 #include "line_metrics.h"
+#include "minikin/Layout.h"
 #include "minikin/LineBreaker.h"
 #include "paint_record.h"
 #include "paragraph.h"
@@ -121,6 +123,17 @@ class ParagraphTxt : public Paragraph {
   // line in the final layout.
   std::vector<LineMetrics>& GetLineMetrics() override;
 
+  void SetConcurrentTaskRunner(
+      std::shared_ptr<fml::ConcurrentTaskRunner> task_runner) override;
+
+  // Lays out each of |paragraphs| at the width at the same index in |widths|,
+  // spreading the paragraphs over the workers of |task_runner| and the calling
+  // thread. Returns when all the paragraphs are laid out. The paragraphs must
+  // be distinct and must not be used on other threads meanwhile.
+  static void LayoutAll(const std::vector<ParagraphTxt*>& paragraphs,
+                        const std::vector<double>& widths,
+                        fml::ConcurrentTaskRunner& task_runner);
+
   // Sets the needs_layout_ to dirty. When Layout() is called, a new Layout will
   // be performed when this is set to true. Can also be used to prevent a new
   // Layout from being calculated by setting to false.
@@ -128,6 +141,7 @@ class ParagraphTxt : public Paragraph {
 
  private:
   friend class ParagraphBuilderTxt;
+  friend class ParagraphTest;
   FRIEND_TEST(ParagraphTest, SimpleParagraph);
   FRIEND_TEST(ParagraphTest, SimpleParagraphSmall);
   FRIEND_TEST(ParagraphTest, SimpleRedParagraph);
@@ -163,6 +177,7 @@ class ParagraphTxt : public Paragraph {
   FRIEND_TEST(ParagraphTest, GetGlyphPositionAtCoordinateSegfault);
   FRIEND_TEST(ParagraphTest, KhmerLineBreaker);
   FRIEND_TEST(ParagraphTest, TextHeightBehaviorRectsParagraph);
+  FRIEND_TEST(ParagraphTest, ConcurrentLayoutMatchesSerialLayout);
 
   // Starting data to layout.
   std::vector<uint16_t> text_;
@@ -185,6 +200,8 @@ class ParagraphTxt : public Paragraph {
   minikin::LineBreaker breaker_;
   mutable std::unique_ptr<icu::BreakIterator> word_breaker_;
 
+  std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner_;
+
   std::vector<LineMetrics> line_metrics_;
   size_t final_line_count_;
   std::vector<double> line_widths_;
@@ -277,8 +294,14 @@ class ParagraphTxt : public Paragraph {
     // Glyph positions sorted by x coordinate.
     const std::vector<GlyphPosition> positions;
     const size_t total_code_units;
-
-    GlyphLine(std::vector<GlyphPosition>&& p, size_t tcu);
+    // Sum of the total_code_units of the previous lines.
+    const size_t start_code_unit;
+    // The largest x coordinate at which each glyph or any glyph before it
+    // ends, where a glyph ends where the next one starts. Nondecreasing, so
+    // it can be binary searched for the glyph at an x coordinate.
+    std::vector<double> max_glyph_ends;
+
+    GlyphLine(std::vector<GlyphPosition>&& p, size_t tcu, size_t start);
   };
 
   struct CodeUnitRun {
@@ -310,6 +333,14 @@ class ParagraphTxt : public Paragraph {
   // Holds the positions of each range of code units in the text.
   // Sorted in code unit index order.
   std::vector<CodeUnitRun> code_unit_runs_;
+  // The largest code unit index at which each run in code_unit_runs_ or any
+  // run before it ends. Nondecreasing, so it can be binary searched for the
+  // first run that ends after an index.
+  std::vector<size_t> code_unit_run_max_ends_;
+  // For each line, the x position of the end of its last run in
+  // code_unit_runs_, which is where a selected newline character is drawn.
+  // NaN for lines without runs.
+  std::vector<double> newline_x_positions_;
   // Holds the positions of the inline placeholders.
   std::vector<CodeUnitRun> inline_placeholder_code_unit_runs_;
 
@@ -324,6 +355,47 @@ class ParagraphTxt : public Paragraph {
 
   bool needs_layout_ = true;
 
+  // The advances of the characters of a text run, as measured for the line
+  // breaker.
+  struct MeasuredRun {
+    std::vector<float> char_widths;
+    double width;
+  };
+
+  // The layout of a bidi run, split into the words that minikin shapes
+  // separately. Appending the layouts of the words that make up a part of the
+  // run gives the same result as laying out that part of the run.
+  struct ShapedRun {
+    struct Word {
+      size_t start;
+      size_t end;
+      minikin::Layout layout;
+    };
+    // Ordered as minikin lays them out: right to left in RTL runs.
+    std::vector<Word> words;
+  };
+
+  // Below this many code units, the text of a paragraph is shaped on the
+  // calling thread even if a concurrent task runner is set.
+  static constexpr size_t kMinConcurrentShapingSize = 2000;
+
+  // The number of words shaped by each task when shaping concurrently.
+  static constexpr size_t kWordsPerShapingTask = 64;
+
+  // Holds the results of the parts of Layout() that do not depend on the
+  // width, so that laying out the paragraph again at another width does not
+  // need to measure and shape the text again. It is cleared whenever the
+  // paragraph needs layout.
+  struct ShapingCache {
+    bool valid = false;
+    // The regular text runs in the order they were added to the line breaker.
+    std::vector<MeasuredRun> measured_runs;
+    std::vector<BidiRun> bidi_runs;
+    // Shaped on first use. Indexed like bidi_runs.
+    std::vector<std::unique_ptr<ShapedRun>> shaped_runs;
+  };
+  ShapingCache shaping_cache_;
+
   struct WaveCoordinates {
     double x_start;
     double y_start;
@@ -352,6 +424,29 @@ class ParagraphTxt : public Paragraph {
   // Break the text into runs based on LTR/RTL text direction.
   bool ComputeBidiRuns(std::vector<BidiRun>* result);
 
+  // Splits |bidi_run| into the words that minikin::Layout::doLayout shapes
+  // separately, without shaping them.
+  std::unique_ptr<ShapedRun> SplitIntoWords(const BidiRun& bidi_run) const;
+
+  // Shapes the words in [start, end) of |shaped_run|, which was split from
+  // |bidi_run|. Safe to call concurrently for distinct words.
+  void ShapeWords(const BidiRun& bidi_run,
+                  ShapedRun* shaped_run,
+                  size_t start,
+                  size_t end);
+
+  // Shapes the words of the bidi runs that start before |end| and were not
+  // shaped yet on the workers of concurrent_task_runner_.
+  void ShapeBidiRunsConcurrently(size_t end);
+
+  // Lays out the part of the bidi run at |bidi_run_index| that |run| covers
+  // from the cached shaping results of the words of the bidi run. Returns
+  // false if |run| does not start and end at word boundaries, in which case
+  // it has to be laid out with minikin::Layout::doLayout.
+  bool LayoutFromShapedRun(size_t bidi_run_index,
+                           const BidiRun& run,
+                           minikin::Layout* layout);
+
   // Calculates and populates strut based on paragraph_style_ strut info.
   void ComputeStrut(StrutMetrics* strut, SkFont& font);
 
@@ -16,7 +16,9 @@
 
 #include <iostream>
 
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/logging.h"
+#include "minikin/Layout.h"
 #include "render_test.h"
 #include "third_party/icu/source/common/unicode/unistr.h"
 #include "third_party/skia/include/core/SkColor.h"
@@ -33,7 +35,41 @@
 
 namespace txt {
 
-using ParagraphTest = RenderTest;
+class ParagraphTest : public RenderTest {
+ protected:
+  // Builds a paragraph of |text| in black 26pt Roboto.
+  std::unique_ptr<ParagraphTxt> BuildRobotoParagraph(
+      const std::u16string& text,
+      const ParagraphStyle& paragraph_style = ParagraphStyle()) {
+    ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+    TextStyle text_style;
+    text_style.font_families = std::vector<std::string>(1, "Roboto");
+    text_style.font_size = 26;
+    text_style.color = SK_ColorBLACK;
+    builder.PushStyle(text_style);
+    builder.AddText(text);
+    builder.Pop();
+    return BuildParagraph(builder);
+  }
+
+  // Asserts that the glyphs of |paragraph| are laid out on the same lines and
+  // at the same positions as those of |expected|.
+  static void AssertSameGlyphPositions(const ParagraphTxt& paragraph,
+                                       const ParagraphTxt& expected) {
+    ASSERT_EQ(paragraph.glyph_lines_.size(), expected.glyph_lines_.size());
+    for (size_t i = 0; i < expected.glyph_lines_.size(); ++i) {
+      const auto& positions = paragraph.glyph_lines_[i].positions;
+      const auto& expected_positions = expected.glyph_lines_[i].positions;
+      ASSERT_EQ(positions.size(), expected_positions.size());
+      for (size_t j = 0; j < expected_positions.size(); ++j) {
+        ASSERT_EQ(positions[j].code_units.start,
+                  expected_positions[j].code_units.start);
+        ASSERT_EQ(positions[j].x_pos.start, expected_positions[j].x_pos.start);
+        ASSERT_EQ(positions[j].x_pos.end, expected_positions[j].x_pos.end);
+      }
+    }
+  }
+};
 
 TEST_F(ParagraphTest, SimpleParagraph) {
   const char* text = "Hello World Text Dialog";
@@ -6483,4 +6519,135 @@ TEST_F(ParagraphTest, TextHeightBehaviorRectsParagraph) {
   ASSERT_TRUE(Snapshot());
 }
 
+TEST_F(ParagraphTest, RelayoutMatchesFreshLayout) {
+  const char* text =
+      "This is a very long sentence to test if the text will properly wrap "
+      "around and go to the next line. אאא בּבּבּבּ אאאא בּבּ אאא בּבּבּ "
+      "Sometimes, short sentence.\nLonger sentences are okay too.";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+  paragraph_style.text_align = TextAlign::center;
+  auto relaid_paragraph = BuildRobotoParagraph(u16_text, paragraph_style);
+  for (double width : {GetTestCanvasWidth() - 100.0, 150.0, 330.0, 75.0}) {
+    auto fresh_paragraph = BuildRobotoParagraph(u16_text, paragraph_style);
+    fresh_paragraph->Layout(width);
+    relaid_paragraph->Layout(width);
+
+    ASSERT_EQ(relaid_paragraph->GetHeight(), fresh_paragraph->GetHeight());
+    ASSERT_EQ(relaid_paragraph->GetMaxIntrinsicWidth(),
+              fresh_paragraph->GetMaxIntrinsicWidth());
+    ASSERT_EQ(relaid_paragraph->GetLineCount(),
+              fresh_paragraph->GetLineCount());
+    ASSERT_NO_FATAL_FAILURE(
+        AssertSameGlyphPositions(*relaid_paragraph, *fresh_paragraph));
+  }
+}
+
+TEST_F(ParagraphTest, ConcurrentLayoutMatchesSerialLayout) {
+  std::string text;
+  while (text.size() < 4 * ParagraphTxt::kMinConcurrentShapingSize) {
+    text += "The quick brown fox jumps over the lazy dog. אאא בּבּבּבּ אאאא. ";
+  }
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  const double width = GetTestCanvasWidth() - 100;
+  auto serial_paragraph = BuildRobotoParagraph(u16_text);
+  serial_paragraph->Layout(width);
+
+  auto concurrent_paragraph = BuildRobotoParagraph(u16_text);
+  concurrent_paragraph->SetConcurrentTaskRunner(loop->GetTaskRunner());
+  auto batch_paragraph_1 = BuildRobotoParagraph(u16_text);
+  auto batch_paragraph_2 = BuildRobotoParagraph(u16_text);
+  ParagraphTxt::LayoutAll(
+      {concurrent_paragraph.get(), batch_paragraph_1.get(),
+       batch_paragraph_2.get()},
+      {width, width, width}, *loop->GetTaskRunner());
+
+  for (auto* paragraph : {concurrent_paragraph.get(), batch_paragraph_1.get(),
+                          batch_paragraph_2.get()}) {
+    ASSERT_EQ(paragraph->GetHeight(), serial_paragraph->GetHeight());
+    ASSERT_EQ(paragraph->GetLineCount(), serial_paragraph->GetLineCount());
+    ASSERT_NO_FATAL_FAILURE(
+        AssertSameGlyphPositions(*paragraph, *serial_paragraph));
+  }
+}
+
+TEST_F(ParagraphTest, ConcurrentLayoutWithoutLines) {
+  std::string text;
+  while (text.size() < 8000) {
+    text += "The quick brown fox jumps over the lazy dog. ";
+  }
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  // dart:ui passes any number of lines through, including none.
+  txt::ParagraphStyle paragraph_style;
+  paragraph_style.max_lines = 0;
+  auto paragraph = BuildRobotoParagraph(u16_text, paragraph_style);
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  paragraph->SetConcurrentTaskRunner(loop->GetTaskRunner());
+  paragraph->Layout(GetTestCanvasWidth() - 100);
+
+  ASSERT_EQ(paragraph->GetLineCount(), 0ull);
+  ASSERT_TRUE(paragraph->DidExceedMaxLines());
+}
+
+// Sets the byte budget of the layout cache, and restores the previous budget
+// when it goes out of scope, even if the test fails first.
+class ScopedLayoutCacheMaxBytes {
+ public:
+  explicit ScopedLayoutCacheMaxBytes(size_t max_bytes)
+      : previous_max_bytes_(minikin::Layout::getCacheStats().maxBytes) {
+    minikin::Layout::setCacheMaxBytes(max_bytes);
+  }
+
+  ~ScopedLayoutCacheMaxBytes() {
+    minikin::Layout::setCacheMaxBytes(previous_max_bytes_);
+  }
+
+ private:
+  const size_t previous_max_bytes_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ScopedLayoutCacheMaxBytes);
+};
+
+TEST_F(ParagraphTest, LayoutCacheStaysWithinBudget) {
+  std::string text;
+  for (int i = 0; text.size() < 20000; ++i) {
+    text += "word" + std::to_string(i) + " 漢字かな交じり文 ";
+  }
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  minikin::Layout::purgeCaches();
+  const size_t max_bytes = 64 * 1024;
+  ScopedLayoutCacheMaxBytes scoped_max_bytes(max_bytes);
+
+  auto paragraph = BuildRobotoParagraph(u16_text);
+  paragraph->Layout(GetTestCanvasWidth());
+  minikin::LayoutCacheStats stats = minikin::Layout::getCacheStats();
+  EXPECT_EQ(stats.maxBytes, max_bytes);
+  EXPECT_LE(stats.byteCount, max_bytes);
+  EXPECT_GT(stats.entryCount, 0u);
+  EXPECT_GT(stats.evictions, 0u);
+
+  // Laying out the same text again hits the words that are still cached.
+  uint64_t hits = stats.hits;
+  auto cached_paragraph = BuildRobotoParagraph(u16_text);
+  cached_paragraph->Layout(GetTestCanvasWidth());
+  stats = minikin::Layout::getCacheStats();
+  EXPECT_GT(stats.hits, hits);
+  EXPECT_LE(stats.byteCount, max_bytes);
+  ASSERT_NO_FATAL_FAILURE(
+      AssertSameGlyphPositions(*cached_paragraph, *paragraph));
+}
+
 }  // namespace txt